@@ -0,0 +1,182 @@
+#ifndef AUTO_EXPOSURE_H
+#define AUTO_EXPOSURE_H
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+// CPU reference of the auto exposure compute passes of the HDR demo (6.histogram.cs and
+// 6.histogram_average.cs). The luminance of every pixel is sorted into one of 256 bins on a log2
+// scale: bin 0 holds pixels darker than 2^MinLogLuminance (black), bins 1 to 255 evenly cover
+// [MinLogLuminance, MinLogLuminance + LogLuminanceRange]. The average skips bin 0 and clips the
+// darkest LowPercentile and brightest HighPercentile of the remaining pixels, so a few very dark
+// or very bright pixels don't swing the exposure. The exposure then adapts towards that average
+// over time, faster when the scene gets brighter than when it gets darker, like the eye does.
+// The GPU passes follow these functions operation for operation so their results can be compared.
+struct AutoExposureSettings
+{
+    float MinLogLuminance = -8.0f;
+    float LogLuminanceRange = 12.0f;
+    float LowPercentile = 0.1f;     // fraction of the lit pixels ignored at the dark end
+    float HighPercentile = 0.02f;   // fraction of the lit pixels ignored at the bright end
+    float KeyValue = 0.18f;         // middle grey: the average luminance maps to this
+    float SpeedUp = 3.0f;           // adaptation rate towards brighter scenes, per second
+    float SpeedDown = 1.0f;         // adaptation rate towards darker scenes, per second
+};
+
+typedef std::array<uint32_t, 256> LuminanceHistogram;
+
+inline float AutoExposureLuminance(const glm::vec3& color)
+{
+    return glm::dot(color, glm::vec3(0.2126f, 0.7152f, 0.0722f));
+}
+
+inline unsigned int AutoExposureBin(float luminance, const AutoExposureSettings& settings)
+{
+    if (luminance < std::exp2(settings.MinLogLuminance))
+        return 0;
+    float t = glm::clamp((std::log2(luminance) - settings.MinLogLuminance) / settings.LogLuminanceRange, 0.0f, 1.0f);
+    return (unsigned int)(t * 254.0f + 1.0f);
+}
+
+// histogram of an image with 'channels' floats per pixel (RGB in the first three)
+inline LuminanceHistogram BuildLuminanceHistogram(const float* pixels, size_t pixelCount, unsigned int channels, const AutoExposureSettings& settings)
+{
+    LuminanceHistogram histogram;
+    histogram.fill(0);
+    for (size_t i = 0; i < pixelCount; i++)
+    {
+        const float* p = pixels + i * channels;
+        histogram[AutoExposureBin(AutoExposureLuminance(glm::vec3(p[0], p[1], p[2])), settings)]++;
+    }
+    return histogram;
+}
+
+// average luminance of the histogram with the outliers clipped; the center of a bin stands for all its pixels
+inline float HistogramAverageLuminance(const LuminanceHistogram& histogram, const AutoExposureSettings& settings)
+{
+    uint32_t lit = 0;
+    for (unsigned int bin = 1; bin < 256; bin++)
+        lit += histogram[bin];
+    if (lit == 0)
+        return std::exp2(settings.MinLogLuminance);
+
+    float low = lit * settings.LowPercentile;
+    float high = lit * (1.0f - settings.HighPercentile);
+    float weightedBins = 0.0f, counted = 0.0f;
+    uint32_t before = 0;
+    for (unsigned int bin = 1; bin < 256; bin++)
+    {
+        uint32_t after = before + histogram[bin];
+        float count = glm::clamp((float)after, low, high) - glm::clamp((float)before, low, high);
+        weightedBins += count * (bin - 1);
+        counted += count;
+        before = after;
+    }
+    float averageBin = counted > 0.0f ? weightedBins / counted : 0.0f;
+    return std::exp2((averageBin + 0.5f) / 254.0f * settings.LogLuminanceRange + settings.MinLogLuminance);
+}
+
+// moves the adapted luminance towards the target over 'deltaTime' seconds
+inline float AdaptLuminance(float adapted, float target, float deltaTime, const AutoExposureSettings& settings)
+{
+    float speed = target > adapted ? settings.SpeedUp : settings.SpeedDown;
+    return adapted + (target - adapted) * (1.0f - std::exp(-deltaTime * speed));
+}
+
+inline float ExposureFromLuminance(float luminance, const AutoExposureSettings& settings)
+{
+    return settings.KeyValue / std::max(luminance, 1e-4f);
+}
+
+// luminance at the center of a bin of 1 to 255, the value HistogramAverageLuminance stands the bin for
+inline float AutoExposureBinCenter(unsigned int bin, const AutoExposureSettings& settings)
+{
+    return std::exp2((bin - 0.5f) / 254.0f * settings.LogLuminanceRange + settings.MinLogLuminance);
+}
+
+// checks the reference on synthetic images whose histograms are known, no GPU needed:
+// - misbinnedPixels: pixels of an image with 'bin' grey pixels at each bin center, plus black pixels and
+//   pixels beyond the range, that don't land in the expected bin (black in 0, too bright clamped to 255)
+// - maxAverageError: largest difference in stops between HistogramAverageLuminance and the hand-computed
+//   average of images with outliers that exactly fill the clipped fractions, so they mustn't move it
+// - maxAdaptError: largest deviation of an AdaptLuminance step from the closed form with the right
+//   speed for each direction, and of a long adaptation from the target, including any overshoot
+inline void AutoExposureValidate(unsigned int& misbinnedPixels, float& maxAverageError, float& maxAdaptError, const AutoExposureSettings& settings = AutoExposureSettings())
+{
+    // binning; the luminance weights sum to 1 so a grey pixel's luminance is its value
+    LuminanceHistogram expected;
+    expected.fill(0);
+    std::vector<float> pixels;
+    for (unsigned int bin = 1; bin < 256; bin++)
+    {
+        for (unsigned int i = 0; i < bin; i++)
+            pixels.insert(pixels.end(), 3, AutoExposureBinCenter(bin, settings));
+        expected[bin] += bin;
+    }
+    const float black[] = { 0.0f, 0.5f * std::exp2(settings.MinLogLuminance) };
+    for (float value : black)
+        pixels.insert(pixels.end(), 3, value);
+    expected[0] += 2;
+    const float bright[] = { std::exp2(settings.MinLogLuminance + settings.LogLuminanceRange + 1.0f), 1e30f };
+    for (float value : bright)
+        pixels.insert(pixels.end(), 3, value);
+    expected[255] += 2;
+    LuminanceHistogram histogram = BuildLuminanceHistogram(pixels.data(), pixels.size() / 3, 3, settings);
+    misbinnedPixels = 0;
+    for (unsigned int bin = 0; bin < 256; bin++)
+        misbinnedPixels += (unsigned int)std::abs((long long)histogram[bin] - (long long)expected[bin]);
+
+    // percentile clipping: 1000 lit pixels, the darkest LowPercentile in bin 1 and the brightest
+    // HighPercentile in bin 255, the rest split between two bins whose average is known
+    maxAverageError = 0.0f;
+    const unsigned int lit = 1000;
+    const unsigned int dark = (unsigned int)std::lround(lit * settings.LowPercentile);
+    const unsigned int light = (unsigned int)std::lround(lit * settings.HighPercentile);
+    const unsigned int cases[][2] = { { 100, 100 }, { 60, 120 }, { 2, 254 }, { 128, 200 } };
+    for (const auto& bins : cases)
+    {
+        unsigned int middle = lit - dark - light;
+        histogram.fill(0);
+        histogram[0] = 5000; // black doesn't count towards the average at all
+        histogram[1] += dark;
+        histogram[255] += light;
+        histogram[bins[0]] += middle / 2;
+        histogram[bins[1]] += middle - middle / 2;
+        float averageBin = ((middle / 2) * (bins[0] - 1.0f) + (middle - middle / 2) * (bins[1] - 1.0f)) / middle;
+        float average = std::exp2((averageBin + 0.5f) / 254.0f * settings.LogLuminanceRange + settings.MinLogLuminance);
+        maxAverageError = std::max(maxAverageError, std::abs(std::log2(HistogramAverageLuminance(histogram, settings) / average)));
+    }
+    // an all black image falls back to the bottom of the range
+    histogram.fill(0);
+    histogram[0] = lit;
+    maxAverageError = std::max(maxAverageError, std::abs(std::log2(HistogramAverageLuminance(histogram, settings)) - settings.MinLogLuminance));
+
+    // adaptation: one step of each direction, a zero step, and a long run that mustn't overshoot
+    maxAdaptError = 0.0f;
+    const float deltaTime = 1.0f / 60.0f;
+    maxAdaptError = std::max(maxAdaptError, std::abs(AdaptLuminance(0.1f, 1.0f, deltaTime, settings) - (0.1f + 0.9f * (1.0f - std::exp(-deltaTime * settings.SpeedUp)))));
+    maxAdaptError = std::max(maxAdaptError, std::abs(AdaptLuminance(1.0f, 0.1f, deltaTime, settings) - (1.0f - 0.9f * (1.0f - std::exp(-deltaTime * settings.SpeedDown)))));
+    maxAdaptError = std::max(maxAdaptError, std::abs(AdaptLuminance(0.3f, 5.0f, 0.0f, settings) - 0.3f));
+    const float targets[] = { 0.01f, 4.0f };
+    for (float target : targets)
+    {
+        float adapted = target > 1.0f ? 0.01f : 4.0f;
+        for (unsigned int i = 0; i < 3600; i++)
+        {
+            float next = AdaptLuminance(adapted, target, deltaTime, settings);
+            bool overshoot = (next - target) * (adapted - target) < 0.0f || std::abs(next - target) > std::abs(adapted - target);
+            if (overshoot)
+                maxAdaptError = std::max(maxAdaptError, std::abs(next - target));
+            adapted = next;
+        }
+        maxAdaptError = std::max(maxAdaptError, std::abs(adapted - target) / target);
+    }
+}
+
+// AUTO_EXPOSURE_H
+#endif
@@ -0,0 +1,292 @@
+#ifndef CDLOD_H
+#define CDLOD_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <chrono>
+
+// Continuous distance-dependent level of detail (CDLOD) for heightmap terrain. The heightmap is
+// covered by a quadtree whose leaves are LeafSize texels wide; every level up doubles the node
+// size. Each frame the tree is walked from the root and a node is drawn as soon as the camera is
+// far enough away that its children aren't needed. All nodes are drawn with the same small grid
+// mesh, displaced by the height texture in the vertex shader, so the vertex and draw count only
+// depend on the view distance and not on the size of the heightmap. Within the last part of its
+// range a grid vertex morphs towards the grid of the next coarser level so there are no seams
+// or pops between levels.
+struct CDLODSettings
+{
+    unsigned int LeafSize = 64;         // texels covered by a leaf node, power of two
+    unsigned int GridResolution = 64;   // quads per side of the shared grid mesh, power of two
+    unsigned int LodLevels = 7;
+    float LeafRange = 160.0f;           // view range of the finest level, doubles every level
+    float MorphStartRatio = 0.66f;      // morphing starts at this fraction of a level's range
+};
+
+// a node picked by CDLODTerrain::Select(). When only some children of a node are needed, the
+// remaining quarters are drawn at the parent's level with a half resolution grid so the vertex
+// spacing still matches that level; Select() returns those in a separate list.
+struct CDLODNode
+{
+    glm::vec2 Offset;   // world xz of the corner with the lowest coordinates
+    float Size;         // world size of the covered square
+    float Level;        // 0 = finest
+};
+
+// frustum planes (a, b, c, d with the normal pointing inward) of a view-projection matrix
+struct CDLODFrustum
+{
+    glm::vec4 Planes[6];
+
+    explicit CDLODFrustum(const glm::mat4& viewProjection)
+    {
+        glm::mat4 m = glm::transpose(viewProjection);
+        Planes[0] = m[3] + m[0];
+        Planes[1] = m[3] - m[0];
+        Planes[2] = m[3] + m[1];
+        Planes[3] = m[3] - m[1];
+        Planes[4] = m[3] + m[2];
+        Planes[5] = m[3] - m[2];
+    }
+
+    bool IntersectsBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+    {
+        for (const glm::vec4& plane : Planes)
+        {
+            // the box corner furthest along the plane normal
+            glm::vec3 p(plane.x > 0.0f ? boxMax.x : boxMin.x,
+                        plane.y > 0.0f ? boxMax.y : boxMin.y,
+                        plane.z > 0.0f ? boxMax.z : boxMin.z);
+            if (glm::dot(glm::vec3(plane), p) + plane.w < 0.0f)
+                return false;
+        }
+        return true;
+    }
+};
+
+class CDLODTerrain
+{
+public:
+    CDLODSettings Settings;
+    glm::vec2 Origin = glm::vec2(0.0f);     // world xz of texel (0, 0)
+    glm::ivec2 Extent = glm::ivec2(0);      // texels along world x and z
+
+    // builds the min/max height pyramid of the quadtree. The heightmap is laid out like in
+    // terrain_cpu_src: row i maps to world x = origin.x + i, column j to world z = origin.y + j,
+    // and the height of a texel is its first channel * yScale - yShift.
+    void Build(const unsigned char* data, int width, int height, int channels, float yScale, float yShift,
+               const glm::vec2& origin, const CDLODSettings& settings)
+    {
+        Settings = settings;
+        Origin = origin;
+        Extent = glm::ivec2(height, width);
+
+        // the root has to cover the whole map, add levels to the tree if needed
+        unsigned int rootSize = Settings.LeafSize << (Settings.LodLevels - 1);
+        while (rootSize < (unsigned int)std::max(width, height))
+        {
+            Settings.LodLevels++;
+            rootSize *= 2;
+        }
+
+        levels.assign(Settings.LodLevels, Level());
+        for (unsigned int l = 0; l < Settings.LodLevels; l++)
+        {
+            Level& level = levels[l];
+            level.NodeSize = Settings.LeafSize << l;
+            level.Count = rootSize / level.NodeSize;
+            level.MinHeight.assign(level.Count * level.Count, 1.0f);
+            level.MaxHeight.assign(level.Count * level.Count, -1.0f); // min > max: outside the map
+        }
+
+        // leaves; a leaf shares its last row and column of texels with its neighbours
+        Level& leaves = levels[0];
+        for (unsigned int ix = 0; ix < leaves.Count; ix++)
+        {
+            int row0 = ix * leaves.NodeSize;
+            if (row0 >= height)
+                break;
+            int row1 = std::min(row0 + (int)leaves.NodeSize, height - 1);
+            for (unsigned int iz = 0; iz < leaves.Count; iz++)
+            {
+                int column0 = iz * leaves.NodeSize;
+                if (column0 >= width)
+                    break;
+                int column1 = std::min(column0 + (int)leaves.NodeSize, width - 1);
+                unsigned char low = 255, high = 0;
+                for (int i = row0; i <= row1; i++)
+                {
+                    const unsigned char* texel = data + ((size_t)width * i + column0) * channels;
+                    for (int j = column0; j <= column1; j++, texel += channels)
+                    {
+                        low = std::min(low, texel[0]);
+                        high = std::max(high, texel[0]);
+                    }
+                }
+                leaves.MinHeight[leaves.Index(ix, iz)] = low * yScale - yShift;
+                leaves.MaxHeight[leaves.Index(ix, iz)] = high * yScale - yShift;
+            }
+        }
+
+        // every parent bounds its four children
+        for (unsigned int l = 1; l < Settings.LodLevels; l++)
+        {
+            Level& level = levels[l];
+            const Level& children = levels[l - 1];
+            for (unsigned int ix = 0; ix < level.Count; ix++)
+            {
+                for (unsigned int iz = 0; iz < level.Count; iz++)
+                {
+                    float low = 1e30f, high = -1e30f;
+                    for (unsigned int c = 0; c < 4; c++)
+                    {
+                        unsigned int child = children.Index(ix * 2 + (c & 1), iz * 2 + (c >> 1));
+                        if (children.MinHeight[child] > children.MaxHeight[child])
+                            continue;
+                        low = std::min(low, children.MinHeight[child]);
+                        high = std::max(high, children.MaxHeight[child]);
+                    }
+                    if (low <= high)
+                    {
+                        level.MinHeight[level.Index(ix, iz)] = low;
+                        level.MaxHeight[level.Index(ix, iz)] = high;
+                    }
+                }
+            }
+        }
+    }
+
+    unsigned int LodLevels() const
+    {
+        return Settings.LodLevels;
+    }
+
+    // view range of a level: nodes of this level are drawn up to this distance from the camera
+    float LodRange(unsigned int level) const
+    {
+        return Settings.LeafRange * (float)(1u << level);
+    }
+
+    // distances between which vertices of a level morph into the next coarser grid
+    glm::vec2 MorphRange(unsigned int level) const
+    {
+        float previous = level == 0 ? 0.0f : LodRange(level - 1);
+        float range = LodRange(level);
+        return glm::vec2(previous + (range - previous) * Settings.MorphStartRatio, range);
+    }
+
+    // picks the nodes to draw; full nodes use the full grid, quarter nodes the half resolution grid
+    void Select(const glm::vec3& cameraPosition, const CDLODFrustum& frustum,
+                std::vector<CDLODNode>& fullNodes, std::vector<CDLODNode>& quarterNodes) const
+    {
+        fullNodes.clear();
+        quarterNodes.clear();
+        if (levels.empty())
+            return;
+        selectNode(Settings.LodLevels - 1, 0, 0, cameraPosition, frustum, fullNodes, quarterNodes);
+    }
+
+private:
+    struct Level
+    {
+        unsigned int NodeSize = 0;
+        unsigned int Count = 0;     // nodes per side
+        std::vector<float> MinHeight, MaxHeight;
+
+        unsigned int Index(unsigned int ix, unsigned int iz) const
+        {
+            return ix + Count * iz;
+        }
+    };
+    std::vector<Level> levels;
+
+    static bool intersectsSphere(const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::vec3& center, float radius)
+    {
+        glm::vec3 closest = glm::clamp(center, boxMin, boxMax);
+        glm::vec3 d = closest - center;
+        return glm::dot(d, d) <= radius * radius;
+    }
+
+    // returns false when the node is out of range of its level, so the caller has to cover its
+    // area itself; culled nodes count as handled
+    bool selectNode(unsigned int l, unsigned int ix, unsigned int iz, const glm::vec3& cameraPosition, const CDLODFrustum& frustum,
+                    std::vector<CDLODNode>& fullNodes, std::vector<CDLODNode>& quarterNodes) const
+    {
+        const Level& level = levels[l];
+        unsigned int index = level.Index(ix, iz);
+        if (level.MinHeight[index] > level.MaxHeight[index])
+            return true;
+
+        glm::vec2 offset = Origin + glm::vec2(ix, iz) * (float)level.NodeSize;
+        glm::vec3 boxMin(offset.x, level.MinHeight[index], offset.y);
+        glm::vec3 boxMax(offset.x + level.NodeSize, level.MaxHeight[index], offset.y + level.NodeSize);
+
+        if (!intersectsSphere(boxMin, boxMax, cameraPosition, LodRange(l)))
+            return false;
+        if (!frustum.IntersectsBox(boxMin, boxMax))
+            return true;
+
+        if (l == 0 || !intersectsSphere(boxMin, boxMax, cameraPosition, LodRange(l - 1)))
+        {
+            fullNodes.push_back({ offset, (float)level.NodeSize, (float)l });
+            return true;
+        }
+
+        // some children are close enough for the finer level; cover the rest at this level
+        for (unsigned int c = 0; c < 4; c++)
+        {
+            unsigned int cx = ix * 2 + (c & 1), cz = iz * 2 + (c >> 1);
+            if (!selectNode(l - 1, cx, cz, cameraPosition, frustum, fullNodes, quarterNodes))
+            {
+                const Level& children = levels[l - 1];
+                unsigned int child = children.Index(cx, cz);
+                if (children.MinHeight[child] > children.MaxHeight[child])
+                    continue;
+                glm::vec2 childOffset = Origin + glm::vec2(cx, cz) * (float)children.NodeSize;
+                glm::vec3 childMin(childOffset.x, children.MinHeight[child], childOffset.y);
+                glm::vec3 childMax(childOffset.x + children.NodeSize, children.MaxHeight[child], childOffset.y + children.NodeSize);
+                if (frustum.IntersectsBox(childMin, childMax))
+                    quarterNodes.push_back({ childOffset, (float)children.NodeSize, (float)l });
+            }
+        }
+        return true;
+    }
+};
+
+// times CDLODTerrain::Select() from random cameras above the terrain looking in random
+// directions; returns the average time per selection in microseconds and the average node count
+inline glm::vec2 CDLODBenchmark(const CDLODTerrain& terrain, const glm::mat4& projection, unsigned int iterations = 1000)
+{
+    std::mt19937 generator(7);
+    std::uniform_real_distribution<float> x(terrain.Origin.x, terrain.Origin.x + terrain.Extent.x);
+    std::uniform_real_distribution<float> z(terrain.Origin.y, terrain.Origin.y + terrain.Extent.y);
+    std::uniform_real_distribution<float> y(0.0f, 600.0f);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+    std::vector<CDLODNode> fullNodes, quarterNodes;
+    fullNodes.reserve(1024);
+    quarterNodes.reserve(1024);
+
+    double seconds = 0.0;
+    size_t nodes = 0;
+    for (unsigned int i = 0; i < iterations; i++)
+    {
+        glm::vec3 position(x(generator), y(generator), z(generator));
+        float yaw = angle(generator), pitch = -0.2f * angle(generator) / 6.2831853f - 0.1f;
+        glm::vec3 front(std::cos(yaw) * std::cos(pitch), std::sin(pitch), std::sin(yaw) * std::cos(pitch));
+        glm::mat4 view = glm::lookAt(position, position + front, glm::vec3(0.0f, 1.0f, 0.0f));
+        CDLODFrustum frustum(projection * view);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        terrain.Select(position, frustum, fullNodes, quarterNodes);
+        seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        nodes += fullNodes.size() + quarterNodes.size();
+    }
+    return glm::vec2((float)(seconds * 1e6 / iterations), (float)nodes / iterations);
+}
+
+// CDLOD_H
+#endif
@@ -0,0 +1,195 @@
+#ifndef CLUSTERED_LIGHTS_H
+#define CLUSTERED_LIGHTS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+// Point light as laid out in the lights SSBO (std430): two vec4s per light, 32 bytes.
+// The linear attenuation term is shared by all lights and sent as a uniform.
+struct ClusterPointLight
+{
+    glm::vec4 PositionRadius; // xyz = world-space position, w = radius of the light volume
+    glm::vec4 ColorQuadratic; // rgb = color, a = quadratic attenuation term
+};
+
+// Describes how the view frustum is split into clusters: GridX * GridY screen-space tiles
+// times GridZ depth slices that are distributed logarithmically between ZNear and ZFar.
+// The same math is used by 8.3.cluster_binning.cs, so keep both in sync.
+struct ClusterGrid
+{
+    unsigned int GridX = 16;
+    unsigned int GridY = 9;
+    unsigned int GridZ = 24;
+    unsigned int MaxLightsPerCluster = 256;
+
+    float ZNear = 0.1f;
+    float ZFar = 100.0f;
+
+    unsigned int NumClusters() const
+    {
+        return GridX * GridY * GridZ;
+    }
+
+    unsigned int ClusterIndex(unsigned int x, unsigned int y, unsigned int z) const
+    {
+        return x + GridX * (y + GridY * z);
+    }
+
+    // depth slice of a positive view-space depth (distance along the view direction)
+    int DepthSlice(float viewDepth) const
+    {
+        float slice = std::log(viewDepth / ZNear) * (float)GridZ / std::log(ZFar / ZNear);
+        return (int)std::floor(slice);
+    }
+};
+
+// Inclusive range of clusters touched by a single light; empty when MinX > MaxX etc.
+struct ClusterRange
+{
+    int MinX, MinY, MinZ;
+    int MaxX, MaxY, MaxZ;
+
+    bool IsEmpty() const
+    {
+        return MinX > MaxX || MinY > MaxY || MinZ > MaxZ;
+    }
+};
+
+// Computes a conservative cluster range for a light sphere given in view space. The x/y tile
+// range comes from projecting the corners of the sphere's view-space bounding box (with depth
+// clamped to the near plane), the z range from the sphere's nearest and farthest depth.
+// projScaleX/Y are projection[0][0] and projection[1][1] of a symmetric perspective matrix.
+inline ClusterRange ComputeClusterRange(const ClusterGrid& grid, const glm::vec3& viewPos, float radius, float projScaleX, float projScaleY)
+{
+    ClusterRange range = { 0, 0, 0, -1, -1, -1 };
+
+    // depth along the view direction (camera looks down -z)
+    float depthMin = -viewPos.z - radius;
+    float depthMax = -viewPos.z + radius;
+    if (depthMax < grid.ZNear || depthMin > grid.ZFar)
+        return range;
+    depthMin = std::max(depthMin, grid.ZNear);
+    depthMax = std::min(depthMax, grid.ZFar);
+
+    // x/(depth) reaches its extremes at the corners of the box, so testing the nearest and
+    // farthest depth for both x extents gives a conservative NDC rectangle
+    float ndcMinX = 1.0f, ndcMaxX = -1.0f, ndcMinY = 1.0f, ndcMaxY = -1.0f;
+    const float depths[2] = { depthMin, depthMax };
+    for (int d = 0; d < 2; d++)
+    {
+        for (int sx = -1; sx <= 1; sx += 2)
+        {
+            float ndcX = projScaleX * (viewPos.x + sx * radius) / depths[d];
+            ndcMinX = std::min(ndcMinX, ndcX);
+            ndcMaxX = std::max(ndcMaxX, ndcX);
+        }
+        for (int sy = -1; sy <= 1; sy += 2)
+        {
+            float ndcY = projScaleY * (viewPos.y + sy * radius) / depths[d];
+            ndcMinY = std::min(ndcMinY, ndcY);
+            ndcMaxY = std::max(ndcMaxY, ndcY);
+        }
+    }
+    if (ndcMaxX < -1.0f || ndcMinX > 1.0f || ndcMaxY < -1.0f || ndcMinY > 1.0f)
+        return range;
+
+    range.MinX = std::max(0, (int)std::floor((ndcMinX * 0.5f + 0.5f) * grid.GridX));
+    range.MaxX = std::min((int)grid.GridX - 1, (int)std::floor((ndcMaxX * 0.5f + 0.5f) * grid.GridX));
+    range.MinY = std::max(0, (int)std::floor((ndcMinY * 0.5f + 0.5f) * grid.GridY));
+    range.MaxY = std::min((int)grid.GridY - 1, (int)std::floor((ndcMaxY * 0.5f + 0.5f) * grid.GridY));
+    range.MinZ = std::max(0, grid.DepthSlice(depthMin));
+    range.MaxZ = std::min((int)grid.GridZ - 1, grid.DepthSlice(depthMax));
+    return range;
+}
+
+// CPU reference of the binning compute pass. Fills per-cluster light counts and a flat index
+// list with MaxLightsPerCluster slots per cluster; lights beyond that are dropped (and counted
+// in the returned overflow number) exactly like the GPU version. Index order within a cluster
+// follows the light order here, whereas the GPU appends atomically, so compare sorted lists.
+inline unsigned int BinLightsCPU(const ClusterGrid& grid, const std::vector<ClusterPointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+                                 std::vector<unsigned int>& clusterCounts, std::vector<unsigned int>& clusterIndices)
+{
+    clusterCounts.assign(grid.NumClusters(), 0);
+    clusterIndices.assign(grid.NumClusters() * grid.MaxLightsPerCluster, 0);
+    unsigned int overflow = 0;
+    for (unsigned int i = 0; i < lights.size(); i++)
+    {
+        glm::vec3 viewPos = glm::vec3(view * glm::vec4(glm::vec3(lights[i].PositionRadius), 1.0f));
+        ClusterRange range = ComputeClusterRange(grid, viewPos, lights[i].PositionRadius.w, projection[0][0], projection[1][1]);
+        if (range.IsEmpty())
+            continue;
+        for (int z = range.MinZ; z <= range.MaxZ; z++)
+            for (int y = range.MinY; y <= range.MaxY; y++)
+                for (int x = range.MinX; x <= range.MaxX; x++)
+                {
+                    unsigned int cluster = grid.ClusterIndex(x, y, z);
+                    unsigned int slot = clusterCounts[cluster]++;
+                    if (slot < grid.MaxLightsPerCluster)
+                        clusterIndices[cluster * grid.MaxLightsPerCluster + slot] = i;
+                    else
+                        overflow++;
+                }
+    }
+    return overflow;
+}
+
+// checks that BinLightsCPU is conservative: random points inside random light spheres, seen from
+// random cameras, are mapped to the cluster they fall in, and that cluster has to list the light.
+// Returns the number of points whose cluster misses their light (clusters that overflowed,
+// where the list is incomplete by design, are skipped); 0 means no light can be cut off.
+inline unsigned int ClusterBinningValidate(unsigned int cameras = 20, unsigned int lightCount = 500, unsigned int samplesPerLight = 64)
+{
+    ClusterGrid grid;
+    std::mt19937 generator(3);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 6.0f);
+    unsigned int misses = 0;
+    std::vector<ClusterPointLight> lights(lightCount);
+    std::vector<unsigned int> counts, indices;
+    for (unsigned int c = 0; c < cameras; c++)
+    {
+        glm::vec3 eye(unit(generator) * 20.0f, unit(generator) * 5.0f, unit(generator) * 20.0f);
+        glm::mat4 view = glm::lookAt(eye, glm::vec3(unit(generator), unit(generator), unit(generator)) * 5.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projection = glm::perspective(glm::radians(30.0f + 30.0f * (unit(generator) + 1.0f)), 16.0f / 9.0f, grid.ZNear, grid.ZFar);
+        for (ClusterPointLight& light : lights)
+            light.PositionRadius = glm::vec4(unit(generator) * 40.0f, unit(generator) * 10.0f, unit(generator) * 40.0f, radius(generator));
+        BinLightsCPU(grid, lights, view, projection, counts, indices);
+
+        for (unsigned int i = 0; i < lightCount; i++)
+        {
+            for (unsigned int s = 0; s < samplesPerLight; s++)
+            {
+                glm::vec3 offset(unit(generator), unit(generator), unit(generator));
+                if (glm::dot(offset, offset) > 1.0f)
+                    continue;
+                glm::vec3 point = glm::vec3(lights[i].PositionRadius) + offset * lights[i].PositionRadius.w;
+                glm::vec3 viewPoint = glm::vec3(view * glm::vec4(point, 1.0f));
+                float depth = -viewPoint.z;
+                if (depth < grid.ZNear || depth > grid.ZFar)
+                    continue;
+                float ndcX = projection[0][0] * viewPoint.x / depth;
+                float ndcY = projection[1][1] * viewPoint.y / depth;
+                if (std::abs(ndcX) > 1.0f || std::abs(ndcY) > 1.0f)
+                    continue;
+                int x = std::min((int)grid.GridX - 1, (int)std::floor((ndcX * 0.5f + 0.5f) * grid.GridX));
+                int y = std::min((int)grid.GridY - 1, (int)std::floor((ndcY * 0.5f + 0.5f) * grid.GridY));
+                int z = std::min((int)grid.GridZ - 1, std::max(0, grid.DepthSlice(depth)));
+                unsigned int cluster = grid.ClusterIndex(x, y, z);
+                if (counts[cluster] > grid.MaxLightsPerCluster)
+                    continue;
+                auto begin = indices.begin() + cluster * grid.MaxLightsPerCluster;
+                if (std::find(begin, begin + counts[cluster], i) == begin + counts[cluster])
+                    misses++;
+            }
+        }
+    }
+    return misses;
+}
+
+// CLUSTERED_LIGHTS_H
+#endif
@@ -0,0 +1,165 @@
+#ifndef GBUFFER_H
+#define GBUFFER_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <random>
+#include <iostream>
+#include <iomanip>
+
+// Two G-buffer layouts that can be swapped at runtime:
+//  - GBUFFER_FAT:  position RGBA16F + normal RGBA16F + albedo/specular RGBA8 + depth
+//  - GBUFFER_THIN: octahedral normal RG16 + albedo/specular RGBA8 + depth; the position is
+//    reconstructed from depth and the inverse projection in the shaders
+// Depth is a texture in both layouts so passes that only need depth work with either one.
+enum GBufferLayout {
+    GBUFFER_FAT,
+    GBUFFER_THIN
+};
+
+// CPU versions of the octahedral normal encoding used by the thin G-buffer shaders; the result
+// is in [0, 1] so it can be stored in a GL_RG16 (unorm) texture
+inline glm::vec2 OctahedralEncode(glm::vec3 n)
+{
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 e(n.x, n.y);
+    if (n.z < 0.0f)
+    {
+        e = glm::vec2((1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+                      (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+    }
+    return e * 0.5f + 0.5f;
+}
+
+inline glm::vec3 OctahedralDecode(glm::vec2 e)
+{
+    e = e * 2.0f - 1.0f;
+    glm::vec3 n(e.x, e.y, 1.0f - std::abs(e.x) - std::abs(e.y));
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return glm::normalize(n);
+}
+
+// largest angle (in degrees) between a normal and its octahedral encoding after quantizing
+// both components to 16 bits, measured over a set of random unit vectors
+inline float OctahedralQuantizationError(unsigned int samples = 10000)
+{
+    std::mt19937 generator(7);
+    std::normal_distribution<float> gaussian;
+    float maxError = 0.0f;
+    for (unsigned int i = 0; i < samples; i++)
+    {
+        glm::vec3 n = glm::normalize(glm::vec3(gaussian(generator), gaussian(generator), gaussian(generator)));
+        glm::vec2 e = glm::round(OctahedralEncode(n) * 65535.0f) / 65535.0f;
+        float cosAngle = glm::clamp(glm::dot(n, OctahedralDecode(e)), -1.0f, 1.0f);
+        maxError = std::max(maxError, glm::degrees(std::acos(cosAngle)));
+    }
+    return maxError;
+}
+
+class GBuffer
+{
+public:
+    unsigned int FBO = 0;
+    unsigned int Position = 0;    // only in the fat layout
+    unsigned int Normal = 0;
+    unsigned int AlbedoSpec = 0;
+    unsigned int Depth = 0;
+    GBufferLayout Layout = GBUFFER_FAT;
+    unsigned int Width = 0, Height = 0;
+
+    GBuffer() = default;
+    GBuffer(const GBuffer&) = delete;
+    GBuffer& operator=(const GBuffer&) = delete;
+    ~GBuffer()
+    {
+        Release();
+    }
+
+    // (re)creates all attachments for the given layout and size
+    void Create(GBufferLayout layout, unsigned int width, unsigned int height)
+    {
+        Release();
+        Layout = layout;
+        Width = width;
+        Height = height;
+        glGenFramebuffers(1, &FBO);
+        glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        if (layout == GBUFFER_FAT)
+        {
+            Position = createAttachment(GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT0);
+            Normal = createAttachment(GL_RGBA16F, GL_RGBA, GL_FLOAT, GL_COLOR_ATTACHMENT1);
+            AlbedoSpec = createAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT2);
+            unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+            glDrawBuffers(3, attachments);
+        }
+        else
+        {
+            // the thin layout writes its normal and albedo to the same locations 1 and 2
+            Normal = createAttachment(GL_RG16, GL_RG, GL_UNSIGNED_SHORT, GL_COLOR_ATTACHMENT1);
+            AlbedoSpec = createAttachment(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_COLOR_ATTACHMENT2);
+            unsigned int attachments[3] = { GL_NONE, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+            glDrawBuffers(3, attachments);
+        }
+        Depth = createAttachment(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_FLOAT, GL_DEPTH_ATTACHMENT);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "Framebuffer not complete!" << std::endl;
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+
+    void Release()
+    {
+        if (FBO == 0)
+            return;
+        glDeleteFramebuffers(1, &FBO);
+        if (Position)
+            glDeleteTextures(1, &Position);
+        glDeleteTextures(1, &Normal);
+        glDeleteTextures(1, &AlbedoSpec);
+        glDeleteTextures(1, &Depth);
+        FBO = Position = Normal = AlbedoSpec = Depth = 0;
+    }
+
+    // bytes written per pixel by the geometry pass, including depth
+    unsigned int BytesPerPixel() const
+    {
+        return Layout == GBUFFER_FAT ? 8 + 8 + 4 + 4 : 4 + 4 + 4;
+    }
+
+    // prints the G-buffer's memory footprint and a rough per-frame bandwidth estimate: every pixel
+    // is written once by the geometry pass and the given number of full-screen passes read it back
+    void PrintReport(unsigned int fullscreenReads) const
+    {
+        const double pixels = (double)Width * Height;
+        const double megabytes = pixels * BytesPerPixel() / (1024.0 * 1024.0);
+        std::cout << "gbuffer: " << (Layout == GBUFFER_FAT ? "fat " : "thin") << " | " << BytesPerPixel() << " bytes/pixel"
+                  << " | memory: " << std::fixed << std::setprecision(2) << megabytes << " MB"
+                  << " | est. bandwidth: " << megabytes * (1 + fullscreenReads) << " MB/frame"
+                  << " (1 write + " << fullscreenReads << " reads)";
+        if (Layout == GBUFFER_THIN)
+            std::cout << " | normal error: " << std::setprecision(4) << OctahedralQuantizationError() << " deg";
+        std::cout << std::endl;
+    }
+
+private:
+    unsigned int createAttachment(GLenum internalFormat, GLenum format, GLenum type, GLenum attachment)
+    {
+        unsigned int texture;
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, Width, Height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture, 0);
+        return texture;
+    }
+};
+
+// GBUFFER_H
+#endif
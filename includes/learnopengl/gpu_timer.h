@@ -0,0 +1,78 @@
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+#include <glad/glad.h>
+
+// Measures GPU time spent between Begin() and End() with GL_TIME_ELAPSED queries (core since 3.3).
+// Queries are double buffered: the result read in End() belongs to the previous frame, so reading
+// it never stalls the pipeline. Timers can't be nested, as only one GL_TIME_ELAPSED query may be
+// active at a time.
+class GpuTimer
+{
+public:
+    GpuTimer()
+    {
+        glGenQueries(2, queries);
+    }
+    ~GpuTimer()
+    {
+        glDeleteQueries(2, queries);
+    }
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void Begin()
+    {
+        glBeginQuery(GL_TIME_ELAPSED, queries[current]);
+    }
+    void End()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        current = 1 - current;
+        // the other query was issued a frame ago; pick up its result if it has arrived
+        if (issued[current])
+        {
+            GLint available = 0;
+            glGetQueryObjectiv(queries[current], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (available)
+            {
+                GLuint64 elapsed = 0;
+                glGetQueryObjectui64v(queries[current], GL_QUERY_RESULT, &elapsed);
+                lastMs = elapsed / 1000000.0;
+                sumMs += lastMs;
+                samples++;
+            }
+        }
+        issued[1 - current] = true;
+    }
+    // time of the most recently finished measurement
+    double ElapsedMs() const
+    {
+        return lastMs;
+    }
+    // average over all measurements since the last Reset()
+    double AverageMs() const
+    {
+        return samples > 0 ? sumMs / samples : 0.0;
+    }
+    unsigned int Samples() const
+    {
+        return samples;
+    }
+    void Reset()
+    {
+        sumMs = 0.0;
+        samples = 0;
+    }
+
+private:
+    GLuint queries[2];
+    bool issued[2] = { false, false };
+    int current = 0;
+    double lastMs = 0.0;
+    double sumMs = 0.0;
+    unsigned int samples = 0;
+};
+
+// GPU_TIMER_H
+#endif
@@ -0,0 +1,105 @@
+#ifndef GTAO_H
+#define GTAO_H
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+// CPU reference of the ground-truth ambient occlusion (GTAO) slice integral used by
+// 9.2.gtao.cs. For every slice the shader finds two horizon angles h0 <= 0 <= h1 (measured from
+// the view vector inside the slice plane, +-pi when nothing occludes that side) and the angle n
+// of the normal projected onto that plane. The cosine-weighted visibility of the slice is
+//     integral over [h0, h1] of cos(theta - n) * |sin(theta)| dtheta
+// which is 1 for an unoccluded slice facing the viewer and has the closed form below. Keep both
+// in sync.
+
+const float GTAO_PI = 3.14159265358979f;
+
+// closed-form integral of cos(theta - n) * |sin(theta)| between 0 and h (either sign of h)
+inline float GTAOIntegrateArc(float h, float n)
+{
+    return 0.25f * (-std::cos(2.0f * h - n) + std::cos(n) + 2.0f * h * std::sin(n));
+}
+
+// visibility of one slice; the horizons are clamped to the hemisphere around the normal first
+inline float GTAOSliceVisibility(float h0, float h1, float n)
+{
+    h0 = n + std::max(h0 - n, -0.5f * GTAO_PI);
+    h1 = n + std::min(h1 - n, 0.5f * GTAO_PI);
+    return GTAOIntegrateArc(h0, n) + GTAOIntegrateArc(h1, n);
+}
+
+// the same slice visibility by midpoint-rule integration, to check the closed form against
+inline float GTAOSliceVisibilityNumeric(float h0, float h1, float n, unsigned int steps = 4096)
+{
+    h0 = n + std::max(h0 - n, -0.5f * GTAO_PI);
+    h1 = n + std::min(h1 - n, 0.5f * GTAO_PI);
+    double sum = 0.0;
+    const double dTheta = (double)(h1 - h0) / steps;
+    for (unsigned int i = 0; i < steps; i++)
+    {
+        double theta = h0 + (i + 0.5) * dTheta;
+        sum += std::cos(theta - n) * std::abs(std::sin(theta));
+    }
+    return (float)(sum * dTheta);
+}
+
+// projects the normal onto the slice plane spanned by the view vector and the slice direction
+// (the shader uses the screen-space direction with z = 0); returns the signed angle n from the
+// view vector and the projected length, which weighs the slice's contribution
+inline float GTAOProjectNormal(const glm::vec3& normal, const glm::vec3& viewVector, const glm::vec3& direction, float& projectedLength)
+{
+    glm::vec3 orthoDirection = direction - glm::dot(direction, viewVector) * viewVector;
+    glm::vec3 axis = glm::normalize(glm::cross(orthoDirection, viewVector));
+    glm::vec3 projectedNormal = normal - axis * glm::dot(normal, axis);
+    projectedLength = glm::length(projectedNormal);
+    float signN = glm::dot(orthoDirection, projectedNormal) >= 0.0f ? 1.0f : -1.0f;
+    float cosN = glm::clamp(glm::dot(projectedNormal, viewVector) / projectedLength, 0.0f, 1.0f);
+    return signN * std::acos(cosN);
+}
+
+// GTAO of a fully unoccluded point over sliceCount slices evenly rotated around the view vector;
+// approaches 1 for any normal facing the viewer as the slice count grows
+inline float GTAOUnoccludedVisibility(const glm::vec3& normal, const glm::vec3& viewVector, unsigned int sliceCount)
+{
+    glm::vec3 tangent = glm::normalize(glm::cross(std::abs(viewVector.x) < 0.9f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f), viewVector));
+    glm::vec3 bitangent = glm::cross(viewVector, tangent);
+    float visibility = 0.0f;
+    for (unsigned int i = 0; i < sliceCount; i++)
+    {
+        float phi = (i + 0.5f) / sliceCount * GTAO_PI;
+        float projectedLength;
+        float n = GTAOProjectNormal(normal, viewVector, std::cos(phi) * tangent + std::sin(phi) * bitangent, projectedLength);
+        visibility += projectedLength * GTAOSliceVisibility(-GTAO_PI, GTAO_PI, n);
+    }
+    return visibility / sliceCount;
+}
+
+// runs both checks over random inputs: the largest difference between the closed-form and the
+// numeric slice integral, and the largest deviation of an unoccluded point's visibility from 1
+inline void GTAOValidate(float& maxIntegralError, float& maxUnoccludedError, unsigned int cases = 1000)
+{
+    std::mt19937 generator(11);
+    std::uniform_real_distribution<float> angle(-0.5f * GTAO_PI, 0.5f * GTAO_PI);
+    std::normal_distribution<float> gaussian;
+    maxIntegralError = 0.0f;
+    maxUnoccludedError = 0.0f;
+    for (unsigned int i = 0; i < cases; i++)
+    {
+        float n = angle(generator);
+        float h0 = -std::abs(angle(generator));
+        float h1 = std::abs(angle(generator));
+        maxIntegralError = std::max(maxIntegralError, std::abs(GTAOSliceVisibility(h0, h1, n) - GTAOSliceVisibilityNumeric(h0, h1, n)));
+
+        glm::vec3 viewVector = glm::normalize(glm::vec3(gaussian(generator), gaussian(generator), std::abs(gaussian(generator)) + 0.5f));
+        glm::vec3 normal = glm::normalize(glm::vec3(gaussian(generator), gaussian(generator), gaussian(generator)));
+        if (glm::dot(normal, viewVector) < 0.0f)
+            normal = -normal;
+        maxUnoccludedError = std::max(maxUnoccludedError, std::abs(GTAOUnoccludedVisibility(normal, viewVector, 256) - 1.0f));
+    }
+}
+
+// GTAO_H
+#endif
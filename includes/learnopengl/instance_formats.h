@@ -0,0 +1,194 @@
+#ifndef INSTANCE_FORMATS_H
+#define INSTANCE_FORMATS_H
+
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+// Per instance transforms in three vertex formats of decreasing size. Instances that only need a
+// position, a rotation and a uniform scale don't have to stream a full matrix:
+//   Matrix     64 bytes: the model matrix as four vec4 attributes
+//   Compact32  32 bytes: vec4 (position, scale) and the rotation quaternion as a float vec4
+//   Compact16  16 bytes: half float (position, scale) and the quaternion as 4 normalized shorts
+// Compact16 stores the position as an offset from an origin given to PackInstances(), so pick one
+// near the instances: half floats keep 11 significant bits, an offset of 100 to 200 units is off
+// by up to 0.0625. Both compact formats use the same two attributes, (position, scale) and
+// (rotation), so one vertex shader reads either; it rebuilds the position as
+//   origin + position + rotate(rotation, scale * aPos)
+struct InstanceTransform
+{
+    glm::vec3 Position = glm::vec3(0.0f);
+    glm::quat Rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+    float Scale = 1.0f;
+
+    glm::mat4 Matrix() const
+    {
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), Position);
+        model = glm::scale(model, glm::vec3(Scale));
+        return model * glm::mat4_cast(Rotation);
+    }
+};
+
+enum class InstanceFormat
+{
+    Matrix,
+    Compact32,
+    Compact16
+};
+
+inline const char* InstanceFormatName(InstanceFormat format)
+{
+    switch (format)
+    {
+    case InstanceFormat::Matrix: return "mat4 (64 B)";
+    case InstanceFormat::Compact32: return "compact32 (32 B)";
+    default: return "compact16 (16 B)";
+    }
+}
+
+inline unsigned int InstanceFormatStride(InstanceFormat format)
+{
+    switch (format)
+    {
+    case InstanceFormat::Matrix: return sizeof(glm::mat4);
+    case InstanceFormat::Compact32: return 2 * sizeof(glm::vec4);
+    default: return 4 * sizeof(uint32_t);
+    }
+}
+
+// packs the transforms into the vertex data of the given format
+inline std::vector<unsigned char> PackInstances(InstanceFormat format, const std::vector<InstanceTransform>& transforms,
+                                                const glm::vec3& origin = glm::vec3(0.0f))
+{
+    unsigned int stride = InstanceFormatStride(format);
+    std::vector<unsigned char> data(transforms.size() * stride);
+    for (size_t i = 0; i < transforms.size(); i++)
+    {
+        const InstanceTransform& t = transforms[i];
+        unsigned char* out = &data[i * stride];
+        glm::vec4 rotation(t.Rotation.x, t.Rotation.y, t.Rotation.z, t.Rotation.w);
+        if (format == InstanceFormat::Matrix)
+        {
+            glm::mat4 model = t.Matrix();
+            memcpy(out, &model[0][0], sizeof(glm::mat4));
+        }
+        else if (format == InstanceFormat::Compact32)
+        {
+            glm::vec4 positionScale(t.Position - origin, t.Scale);
+            memcpy(out, &positionScale, sizeof(glm::vec4));
+            memcpy(out + sizeof(glm::vec4), &rotation, sizeof(glm::vec4));
+        }
+        else
+        {
+            uint64_t positionScale = glm::packHalf4x16(glm::vec4(t.Position - origin, t.Scale));
+            uint64_t packedRotation = glm::packSnorm4x16(glm::normalize(rotation));
+            memcpy(out, &positionScale, sizeof(uint64_t));
+            memcpy(out + sizeof(uint64_t), &packedRotation, sizeof(uint64_t));
+        }
+    }
+    return data;
+}
+
+// the transform as the vertex shader will see it after decoding the packed data of instance i
+inline InstanceTransform UnpackInstance(InstanceFormat format, const std::vector<unsigned char>& data, size_t i,
+                                        const glm::vec3& origin = glm::vec3(0.0f))
+{
+    InstanceTransform t;
+    const unsigned char* in = &data[i * InstanceFormatStride(format)];
+    glm::vec4 positionScale, rotation;
+    if (format == InstanceFormat::Matrix)
+    {
+        // only meant for matrices written by PackInstances()
+        glm::mat4 model;
+        memcpy(&model[0][0], in, sizeof(glm::mat4));
+        t.Position = glm::vec3(model[3]);
+        t.Scale = glm::length(glm::vec3(model[0]));
+        t.Rotation = glm::quat_cast(glm::mat3(model) / t.Scale);
+        return t;
+    }
+    if (format == InstanceFormat::Compact32)
+    {
+        memcpy(&positionScale, in, sizeof(glm::vec4));
+        memcpy(&rotation, in + sizeof(glm::vec4), sizeof(glm::vec4));
+    }
+    else
+    {
+        uint64_t packed[2];
+        memcpy(packed, in, sizeof(packed));
+        positionScale = glm::unpackHalf4x16(packed[0]);
+        rotation = glm::normalize(glm::unpackSnorm4x16(packed[1]));
+    }
+    t.Position = origin + glm::vec3(positionScale);
+    t.Scale = positionScale.w;
+    t.Rotation = glm::quat(rotation.w, rotation.x, rotation.y, rotation.z);
+    return t;
+}
+
+// largest distance between a point within 'radius' of the mesh origin transformed by the original
+// and by the decoded transforms; tells whether a packed format is precise enough for a scene
+inline float InstanceFormatMaxError(InstanceFormat format, const std::vector<InstanceTransform>& transforms,
+                                    float radius, const glm::vec3& origin = glm::vec3(0.0f))
+{
+    std::vector<unsigned char> data = PackInstances(format, transforms, origin);
+    const glm::vec3 probes[4] = { glm::vec3(radius, 0.0f, 0.0f), glm::vec3(0.0f, radius, 0.0f),
+                                  glm::vec3(0.0f, 0.0f, radius), glm::vec3(0.0f) };
+    float maxError = 0.0f;
+    for (size_t i = 0; i < transforms.size(); i++)
+    {
+        glm::mat4 expected = transforms[i].Matrix();
+        glm::mat4 decoded = UnpackInstance(format, data, i, origin).Matrix();
+        for (const glm::vec3& p : probes)
+            maxError = std::max(maxError, glm::length(glm::vec3(expected * glm::vec4(p, 1.0f)) - glm::vec3(decoded * glm::vec4(p, 1.0f))));
+    }
+    return maxError;
+}
+
+// points the instanced attributes of the bound vertex array to 'buffer': the Matrix format uses
+// locations firstLocation to firstLocation + 3, the compact formats firstLocation (position, scale)
+// and firstLocation + 1 (rotation). Locations left over from another format are disabled, so a
+// vertex array can switch formats.
+inline void SetInstanceAttributes(InstanceFormat format, unsigned int buffer, unsigned int firstLocation)
+{
+    GLsizei stride = InstanceFormatStride(format);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    unsigned int used = 2;
+    if (format == InstanceFormat::Matrix)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+            glVertexAttribPointer(firstLocation + c, 4, GL_FLOAT, GL_FALSE, stride, (void*)(c * sizeof(glm::vec4)));
+        used = 4;
+    }
+    else if (format == InstanceFormat::Compact32)
+    {
+        glVertexAttribPointer(firstLocation, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(firstLocation + 1, 4, GL_FLOAT, GL_FALSE, stride, (void*)sizeof(glm::vec4));
+    }
+    else
+    {
+        glVertexAttribPointer(firstLocation, 4, GL_HALF_FLOAT, GL_FALSE, stride, (void*)0);
+        glVertexAttribPointer(firstLocation + 1, 4, GL_SHORT, GL_TRUE, stride, (void*)sizeof(uint64_t));
+    }
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        if (c < used)
+        {
+            glEnableVertexAttribArray(firstLocation + c);
+            glVertexAttribDivisor(firstLocation + c, 1);
+        }
+        else
+        {
+            glDisableVertexAttribArray(firstLocation + c);
+        }
+    }
+}
+
+// INSTANCE_FORMATS_H
+#endif
@@ -0,0 +1,257 @@
+#ifndef SHADOW_ATLAS_H
+#define SHADOW_ATLAS_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <random>
+
+// Packs the shadow maps of many lights into one square depth texture. Tiles are power-of-two
+// squares handed out by a quadtree buddy allocator: a tile of level l is AtlasSize >> l texels
+// wide, is split into four children on demand and merged back once all four are free again,
+// so tiles never overlap and freed space doesn't fragment permanently.
+struct ShadowAtlasTile
+{
+    unsigned int X = 0, Y = 0;  // lower left corner in texels
+    unsigned int Size = 0;      // 0 = no tile
+
+    bool IsValid() const
+    {
+        return Size > 0;
+    }
+};
+
+class ShadowAtlasAllocator
+{
+public:
+    unsigned int AtlasSize = 0;
+    unsigned int MinTileSize = 0;
+
+    ShadowAtlasAllocator() = default;
+    ShadowAtlasAllocator(unsigned int atlasSize, unsigned int minTileSize)
+    {
+        Reset(atlasSize, minTileSize);
+    }
+
+    // frees everything; atlasSize and minTileSize have to be powers of two
+    void Reset(unsigned int atlasSize, unsigned int minTileSize)
+    {
+        AtlasSize = atlasSize;
+        MinTileSize = minTileSize;
+        levels = 1;
+        while ((atlasSize >> levels) >= minTileSize)
+            levels++;
+        freeTiles.assign(levels, std::vector<glm::uvec2>());
+        freeTiles[0].push_back(glm::uvec2(0, 0));
+        usedTexels = 0;
+    }
+
+    // returns a tile of exactly the requested (power-of-two) size, or an invalid tile when the
+    // atlas has no room left for it
+    ShadowAtlasTile Allocate(unsigned int size)
+    {
+        ShadowAtlasTile tile;
+        int level = levelOf(size);
+        if (level < 0)
+            return tile;
+        // find the smallest free tile that is at least as large, then split it down
+        int source = level;
+        while (source >= 0 && freeTiles[source].empty())
+            source--;
+        if (source < 0)
+            return tile;
+        glm::uvec2 position = freeTiles[source].back();
+        freeTiles[source].pop_back();
+        for (int l = source + 1; l <= level; l++)
+        {
+            unsigned int child = AtlasSize >> l;
+            // keep the lower left child, the other three become free
+            freeTiles[l].push_back(position + glm::uvec2(child, 0));
+            freeTiles[l].push_back(position + glm::uvec2(0, child));
+            freeTiles[l].push_back(position + glm::uvec2(child, child));
+        }
+        tile.X = position.x;
+        tile.Y = position.y;
+        tile.Size = size;
+        usedTexels += (unsigned long long)size * size;
+        return tile;
+    }
+
+    // returns a tile to the atlas, merging it with its three siblings when they are all free
+    void Free(ShadowAtlasTile& tile)
+    {
+        if (!tile.IsValid())
+            return;
+        usedTexels -= (unsigned long long)tile.Size * tile.Size;
+        int level = levelOf(tile.Size);
+        glm::uvec2 position(tile.X, tile.Y);
+        tile = ShadowAtlasTile();
+        while (level > 0)
+        {
+            unsigned int size = AtlasSize >> level;
+            glm::uvec2 parent = (position / (2 * size)) * (2 * size);
+            glm::uvec2 siblings[3];
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < 4; i++)
+            {
+                glm::uvec2 sibling = parent + glm::uvec2(i & 1, i >> 1) * size;
+                if (sibling != position)
+                    siblings[count++] = sibling;
+            }
+            std::vector<glm::uvec2>& list = freeTiles[level];
+            bool allFree = true;
+            for (const glm::uvec2& sibling : siblings)
+                allFree = allFree && std::find(list.begin(), list.end(), sibling) != list.end();
+            if (!allFree)
+                break;
+            for (const glm::uvec2& sibling : siblings)
+                list.erase(std::find(list.begin(), list.end(), sibling));
+            position = parent;
+            level--;
+        }
+        freeTiles[level].push_back(position);
+    }
+
+    // fraction of the atlas covered by allocated tiles
+    float Occupancy() const
+    {
+        return (float)((double)usedTexels / ((double)AtlasSize * AtlasSize));
+    }
+
+    // number of tiles of the given (power-of-two) size that can still be allocated
+    unsigned int FreeTileCount(unsigned int size) const
+    {
+        int level = levelOf(size);
+        if (level < 0)
+            return 0;
+        unsigned int count = 0;
+        for (int l = 0; l <= level; l++)
+            count += (unsigned int)freeTiles[l].size() << (2 * (level - l));
+        return count;
+    }
+
+    // largest tile that can currently be allocated, 0 when the atlas is full
+    unsigned int LargestFreeTile() const
+    {
+        for (unsigned int l = 0; l < levels; l++)
+            if (!freeTiles[l].empty())
+                return AtlasSize >> l;
+        return 0;
+    }
+
+private:
+    unsigned int levels = 0;
+    std::vector<std::vector<glm::uvec2>> freeTiles; // per level: lower left corners of free tiles
+    unsigned long long usedTexels = 0;
+
+    int levelOf(unsigned int size) const
+    {
+        for (unsigned int l = 0; l < levels; l++)
+            if ((AtlasSize >> l) == size)
+                return (int)l;
+        return -1;
+    }
+};
+
+// light types that can be placed in the atlas; a point light needs six tiles, one per cube face
+// in the usual +X, -X, +Y, -Y, +Z, -Z order
+enum ShadowLightType {
+    SHADOW_LIGHT_SPOT,
+    SHADOW_LIGHT_POINT,
+    SHADOW_LIGHT_DIRECTIONAL
+};
+
+inline unsigned int ShadowLightFaceCount(ShadowLightType type)
+{
+    return type == SHADOW_LIGHT_POINT ? 6 : 1;
+}
+
+// screen-space importance of a local light: the projected radius of its bounding sphere as a
+// fraction of half the screen height, 1 when the camera is inside the sphere and 0 when the
+// sphere is completely behind the camera
+inline float ShadowLightImportance(const glm::vec3& position, float range, const glm::mat4& view, float fovY)
+{
+    glm::vec3 viewPosition = glm::vec3(view * glm::vec4(position, 1.0f));
+    float distance = glm::length(viewPosition);
+    if (distance <= range)
+        return 1.0f;
+    if (-viewPosition.z < -range)
+        return 0.0f;
+    float projectedRadius = range / (std::sqrt(distance * distance - range * range) * std::tan(fovY * 0.5f));
+    return std::min(projectedRadius, 1.0f);
+}
+
+// tile size for an importance: maxTileSize for a light covering the screen, halved for every
+// halving of its projected size, never below minTileSize
+inline unsigned int ShadowTileSizeForImportance(float importance, unsigned int minTileSize, unsigned int maxTileSize)
+{
+    unsigned int size = maxTileSize;
+    while (size > minTileSize && importance * maxTileSize < size * 0.75f)
+        size /= 2;
+    return size;
+}
+
+// maps clip space of a shadow view into the atlas: xy into the tile, z from [-1, 1] to [0, 1],
+// so the lighting shader only needs one matrix per view
+inline glm::mat4 ShadowAtlasTileMatrix(const ShadowAtlasTile& tile, unsigned int atlasSize)
+{
+    float scale = (float)tile.Size / atlasSize;
+    glm::mat4 matrix = glm::translate(glm::mat4(1.0f), glm::vec3((float)tile.X / atlasSize + 0.5f * scale, (float)tile.Y / atlasSize + 0.5f * scale, 0.5f));
+    return glm::scale(matrix, glm::vec3(0.5f * scale, 0.5f * scale, 0.5f));
+}
+
+// allocates random tiles and frees them in random order; returns false when two live tiles
+// overlap, a tile leaves the atlas, FreeTileCount() doesn't match how many tiles a copy of the
+// allocator can still hand out, or the atlas isn't a single free tile again at the end
+inline bool ShadowAtlasValidate(unsigned int atlasSize = 4096, unsigned int minTileSize = 64, unsigned int rounds = 2000)
+{
+    ShadowAtlasAllocator allocator(atlasSize, minTileSize);
+    std::mt19937 generator(5);
+    std::uniform_int_distribution<unsigned int> level(2, 6);
+    std::vector<ShadowAtlasTile> tiles;
+    for (unsigned int i = 0; i < rounds; i++)
+    {
+        if (tiles.empty() || generator() % 3 != 0)
+        {
+            ShadowAtlasTile tile = allocator.Allocate(std::max(atlasSize >> level(generator), minTileSize));
+            if (!tile.IsValid())
+                continue;
+            if (tile.X + tile.Size > atlasSize || tile.Y + tile.Size > atlasSize)
+                return false;
+            for (const ShadowAtlasTile& other : tiles)
+            {
+                bool overlapX = tile.X < other.X + other.Size && other.X < tile.X + tile.Size;
+                bool overlapY = tile.Y < other.Y + other.Size && other.Y < tile.Y + tile.Size;
+                if (overlapX && overlapY)
+                    return false;
+            }
+            tiles.push_back(tile);
+        }
+        else
+        {
+            unsigned int index = generator() % tiles.size();
+            allocator.Free(tiles[index]);
+            tiles.erase(tiles.begin() + index);
+        }
+        if (i % 100 == 0)
+        {
+            unsigned int size = std::max(atlasSize >> level(generator), minTileSize);
+            ShadowAtlasAllocator copy = allocator;
+            unsigned int count = allocator.FreeTileCount(size);
+            for (unsigned int n = 0; n < count; n++)
+                if (!copy.Allocate(size).IsValid())
+                    return false;
+            if (copy.Allocate(size).IsValid())
+                return false;
+        }
+    }
+    for (ShadowAtlasTile& tile : tiles)
+        allocator.Free(tile);
+    return allocator.LargestFreeTile() == atlasSize && allocator.Occupancy() == 0.0f;
+}
+
+// SHADOW_ATLAS_H
+#endif
@@ -0,0 +1,191 @@
+#ifndef TERRAIN_BUILDER_H
+#define TERRAIN_BUILDER_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+
+// Builds a renderable heightmap grid in compact form. A vertex is 6 bytes in two tightly packed
+// streams: a 16-bit height in Heights and a GL_INT_2_10_10_10_REV normal in Normals, against 12
+// for a float position alone. x and z aren't stored at all, the vertex shader derives them from
+// gl_VertexID. All rows are joined into one triangle strip separated by the primitive restart
+// index, so the whole grid is one draw.
+//
+// Optional skirts hang a vertical strip of SkirtDepth below the border, which hides the gaps between
+// neighbouring terrain chunks of different resolution. Skirt vertices follow the grid vertices and
+// walk the border counter-clockwise starting at (0, 0): along row 0, up the last column, back along
+// the last row and down column 0.
+//
+// Heights and normals are generated in parallel bands of rows. The grid frame is x = column,
+// z = row, y = up, with one unit between neighbouring texels.
+struct TerrainMeshSettings
+{
+    float YScale = 64.0f / 256.0f;
+    float YShift = 16.0f;
+    bool Skirts = false;
+    float SkirtDepth = 8.0f;
+    unsigned int Threads = 0;   // 0 = one per hardware thread
+};
+
+struct TerrainMesh
+{
+    static const uint32_t RestartIndex = 0xFFFFFFFFu;
+
+    int Width = 0, Height = 0;              // grid vertices per row and number of rows
+    float MinHeight = 0.0f, MaxHeight = 0.0f; // quantized heights map 0..65535 onto this range
+    std::vector<uint16_t> Heights;          // grid vertices, then skirt vertices
+    std::vector<uint32_t> Normals;          // GL_INT_2_10_10_10_REV, same order
+    std::vector<uint32_t> Indices;          // one strip per row (then the skirt), RestartIndex between them
+
+    double BuildMs = 0.0;
+    unsigned int ThreadsUsed = 0;
+
+    unsigned int GridVertexCount() const
+    {
+        return (unsigned int)Width * Height;
+    }
+    unsigned int SkirtVertexCount() const
+    {
+        return (unsigned int)Heights.size() - GridVertexCount();
+    }
+    size_t VertexBytes() const
+    {
+        return Heights.size() * sizeof(uint16_t) + Normals.size() * sizeof(uint32_t);
+    }
+    size_t IndexBytes() const
+    {
+        return Indices.size() * sizeof(uint32_t);
+    }
+};
+
+inline uint32_t TerrainPackNormal(const glm::vec3& n)
+{
+    auto pack = [](float v) { return (uint32_t)((int)std::round(glm::clamp(v, -1.0f, 1.0f) * 511.0f) & 0x3FF); };
+    return pack(n.x) | (pack(n.y) << 10) | (pack(n.z) << 20);
+}
+
+// grid coordinates of skirt vertex k of a width x height grid
+inline glm::ivec2 TerrainSkirtCoordinate(int k, int width, int height)
+{
+    if (k < width - 1)
+        return glm::ivec2(k, 0);
+    k -= width - 1;
+    if (k < height - 1)
+        return glm::ivec2(width - 1, k);
+    k -= height - 1;
+    if (k < width - 1)
+        return glm::ivec2(width - 1 - k, height - 1);
+    k -= width - 1;
+    return glm::ivec2(0, height - 1 - k);
+}
+
+// builds the mesh of an 8-bit heightmap (the first channel is the height)
+inline TerrainMesh BuildTerrainMesh(const unsigned char* data, int width, int height, int channels, const TerrainMeshSettings& settings)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    TerrainMesh mesh;
+    mesh.Width = width;
+    mesh.Height = height;
+    unsigned int threadCount = settings.Threads > 0 ? settings.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threadCount = std::min<unsigned int>(threadCount, height);
+    mesh.ThreadsUsed = threadCount;
+
+    // runs work(rowBegin, rowEnd) on every band of rows in parallel
+    auto forEachBand = [&](auto work) {
+        std::vector<std::thread> threads;
+        for (unsigned int t = 0; t < threadCount; t++)
+        {
+            int rowBegin = (int)((long long)height * t / threadCount), rowEnd = (int)((long long)height * (t + 1) / threadCount);
+            threads.emplace_back(work, rowBegin, rowEnd);
+        }
+        for (std::thread& thread : threads)
+            thread.join();
+    };
+
+    unsigned char low = 255, high = 0;
+    for (size_t i = 0; i < (size_t)width * height; i++)
+    {
+        low = std::min(low, data[i * channels]);
+        high = std::max(high, data[i * channels]);
+    }
+    mesh.MinHeight = low * settings.YScale - settings.YShift - (settings.Skirts ? settings.SkirtDepth : 0.0f);
+    mesh.MaxHeight = std::max(high * settings.YScale - settings.YShift, mesh.MinHeight + 1e-3f);
+    float quantize = 65535.0f / (mesh.MaxHeight - mesh.MinHeight);
+
+    int perimeter = settings.Skirts ? 2 * (width - 1) + 2 * (height - 1) : 0;
+    size_t gridVertices = (size_t)width * height;
+    mesh.Heights.resize(gridVertices + perimeter);
+    mesh.Normals.resize(gridVertices + perimeter);
+
+    // every row is a strip of 2 * width indices followed by a restart index, so each band knows
+    // where its rows start without waiting for the others
+    size_t rowIndices = 2 * (size_t)width + 1;
+    size_t gridIndices = (height - 1) * rowIndices;
+    mesh.Indices.resize(gridIndices + (settings.Skirts ? 2 * (size_t)(perimeter + 1) : 0));
+
+    auto heightAt = [&](int x, int z) {
+        x = glm::clamp(x, 0, width - 1);
+        z = glm::clamp(z, 0, height - 1);
+        return data[((size_t)z * width + x) * channels] * settings.YScale - settings.YShift;
+    };
+
+    forEachBand([&](int rowBegin, int rowEnd) {
+        for (int z = rowBegin; z < rowEnd; z++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                size_t i = (size_t)z * width + x;
+                mesh.Heights[i] = (uint16_t)std::round((heightAt(x, z) - mesh.MinHeight) * quantize);
+
+                // 3x3 Sobel filter for the slope along x and z
+                float dx = (heightAt(x + 1, z - 1) + 2.0f * heightAt(x + 1, z) + heightAt(x + 1, z + 1))
+                         - (heightAt(x - 1, z - 1) + 2.0f * heightAt(x - 1, z) + heightAt(x - 1, z + 1));
+                float dz = (heightAt(x - 1, z + 1) + 2.0f * heightAt(x, z + 1) + heightAt(x + 1, z + 1))
+                         - (heightAt(x - 1, z - 1) + 2.0f * heightAt(x, z - 1) + heightAt(x + 1, z - 1));
+                mesh.Normals[i] = TerrainPackNormal(glm::normalize(glm::vec3(-dx / 8.0f, 1.0f, -dz / 8.0f)));
+            }
+            if (z + 1 < height)
+            {
+                uint32_t* strip = &mesh.Indices[z * rowIndices];
+                for (int x = 0; x < width; x++)
+                {
+                    strip[2 * x] = (uint32_t)((z + 1) * width + x);
+                    strip[2 * x + 1] = (uint32_t)(z * width + x);
+                }
+                strip[2 * width] = TerrainMesh::RestartIndex;
+            }
+        }
+    });
+
+    if (settings.Skirts)
+    {
+        // skirt vertices copy the normal of the border vertex above them; the strip zig-zags
+        // between the border and the skirt and closes the loop at the end
+        uint32_t* strip = &mesh.Indices[gridIndices];
+        for (int k = 0; k <= perimeter; k++)
+        {
+            int skirt = k % perimeter;
+            glm::ivec2 grid = TerrainSkirtCoordinate(skirt, width, height);
+            size_t border = (size_t)grid.y * width + grid.x;
+            if (k < perimeter)
+            {
+                float h = heightAt(grid.x, grid.y) - settings.SkirtDepth;
+                mesh.Heights[gridVertices + skirt] = (uint16_t)std::round((h - mesh.MinHeight) * quantize);
+                mesh.Normals[gridVertices + skirt] = mesh.Normals[border];
+            }
+            strip[2 * k] = (uint32_t)border;
+            strip[2 * k + 1] = (uint32_t)(gridVertices + skirt);
+        }
+    }
+
+    mesh.BuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    return mesh;
+}
+
+// TERRAIN_BUILDER_H
+#endif
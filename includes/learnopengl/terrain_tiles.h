@@ -0,0 +1,444 @@
+#ifndef TERRAIN_TILES_H
+#define TERRAIN_TILES_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <list>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <string>
+#include <fstream>
+#include <functional>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Tiled heightmap format for terrains that don't fit in memory. The file starts with a
+// TerrainTileHeader and is followed by the tiles of every mip level, finest level first, each
+// level in row-major tile order. A tile is TileSize x TileSize unsigned 16-bit heights; level l
+// is the 2x2 box filtered version of level l - 1, and the pyramid goes down to a single tile.
+// Texels past the edge of the terrain repeat the last row or column.
+struct TerrainTileHeader
+{
+    char Magic[4] = { 'H', 'T', 'S', '1' };
+    uint32_t Width = 0, Height = 0;     // texels of level 0
+    uint32_t TileSize = 0;
+    uint32_t Levels = 0;
+};
+
+// identifies one tile of the pyramid
+struct TerrainTileKey
+{
+    int Level = 0;
+    int X = 0, Y = 0;
+
+    bool operator==(const TerrainTileKey& other) const
+    {
+        return Level == other.Level && X == other.X && Y == other.Y;
+    }
+};
+
+struct TerrainTileKeyHash
+{
+    size_t operator()(const TerrainTileKey& key) const
+    {
+        return ((size_t)key.Level << 40) ^ ((size_t)(unsigned int)key.Y << 20) ^ (size_t)(unsigned int)key.X;
+    }
+};
+
+// read-only view of a tile file. The file is memory mapped, so opening it costs nothing no matter
+// how large it is; a tile is only paged in by the OS when its texels are read.
+class TerrainTileSet
+{
+public:
+    TerrainTileHeader Header;
+
+    TerrainTileSet() = default;
+    ~TerrainTileSet()
+    {
+        Close();
+    }
+    TerrainTileSet(const TerrainTileSet&) = delete;
+    TerrainTileSet& operator=(const TerrainTileSet&) = delete;
+
+    bool Open(const std::string& path)
+    {
+        Close();
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        mappedSize = (size_t)size.QuadPart;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+        {
+            Close();
+            return false;
+        }
+        mapped = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+        file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+        struct stat info;
+        fstat(file, &info);
+        mappedSize = (size_t)info.st_size;
+        void* address = mmap(NULL, mappedSize, PROT_READ, MAP_SHARED, file, 0);
+        mapped = address == MAP_FAILED ? nullptr : (const unsigned char*)address;
+#endif
+        if (mapped == nullptr || mappedSize < sizeof(TerrainTileHeader))
+        {
+            Close();
+            return false;
+        }
+        std::memcpy(&Header, mapped, sizeof(TerrainTileHeader));
+        if (std::memcmp(Header.Magic, "HTS1", 4) != 0 || mappedSize < TileOffset({ (int)Header.Levels, 0, 0 }))
+        {
+            Close();
+            return false;
+        }
+        return true;
+    }
+
+    void Close()
+    {
+#ifdef _WIN32
+        if (mapped)
+            UnmapViewOfFile(mapped);
+        if (mapping != NULL)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (mapped)
+            munmap((void*)mapped, mappedSize);
+        if (file >= 0)
+            close(file);
+        file = -1;
+#endif
+        mapped = nullptr;
+        mappedSize = 0;
+    }
+
+    bool IsOpen() const
+    {
+        return mapped != nullptr;
+    }
+
+    glm::ivec2 LevelSize(int level) const
+    {
+        return LevelSize(Header, level);
+    }
+    glm::ivec2 TileCount(int level) const
+    {
+        return TileCount(Header, level);
+    }
+    size_t TileBytes() const
+    {
+        return (size_t)Header.TileSize * Header.TileSize * sizeof(uint16_t);
+    }
+
+    // byte offset of a tile in the file; a key one past the last level gives the file size
+    size_t TileOffset(const TerrainTileKey& key) const
+    {
+        size_t offset = sizeof(TerrainTileHeader);
+        for (int l = 0; l < key.Level; l++)
+        {
+            glm::ivec2 count = TileCount(l);
+            offset += (size_t)count.x * count.y * TileBytes();
+        }
+        return offset + ((size_t)key.Y * TileCount(key.Level).x + key.X) * TileBytes();
+    }
+
+    // copies a tile out of the mapping, then tells the OS the pages can be dropped again so the
+    // mapping doesn't grow the resident set as the camera travels
+    void ReadTile(const TerrainTileKey& key, uint16_t* destination) const
+    {
+        size_t offset = TileOffset(key);
+        std::memcpy(destination, mapped + offset, TileBytes());
+#ifndef _WIN32
+        size_t page = (size_t)sysconf(_SC_PAGESIZE);
+        size_t begin = (offset + page - 1) / page * page, end = (offset + TileBytes()) / page * page;
+        if (end > begin)
+            madvise((void*)(mapped + begin), end - begin, MADV_DONTNEED);
+#endif
+    }
+
+    static glm::ivec2 LevelSize(const TerrainTileHeader& header, int level)
+    {
+        return glm::ivec2(std::max(1u, (header.Width + (1u << level) - 1) >> level),
+                          std::max(1u, (header.Height + (1u << level) - 1) >> level));
+    }
+    static glm::ivec2 TileCount(const TerrainTileHeader& header, int level)
+    {
+        glm::ivec2 size = LevelSize(header, level);
+        return (size + glm::ivec2(header.TileSize - 1)) / glm::ivec2(header.TileSize);
+    }
+
+    // size in bytes of the tile file Write produces for a terrain of width x height texels
+    static size_t FileSize(unsigned int width, unsigned int height, unsigned int tileSize)
+    {
+        TerrainTileHeader header;
+        header.Width = width;
+        header.Height = height;
+        header.TileSize = tileSize;
+        size_t size = sizeof(TerrainTileHeader);
+        for (int l = 0; ; l++)
+        {
+            glm::ivec2 count = TileCount(header, l);
+            size += (size_t)count.x * count.y * tileSize * tileSize * sizeof(uint16_t);
+            if (count == glm::ivec2(1))
+                return size;
+        }
+    }
+
+    // writes a tile file. source fills a tileSize x tileSize block of level 0 texels starting at
+    // (x, y), clamping coordinates past the edge itself; coarser levels are filtered from the
+    // tiles already written, so only a handful of tiles are ever held in memory
+    static bool Write(const std::string& path, unsigned int width, unsigned int height, unsigned int tileSize,
+                      const std::function<void(int x, int y, uint16_t* tile)>& source,
+                      const std::function<void(int level, int levels)>& progress = nullptr)
+    {
+        TerrainTileHeader header;
+        header.Width = width;
+        header.Height = height;
+        header.TileSize = tileSize;
+        header.Levels = 1;
+        while (TileCount(header, header.Levels - 1) != glm::ivec2(1))
+            header.Levels++;
+
+        std::fstream stream(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!stream)
+            return false;
+        stream.write((const char*)&header, sizeof(header));
+
+        size_t tileTexels = (size_t)tileSize * tileSize;
+        std::vector<uint16_t> tile(tileTexels), child(tileTexels);
+        std::vector<size_t> levelOffsets(header.Levels, sizeof(TerrainTileHeader));
+        for (unsigned int l = 1; l < header.Levels; l++)
+        {
+            glm::ivec2 count = TileCount(header, l - 1);
+            levelOffsets[l] = levelOffsets[l - 1] + (size_t)count.x * count.y * tileTexels * sizeof(uint16_t);
+        }
+
+        for (unsigned int l = 0; l < header.Levels; l++)
+        {
+            if (progress)
+                progress(l, header.Levels);
+            glm::ivec2 count = TileCount(header, l);
+            for (int ty = 0; ty < count.y; ty++)
+            {
+                for (int tx = 0; tx < count.x; tx++)
+                {
+                    if (l == 0)
+                    {
+                        source(tx * tileSize, ty * tileSize, tile.data());
+                    }
+                    else
+                    {
+                        // every quarter of the tile is the 2x2 average of one child tile
+                        glm::ivec2 childCount = TileCount(header, l - 1);
+                        for (int c = 0; c < 4; c++)
+                        {
+                            int cx = std::min(tx * 2 + (c & 1), childCount.x - 1);
+                            int cy = std::min(ty * 2 + (c >> 1), childCount.y - 1);
+                            stream.seekg(levelOffsets[l - 1] + ((size_t)cy * childCount.x + cx) * tileTexels * sizeof(uint16_t));
+                            stream.read((char*)child.data(), tileTexels * sizeof(uint16_t));
+                            unsigned int half = tileSize / 2;
+                            for (unsigned int y = 0; y < half; y++)
+                            {
+                                for (unsigned int x = 0; x < half; x++)
+                                {
+                                    const uint16_t* texel = &child[(size_t)(y * 2) * tileSize + x * 2];
+                                    unsigned int sum = texel[0] + texel[1] + texel[tileSize] + texel[tileSize + 1];
+                                    tile[(size_t)(y + (c >> 1) * half) * tileSize + x + (c & 1) * half] = (uint16_t)((sum + 2) / 4);
+                                }
+                            }
+                        }
+                    }
+                    stream.seekp(levelOffsets[l] + ((size_t)ty * count.x + tx) * tileTexels * sizeof(uint16_t));
+                    stream.write((const char*)tile.data(), tileTexels * sizeof(uint16_t));
+                }
+            }
+        }
+        return (bool)stream;
+    }
+
+private:
+    const unsigned char* mapped = nullptr;
+    size_t mappedSize = 0;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int file = -1;
+#endif
+};
+
+// Fixed size LRU cache of decoded tiles, filled by a background thread. All tile memory is
+// allocated up front, so the cache never grows: loading a tile into a full cache evicts the
+// least recently used one. Each frame the renderer hands over the list of tiles it still misses,
+// most important first, which replaces whatever the loader hadn't gotten to yet.
+class TerrainTileCache
+{
+public:
+    // statistics since the last ResetStats()
+    std::atomic<unsigned int> Loads{ 0 }, Evictions{ 0 }, Hits{ 0 }, Misses{ 0 };
+
+    TerrainTileCache(const TerrainTileSet& tiles, unsigned int capacity)
+        : tiles(tiles), capacity(capacity), texelsPerTile((size_t)tiles.Header.TileSize * tiles.Header.TileSize)
+    {
+        memory.resize(capacity * texelsPerTile);
+        for (unsigned int i = 0; i < capacity; i++)
+            freeSlots.push_back(i);
+        loader = std::thread(&TerrainTileCache::loaderMain, this);
+    }
+    ~TerrainTileCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wakeUp.notify_one();
+        loader.join();
+    }
+    TerrainTileCache(const TerrainTileCache&) = delete;
+    TerrainTileCache& operator=(const TerrainTileCache&) = delete;
+
+    // replaces the pending requests; tiles already cached or being loaded are skipped
+    void SetRequests(const std::vector<TerrainTileKey>& keys)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.clear();
+            for (const TerrainTileKey& key : keys)
+                if (entries.find(key) == entries.end() && !(loading && key == loadingKey))
+                    requests.push_back(key);
+        }
+        wakeUp.notify_one();
+    }
+
+    // calls use with the texels of the tile when it is cached and returns true; the tile can't be
+    // evicted while use runs, so it may hand the pointer straight to glTexSubImage
+    bool Use(const TerrainTileKey& key, const std::function<void(const uint16_t*)>& use)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto entry = entries.find(key);
+        if (entry == entries.end())
+        {
+            Misses++;
+            return false;
+        }
+        Hits++;
+        lru.splice(lru.begin(), lru, entry->second.Position);
+        use(&memory[entry->second.Slot * texelsPerTile]);
+        return true;
+    }
+
+    size_t PendingRequests()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return requests.size();
+    }
+
+    size_t MemoryBytes() const
+    {
+        return memory.size() * sizeof(uint16_t);
+    }
+
+    void ResetStats()
+    {
+        Loads = Evictions = Hits = Misses = 0;
+    }
+
+private:
+    struct Entry
+    {
+        unsigned int Slot;
+        std::list<TerrainTileKey>::iterator Position;
+    };
+
+    const TerrainTileSet& tiles;
+    unsigned int capacity;
+    size_t texelsPerTile;
+    std::vector<uint16_t> memory;
+    std::vector<unsigned int> freeSlots;
+    std::list<TerrainTileKey> lru;      // most recently used first
+    std::unordered_map<TerrainTileKey, Entry, TerrainTileKeyHash> entries;
+    std::deque<TerrainTileKey> requests;
+    bool loading = false;
+    TerrainTileKey loadingKey;
+
+    std::thread loader;
+    std::mutex mutex;
+    std::condition_variable wakeUp;
+    bool stop = false;
+
+    void loaderMain()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            wakeUp.wait(lock, [this] { return stop || !requests.empty(); });
+            if (stop)
+                return;
+            TerrainTileKey key = requests.front();
+            requests.pop_front();
+            if (entries.find(key) != entries.end())
+                continue;
+
+            // claim a slot; an evicted tile disappears from the map before its memory is reused,
+            // so Use() can't be reading it
+            unsigned int slot;
+            if (!freeSlots.empty())
+            {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+            {
+                TerrainTileKey victim = lru.back();
+                lru.pop_back();
+                slot = entries[victim].Slot;
+                entries.erase(victim);
+                Evictions++;
+            }
+            loading = true;
+            loadingKey = key;
+
+            lock.unlock();
+            tiles.ReadTile(key, &memory[slot * texelsPerTile]);
+            lock.lock();
+
+            loading = false;
+            lru.push_front(key);
+            entries[key] = { slot, lru.begin() };
+            Loads++;
+        }
+    }
+};
+
+// TERRAIN_TILES_H
+#endif
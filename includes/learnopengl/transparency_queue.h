@@ -0,0 +1,175 @@
+#ifndef TRANSPARENCY_QUEUE_H
+#define TRANSPARENCY_QUEUE_H
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// Orders transparent draws back to front without allocating per frame. Every Push() stores a
+// 32-bit key computed from the distance to the camera and the caller's id of the object (an index
+// into its own array of draws); Sort() orders the entries by key with a least significant digit
+// radix sort: four counting passes over 8 bits, O(n) and stable, so objects at exactly the same
+// distance are all kept, in the order they were pushed. Passes over a byte that is the same for
+// every key are skipped. The arrays only grow, so after the first frames nothing is allocated.
+class TransparencyQueue
+{
+public:
+    struct Entry
+    {
+        uint32_t Key;
+        uint32_t Id;
+    };
+
+    explicit TransparencyQueue(size_t capacity = 0)
+    {
+        Reserve(capacity);
+    }
+
+    void Reserve(size_t capacity)
+    {
+        entries.reserve(capacity);
+        scratch.reserve(capacity);
+    }
+
+    void Clear()
+    {
+        entries.clear();
+    }
+
+    // any monotonic measure of distance works, e.g. the squared distance to the camera or the
+    // negated view space z; the furthest object is drawn first
+    void Push(float distance, uint32_t id)
+    {
+        entries.push_back({ ~OrderedBits(distance), id });
+    }
+
+    void Sort()
+    {
+        size_t count = entries.size();
+        scratch.resize(count);
+
+        uint32_t histograms[4][256];
+        memset(histograms, 0, sizeof(histograms));
+        for (const Entry& entry : entries)
+            for (unsigned int pass = 0; pass < 4; pass++)
+                histograms[pass][(entry.Key >> (8 * pass)) & 0xFF]++;
+
+        Entry* source = entries.data();
+        Entry* destination = scratch.data();
+        for (unsigned int pass = 0; pass < 4; pass++)
+        {
+            uint32_t* histogram = histograms[pass];
+            if (count == 0 || histogram[(source[0].Key >> (8 * pass)) & 0xFF] == count)
+                continue;
+            uint32_t offset = 0;
+            for (unsigned int digit = 0; digit < 256; digit++)
+            {
+                uint32_t digitCount = histogram[digit];
+                histogram[digit] = offset;
+                offset += digitCount;
+            }
+            for (size_t i = 0; i < count; i++)
+                destination[histogram[(source[i].Key >> (8 * pass)) & 0xFF]++] = source[i];
+            std::swap(source, destination);
+        }
+        if (source != entries.data())
+            memcpy(entries.data(), source, count * sizeof(Entry));
+    }
+
+    size_t Size() const
+    {
+        return entries.size();
+    }
+    const Entry* begin() const
+    {
+        return entries.data();
+    }
+    const Entry* end() const
+    {
+        return entries.data() + entries.size();
+    }
+
+    // maps a float to an unsigned integer with the same ordering, negative values included
+    static uint32_t OrderedBits(float value)
+    {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+    }
+
+private:
+    std::vector<Entry> entries, scratch;
+};
+
+// result of TransparencyQueueBenchmark(); times in milliseconds per frame
+struct TransparencyQueueStats
+{
+    double RadixMs = 0.0;
+    double MapMs = 0.0;         // std::map<float, glm::vec3> keyed by distance, as in blending_sorted
+    size_t Count = 0;
+    size_t MapLost = 0;         // objects the map dropped because their distance was already taken
+    bool Valid = false;         // the queue kept every object exactly once, furthest first
+};
+
+// sorts 'count' random quads on a coarse grid (so many distances are equal) from random cameras
+// with both the queue and a std::map, and checks that the queue neither loses nor reorders objects
+inline TransparencyQueueStats TransparencyQueueBenchmark(unsigned int count = 100000, unsigned int frames = 20)
+{
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> cell(-50, 50);
+    std::uniform_real_distribution<float> camera(-60.0f, 60.0f);
+    std::vector<glm::vec3> positions(count);
+    for (glm::vec3& p : positions)
+        p = glm::vec3(cell(generator), cell(generator) * 0.25f, cell(generator));
+
+    TransparencyQueueStats stats;
+    stats.Count = count;
+    stats.Valid = true;
+    TransparencyQueue queue(count);
+    std::vector<uint32_t> seen(count);
+    for (unsigned int frame = 0; frame < frames; frame++)
+    {
+        glm::vec3 eye(camera(generator), camera(generator), camera(generator));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        queue.Clear();
+        for (unsigned int i = 0; i < count; i++)
+        {
+            glm::vec3 d = positions[i] - eye;
+            queue.Push(glm::dot(d, d), i);
+        }
+        queue.Sort();
+        stats.RadixMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        start = std::chrono::high_resolution_clock::now();
+        std::map<float, glm::vec3> sorted;
+        for (unsigned int i = 0; i < count; i++)
+            sorted[glm::length(eye - positions[i])] = positions[i];
+        stats.MapMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        stats.MapLost = count - sorted.size();
+
+        // every id exactly once, distances never increasing
+        std::fill(seen.begin(), seen.end(), 0u);
+        float previous = 1e30f;
+        stats.Valid = stats.Valid && queue.Size() == count;
+        for (const TransparencyQueue::Entry& entry : queue)
+        {
+            glm::vec3 d = positions[entry.Id] - eye;
+            float distance = glm::dot(d, d);
+            stats.Valid = stats.Valid && seen[entry.Id]++ == 0 && distance <= previous;
+            previous = distance;
+        }
+    }
+    stats.RadixMs /= frames;
+    stats.MapMs /= frames;
+    return stats;
+}
+
+// TRANSPARENCY_QUEUE_H
+#endif
@@ -1,15 +1,25 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
-layout (location = 2) in mat4 instanceMatrix; // New attribute for instanced rendering
+layout (location = 2) in vec4 aInstancePositionScale; // offset from instanceOrigin, uniform scale
+layout (location = 3) in vec4 aInstanceRotation;      // quaternion (x, y, z, w)
 
 out vec2 TexCoord;
 
 uniform mat4 view;
 uniform mat4 projection;
+uniform vec3 instanceOrigin;
+
+vec3 rotate(vec4 q, vec3 v)
+{
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
 
 void main()
 {
-    gl_Position = projection * view * instanceMatrix * vec4(aPos, 1.0f);
+    // normalized shorts don't quite keep the quaternion at unit length
+    vec4 rotation = normalize(aInstanceRotation);
+    vec3 worldPos = instanceOrigin + aInstancePositionScale.xyz + rotate(rotation, aInstancePositionScale.w * aPos);
+    gl_Position = projection * view * vec4(worldPos, 1.0f);
     TexCoord = vec2(aTexCoord.x, 1.0 - aTexCoord.y);
 }
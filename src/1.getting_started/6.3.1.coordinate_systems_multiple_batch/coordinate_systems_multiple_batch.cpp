@@ -8,6 +8,7 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader_m.h>
+#include <learnopengl/instance_formats.h>
 
 #include <iostream>
 #include <vector>
@@ -154,25 +155,27 @@ int main()
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     glEnableVertexAttribArray(1);
 
-    // Instance array
+    // Instance array: 16 bytes per cube instead of a 64 byte mat4; half float positions are stored
+    // relative to the middle of the cubes, which keeps them precise
+    const InstanceFormat instanceFormat = InstanceFormat::Compact16;
+    std::vector<InstanceTransform> transforms;
+    glm::vec3 instanceOrigin(0.0f);
+    for (unsigned int i = 0; i < 10; i++) {
+        InstanceTransform transform;
+        transform.Position = cubePositions[i];
+        transforms.push_back(transform);
+        instanceOrigin += cubePositions[i] / 10.0f;
+    }
+    std::vector<unsigned char> instanceData = PackInstances(instanceFormat, transforms, instanceOrigin);
+    std::cout << InstanceFormatName(instanceFormat) << ": " << instanceData.size() << " bytes for " << transforms.size()
+              << " cubes, max error " << InstanceFormatMaxError(instanceFormat, transforms, 0.87f, instanceOrigin) << std::endl;
+
     unsigned int instanceVBO;
     glGenBuffers(1, &instanceVBO);
     glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
-
-    std::vector<glm::mat4> modelMatrices;
-    for (unsigned int i = 0; i < 10; i++) {
-        glm::mat4 model = glm::mat4(1.0f);
-        model = glm::translate(model, cubePositions[i]);
-        modelMatrices.push_back(model);
-    }
-    glBufferData(GL_ARRAY_BUFFER, modelMatrices.size() * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
-    // Set attribute pointers for mat4 (4 times vec4)
-    std::size_t vec4Size = sizeof(glm::vec4);
-    for (unsigned int i = 0; i < 4; i++) {
-        glEnableVertexAttribArray(2 + i);
-        glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, 4 * vec4Size, (void*)(i * vec4Size));
-        glVertexAttribDivisor(2 + i, 1);
-    }
+    glBufferData(GL_ARRAY_BUFFER, instanceData.size(), instanceData.data(), GL_STATIC_DRAW);
+    // (position, scale) at location 2, rotation at location 3
+    SetInstanceAttributes(instanceFormat, instanceVBO, 2);
     // texture setup omitted for brevity
 
     // load and create a texture 
@@ -231,6 +234,7 @@ int main()
     ourShader.use();
     ourShader.setInt("texture1", 0);
     ourShader.setInt("texture2", 1);
+    ourShader.setVec3("instanceOrigin", instanceOrigin);
 
     IMGUI_CHECKVERSION();
     ImGui::CreateContext();
@@ -325,6 +329,7 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &instanceVBO);
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -10,18 +10,31 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
+#include <learnopengl/instance_formats.h>
 
 #include <iostream>
+#include <iomanip>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+void benchmarkInstanceFormats(const Model& rock, const std::vector<InstanceTransform>& transforms, Shader& matrixShader, Shader& compactShader,
+                              const glm::mat4& projection, const glm::mat4& view);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// instance data
+const unsigned int FORMAT_COUNT = 3;
+InstanceFormat instanceFormat = InstanceFormat::Matrix;    // F: cycle through the instance formats
+bool instanceFormatKeyPressed = false;
+bool runBenchmark = false;                                 // B: time vertex processing of 1M instances in every format
+bool benchmarkKeyPressed = false;
+
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 155.0f));
 float lastX = (float)SCR_WIDTH / 2.0;
@@ -77,6 +90,7 @@ int main()
     // build and compile shaders
     // -------------------------
     Shader asteroidShader("10.3.asteroids.vs", "10.3.asteroids.fs");
+    Shader compactAsteroidShader("10.3.asteroids_compact.vs", "10.3.asteroids.fs");
     Shader planetShader("10.3.planet.vs", "10.3.planet.fs");
 
     // load models
@@ -84,17 +98,15 @@ int main()
     Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"));
     Model planet(FileSystem::getPath("resources/objects/planet/planet.obj"));
 
-    // generate a large list of semi-random model transformation matrices
-    // ------------------------------------------------------------------
+    // generate a large list of semi-random model transformations
+    // ----------------------------------------------------------
     unsigned int amount = 100000;
-    glm::mat4* modelMatrices;
-    modelMatrices = new glm::mat4[amount];
+    std::vector<InstanceTransform> transforms(amount);
     srand(static_cast<unsigned int>(glfwGetTime())); // initialize random seed
     float radius = 150.0;
     float offset = 25.0f;
     for (unsigned int i = 0; i < amount; i++)
     {
-        glm::mat4 model = glm::mat4(1.0f);
         // 1. translation: displace along circle with 'radius' in range [-offset, offset]
         float angle = (float)i / (float)amount * 360.0f;
         float displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
@@ -103,53 +115,52 @@ int main()
         float y = displacement * 0.4f; // keep height of asteroid field smaller compared to width of x and z
         displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
         float z = cos(angle) * radius + displacement;
-        model = glm::translate(model, glm::vec3(x, y, z));
+        transforms[i].Position = glm::vec3(x, y, z);
 
         // 2. scale: Scale between 0.05 and 0.25f
-        float scale = static_cast<float>((rand() % 20) / 100.0 + 0.05);
-        model = glm::scale(model, glm::vec3(scale));
+        transforms[i].Scale = static_cast<float>((rand() % 20) / 100.0 + 0.05);
 
         // 3. rotation: add random rotation around a (semi)randomly picked rotation axis vector
         float rotAngle = static_cast<float>((rand() % 360));
-        model = glm::rotate(model, rotAngle, glm::vec3(0.4f, 0.6f, 0.8f));
-
-        // 4. now add to list of matrices
-        modelMatrices[i] = model;
+        transforms[i].Rotation = glm::angleAxis(rotAngle, glm::normalize(glm::vec3(0.4f, 0.6f, 0.8f)));
     }
 
-    // configure instanced array
-    // -------------------------
-    unsigned int buffer;
-    glGenBuffers(1, &buffer);
-    glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, amount * sizeof(glm::mat4), &modelMatrices[0], GL_STATIC_DRAW);
+    // configure instanced arrays, one buffer per instance format; the model matrix of each
+    // asteroid is translate * scale * rotate, which the compact formats store without the matrix
+    // -------------------------------------------------------------------------------------------
+    float rockRadius = 0.0f;
+    for (const Mesh& mesh : rock.meshes)
+        for (const Vertex& vertex : mesh.vertices)
+            rockRadius = std::max(rockRadius, glm::length(vertex.Position));
+    unsigned int buffers[FORMAT_COUNT];
+    glGenBuffers(FORMAT_COUNT, buffers);
+    for (unsigned int f = 0; f < FORMAT_COUNT; f++)
+    {
+        InstanceFormat format = (InstanceFormat)f;
+        std::vector<unsigned char> data = PackInstances(format, transforms);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers[f]);
+        glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+        std::cout << std::left << std::setw(18) << InstanceFormatName(format) << std::right << std::fixed << std::setprecision(2)
+                  << data.size() / (1024.0 * 1024.0) << " MB, max vertex error " << std::setprecision(4)
+                  << InstanceFormatMaxError(format, transforms, rockRadius * 0.25f) << std::endl;
+    }
 
-    // set transformation matrices as an instance vertex attribute (with divisor 1)
+    // set the transformations as instance vertex attributes (with divisor 1)
     // note: we're cheating a little by taking the, now publicly declared, VAO of the model's mesh(es) and adding new vertexAttribPointers
     // normally you'd want to do this in a more organized fashion, but for learning purposes this will do.
     // -----------------------------------------------------------------------------------------------------------------------------------
+    InstanceFormat boundFormat = instanceFormat;
+    bool rebindInstances = false;
     for (unsigned int i = 0; i < rock.meshes.size(); i++)
     {
-        unsigned int VAO = rock.meshes[i].VAO;
-        glBindVertexArray(VAO);
-        // set attribute pointers for matrix (4 times vec4)
-        glEnableVertexAttribArray(3);
-        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)0);
-        glEnableVertexAttribArray(4);
-        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(sizeof(glm::vec4)));
-        glEnableVertexAttribArray(5);
-        glVertexAttribPointer(5, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(2 * sizeof(glm::vec4)));
-        glEnableVertexAttribArray(6);
-        glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(3 * sizeof(glm::vec4)));
-
-        glVertexAttribDivisor(3, 1);
-        glVertexAttribDivisor(4, 1);
-        glVertexAttribDivisor(5, 1);
-        glVertexAttribDivisor(6, 1);
-
+        glBindVertexArray(rock.meshes[i].VAO);
+        SetInstanceAttributes(instanceFormat, buffers[(int)instanceFormat], 3);
         glBindVertexArray(0);
     }
 
+    GpuTimer asteroidTimer;
+    unsigned int frameCount = 0;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -172,9 +183,6 @@ int main()
         // configure transformation matrices
         glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        asteroidShader.use();
-        asteroidShader.setMat4("projection", projection);
-        asteroidShader.setMat4("view", view);
         planetShader.use();
         planetShader.setMat4("projection", projection);
         planetShader.setMat4("view", view);
@@ -187,16 +195,47 @@ int main()
         planet.Draw(planetShader);
 
         // draw meteorites
-        asteroidShader.use();
-        asteroidShader.setInt("texture_diffuse1", 0);
+        if (boundFormat != instanceFormat || rebindInstances)
+        {
+            boundFormat = instanceFormat;
+            rebindInstances = false;
+            for (unsigned int i = 0; i < rock.meshes.size(); i++)
+            {
+                glBindVertexArray(rock.meshes[i].VAO);
+                SetInstanceAttributes(instanceFormat, buffers[(int)instanceFormat], 3);
+            }
+            glBindVertexArray(0);
+        }
+        Shader& shader = instanceFormat == InstanceFormat::Matrix ? asteroidShader : compactAsteroidShader;
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("instanceOrigin", glm::vec3(0.0f));
+        shader.setInt("texture_diffuse1", 0);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, rock.textures_loaded[0].id); // note: we also made the textures_loaded vector public (instead of private) from the model class.
+        asteroidTimer.Begin();
         for (unsigned int i = 0; i < rock.meshes.size(); i++)
         {
             glBindVertexArray(rock.meshes[i].VAO);
             glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(rock.meshes[i].indices.size()), GL_UNSIGNED_INT, 0, amount);
             glBindVertexArray(0);
         }
+        asteroidTimer.End();
+
+        if (++frameCount % 100 == 0)
+        {
+            std::cout << InstanceFormatName(instanceFormat) << " | asteroids: " << std::fixed << std::setprecision(3)
+                      << asteroidTimer.AverageMs() << " ms" << std::endl;
+            asteroidTimer.Reset();
+        }
+
+        if (runBenchmark)
+        {
+            runBenchmark = false;
+            benchmarkInstanceFormats(rock, transforms, asteroidShader, compactAsteroidShader, projection, view);
+            rebindInstances = true; // the benchmark left its own buffer in the vertex arrays
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -204,10 +243,71 @@ int main()
         glfwPollEvents();
     }
 
+    glDeleteBuffers(FORMAT_COUNT, buffers);
+
     glfwTerminate();
     return 0;
 }
 
+// draws 1M rock instances from each instance format, with the shader that decodes it, with
+// rasterization turned off, so the GPU time is spent fetching and transforming vertices only
+// --------------------------------------------------------------------------------------------
+void benchmarkInstanceFormats(const Model& rock, const std::vector<InstanceTransform>& transforms, Shader& matrixShader, Shader& compactShader,
+                              const glm::mat4& projection, const glm::mat4& view)
+{
+    const unsigned int instances = 1000000;
+    const unsigned int repeats = 10;
+    std::vector<InstanceTransform> many(instances);
+    for (unsigned int i = 0; i < instances; i++)
+        many[i] = transforms[i % transforms.size()];
+
+    unsigned int buffer, query;
+    glGenBuffers(1, &buffer);
+    glGenQueries(1, &query);
+    glEnable(GL_RASTERIZER_DISCARD);
+    std::cout << "vertex processing of " << instances << " instances:" << std::endl;
+    for (unsigned int f = 0; f < FORMAT_COUNT; f++)
+    {
+        InstanceFormat format = (InstanceFormat)f;
+        Shader& shader = format == InstanceFormat::Matrix ? matrixShader : compactShader;
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("instanceOrigin", glm::vec3(0.0f));
+        std::vector<unsigned char> data = PackInstances(format, many);
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glBufferData(GL_ARRAY_BUFFER, data.size(), data.data(), GL_STATIC_DRAW);
+        for (const Mesh& mesh : rock.meshes)
+        {
+            glBindVertexArray(mesh.VAO);
+            SetInstanceAttributes(format, buffer, 3);
+        }
+
+        // the first draw warms up, the query waits for the rest to finish; fine for a benchmark
+        double totalMs = 0.0;
+        for (unsigned int r = 0; r <= repeats; r++)
+        {
+            glBeginQuery(GL_TIME_ELAPSED, query);
+            for (const Mesh& mesh : rock.meshes)
+            {
+                glBindVertexArray(mesh.VAO);
+                glDrawElementsInstanced(GL_TRIANGLES, static_cast<unsigned int>(mesh.indices.size()), GL_UNSIGNED_INT, 0, instances);
+            }
+            glEndQuery(GL_TIME_ELAPSED);
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+            if (r > 0)
+                totalMs += elapsed / 1e6;
+        }
+        std::cout << "  " << std::left << std::setw(18) << InstanceFormatName(format) << std::right << std::fixed << std::setprecision(2)
+                  << data.size() / (1024.0 * 1024.0) << " MB, " << std::setprecision(3) << totalMs / repeats << " ms" << std::endl;
+    }
+    glDisable(GL_RASTERIZER_DISCARD);
+    glBindVertexArray(0);
+    glDeleteQueries(1, &query);
+    glDeleteBuffers(1, &buffer);
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
@@ -223,6 +323,25 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS && !instanceFormatKeyPressed)
+    {
+        instanceFormat = (InstanceFormat)(((int)instanceFormat + 1) % FORMAT_COUNT);
+        instanceFormatKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_F) == GLFW_RELEASE)
+    {
+        instanceFormatKeyPressed = false;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        runBenchmark = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
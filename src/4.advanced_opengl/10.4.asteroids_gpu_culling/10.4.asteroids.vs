@@ -0,0 +1,21 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+
+// model matrices of the visible asteroids, written by 10.4.asteroids_cull.cs
+layout (std430, binding = 1) readonly buffer VisibleMatrices
+{
+    mat4 matrices[];
+};
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform uint instanceOffset;    // start of the range of the level of detail being drawn
+
+void main()
+{
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * matrices[instanceOffset + gl_InstanceID] * vec4(aPos, 1.0f);
+}
@@ -0,0 +1,80 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+// one thread per asteroid: place it on its orbit, test its bounding sphere against the frustum,
+// pick a level of detail from its distance and append its model matrix to that level's range of
+// the visible instance buffer. The per level counters end up in the indirect draw commands.
+struct Asteroid
+{
+    vec4 orbit;     // x = orbit radius, y = angle at time 0, z = height, w = angular speed
+    vec4 spin;      // x = rotation angle at time 0, y = rotation speed, z = scale
+};
+
+layout (std430, binding = 0) readonly buffer Asteroids
+{
+    Asteroid asteroids[];
+};
+
+layout (std430, binding = 1) writeonly buffer VisibleMatrices
+{
+    mat4 matrices[];
+};
+
+layout (std430, binding = 2) buffer LodCounts
+{
+    uint counts[];
+};
+
+uniform uint asteroidCount;
+uniform uint maxPerLod;         // size of every level's range in VisibleMatrices
+uniform float time;
+uniform bool cullAndLod;        // false: every asteroid goes into level 0, like plain instancing
+uniform vec4 frustumPlanes[6];
+uniform vec3 cameraPos;
+uniform vec2 lodDistances;      // end of level 0 and of level 1; level 2 runs up to cullDistance
+uniform float cullDistance;
+uniform float meshRadius;       // bounding sphere radius of the rock at scale 1
+
+const vec3 SPIN_AXIS = normalize(vec3(0.4, 0.6, 0.8));
+
+mat4 rotationMatrix(vec3 axis, float angle)
+{
+    float c = cos(angle), s = sin(angle);
+    mat3 r = mat3(c) + (1.0 - c) * outerProduct(axis, axis) + s * mat3(0.0, axis.z, -axis.y,
+                                                                       -axis.z, 0.0, axis.x,
+                                                                       axis.y, -axis.x, 0.0);
+    return mat4(r);
+}
+
+void main()
+{
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= asteroidCount)
+        return;
+
+    Asteroid asteroid = asteroids[index];
+    float angle = asteroid.orbit.y + asteroid.orbit.w * time;
+    vec3 position = vec3(sin(angle) * asteroid.orbit.x, asteroid.orbit.z, cos(angle) * asteroid.orbit.x);
+    float scale = asteroid.spin.z;
+
+    uint lod = 0u;
+    if (cullAndLod)
+    {
+        float radius = meshRadius * scale;
+        for (int i = 0; i < 6; i++)
+            if (dot(frustumPlanes[i].xyz, position) + frustumPlanes[i].w < -radius)
+                return;
+        float dist = distance(position, cameraPos);
+        if (dist > cullDistance)
+            return;
+        lod = dist < lodDistances.x ? 0u : (dist < lodDistances.y ? 1u : 2u);
+    }
+
+    // same composition as the static matrices: translate, then scale, then rotate
+    mat4 model = mat4(1.0);
+    model[3] = vec4(position, 1.0);
+    model = model * mat4(mat3(scale)) * rotationMatrix(SPIN_AXIS, asteroid.spin.x + asteroid.spin.y * time);
+
+    uint slot = atomicAdd(counts[lod], 1u);
+    matrices[lod * maxPerLod + slot] = model;
+}
@@ -0,0 +1,459 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <map>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+unsigned int createRockLod(unsigned int subdivisions, float radius, unsigned int& indexCount);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// levels of detail: the rock model up close, then two icospheres of decreasing detail
+const unsigned int LOD_COUNT = 3;
+const glm::vec2 LOD_DISTANCES = glm::vec2(40.0f, 120.0f);
+const float CULL_DISTANCE = 400.0f;
+
+bool cullAndLod = true;         // C: frustum cull and pick levels of detail, otherwise draw every rock at full detail
+bool cullAndLodKeyPressed = false;
+bool animateOrbit = true;       // O: move the asteroids along their orbit on the GPU
+bool animateOrbitKeyPressed = false;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 155.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// per asteroid data as read by 10.4.asteroids_cull.cs (std430)
+struct Asteroid
+{
+    glm::vec4 Orbit;    // x = orbit radius, y = angle at time 0, z = height, w = angular speed
+    glm::vec4 Spin;     // x = rotation angle at time 0, y = rotation speed, z = scale
+};
+
+// layout of one glDrawElementsIndirect command
+struct DrawElementsIndirectCommand
+{
+    GLuint Count;
+    GLuint InstanceCount;
+    GLuint FirstIndex;
+    GLint BaseVertex;
+    GLuint BaseInstance;
+};
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader asteroidShader("10.4.asteroids.vs", "10.4.asteroids.fs");
+    Shader planetShader("10.4.planet.vs", "10.4.planet.fs");
+    ComputeShader cullShader("10.4.asteroids_cull.cs");
+
+    // load models
+    // -----------
+    Model rock(FileSystem::getPath("resources/objects/rock/rock.obj"));
+    Model planet(FileSystem::getPath("resources/objects/planet/planet.obj"));
+
+    // bounding sphere of the rock, used for culling and to size the lower levels of detail
+    float rockRadius = 0.0f;
+    for (const Mesh& mesh : rock.meshes)
+        for (const Vertex& vertex : mesh.vertices)
+            rockRadius = std::max(rockRadius, glm::length(vertex.Position));
+
+    // generate a large list of semi-random orbits; the same placement as the instancing
+    // demo, but stored as orbit parameters so the compute shader can move them
+    // -----------------------------------------------------------------------------------
+    unsigned int amount = 100000;
+    std::vector<Asteroid> asteroids(amount);
+    srand(static_cast<unsigned int>(glfwGetTime())); // initialize random seed
+    float radius = 150.0;
+    float offset = 25.0f;
+    for (unsigned int i = 0; i < amount; i++)
+    {
+        // 1. translation: displace along circle with 'radius' in range [-offset, offset]
+        float angle = (float)i / (float)amount * 360.0f;
+        float displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float x = sin(angle) * radius + displacement;
+        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float y = displacement * 0.4f; // keep height of asteroid field smaller compared to width of x and z
+        displacement = (rand() % (int)(2 * offset * 100)) / 100.0f - offset;
+        float z = cos(angle) * radius + displacement;
+
+        // 2. scale: Scale between 0.05 and 0.25f
+        float scale = static_cast<float>((rand() % 20) / 100.0 + 0.05);
+
+        // 3. rotation: add random rotation around a (semi)randomly picked rotation axis vector
+        float rotAngle = static_cast<float>((rand() % 360));
+
+        // inner asteroids orbit faster, and every rock tumbles at its own pace
+        float orbitRadius = sqrt(x * x + z * z);
+        float orbitSpeed = 0.02f * sqrt(radius / orbitRadius);
+        float spinSpeed = ((rand() % 200) / 100.0f - 1.0f) * 0.5f;
+        asteroids[i].Orbit = glm::vec4(orbitRadius, atan2(x, z), y, orbitSpeed);
+        asteroids[i].Spin = glm::vec4(rotAngle, spinSpeed, scale, 0.0f);
+    }
+
+    // GPU buffers: the asteroids, the visible model matrices (a range of 'amount' matrices per
+    // level of detail), the per level counters and the indirect draw commands
+    // ----------------------------------------------------------------------------------------
+    unsigned int asteroidBuffer, visibleBuffer, countBuffer, commandBuffer;
+    glGenBuffers(1, &asteroidBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, asteroidBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, amount * sizeof(Asteroid), asteroids.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &visibleBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, visibleBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, LOD_COUNT * amount * sizeof(glm::mat4), NULL, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &countBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, LOD_COUNT * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+    // one draw per rock mesh for level 0, one per icosphere for the others
+    std::vector<unsigned int> drawVAOs, drawLods;
+    std::vector<DrawElementsIndirectCommand> commands;
+    for (unsigned int i = 0; i < rock.meshes.size(); i++)
+    {
+        drawVAOs.push_back(rock.meshes[i].VAO);
+        drawLods.push_back(0);
+        commands.push_back({ static_cast<GLuint>(rock.meshes[i].indices.size()), 0, 0, 0, 0 });
+    }
+    unsigned int lodSubdivisions[LOD_COUNT - 1] = { 2, 0 };
+    for (unsigned int lod = 1; lod < LOD_COUNT; lod++)
+    {
+        unsigned int indexCount;
+        drawVAOs.push_back(createRockLod(lodSubdivisions[lod - 1], rockRadius * 0.7f, indexCount));
+        drawLods.push_back(lod);
+        commands.push_back({ indexCount, 0, 0, 0, 0 });
+    }
+    glGenBuffers(1, &commandBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, commands.size() * sizeof(DrawElementsIndirectCommand), commands.data(), GL_DYNAMIC_DRAW);
+
+    std::cout << amount << " asteroids, rock radius " << rockRadius << ", " << LOD_COUNT << " levels of detail" << std::endl;
+
+    GpuTimer cullTimer, drawTimer;
+    unsigned int frameCount = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // configure transformation matrices
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+
+        // 1. cull and select levels of detail on the GPU
+        // ----------------------------------------------
+        cullTimer.Begin();
+        GLuint zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, asteroidBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, visibleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, countBuffer);
+
+        cullShader.use();
+        static float orbitTime = 0.0f;
+        if (animateOrbit)
+            orbitTime += deltaTime;
+        glUniform1ui(glGetUniformLocation(cullShader.ID, "asteroidCount"), amount);
+        glUniform1ui(glGetUniformLocation(cullShader.ID, "maxPerLod"), amount);
+        cullShader.setFloat("time", orbitTime);
+        cullShader.setBool("cullAndLod", cullAndLod);
+        glm::mat4 m = glm::transpose(projection * view);
+        glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+        for (unsigned int i = 0; i < 6; i++)
+            cullShader.setVec4("frustumPlanes[" + std::to_string(i) + "]", planes[i] / glm::length(glm::vec3(planes[i])));
+        cullShader.setVec3("cameraPos", camera.Position);
+        cullShader.setVec2("lodDistances", LOD_DISTANCES);
+        cullShader.setFloat("cullDistance", CULL_DISTANCE);
+        cullShader.setFloat("meshRadius", rockRadius);
+        glDispatchCompute((amount + 255) / 256, 1, 1);
+
+        // copy the counters into the instance counts of the draw commands, without a round trip to the CPU
+        glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        glBindBuffer(GL_COPY_READ_BUFFER, countBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, commandBuffer);
+        for (unsigned int d = 0; d < drawVAOs.size(); d++)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, drawLods[d] * sizeof(GLuint),
+                                d * sizeof(DrawElementsIndirectCommand) + offsetof(DrawElementsIndirectCommand, InstanceCount), sizeof(GLuint));
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+        cullTimer.End();
+
+        // 2. draw
+        // -------
+        drawTimer.Begin();
+        planetShader.use();
+        planetShader.setMat4("projection", projection);
+        planetShader.setMat4("view", view);
+
+        // draw planet
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::translate(model, glm::vec3(0.0f, -3.0f, 0.0f));
+        model = glm::scale(model, glm::vec3(4.0f, 4.0f, 4.0f));
+        planetShader.setMat4("model", model);
+        planet.Draw(planetShader);
+
+        // draw meteorites, one indirect draw per mesh and level of detail
+        asteroidShader.use();
+        asteroidShader.setMat4("projection", projection);
+        asteroidShader.setMat4("view", view);
+        asteroidShader.setInt("texture_diffuse1", 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, rock.textures_loaded[0].id);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        for (unsigned int d = 0; d < drawVAOs.size(); d++)
+        {
+            glUniform1ui(glGetUniformLocation(asteroidShader.ID, "instanceOffset"), drawLods[d] * amount);
+            glBindVertexArray(drawVAOs[d]);
+            glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)(d * sizeof(DrawElementsIndirectCommand)));
+        }
+        glBindVertexArray(0);
+        drawTimer.End();
+
+        // the counters are only read back for this report, drawing never waits for them
+        if (++frameCount % 100 == 0)
+        {
+            GLuint counts[LOD_COUNT];
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, countBuffer);
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(counts), counts);
+            std::cout << std::fixed << std::setprecision(3) << (cullAndLod ? "GPU culling + LOD" : "all instances at full detail")
+                      << (animateOrbit ? ", animated" : ", static") << " | drawn per level: " << counts[0] << " / " << counts[1] << " / " << counts[2]
+                      << " of " << amount << " | cull: " << cullTimer.AverageMs() << " ms | draw: " << drawTimer.AverageMs() << " ms" << std::endl;
+            cullTimer.Reset();
+            drawTimer.Reset();
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteBuffers(1, &asteroidBuffer);
+    glDeleteBuffers(1, &visibleBuffer);
+    glDeleteBuffers(1, &countBuffer);
+    glDeleteBuffers(1, &commandBuffer);
+
+    glfwTerminate();
+    return 0;
+}
+
+// creates an icosphere standing in for the rock at a distance; positions double as normals
+// for a spherical texture mapping. Uses the Vertex layout of the model meshes (position at
+// location 0, texture coordinates at location 2) so the asteroid shader works unchanged.
+// --------------------------------------------------------------------------------------------
+unsigned int createRockLod(unsigned int subdivisions, float radius, unsigned int& indexCount)
+{
+    const float t = (1.0f + sqrt(5.0f)) / 2.0f;
+    std::vector<glm::vec3> positions = {
+        {-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+        {0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}
+    };
+    std::vector<unsigned int> indices = {
+        0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+        3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1
+    };
+    for (unsigned int s = 0; s < subdivisions; s++)
+    {
+        // split every triangle into four, sharing the new edge midpoints between neighbours
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        auto midpoint = [&](unsigned int a, unsigned int b) {
+            std::pair<unsigned int, unsigned int> key(std::min(a, b), std::max(a, b));
+            auto found = midpoints.find(key);
+            if (found != midpoints.end())
+                return found->second;
+            positions.push_back((positions[a] + positions[b]) * 0.5f);
+            midpoints[key] = (unsigned int)positions.size() - 1;
+            return (unsigned int)positions.size() - 1;
+        };
+        std::vector<unsigned int> subdivided;
+        for (size_t i = 0; i < indices.size(); i += 3)
+        {
+            unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            unsigned int ab = midpoint(a, b), bc = midpoint(b, c), ca = midpoint(c, a);
+            subdivided.insert(subdivided.end(), { a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca });
+        }
+        indices = subdivided;
+    }
+
+    std::vector<Vertex> vertices(positions.size());
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        glm::vec3 n = glm::normalize(positions[i]);
+        vertices[i].Position = n * radius;
+        vertices[i].Normal = n;
+        vertices[i].TexCoords = glm::vec2(0.5f + atan2(n.z, n.x) / (2.0f * glm::pi<float>()), 0.5f + asin(n.y) / glm::pi<float>());
+    }
+
+    unsigned int VAO, VBO, EBO;
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, Position));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, TexCoords));
+    glBindVertexArray(0);
+
+    indexCount = (unsigned int)indices.size();
+    return VAO;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_PRESS && !cullAndLodKeyPressed)
+    {
+        cullAndLod = !cullAndLod;
+        cullAndLodKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE)
+    {
+        cullAndLodKeyPressed = false;
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !animateOrbitKeyPressed)
+    {
+        animateOrbit = !animateOrbit;
+        animateOrbitKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE)
+    {
+        animateOrbitKeyPressed = false;
+    }
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
@@ -0,0 +1,135 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D screenTexture;
+uniform vec2 texelSize;
+
+// a condensed version of FXAA 3.11's quality preset: find edges from the luma contrast, search
+// along them for their ends and blend across the edge by how far the pixel is from an end
+const float EDGE_THRESHOLD_MIN = 0.0312;
+const float EDGE_THRESHOLD_MAX = 0.125;
+const float SUBPIXEL_QUALITY = 0.75;
+const int SEARCH_STEPS = 12;
+const float STEP_SIZES[SEARCH_STEPS] = float[](1.0, 1.0, 1.0, 1.0, 1.0, 1.5, 2.0, 2.0, 2.0, 2.0, 4.0, 8.0);
+
+float luma(vec3 color)
+{
+    return sqrt(dot(color, vec3(0.299, 0.587, 0.114)));
+}
+
+float lumaAt(vec2 coords)
+{
+    return luma(texture(screenTexture, coords).rgb);
+}
+
+void main()
+{
+    vec3 colorCenter = texture(screenTexture, TexCoords).rgb;
+    float lumaCenter = luma(colorCenter);
+    float lumaDown = lumaAt(TexCoords + vec2(0.0, -texelSize.y));
+    float lumaUp = lumaAt(TexCoords + vec2(0.0, texelSize.y));
+    float lumaLeft = lumaAt(TexCoords + vec2(-texelSize.x, 0.0));
+    float lumaRight = lumaAt(TexCoords + vec2(texelSize.x, 0.0));
+
+    // skip pixels without enough contrast
+    float lumaMin = min(lumaCenter, min(min(lumaDown, lumaUp), min(lumaLeft, lumaRight)));
+    float lumaMax = max(lumaCenter, max(max(lumaDown, lumaUp), max(lumaLeft, lumaRight)));
+    float lumaRange = lumaMax - lumaMin;
+    if (lumaRange < max(EDGE_THRESHOLD_MIN, lumaMax * EDGE_THRESHOLD_MAX))
+    {
+        FragColor = vec4(colorCenter, 1.0);
+        return;
+    }
+
+    float lumaDownLeft = lumaAt(TexCoords + vec2(-texelSize.x, -texelSize.y));
+    float lumaUpRight = lumaAt(TexCoords + vec2(texelSize.x, texelSize.y));
+    float lumaUpLeft = lumaAt(TexCoords + vec2(-texelSize.x, texelSize.y));
+    float lumaDownRight = lumaAt(TexCoords + vec2(texelSize.x, -texelSize.y));
+
+    // is the edge horizontal or vertical
+    float lumaDownUp = lumaDown + lumaUp;
+    float lumaLeftRight = lumaLeft + lumaRight;
+    float lumaLeftCorners = lumaDownLeft + lumaUpLeft;
+    float lumaDownCorners = lumaDownLeft + lumaDownRight;
+    float lumaRightCorners = lumaDownRight + lumaUpRight;
+    float lumaUpCorners = lumaUpRight + lumaUpLeft;
+    float edgeHorizontal = abs(-2.0 * lumaLeft + lumaLeftCorners) + abs(-2.0 * lumaCenter + lumaDownUp) * 2.0 + abs(-2.0 * lumaRight + lumaRightCorners);
+    float edgeVertical = abs(-2.0 * lumaUp + lumaUpCorners) + abs(-2.0 * lumaCenter + lumaLeftRight) * 2.0 + abs(-2.0 * lumaDown + lumaDownCorners);
+    bool isHorizontal = edgeHorizontal >= edgeVertical;
+
+    // which side of the pixel the edge is on
+    float luma1 = isHorizontal ? lumaDown : lumaLeft;
+    float luma2 = isHorizontal ? lumaUp : lumaRight;
+    float gradient1 = luma1 - lumaCenter;
+    float gradient2 = luma2 - lumaCenter;
+    bool is1Steepest = abs(gradient1) >= abs(gradient2);
+    float gradientScaled = 0.25 * max(abs(gradient1), abs(gradient2));
+
+    float stepLength = isHorizontal ? texelSize.y : texelSize.x;
+    float lumaLocalAverage;
+    if (is1Steepest)
+    {
+        stepLength = -stepLength;
+        lumaLocalAverage = 0.5 * (luma1 + lumaCenter);
+    }
+    else
+    {
+        lumaLocalAverage = 0.5 * (luma2 + lumaCenter);
+    }
+
+    // start on the edge, half a pixel towards it, and walk along it both ways
+    vec2 currentCoords = TexCoords;
+    if (isHorizontal)
+        currentCoords.y += stepLength * 0.5;
+    else
+        currentCoords.x += stepLength * 0.5;
+    vec2 offset = isHorizontal ? vec2(texelSize.x, 0.0) : vec2(0.0, texelSize.y);
+
+    vec2 coords1 = currentCoords - offset;
+    vec2 coords2 = currentCoords + offset;
+    float lumaEnd1 = lumaAt(coords1) - lumaLocalAverage;
+    float lumaEnd2 = lumaAt(coords2) - lumaLocalAverage;
+    bool reached1 = abs(lumaEnd1) >= gradientScaled;
+    bool reached2 = abs(lumaEnd2) >= gradientScaled;
+    for (int i = 1; i < SEARCH_STEPS && !(reached1 && reached2); i++)
+    {
+        if (!reached1)
+        {
+            coords1 -= offset * STEP_SIZES[i];
+            lumaEnd1 = lumaAt(coords1) - lumaLocalAverage;
+            reached1 = abs(lumaEnd1) >= gradientScaled;
+        }
+        if (!reached2)
+        {
+            coords2 += offset * STEP_SIZES[i];
+            lumaEnd2 = lumaAt(coords2) - lumaLocalAverage;
+            reached2 = abs(lumaEnd2) >= gradientScaled;
+        }
+    }
+
+    // distance to the nearer end decides how much to blend
+    float distance1 = isHorizontal ? (TexCoords.x - coords1.x) : (TexCoords.y - coords1.y);
+    float distance2 = isHorizontal ? (coords2.x - TexCoords.x) : (coords2.y - TexCoords.y);
+    bool isDirection1 = distance1 < distance2;
+    float distanceFinal = min(distance1, distance2);
+    float edgeThickness = distance1 + distance2;
+    bool isLumaCenterSmaller = lumaCenter < lumaLocalAverage;
+    bool correctVariation = ((isDirection1 ? lumaEnd1 : lumaEnd2) < 0.0) != isLumaCenterSmaller;
+    float pixelOffset = correctVariation ? -distanceFinal / edgeThickness + 0.5 : 0.0;
+
+    // sub-pixel aliasing: single pixel features get blended by their contrast with the neighbourhood
+    float lumaAverage = (1.0 / 12.0) * (2.0 * (lumaDownUp + lumaLeftRight) + lumaLeftCorners + lumaRightCorners);
+    float subPixelOffset1 = clamp(abs(lumaAverage - lumaCenter) / lumaRange, 0.0, 1.0);
+    float subPixelOffset2 = (-2.0 * subPixelOffset1 + 3.0) * subPixelOffset1 * subPixelOffset1;
+    float subPixelOffset = subPixelOffset2 * subPixelOffset2 * SUBPIXEL_QUALITY;
+    pixelOffset = max(pixelOffset, subPixelOffset);
+
+    vec2 finalCoords = TexCoords;
+    if (isHorizontal)
+        finalCoords.y += pixelOffset * stepLength;
+    else
+        finalCoords.x += pixelOffset * stepLength;
+    FragColor = vec4(texture(screenTexture, finalCoords).rgb, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 330 core
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out vec2 Velocity;   // screen space motion since the last frame, in texture coordinates
+
+in vec3 FragPos;
+in vec4 CurrentClip;
+in vec4 PreviousClip;
+
+uniform vec3 color;
+uniform vec3 lightDir;
+
+void main()
+{
+    // flat shading from the screen space derivatives, so the cube edges alias clearly without anti-aliasing
+    vec3 normal = normalize(cross(dFdx(FragPos), dFdy(FragPos)));
+    float diffuse = max(dot(normal, -lightDir), 0.0);
+    FragColor = vec4(color * (0.2 + 0.8 * diffuse), 1.0);
+
+    Velocity = (CurrentClip.xy / CurrentClip.w - PreviousClip.xy / PreviousClip.w) * 0.5;
+}
@@ -0,0 +1,21 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+
+out vec3 FragPos;
+out vec4 CurrentClip;
+out vec4 PreviousClip;
+
+uniform mat4 model;
+uniform mat4 previousModel;
+uniform mat4 viewProjection;            // jittered when temporal anti-aliasing is on
+uniform mat4 unjitteredViewProjection;
+uniform mat4 previousViewProjection;    // unjittered
+
+void main()
+{
+    vec4 worldPos = model * vec4(aPos, 1.0);
+    FragPos = worldPos.xyz;
+    CurrentClip = unjitteredViewProjection * worldPos;
+    PreviousClip = previousViewProjection * previousModel * vec4(aPos, 1.0);
+    gl_Position = viewProjection * worldPos;
+}
@@ -0,0 +1,61 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D currentTexture;   // this frame, rendered with a jittered projection
+uniform sampler2D historyTexture;   // the accumulated result of the previous frames
+uniform sampler2D velocityTexture;
+uniform sampler2D depthTexture;
+
+uniform vec2 texelSize;
+uniform float blendFactor;          // weight of the current frame; 1 discards the history
+
+// the neighbourhood clamp works better in a luma/chroma space than in RGB
+vec3 RGBToYCoCg(vec3 c)
+{
+    return vec3(0.25 * c.r + 0.5 * c.g + 0.25 * c.b, 0.5 * c.r - 0.5 * c.b, -0.25 * c.r + 0.5 * c.g - 0.25 * c.b);
+}
+
+vec3 YCoCgToRGB(vec3 c)
+{
+    return vec3(c.x + c.y - c.z, c.x + c.z, c.x - c.y - c.z);
+}
+
+void main()
+{
+    // gather the color bounds of the 3x3 neighbourhood and find its closest fragment; taking the
+    // velocity from there keeps the motion of foreground edges, which are only partly covered
+    vec3 current = RGBToYCoCg(texture(currentTexture, TexCoords).rgb);
+    vec3 minColor = current, maxColor = current;
+    float closestDepth = 1.0;
+    vec2 closestOffset = vec2(0.0);
+    for (int x = -1; x <= 1; x++)
+    {
+        for (int y = -1; y <= 1; y++)
+        {
+            vec2 offset = vec2(x, y) * texelSize;
+            vec3 neighbour = RGBToYCoCg(texture(currentTexture, TexCoords + offset).rgb);
+            minColor = min(minColor, neighbour);
+            maxColor = max(maxColor, neighbour);
+            float depth = texture(depthTexture, TexCoords + offset).r;
+            if (depth < closestDepth)
+            {
+                closestDepth = depth;
+                closestOffset = offset;
+            }
+        }
+    }
+
+    // reproject: where was this surface last frame
+    vec2 velocity = texture(velocityTexture, TexCoords + closestOffset).rg;
+    vec2 historyCoords = TexCoords - velocity;
+    float blend = blendFactor;
+    if (any(lessThan(historyCoords, vec2(0.0))) || any(greaterThan(historyCoords, vec2(1.0))))
+        blend = 1.0; // disoccluded at the screen border, there is no history
+
+    // history colors outside of what the neighbourhood shows now are stale; clamp them
+    vec3 history = clamp(RGBToYCoCg(texture(historyTexture, historyCoords).rgb), minColor, maxColor);
+
+    FragColor = vec4(YCoCgToRGB(mix(history, current, blend)), 1.0);
+}
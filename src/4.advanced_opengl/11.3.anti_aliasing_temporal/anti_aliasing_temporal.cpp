@@ -0,0 +1,549 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/gpu_timer.h>
+
+#include <iostream>
+#include <iomanip>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+float halton(unsigned int index, unsigned int base);
+unsigned int createTexture(GLenum internalFormat, GLenum format, GLenum type, GLenum filter);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// anti-aliasing modes, cycled with M; B renders a while in every mode and prints their cost
+enum AAMode
+{
+    AA_NONE,
+    AA_MSAA,
+    AA_FXAA,
+    AA_TAA,
+    AA_MODE_COUNT
+};
+const char* aaModeNames[AA_MODE_COUNT] = { "no anti-aliasing", "4x MSAA", "FXAA", "TAA" };
+// bytes per pixel of the render targets of each mode, for the report
+const unsigned int aaModeBytesPerPixel[AA_MODE_COUNT] = {
+    4 + 4,                  // color, depth/stencil
+    4 * (4 + 4) + 4,        // 4 samples of color and depth/stencil, resolved color
+    4 + 4,                  // color, depth/stencil
+    4 + 4 + 4 + 2 * 8       // color, velocity, depth/stencil, two RGBA16F history buffers
+};
+int aaMode = AA_TAA;
+bool aaModeKeyPressed = false;
+bool benchmarkRequested = false;
+bool benchmarkKeyPressed = false;
+
+// temporal anti-aliasing
+const unsigned int TAA_SAMPLES = 8;     // length of the jitter sequence
+const float TAA_BLEND_FACTOR = 0.1f;    // weight of the current frame in the history
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader sceneShader("11.3.scene.vs", "11.3.scene.fs");
+    Shader presentShader("11.3.post.vs", "11.3.present.fs");
+    Shader fxaaShader("11.3.post.vs", "11.3.fxaa.fs");
+    Shader taaShader("11.3.post.vs", "11.3.taa.fs");
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    float cubeVertices[] = {
+        // positions
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+        -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+
+        -0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+        -0.5f, -0.5f,  0.5f,
+
+        -0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f, -0.5f,
+        -0.5f, -0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+
+        -0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f, -0.5f,
+         0.5f, -0.5f,  0.5f,
+         0.5f, -0.5f,  0.5f,
+        -0.5f, -0.5f,  0.5f,
+        -0.5f, -0.5f, -0.5f,
+
+        -0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f, -0.5f,
+         0.5f,  0.5f,  0.5f,
+         0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f,  0.5f,
+        -0.5f,  0.5f, -0.5f
+    };
+    float quadVertices[] = {   // vertex attributes for a quad that fills the entire screen in Normalized Device Coordinates.
+        // positions   // texCoords
+        -1.0f,  1.0f,  0.0f, 1.0f,
+        -1.0f, -1.0f,  0.0f, 0.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+
+        -1.0f,  1.0f,  0.0f, 1.0f,
+         1.0f, -1.0f,  1.0f, 0.0f,
+         1.0f,  1.0f,  1.0f, 1.0f
+    };
+    // setup cube VAO
+    unsigned int cubeVAO, cubeVBO;
+    glGenVertexArrays(1, &cubeVAO);
+    glGenBuffers(1, &cubeVBO);
+    glBindVertexArray(cubeVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(cubeVertices), &cubeVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    // setup screen VAO
+    unsigned int quadVAO, quadVBO;
+    glGenVertexArrays(1, &quadVAO);
+    glGenBuffers(1, &quadVBO);
+    glBindVertexArray(quadVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+
+    // configure MSAA framebuffer, resolved into msaaResolveFBO like in the offscreen MSAA demo
+    // ----------------------------------------------------------------------------------------
+    unsigned int msaaFBO;
+    glGenFramebuffers(1, &msaaFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, msaaFBO);
+    unsigned int msaaColorBuffer, msaaDepthBuffer;
+    glGenRenderbuffers(1, &msaaColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, msaaColorBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, msaaColorBuffer);
+    glGenRenderbuffers(1, &msaaDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, msaaDepthBuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, msaaDepthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: MSAA framebuffer is not complete!" << std::endl;
+
+    unsigned int msaaResolveFBO;
+    glGenFramebuffers(1, &msaaResolveFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, msaaResolveFBO);
+    unsigned int msaaResolveTexture = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_LINEAR);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, msaaResolveTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: MSAA resolve framebuffer is not complete!" << std::endl;
+
+    // configure the single sampled scene framebuffer: color, screen space velocity and depth
+    // --------------------------------------------------------------------------------------
+    unsigned int sceneFBO;
+    glGenFramebuffers(1, &sceneFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, sceneFBO);
+    unsigned int sceneColorTexture = createTexture(GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE, GL_LINEAR);
+    unsigned int velocityTexture = createTexture(GL_RG16F, GL_RG, GL_HALF_FLOAT, GL_NEAREST);
+    unsigned int depthTexture = createTexture(GL_DEPTH24_STENCIL8, GL_DEPTH_STENCIL, GL_UNSIGNED_INT_24_8, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, sceneColorTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, velocityTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, depthTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "ERROR::FRAMEBUFFER:: Scene framebuffer is not complete!" << std::endl;
+    const GLenum colorOnly[] = { GL_COLOR_ATTACHMENT0, GL_NONE };
+    const GLenum colorAndVelocity[] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+
+    // TAA history, ping-ponged: each frame reads one and writes the other
+    unsigned int historyFBOs[2], historyTextures[2];
+    glGenFramebuffers(2, historyFBOs);
+    for (unsigned int i = 0; i < 2; i++)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[i]);
+        historyTextures[i] = createTexture(GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, GL_LINEAR);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER:: History framebuffer is not complete!" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // shader configuration
+    // --------------------
+    const glm::vec2 texelSize(1.0f / SCR_WIDTH, 1.0f / SCR_HEIGHT);
+    presentShader.use();
+    presentShader.setInt("screenTexture", 0);
+    fxaaShader.use();
+    fxaaShader.setInt("screenTexture", 0);
+    fxaaShader.setVec2("texelSize", texelSize);
+    taaShader.use();
+    taaShader.setInt("currentTexture", 0);
+    taaShader.setInt("historyTexture", 1);
+    taaShader.setInt("velocityTexture", 2);
+    taaShader.setInt("depthTexture", 3);
+    taaShader.setVec2("texelSize", texelSize);
+    sceneShader.use();
+    sceneShader.setVec3("lightDir", glm::normalize(glm::vec3(-0.4f, -1.0f, -0.6f)));
+
+    // a grid of spinning cubes, so there are plenty of moving edges
+    const int GRID = 5;
+    glm::mat4 previousModels[GRID * GRID];
+    glm::mat4 previousViewProjection(1.0f);
+    bool firstFrame = true;
+
+    GpuTimer sceneTimer, aaTimer;
+    unsigned int frameCount = 0, taaFrame = 0, history = 0;
+    int resetHistoryMode = -1;
+
+    // benchmark: every mode renders BENCHMARK_FRAMES frames, the second half of which is measured
+    const unsigned int BENCHMARK_FRAMES = 200;
+    bool benchmarking = false;
+    unsigned int benchmarkFrame = 0;
+    int benchmarkPreviousMode = aaMode;
+    float benchmarkResults[AA_MODE_COUNT][2];
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+        if (benchmarkRequested && !benchmarking)
+        {
+            benchmarking = true;
+            benchmarkFrame = 0;
+            benchmarkPreviousMode = aaMode;
+            aaMode = 0;
+        }
+        benchmarkRequested = false;
+
+        // the history is meaningless after switching to TAA
+        bool resetHistory = aaMode == AA_TAA && resetHistoryMode != AA_TAA;
+        resetHistoryMode = aaMode;
+
+        // set transformation matrices; TAA shifts the projection by a different sub-pixel offset every frame
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 1000.0f);
+        glm::mat4 viewProjection = projection * camera.GetViewMatrix();
+        glm::mat4 jitteredViewProjection = viewProjection;
+        if (aaMode == AA_TAA)
+        {
+            unsigned int sample = taaFrame++ % TAA_SAMPLES + 1;
+            glm::vec2 jitter(halton(sample, 2) - 0.5f, halton(sample, 3) - 0.5f);
+            glm::mat4 jitterTranslation = glm::translate(glm::mat4(1.0f), glm::vec3(jitter * 2.0f * texelSize, 0.0f));
+            jitteredViewProjection = jitterTranslation * viewProjection;
+        }
+        if (firstFrame)
+            previousViewProjection = viewProjection;
+
+        // 1. draw the scene
+        // -----------------
+        sceneTimer.Begin();
+        glBindFramebuffer(GL_FRAMEBUFFER, aaMode == AA_MSAA ? msaaFBO : sceneFBO);
+        if (aaMode != AA_MSAA)
+            glDrawBuffers(2, aaMode == AA_TAA ? colorAndVelocity : colorOnly);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        if (aaMode == AA_TAA)
+        {
+            const float zeroVelocity[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+            glClearBufferfv(GL_COLOR, 1, zeroVelocity);
+        }
+        glEnable(GL_DEPTH_TEST);
+
+        sceneShader.use();
+        sceneShader.setMat4("viewProjection", jitteredViewProjection);
+        sceneShader.setMat4("unjitteredViewProjection", viewProjection);
+        sceneShader.setMat4("previousViewProjection", previousViewProjection);
+        glBindVertexArray(cubeVAO);
+        for (int x = 0; x < GRID; x++)
+        {
+            for (int y = 0; y < GRID; y++)
+            {
+                int i = x * GRID + y;
+                glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3((x - GRID / 2) * 1.6f, (y - GRID / 2) * 1.6f, -6.0f - (i % 3) * 2.0f));
+                model = glm::rotate(model, currentFrame * (0.3f + 0.1f * (i % 7)), glm::normalize(glm::vec3(1.0f, 0.3f * x + 0.1f, 0.5f * y + 0.2f)));
+                if (firstFrame)
+                    previousModels[i] = model;
+                sceneShader.setMat4("model", model);
+                sceneShader.setMat4("previousModel", previousModels[i]);
+                sceneShader.setVec3("color", glm::vec3(0.3f + 0.7f * x / (GRID - 1), 1.0f - 0.5f * y / (GRID - 1), 0.4f + 0.15f * (i % 4)));
+                glDrawArrays(GL_TRIANGLES, 0, 36);
+                previousModels[i] = model;
+            }
+        }
+        previousViewProjection = viewProjection;
+        firstFrame = false;
+        sceneTimer.End();
+
+        // 2. anti-alias into a single sampled texture
+        // -------------------------------------------
+        aaTimer.Begin();
+        glDisable(GL_DEPTH_TEST);
+        glBindVertexArray(quadVAO);
+        unsigned int resultTexture = sceneColorTexture;
+        if (aaMode == AA_MSAA)
+        {
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, msaaFBO);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, msaaResolveFBO);
+            glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            resultTexture = msaaResolveTexture;
+        }
+        else if (aaMode == AA_TAA)
+        {
+            // blend this frame into the reprojected history
+            glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[1 - history]);
+            taaShader.use();
+            taaShader.setFloat("blendFactor", resetHistory ? 1.0f : TAA_BLEND_FACTOR);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, sceneColorTexture);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, historyTextures[history]);
+            glActiveTexture(GL_TEXTURE2);
+            glBindTexture(GL_TEXTURE_2D, velocityTexture);
+            glActiveTexture(GL_TEXTURE3);
+            glBindTexture(GL_TEXTURE_2D, depthTexture);
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+            history = 1 - history;
+            resultTexture = historyTextures[history];
+        }
+        glActiveTexture(GL_TEXTURE0);
+
+        // 3. draw to the screen, FXAA does its work on the way
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT);
+        if (aaMode == AA_FXAA)
+            fxaaShader.use();
+        else
+            presentShader.use();
+        glBindTexture(GL_TEXTURE_2D, resultTexture);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        aaTimer.End();
+
+        if (benchmarking)
+        {
+            benchmarkFrame++;
+            if (benchmarkFrame == BENCHMARK_FRAMES / 2)
+            {
+                sceneTimer.Reset();
+                aaTimer.Reset();
+            }
+            else if (benchmarkFrame == BENCHMARK_FRAMES)
+            {
+                benchmarkResults[aaMode][0] = sceneTimer.AverageMs();
+                benchmarkResults[aaMode][1] = aaTimer.AverageMs();
+                benchmarkFrame = 0;
+                if (++aaMode == AA_MODE_COUNT)
+                {
+                    benchmarking = false;
+                    aaMode = benchmarkPreviousMode;
+                    std::cout << "anti-aliasing cost at " << SCR_WIDTH << "x" << SCR_HEIGHT << " (scene + anti-aliasing = total GPU ms, render target memory):" << std::endl;
+                    for (int m = 0; m < AA_MODE_COUNT; m++)
+                        std::cout << "  " << std::left << std::setw(18) << aaModeNames[m] << std::right << std::fixed << std::setprecision(3)
+                                  << benchmarkResults[m][0] << " + " << benchmarkResults[m][1] << " = " << benchmarkResults[m][0] + benchmarkResults[m][1]
+                                  << " ms, " << std::setprecision(1) << SCR_WIDTH * SCR_HEIGHT * aaModeBytesPerPixel[m] / (1024.0 * 1024.0) << " MB" << std::endl;
+                }
+            }
+        }
+        else if (++frameCount % 100 == 0)
+        {
+            std::cout << std::fixed << std::setprecision(3) << aaModeNames[aaMode] << " | scene: " << sceneTimer.AverageMs() << " ms | anti-aliasing: "
+                      << aaTimer.AverageMs() << " ms | render targets: " << std::setprecision(1)
+                      << SCR_WIDTH * SCR_HEIGHT * aaModeBytesPerPixel[aaMode] / (1024.0 * 1024.0) << " MB" << std::endl;
+            sceneTimer.Reset();
+            aaTimer.Reset();
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glfwTerminate();
+    return 0;
+}
+
+// element 'index' (from 1) of the Halton low-discrepancy sequence in 'base', in [0, 1)
+// -------------------------------------------------------------------------------------
+float halton(unsigned int index, unsigned int base)
+{
+    float result = 0.0f;
+    float fraction = 1.0f;
+    while (index > 0)
+    {
+        fraction /= base;
+        result += fraction * (index % base);
+        index /= base;
+    }
+    return result;
+}
+
+// creates a screen sized texture to render into
+// ---------------------------------------------
+unsigned int createTexture(GLenum internalFormat, GLenum format, GLenum type, GLenum filter)
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, SCR_WIDTH, SCR_HEIGHT, 0, format, type, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !aaModeKeyPressed)
+    {
+        aaMode = (aaMode + 1) % AA_MODE_COUNT;
+        aaModeKeyPressed = true;
+        std::cout << "anti-aliasing: " << aaModeNames[aaMode] << std::endl;
+    }
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE)
+    {
+        aaModeKeyPressed = false;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkRequested = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
@@ -10,6 +10,7 @@
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/transparency_queue.h>
 
 #include <iostream>
 
@@ -17,6 +18,7 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+void benchmarkTransparencyQueue();
 unsigned int loadTexture(const char *path);
 
 // settings
@@ -33,6 +35,8 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+bool benchmarkKeyPressed = false; // B: sort 100k quads with the queue and with std::map
+
 int main()
 {
     // glfw: initialize and configure
@@ -199,6 +203,9 @@ int main()
         glm::vec3( 0.5f, 0.0f, -0.6f)
     };
 
+    // the queue is sized once; sorting never allocates after this
+    TransparencyQueue transparentQueue(windows.size());
+
     // shader configuration
     // --------------------
     shader.use();
@@ -217,15 +224,20 @@ int main()
         // input
         // -----
         camera.processInput(window,deltaTime);
+        bool benchmarkKey = glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS;
+        if (benchmarkKey && !benchmarkKeyPressed)
+            benchmarkTransparencyQueue();
+        benchmarkKeyPressed = benchmarkKey;
 
         // sort the transparent windows before rendering
         // ---------------------------------------------
-        std::map<float, glm::vec3> sorted;
+        transparentQueue.Clear();
         for (unsigned int i = 0; i < windows.size(); i++)
         {
-            float distance = glm::length(camera.Position - windows[i]);
-            sorted[distance] = windows[i];
+            glm::vec3 toCamera = camera.Position - windows[i];
+            transparentQueue.Push(glm::dot(toCamera, toCamera), i);
         }
+        transparentQueue.Sort();
 
         // render
         // ------
@@ -259,10 +271,10 @@ int main()
         // windows (from furthest to nearest)
         glBindVertexArray(transparentVAO);
         glBindTexture(GL_TEXTURE_2D, transparentTexture);
-        for (std::map<float, glm::vec3>::reverse_iterator it = sorted.rbegin(); it != sorted.rend(); ++it)
+        for (const TransparencyQueue::Entry& entry : transparentQueue)
         {
             model = glm::mat4(1.0f);
-            model = glm::translate(model, it->second);
+            model = glm::translate(model, windows[entry.Id]);
             shader.setMat4("model", model);
             glDrawArrays(GL_TRIANGLES, 0, 6);
         }
@@ -285,6 +297,16 @@ int main()
     return 0;
 }
 
+// sorts 100k quads with the queue and with the std::map this demo used before, and prints the times
+// --------------------------------------------------------------------------------------------------
+void benchmarkTransparencyQueue()
+{
+    TransparencyQueueStats stats = TransparencyQueueBenchmark();
+    std::cout << "sorting " << stats.Count << " transparent quads: radix queue " << stats.RadixMs << " ms ("
+              << (stats.Valid ? "none lost, back to front" : "INVALID ORDER") << "), std::map " << stats.MapMs
+              << " ms (" << stats.MapLost << " lost to equal distances)" << std::endl;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
@@ -0,0 +1,72 @@
+#version 430 core
+// One pass of the separable Gaussian prefilter of the moment shadow map. The horizontal pass
+// reads the depth map and turns every texel into its moments first, the vertical pass blurs the
+// result of the horizontal one. Each work group filters 128 texels of one row (or column) and
+// loads them together with the kernel's halo into shared memory once.
+#define GROUP_SIZE 128
+#define MAX_RADIUS 16
+#define MODE_EVSM 1
+#define MODE_MSM 2
+
+layout (local_size_x = GROUP_SIZE) in;
+
+uniform sampler2D source;
+layout (rgba32f, binding = 0) uniform writeonly image2D destination;
+
+uniform bool fromDepth;
+uniform int shadowMode;
+uniform bool vertical;
+uniform int radius;         // kernel radius in texels, at most MAX_RADIUS
+uniform vec2 evsmExponents; // positive and negative warp exponents
+
+shared vec4 texels[GROUP_SIZE + 2 * MAX_RADIUS];
+
+// keep in sync with 3.1.4.shadow_mapping.fs
+vec4 computeMoments(float depth)
+{
+    if (shadowMode == MODE_EVSM)
+    {
+        float d = 2.0 * depth - 1.0;
+        float positive = exp(evsmExponents.x * d);
+        float negative = -exp(-evsmExponents.y * d);
+        return vec4(positive, positive * positive, negative, negative * negative);
+    }
+    float d2 = depth * depth;
+    return vec4(depth, d2, d2 * depth, d2 * d2);
+}
+
+vec4 fetch(ivec2 coords, ivec2 size)
+{
+    coords = clamp(coords, ivec2(0), size - 1);
+    if (fromDepth)
+        return computeMoments(texelFetch(source, coords, 0).r);
+    return texelFetch(source, coords, 0);
+}
+
+void main()
+{
+    ivec2 size = textureSize(source, 0);
+    ivec2 direction = vertical ? ivec2(0, 1) : ivec2(1, 0);
+    ivec2 across = ivec2(1) - direction;
+    int lineLength = size.x * direction.x + size.y * direction.y;
+    int line = int(gl_WorkGroupID.y);
+    int start = int(gl_WorkGroupID.x) * GROUP_SIZE;
+
+    for (int i = int(gl_LocalInvocationID.x); i < GROUP_SIZE + 2 * radius; i += GROUP_SIZE)
+        texels[i] = fetch(direction * (start + i - radius) + across * line, size);
+    barrier();
+
+    int position = start + int(gl_LocalInvocationID.x);
+    if (position >= lineLength)
+        return;
+    float sigma = 0.5 * float(radius) + 0.5;
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int i = -radius; i <= radius; ++i)
+    {
+        float weight = exp(-float(i * i) / (2.0 * sigma * sigma));
+        sum += weight * texels[int(gl_LocalInvocationID.x) + radius + i];
+        weightSum += weight;
+    }
+    imageStore(destination, direction * position + across * line, sum / weightSum);
+}
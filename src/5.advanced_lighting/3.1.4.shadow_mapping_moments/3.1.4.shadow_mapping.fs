@@ -0,0 +1,147 @@
+#version 330 core
+out vec4 FragColor;
+
+in VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+    vec4 FragPosLightSpace;
+} fs_in;
+
+#define MODE_PCF 0
+#define MODE_EVSM 1
+#define MODE_MSM 2
+
+uniform sampler2D diffuseTexture;
+uniform sampler2D shadowMap;  // depth, PCF
+uniform sampler2D momentsMap; // prefiltered moments with mips, EVSM and MSM
+
+uniform vec3 lightPos;
+uniform vec3 viewPos;
+
+uniform int shadowMode;
+uniform int pcfRadius;          // (2r + 1)^2 taps
+uniform vec2 evsmExponents;
+uniform float lightBleedingReduction;
+
+float ShadowPCF(vec3 projCoords)
+{
+    float currentDepth = projCoords.z;
+    // calculate bias (based on depth map resolution and slope)
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 lightDir = normalize(lightPos - fs_in.FragPos);
+    float bias = max(0.05 * (1.0 - dot(normal, lightDir)), 0.005);
+    float shadow = 0.0;
+    vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
+    for(int x = -pcfRadius; x <= pcfRadius; ++x)
+    {
+        for(int y = -pcfRadius; y <= pcfRadius; ++y)
+        {
+            float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r;
+            shadow += currentDepth - bias > pcfDepth ? 1.0 : 0.0;
+        }
+    }
+    float taps = float(2 * pcfRadius + 1);
+    return shadow / (taps * taps);
+}
+
+// cuts off the tail of the visibility function that causes light bleeding
+float reduceLightBleeding(float visibility)
+{
+    return clamp((visibility - lightBleedingReduction) / (1.0 - lightBleedingReduction), 0.0, 1.0);
+}
+
+// one-sided Chebyshev upper bound on the fraction of the filter region closer than t
+float chebyshev(vec2 moments, float t, float minVariance)
+{
+    if (t <= moments.x)
+        return 1.0;
+    float variance = max(moments.y - moments.x * moments.x, minVariance);
+    float d = t - moments.x;
+    return reduceLightBleeding(variance / (variance + d * d));
+}
+
+float ShadowEVSM(vec3 projCoords)
+{
+    // keep the warp in sync with 3.1.4.moments_blur.cs
+    vec4 moments = texture(momentsMap, projCoords.xy);
+    float d = 2.0 * projCoords.z - 1.0;
+    float positive = exp(evsmExponents.x * d);
+    float negative = -exp(-evsmExponents.y * d);
+    // minimum variance scaled with the derivative of the warp
+    vec2 depthScale = 0.0001 * evsmExponents * vec2(positive, negative);
+    vec2 minVariance = depthScale * depthScale;
+    float visibility = min(chebyshev(moments.xy, positive, minVariance.x), chebyshev(moments.zw, negative, minVariance.y));
+    return 1.0 - visibility;
+}
+
+// Hamburger 4 moment shadow mapping (Peters and Klein 2015)
+float ShadowMSM(vec3 projCoords)
+{
+    vec4 b = mix(texture(momentsMap, projCoords.xy), vec4(0.5), 3e-5);
+    float depth = projCoords.z;
+    // Cholesky decomposition of the Hankel matrix of the moments
+    float L32D22 = -b.x * b.y + b.z;
+    float D22 = -b.x * b.x + b.y;
+    float squaredDepthVariance = -b.y * b.y + b.w;
+    float D33D22 = dot(vec2(squaredDepthVariance, -L32D22), vec2(D22, L32D22));
+    float InvD22 = 1.0 / D22;
+    float L32 = L32D22 * InvD22;
+    vec3 c = vec3(1.0, depth, depth * depth);
+    c.y -= b.x;
+    c.z -= b.y + L32 * c.y;
+    c.y *= InvD22;
+    c.z *= D22 / D33D22;
+    c.y -= L32 * c.z;
+    c.x -= dot(c.yz, b.xy);
+    // roots of the quadratic c.x + c.y * z + c.z * z^2
+    float p = c.y / c.z;
+    float q = c.x / c.z;
+    float r = sqrt(max(p * p * 0.25 - q, 0.0));
+    vec3 z = vec3(depth, -p * 0.5 - r, -p * 0.5 + r);
+    vec4 switchVal = (z.z < z.x) ? vec4(z.y, z.x, 1.0, 1.0) :
+                    ((z.y < z.x) ? vec4(z.x, z.y, 0.0, 1.0) : vec4(0.0));
+    float quotient = (switchVal.x * z.z - b.x * (switchVal.x + z.z) + b.y) / ((z.z - switchVal.y) * (z.x - z.y));
+    float shadow = clamp(switchVal.z + switchVal.w * quotient, 0.0, 1.0);
+    return 1.0 - reduceLightBleeding(1.0 - shadow);
+}
+
+float ShadowCalculation(vec4 fragPosLightSpace)
+{
+    // perform perspective divide
+    vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
+    // transform to [0,1] range
+    projCoords = projCoords * 0.5 + 0.5;
+    // keep the shadow at 0.0 outside the light's frustum
+    if(projCoords.z > 1.0 || any(lessThan(projCoords.xy, vec2(0.0))) || any(greaterThan(projCoords.xy, vec2(1.0))))
+        return 0.0;
+    if (shadowMode == MODE_EVSM)
+        return ShadowEVSM(projCoords);
+    if (shadowMode == MODE_MSM)
+        return ShadowMSM(projCoords);
+    return ShadowPCF(projCoords);
+}
+
+void main()
+{
+    vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 lightColor = vec3(0.3);
+    // ambient
+    vec3 ambient = 0.3 * lightColor;
+    // diffuse
+    vec3 lightDir = normalize(lightPos - fs_in.FragPos);
+    float diff = max(dot(lightDir, normal), 0.0);
+    vec3 diffuse = diff * lightColor;
+    // specular
+    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    float spec = 0.0;
+    vec3 halfwayDir = normalize(lightDir + viewDir);
+    spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+    vec3 specular = spec * lightColor;
+    // calculate shadow
+    float shadow = ShadowCalculation(fs_in.FragPosLightSpace);
+    vec3 lighting = (ambient + (1.0 - shadow) * (diffuse + specular)) * color;
+
+    FragColor = vec4(lighting, 1.0);
+}
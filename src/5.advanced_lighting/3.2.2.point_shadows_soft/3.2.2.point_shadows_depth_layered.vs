@@ -0,0 +1,20 @@
+#version 330 core
+// either extension allows writing gl_Layer from the vertex shader; only used when this program compiles and links
+#extension GL_ARB_shader_viewport_layer_array : enable
+#extension GL_AMD_vertex_shader_layer : enable
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 model;
+uniform mat4 shadowMatrices[6];
+// cube faces the caster is visible in, 3 bits per instance: instance i renders face (faceList >> 3i) & 7
+uniform int faceList;
+
+out vec4 FragPos;
+
+void main()
+{
+    int face = (faceList >> (3 * gl_InstanceID)) & 7;
+    FragPos = model * vec4(aPos, 1.0);
+    gl_Position = shadowMatrices[face] * FragPos;
+    gl_Layer = face;
+}
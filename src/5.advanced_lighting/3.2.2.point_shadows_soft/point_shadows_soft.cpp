@@ -10,22 +10,49 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
+#include <memory>
+#include <cstring>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
+void buildCasters();
 void renderScene(const Shader &shader);
-void renderCube();
+unsigned int renderSceneLayered(const Shader &shader, const std::vector<glm::mat4>& shadowTransforms);
+void renderCube(int instances = 1);
+bool hasExtension(const char* name);
+bool programLinked(unsigned int program);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 bool shadows = true;
 bool shadowsKeyPressed = false;
+// render the cubemap faces with gl_Layer from the vertex shader instead of the geometry shader,
+// toggled with L; only available when the layered shader compiles and links with ARB_shader_viewport_layer_array
+// or AMD_vertex_shader_layer
+bool layerExtension = false;
+bool vertexLayer = true;
+bool vertexLayerKeyPressed = false;
+// adds a few hundred small casters to make the difference between both paths measurable, toggled with E
+bool denseScene = false;
+bool denseSceneKeyPressed = false;
+
+// shadow casters with a bounding sphere, so each one is only rendered into the cube faces it touches
+struct Caster
+{
+    glm::mat4 Model;
+    glm::vec3 Center;
+    float Radius;
+    bool Inside; // the room: rendered from the inside, visible in every face
+};
+std::vector<Caster> casters;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
@@ -84,6 +111,21 @@ int main()
     // -------------------------
     Shader shader("3.2.2.point_shadows.vs", "3.2.2.point_shadows.fs");
     Shader simpleDepthShader("3.2.2.point_shadows_depth.vs", "3.2.2.point_shadows_depth.fs", "3.2.2.point_shadows_depth.gs");
+    // single pass without a geometry shader; falls back to the geometry shader when the driver can't write gl_Layer from the vertex shader
+    std::unique_ptr<Shader> layeredDepthShader;
+    layerExtension = hasExtension("GL_ARB_shader_viewport_layer_array") || hasExtension("GL_AMD_vertex_shader_layer");
+    if (layerExtension)
+    {
+        // some drivers report the extension but reject it in a #version 330 shader, so only trust a program that links
+        layeredDepthShader.reset(new Shader("3.2.2.point_shadows_depth_layered.vs", "3.2.2.point_shadows_depth.fs"));
+        layerExtension = programLinked(layeredDepthShader->ID);
+        if (!layerExtension)
+            std::cout << "the vertex shader layer program failed to build, cubemap faces are rendered through the geometry shader" << std::endl;
+    }
+    else
+        std::cout << "no vertex shader layer extension, cubemap faces are rendered through the geometry shader" << std::endl;
+    vertexLayer = layerExtension;
+    buildCasters();
 
     // load textures
     // -------------
@@ -123,6 +165,12 @@ int main()
     // -------------
     glm::vec3 lightPos(0.0f, 0.0f, 0.0f);
 
+    // depth pass statistics, printed every 100 frames
+    GpuTimer depthTimer;
+    unsigned int reportFrames = 0;
+    unsigned long long faceInstances = 0;
+    bool reportedVertexLayer = vertexLayer, reportedDenseScene = denseScene;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -162,15 +210,48 @@ int main()
         // --------------------------------
         glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
         glBindFramebuffer(GL_FRAMEBUFFER, depthMapFBO);
+        depthTimer.Begin();
         glClear(GL_DEPTH_BUFFER_BIT);
-        simpleDepthShader.use();
+        Shader& depthShader = vertexLayer ? *layeredDepthShader : simpleDepthShader;
+        depthShader.use();
         for (unsigned int i = 0; i < 6; ++i)
-            simpleDepthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
-        simpleDepthShader.setFloat("far_plane", far_plane);
-        simpleDepthShader.setVec3("lightPos", lightPos);
-        renderScene(simpleDepthShader);
+            depthShader.setMat4("shadowMatrices[" + std::to_string(i) + "]", shadowTransforms[i]);
+        depthShader.setFloat("far_plane", far_plane);
+        depthShader.setVec3("lightPos", lightPos);
+        if (vertexLayer)
+        {
+            faceInstances += renderSceneLayered(depthShader, shadowTransforms);
+        }
+        else
+        {
+            renderScene(depthShader);
+            faceInstances += casters.size() * 6; // the geometry shader emits every triangle six times
+        }
+        depthTimer.End();
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+        // depth pass report; restarts when the path or scene changes
+        if (vertexLayer != reportedVertexLayer || denseScene != reportedDenseScene)
+        {
+            if (denseScene != reportedDenseScene)
+                buildCasters();
+            reportedVertexLayer = vertexLayer;
+            reportedDenseScene = denseScene;
+            depthTimer.Reset();
+            reportFrames = 0;
+            faceInstances = 0;
+        }
+        else if (++reportFrames >= 100)
+        {
+            std::cout << std::fixed << std::setprecision(3)
+                      << "cubemap pass: " << (vertexLayer ? "vertex shader layer + per-face culling" : "geometry shader") << " | "
+                      << casters.size() << " casters, " << std::setprecision(1) << (double)faceInstances / reportFrames << " face renders (of "
+                      << casters.size() * 6 << ") | " << std::setprecision(3) << depthTimer.AverageMs() << " ms" << std::endl;
+            depthTimer.Reset();
+            reportFrames = 0;
+            faceInstances = 0;
+        }
+
         // 2. render scene as normal 
         // -------------------------
         glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
@@ -205,49 +286,119 @@ int main()
 // --------------------
 void renderScene(const Shader &shader)
 {
+    for (const Caster& caster : casters)
+    {
+        shader.setMat4("model", caster.Model);
+        if (caster.Inside)
+        {
+            glDisable(GL_CULL_FACE); // note that we disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal culling methods.
+            shader.setInt("reverse_normals", 1); // A small little hack to invert normals when drawing cube from the inside so lighting still works.
+            renderCube();
+            shader.setInt("reverse_normals", 0); // and of course disable it
+            glEnable(GL_CULL_FACE);
+        }
+        else
+        {
+            renderCube();
+        }
+    }
+}
+
+// renders the casters into the cube faces their bounding spheres touch, one instance per face;
+// returns the number of face instances drawn
+// ----------------------------------------------------------------------------------------------
+unsigned int renderSceneLayered(const Shader &shader, const std::vector<glm::mat4>& shadowTransforms)
+{
+    unsigned int instances = 0;
+    for (const Caster& caster : casters)
+    {
+        int faceList = 0;
+        int faceCount = 0;
+        for (int face = 0; face < 6; ++face)
+        {
+            // frustum planes of the face, extracted from its view projection matrix
+            const glm::mat4 m = glm::transpose(shadowTransforms[face]);
+            const glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+            bool visible = true;
+            for (const glm::vec4& plane : planes)
+                visible = visible && glm::dot(glm::vec3(plane), caster.Center) + plane.w >= -caster.Radius * glm::length(glm::vec3(plane));
+            if (visible)
+                faceList |= face << (3 * faceCount++);
+        }
+        if (faceCount == 0)
+            continue;
+        shader.setMat4("model", caster.Model);
+        shader.setInt("faceList", faceList);
+        if (caster.Inside)
+            glDisable(GL_CULL_FACE);
+        renderCube(faceCount);
+        if (caster.Inside)
+            glEnable(GL_CULL_FACE);
+        instances += faceCount;
+    }
+    return instances;
+}
+
+// the room and five cubes of the original scene, plus a grid of small cubes in the dense scene
+// ---------------------------------------------------------------------------------------------
+void buildCasters()
+{
+    casters.clear();
+    // the unit cube spans [-1, 1], its bounding sphere radius is sqrt(3) times its scale
+    auto addCaster = [](const glm::mat4& model, const glm::vec3& position, float scale, bool inside = false) {
+        casters.push_back({ model, position, scale * 1.7321f, inside });
+    };
     // room cube
     glm::mat4 model = glm::mat4(1.0f);
     model = glm::scale(model, glm::vec3(5.0f));
-    shader.setMat4("model", model);
-    glDisable(GL_CULL_FACE); // note that we disable culling here since we render 'inside' the cube instead of the usual 'outside' which throws off the normal culling methods.
-    shader.setInt("reverse_normals", 1); // A small little hack to invert normals when drawing cube from the inside so lighting still works.
-    renderCube();
-    shader.setInt("reverse_normals", 0); // and of course disable it
-    glEnable(GL_CULL_FACE);
+    addCaster(model, glm::vec3(0.0f), 5.0f, true);
     // cubes
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(4.0f, -3.5f, 0.0));
     model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
+    addCaster(model, glm::vec3(4.0f, -3.5f, 0.0), 0.5f);
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(2.0f, 3.0f, 1.0));
     model = glm::scale(model, glm::vec3(0.75f));
-    shader.setMat4("model", model);
-    renderCube();
+    addCaster(model, glm::vec3(2.0f, 3.0f, 1.0), 0.75f);
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-3.0f, -1.0f, 0.0));
     model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
+    addCaster(model, glm::vec3(-3.0f, -1.0f, 0.0), 0.5f);
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-1.5f, 1.0f, 1.5));
     model = glm::scale(model, glm::vec3(0.5f));
-    shader.setMat4("model", model);
-    renderCube();
+    addCaster(model, glm::vec3(-1.5f, 1.0f, 1.5), 0.5f);
     model = glm::mat4(1.0f);
     model = glm::translate(model, glm::vec3(-1.5f, 2.0f, -3.0));
     model = glm::rotate(model, glm::radians(60.0f), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
     model = glm::scale(model, glm::vec3(0.75f));
-    shader.setMat4("model", model);
-    renderCube();
+    addCaster(model, glm::vec3(-1.5f, 2.0f, -3.0), 0.75f);
+    if (!denseScene)
+        return;
+    for (int x = -4; x <= 4; ++x)
+    {
+        for (int y = -4; y <= 4; ++y)
+        {
+            for (int z = -4; z <= 4; z += 2)
+            {
+                // keep clear of the light, which moves along the z axis
+                if (std::abs(x) <= 1 && std::abs(y) <= 1)
+                    continue;
+                glm::vec3 position(x, y, z + 0.5f * (y & 1));
+                model = glm::translate(glm::mat4(1.0f), position);
+                model = glm::scale(model, glm::vec3(0.15f));
+                addCaster(model, position, 0.15f);
+            }
+        }
+    }
 }
 
 // renderCube() renders a 1x1 3D cube in NDC.
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
 unsigned int cubeVBO = 0;
-void renderCube()
+void renderCube(int instances)
 {
     // initialize (if necessary)
     if (cubeVAO == 0)
@@ -314,10 +465,36 @@ void renderCube()
     }
     // render Cube
     glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    if (instances == 1)
+        glDrawArrays(GL_TRIANGLES, 0, 36);
+    else
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instances);
     glBindVertexArray(0);
 }
 
+// whether the current context exposes the given OpenGL extension
+// --------------------------------------------------------------
+bool hasExtension(const char* name)
+{
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; ++i)
+    {
+        if (std::strcmp((const char*)glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    }
+    return false;
+}
+
+// whether the program compiled and linked; a shader that failed to compile makes the link fail
+// ------------------------------------------------------------------------------------------
+bool programLinked(unsigned int program)
+{
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow *window)
@@ -343,6 +520,27 @@ void processInput(GLFWwindow *window)
     {
         shadowsKeyPressed = false;
     }
+
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS && !vertexLayerKeyPressed)
+    {
+        // without a working layered program there is only the geometry shader path
+        vertexLayer = layerExtension && !vertexLayer;
+        vertexLayerKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_L) == GLFW_RELEASE)
+    {
+        vertexLayerKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS && !denseSceneKeyPressed)
+    {
+        denseScene = !denseScene;
+        denseSceneKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_RELEASE)
+    {
+        denseSceneKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
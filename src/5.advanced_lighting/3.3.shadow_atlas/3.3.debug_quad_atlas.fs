@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+// sampled through a sampler object without depth comparison
+uniform sampler2D depthMap;
+
+void main()
+{
+    float depthValue = texture(depthMap, TexCoords).r;
+    // perspective tiles are mostly close to 1.0, stretch the range a bit to make them visible
+    FragColor = vec4(vec3(pow(depthValue, 8.0)), 1.0);
+}
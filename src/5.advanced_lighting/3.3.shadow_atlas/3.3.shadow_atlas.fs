@@ -0,0 +1,124 @@
+#version 330 core
+out vec4 FragColor;
+
+in VS_OUT {
+    vec3 FragPos;
+    vec3 Normal;
+    vec2 TexCoords;
+} fs_in;
+
+// keep in sync with shadow_atlas.cpp
+#define MAX_LIGHTS 32
+#define MAX_VIEWS 96
+
+#define LIGHT_SPOT 0
+#define LIGHT_POINT 1
+#define LIGHT_DIRECTIONAL 2
+
+struct Light {
+    vec4 PositionType;    // xyz = position, w = type
+    vec4 DirectionCutoff; // xyz = direction the light shines in, w = cosine of the outer cone angle
+    vec4 ColorRange;      // rgb = color, a = range
+    ivec4 Shadow;         // x = first view, y = 1 when the light has tiles in the atlas
+};
+
+// one shadow map tile: world space to atlas uv + depth, and the tile's uv rectangle
+struct ShadowView {
+    mat4 Matrix;
+    vec4 Rect;
+};
+
+layout (std140) uniform ShadowData {
+    Light lights[MAX_LIGHTS];
+    ShadowView views[MAX_VIEWS];
+};
+
+uniform int lightCount;
+uniform sampler2D diffuseTexture;
+uniform sampler2DShadow shadowAtlas;
+uniform float atlasTexelSize;
+uniform vec3 viewPos;
+uniform bool shadows;
+
+// cube face in the +X, -X, +Y, -Y, +Z, -Z order the point light views are stored in
+int cubeFace(vec3 v)
+{
+    vec3 a = abs(v);
+    if (a.x >= a.y && a.x >= a.z)
+        return v.x > 0.0 ? 0 : 1;
+    if (a.y >= a.z)
+        return v.y > 0.0 ? 2 : 3;
+    return v.z > 0.0 ? 4 : 5;
+}
+
+float ShadowCalculation(Light light, vec3 fragPos, vec3 normal)
+{
+    int view = light.Shadow.x;
+    if (int(light.PositionType.w) == LIGHT_POINT)
+        view += cubeFace(fragPos - light.PositionType.xyz);
+    // offset along the normal by a few texels of the tile, scaled by the distance for perspective views
+    vec4 rect = views[view].Rect;
+    float tileTexels = (rect.z - rect.x) / atlasTexelSize;
+    float distanceScale = int(light.PositionType.w) == LIGHT_DIRECTIONAL ? 40.0 : length(fragPos - light.PositionType.xyz);
+    vec3 offsetPos = fragPos + normal * distanceScale * 1.5 / tileTexels;
+    vec4 projCoords = views[view].Matrix * vec4(offsetPos, 1.0);
+    projCoords.xyz /= projCoords.w;
+    if (projCoords.z > 1.0)
+        return 0.0;
+    // 3x3 PCF; clamp to the tile so filtering never reads a neighbouring light's tile
+    vec2 minUV = rect.xy + 1.5 * atlasTexelSize;
+    vec2 maxUV = rect.zw - 1.5 * atlasTexelSize;
+    float lit = 0.0;
+    for (int x = -1; x <= 1; ++x)
+    {
+        for (int y = -1; y <= 1; ++y)
+        {
+            vec2 uv = clamp(projCoords.xy + vec2(x, y) * atlasTexelSize, minUV, maxUV);
+            lit += texture(shadowAtlas, vec3(uv, projCoords.z));
+        }
+    }
+    return 1.0 - lit / 9.0;
+}
+
+void main()
+{
+    vec3 color = texture(diffuseTexture, fs_in.TexCoords).rgb;
+    vec3 normal = normalize(fs_in.Normal);
+    vec3 viewDir = normalize(viewPos - fs_in.FragPos);
+    vec3 lighting = 0.05 * color;
+    for (int i = 0; i < lightCount; ++i)
+    {
+        Light light = lights[i];
+        int type = int(light.PositionType.w);
+        vec3 lightDir;
+        float attenuation = 1.0;
+        if (type == LIGHT_DIRECTIONAL)
+        {
+            lightDir = -light.DirectionCutoff.xyz;
+        }
+        else
+        {
+            vec3 toLight = light.PositionType.xyz - fs_in.FragPos;
+            float distance = length(toLight);
+            if (distance > light.ColorRange.a)
+                continue;
+            lightDir = toLight / distance;
+            // smooth falloff to zero at the light's range
+            float falloff = clamp(1.0 - pow(distance / light.ColorRange.a, 4.0), 0.0, 1.0);
+            attenuation = falloff * falloff / (1.0 + distance * distance);
+            if (type == LIGHT_SPOT)
+            {
+                float cosAngle = dot(-lightDir, light.DirectionCutoff.xyz);
+                attenuation *= smoothstep(light.DirectionCutoff.w, mix(light.DirectionCutoff.w, 1.0, 0.2), cosAngle);
+            }
+        }
+        float diff = max(dot(lightDir, normal), 0.0);
+        if (diff * attenuation <= 0.0)
+            continue;
+        vec3 halfwayDir = normalize(lightDir + viewDir);
+        float spec = pow(max(dot(normal, halfwayDir), 0.0), 64.0);
+        float shadow = shadows && light.Shadow.y != 0 ? ShadowCalculation(light, fs_in.FragPos, normal) : 0.0;
+        lighting += (1.0 - shadow) * attenuation * light.ColorRange.rgb * (diff * color + spec * 0.3);
+    }
+    FragColor = vec4(pow(lighting, vec3(1.0 / 2.2)), 1.0);
+}
@@ -0,0 +1,820 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <stb_image.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/gpu_timer.h>
+#include <learnopengl/shadow_atlas.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+unsigned int loadTexture(const char *path);
+void renderScene(const Shader &shader);
+void renderCube();
+void renderQuad();
+
+// settings
+const unsigned int SCR_WIDTH = 1280;
+const unsigned int SCR_HEIGHT = 720;
+bool shadows = true;
+bool shadowsKeyPressed = false;
+bool caching = true;          // re-use the tiles of static lights, toggled with B
+bool cachingKeyPressed = false;
+bool showAtlas = false;       // overlay the atlas, toggled with V
+bool showAtlasKeyPressed = false;
+
+// camera
+Camera camera(glm::vec3(0.0f, 6.0f, 24.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// shadow atlas: one depth texture shared by all lights, tiles between MIN and MAX_TILE_SIZE
+// texels wide. Point lights use half the tile size per face, as they need six of them.
+const unsigned int ATLAS_SIZE = 4096;
+const unsigned int MIN_TILE_SIZE = 64;
+const unsigned int MAX_TILE_SIZE = 1024;
+// what a dedicated map per light costs in the other shadow demos: 1024x1024 per 2D map and per cube face
+const unsigned int DEDICATED_MAP_SIZE = 1024;
+
+// keep in sync with 3.3.shadow_atlas.fs
+const unsigned int MAX_LIGHTS = 32;
+const unsigned int MAX_VIEWS = 96;
+
+// lights and shadow views as laid out in the ShadowData uniform block (std140)
+struct GpuLight
+{
+    glm::vec4 PositionType;
+    glm::vec4 DirectionCutoff;
+    glm::vec4 ColorRange;
+    glm::ivec4 Shadow;
+};
+struct GpuShadowView
+{
+    glm::mat4 Matrix;
+    glm::vec4 Rect;
+};
+struct ShadowData
+{
+    GpuLight Lights[MAX_LIGHTS];
+    GpuShadowView Views[MAX_VIEWS];
+};
+
+struct SceneLight
+{
+    ShadowLightType Type;
+    glm::vec3 Position;
+    glm::vec3 Direction;      // direction the light shines in (spot and directional)
+    glm::vec3 Color;
+    float Range;              // spot and point
+    float OuterAngle;         // spot, degrees
+    bool Static;              // static lights in a static scene only need their tiles rendered once
+    // atlas state
+    float Importance = 0.0f;
+    unsigned int TileSize = 0;
+    unsigned int RequestedSize = 0; // size the importance asked for; larger than TileSize when the atlas was full
+    ShadowAtlasTile Tiles[6];
+    glm::mat4 ViewProjections[6];
+    bool Cached = false;      // tiles hold an up to date shadow map
+};
+std::vector<SceneLight> lights;
+
+void createLights();
+void updateLights(float time);
+void computeViewProjections(SceneLight& light);
+bool sphereInFrustum(const glm::mat4& viewProjection, const glm::vec3& center, float radius);
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    // build and compile shaders
+    // -------------------------
+    Shader shader("3.3.shadow_atlas.vs", "3.3.shadow_atlas.fs");
+    Shader simpleDepthShader("3.3.shadow_atlas_depth.vs", "3.3.shadow_atlas_depth.fs");
+    Shader debugDepthQuad("3.3.debug_quad.vs", "3.3.debug_quad_atlas.fs");
+
+    // load textures
+    // -------------
+    unsigned int woodTexture = loadTexture(FileSystem::getPath("resources/textures/wood.png").c_str());
+
+    // configure the atlas FBO
+    // -----------------------
+    unsigned int atlasFBO;
+    glGenFramebuffers(1, &atlasFBO);
+    unsigned int atlasTexture;
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_2D, atlasTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT24, ATLAS_SIZE, ATLAS_SIZE, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    // hardware depth comparison: every tap is bilinearly filtered PCF
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_FUNC, GL_LEQUAL);
+    glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, atlasTexture, 0);
+    glDrawBuffer(GL_NONE);
+    glReadBuffer(GL_NONE);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    // the debug view reads raw depth through a sampler object without the comparison
+    unsigned int rawDepthSampler;
+    glGenSamplers(1, &rawDepthSampler);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glSamplerParameteri(rawDepthSampler, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+
+    // light and shadow view data for the lighting pass
+    unsigned int shadowDataUBO;
+    glGenBuffers(1, &shadowDataUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, shadowDataUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(ShadowData), NULL, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, 0, shadowDataUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glUniformBlockBinding(shader.ID, glGetUniformBlockIndex(shader.ID, "ShadowData"), 0);
+    ShadowData shadowData = {};
+
+    // shader configuration
+    // --------------------
+    shader.use();
+    shader.setInt("diffuseTexture", 0);
+    shader.setInt("shadowAtlas", 1);
+    shader.setFloat("atlasTexelSize", 1.0f / ATLAS_SIZE);
+    debugDepthQuad.use();
+    debugDepthQuad.setInt("depthMap", 0);
+
+    // lighting info
+    // -------------
+    createLights();
+    ShadowAtlasAllocator atlas(ATLAS_SIZE, MIN_TILE_SIZE);
+
+    // memory: the atlas against a dedicated map (or cubemap) per light
+    unsigned long long dedicatedBytes = 0;
+    for (const SceneLight& light : lights)
+        dedicatedBytes += 4ull * DEDICATED_MAP_SIZE * DEDICATED_MAP_SIZE * ShadowLightFaceCount(light.Type);
+    std::cout << "shadow atlas: " << lights.size() << " lights | atlas " << ATLAS_SIZE << "x" << ATLAS_SIZE << " = "
+              << (4ull * ATLAS_SIZE * ATLAS_SIZE) / (1024 * 1024) << " MB | dedicated " << DEDICATED_MAP_SIZE << "^2 maps would need "
+              << dedicatedBytes / (1024 * 1024) << " MB | allocator self-test: " << (ShadowAtlasValidate() ? "passed" : "FAILED") << std::endl;
+
+    // statistics, printed every 100 frames
+    GpuTimer shadowTimer;
+    unsigned int reportFrames = 0;
+    unsigned int renderedViews = 0, cachedViews = 0, reallocations = 0, downgrades = 0, unshadowed = 0;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+
+        updateLights(currentFrame);
+
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+
+        // 0. pick a tile size per light from its screen-space importance and (re)allocate tiles
+        // -------------------------------------------------------------------------------------
+        for (SceneLight& light : lights)
+        {
+            if (light.Type == SHADOW_LIGHT_DIRECTIONAL)
+                light.Importance = 1.0f;
+            else if (!sphereInFrustum(projection * view, light.Position, light.Range))
+                light.Importance = 0.0f;
+            else
+                light.Importance = ShadowLightImportance(light.Position, light.Range, view, glm::radians(camera.Zoom));
+
+            const unsigned int faceCount = ShadowLightFaceCount(light.Type);
+            unsigned int maxSize = light.Type == SHADOW_LIGHT_POINT ? MAX_TILE_SIZE / 2 : MAX_TILE_SIZE;
+            unsigned int desiredSize = 0;
+            if (shadows && light.Importance > 0.0f)
+            {
+                desiredSize = ShadowTileSizeForImportance(light.Importance, MIN_TILE_SIZE, maxSize);
+                // only shrink once the light is clearly smaller on screen, so a light near a size
+                // boundary doesn't bounce between two sizes and get re-rendered every time
+                if (desiredSize < light.RequestedSize && ShadowTileSizeForImportance(light.Importance * 1.5f, MIN_TILE_SIZE, maxSize) >= light.RequestedSize)
+                    desiredSize = light.RequestedSize;
+            }
+            // a light that got smaller tiles (or none) than it asked for keeps them until the atlas
+            // has room for larger ones; freeing them to try again would only get it downgraded
+            // and re-rendered again, every frame
+            unsigned int size = desiredSize;
+            if (desiredSize > light.TileSize && light.TileSize < light.RequestedSize)
+            {
+                size = light.TileSize;
+                for (unsigned int larger = desiredSize; larger > light.TileSize && larger >= MIN_TILE_SIZE; larger /= 2)
+                {
+                    if (atlas.FreeTileCount(larger) >= faceCount)
+                    {
+                        size = larger;
+                        break;
+                    }
+                }
+            }
+            light.RequestedSize = desiredSize;
+            if (size != light.TileSize)
+            {
+                for (unsigned int face = 0; face < faceCount; face++)
+                    atlas.Free(light.Tiles[face]);
+                light.TileSize = size;
+                light.Cached = false;
+            }
+        }
+        // allocate the most important lights first; when the atlas is full a light gets smaller
+        // tiles and in the end no shadow at all
+        std::vector<SceneLight*> allocationOrder;
+        for (SceneLight& light : lights)
+            if (light.TileSize > 0 && !light.Tiles[0].IsValid())
+                allocationOrder.push_back(&light);
+        std::sort(allocationOrder.begin(), allocationOrder.end(), [](const SceneLight* a, const SceneLight* b) { return a->Importance > b->Importance; });
+        for (SceneLight* light : allocationOrder)
+        {
+            const unsigned int faceCount = ShadowLightFaceCount(light->Type);
+            reallocations++;
+            while (light->TileSize >= MIN_TILE_SIZE)
+            {
+                unsigned int face = 0;
+                for (; face < faceCount; face++)
+                {
+                    light->Tiles[face] = atlas.Allocate(light->TileSize);
+                    if (!light->Tiles[face].IsValid())
+                        break;
+                }
+                if (face == faceCount)
+                    break;
+                for (unsigned int i = 0; i < face; i++)
+                    atlas.Free(light->Tiles[i]);
+                light->TileSize /= 2;
+                downgrades++;
+            }
+            if (light->TileSize < MIN_TILE_SIZE)
+            {
+                light->TileSize = 0;
+                unshadowed++;
+            }
+        }
+
+        // 1. render the tiles that aren't cached into the atlas
+        // ---------------------------------------------------
+        shadowTimer.Begin();
+        glBindFramebuffer(GL_FRAMEBUFFER, atlasFBO);
+        glEnable(GL_SCISSOR_TEST);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(2.0f, 4.0f);
+        simpleDepthShader.use();
+        unsigned int viewCount = 0;
+        for (SceneLight& light : lights)
+        {
+            const unsigned int faceCount = ShadowLightFaceCount(light.Type);
+            const bool hasTiles = light.TileSize > 0 && viewCount + faceCount <= MAX_VIEWS;
+            computeViewProjections(light);
+            for (unsigned int face = 0; hasTiles && face < faceCount; face++)
+            {
+                const ShadowAtlasTile& tile = light.Tiles[face];
+                GpuShadowView& gpuView = shadowData.Views[viewCount + face];
+                gpuView.Matrix = ShadowAtlasTileMatrix(tile, ATLAS_SIZE) * light.ViewProjections[face];
+                gpuView.Rect = glm::vec4(tile.X, tile.Y, tile.X + tile.Size, tile.Y + tile.Size) / (float)ATLAS_SIZE;
+                if (caching && light.Static && light.Cached)
+                {
+                    cachedViews++;
+                    continue;
+                }
+                // the scissor limits the clear to the tile
+                glViewport(tile.X, tile.Y, tile.Size, tile.Size);
+                glScissor(tile.X, tile.Y, tile.Size, tile.Size);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                simpleDepthShader.setMat4("lightSpaceMatrix", light.ViewProjections[face]);
+                renderScene(simpleDepthShader);
+                renderedViews++;
+            }
+            light.Cached = hasTiles;
+
+            GpuLight& gpuLight = shadowData.Lights[&light - &lights[0]];
+            gpuLight.PositionType = glm::vec4(light.Position, (float)light.Type);
+            gpuLight.DirectionCutoff = glm::vec4(light.Direction, std::cos(glm::radians(light.OuterAngle)));
+            gpuLight.ColorRange = glm::vec4(light.Color, light.Range);
+            gpuLight.Shadow = glm::ivec4(viewCount, hasTiles ? 1 : 0, 0, 0);
+            if (hasTiles)
+                viewCount += faceCount;
+        }
+        glDisable(GL_POLYGON_OFFSET_FILL);
+        glDisable(GL_SCISSOR_TEST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        shadowTimer.End();
+        glBindBuffer(GL_UNIFORM_BUFFER, shadowDataUBO);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(ShadowData), &shadowData);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        // 2. render scene as normal
+        // -------------------------
+        glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        shader.setVec3("viewPos", camera.Position);
+        shader.setInt("lightCount", (int)lights.size());
+        shader.setInt("shadows", shadows); // enable/disable shadows by pressing 'SPACE'
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, woodTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, atlasTexture);
+        renderScene(shader);
+
+        // 3. atlas overlay in the lower right corner
+        // ------------------------------------------
+        if (showAtlas)
+        {
+            glViewport(SCR_WIDTH - SCR_HEIGHT / 2, 0, SCR_HEIGHT / 2, SCR_HEIGHT / 2);
+            glDisable(GL_DEPTH_TEST);
+            debugDepthQuad.use();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, atlasTexture);
+            glBindSampler(0, rawDepthSampler);
+            renderQuad();
+            glBindSampler(0, 0);
+            glEnable(GL_DEPTH_TEST);
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+        }
+
+        // atlas report
+        if (++reportFrames >= 100)
+        {
+            unsigned int shadowed = 0;
+            unsigned int tilesPerSize[5] = {}; // 1024 .. 64
+            for (const SceneLight& light : lights)
+            {
+                if (light.TileSize == 0)
+                    continue;
+                shadowed++;
+                for (unsigned int i = 0; i < 5; i++)
+                    if (light.TileSize == MAX_TILE_SIZE >> i)
+                        tilesPerSize[i] += ShadowLightFaceCount(light.Type);
+            }
+            std::cout << std::fixed << std::setprecision(2)
+                      << "shadowed lights: " << shadowed << "/" << lights.size() << " | views: " << viewCount
+                      << " | occupancy: " << atlas.Occupancy() * 100.0f << "% | tiles 1024/512/256/128/64: "
+                      << tilesPerSize[0] << "/" << tilesPerSize[1] << "/" << tilesPerSize[2] << "/" << tilesPerSize[3] << "/" << tilesPerSize[4]
+                      << " | per frame: " << (float)renderedViews / reportFrames << " rendered, " << (float)cachedViews / reportFrames << " cached"
+                      << " | (re)allocations: " << reallocations << ", downgrades: " << downgrades << ", no room: " << unshadowed
+                      << " | caching " << (caching ? "on" : "off") << " | shadow pass: " << std::setprecision(3) << shadowTimer.AverageMs() << " ms" << std::endl;
+            shadowTimer.Reset();
+            reportFrames = renderedViews = cachedViews = reallocations = downgrades = unshadowed = 0;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteSamplers(1, &rawDepthSampler);
+    glDeleteBuffers(1, &shadowDataUBO);
+    glDeleteTextures(1, &atlasTexture);
+    glDeleteFramebuffers(1, &atlasFBO);
+
+    glfwTerminate();
+    return 0;
+}
+
+// a static sun, a ring of static spot lights, static and moving point lights and a few sweeping
+// spot lights: 23 shadowed lights, 53 shadow views
+// ------------------------------------------------------------------------------------------------
+void createLights()
+{
+    SceneLight sun = {};
+    sun.Type = SHADOW_LIGHT_DIRECTIONAL;
+    sun.Direction = glm::normalize(glm::vec3(-0.3f, -1.0f, -0.4f));
+    sun.Color = glm::vec3(0.15f, 0.15f, 0.2f);
+    sun.Static = true;
+    lights.push_back(sun);
+
+    const glm::vec3 colors[] = {
+        glm::vec3(1.0f, 0.4f, 0.3f), glm::vec3(0.3f, 1.0f, 0.4f), glm::vec3(0.3f, 0.5f, 1.0f),
+        glm::vec3(1.0f, 0.9f, 0.4f), glm::vec3(0.9f, 0.4f, 1.0f), glm::vec3(0.4f, 1.0f, 1.0f)
+    };
+    for (unsigned int i = 0; i < 12; i++)
+    {
+        float angle = glm::radians(30.0f * i);
+        SceneLight spot = {};
+        spot.Type = SHADOW_LIGHT_SPOT;
+        spot.Position = glm::vec3(std::cos(angle) * 18.0f, 8.0f, std::sin(angle) * 18.0f);
+        spot.Direction = glm::normalize(glm::vec3(std::cos(angle) * 10.0f, 0.0f, std::sin(angle) * 10.0f) - spot.Position);
+        spot.Color = colors[i % 6] * 40.0f;
+        spot.Range = 20.0f;
+        spot.OuterAngle = 35.0f;
+        spot.Static = true;
+        lights.push_back(spot);
+    }
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        SceneLight point = {};
+        point.Type = SHADOW_LIGHT_POINT;
+        point.Position = glm::vec3(-9.75f + 6.5f * (i % 3), 3.0f, i < 3 ? -3.25f : 3.25f); // between the boxes
+        point.Color = colors[(i + 3) % 6] * 15.0f;
+        point.Range = 10.0f;
+        point.Static = i < 3; // the last three move
+        lights.push_back(point);
+    }
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        SceneLight spot = {};
+        spot.Type = SHADOW_LIGHT_SPOT;
+        spot.Position = glm::vec3(-12.0f + 8.0f * i, 10.0f, 0.0f);
+        spot.Color = glm::vec3(40.0f);
+        spot.Range = 18.0f;
+        spot.OuterAngle = 25.0f;
+        spot.Static = false;
+        lights.push_back(spot);
+    }
+}
+
+// moves the dynamic lights; their tiles are re-rendered every frame
+// -----------------------------------------------------------------
+void updateLights(float time)
+{
+    unsigned int index = 0;
+    for (SceneLight& light : lights)
+    {
+        index++;
+        if (light.Static)
+            continue;
+        if (light.Type == SHADOW_LIGHT_POINT)
+        {
+            light.Position.x += std::sin(time + index) * 3.0f * deltaTime;
+            light.Position.y = 3.0f + std::sin(time * 0.7f + index) * 1.5f;
+        }
+        else
+        {
+            light.Direction = glm::normalize(glm::vec3(std::sin(time * 0.5f + index) * 0.6f, -1.0f, std::cos(time * 0.3f + index) * 0.6f));
+        }
+    }
+}
+
+// light space matrices of all faces of a light
+// --------------------------------------------
+void computeViewProjections(SceneLight& light)
+{
+    if (light.Type == SHADOW_LIGHT_DIRECTIONAL)
+    {
+        // the scene is static and small enough for one ortho box around all of it
+        glm::mat4 lightProjection = glm::ortho(-35.0f, 35.0f, -35.0f, 35.0f, 1.0f, 80.0f);
+        glm::mat4 lightView = glm::lookAt(-light.Direction * 40.0f, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        light.ViewProjections[0] = lightProjection * lightView;
+    }
+    else if (light.Type == SHADOW_LIGHT_SPOT)
+    {
+        glm::mat4 lightProjection = glm::perspective(glm::radians(2.0f * light.OuterAngle), 1.0f, 0.1f, light.Range);
+        glm::vec3 up = std::abs(light.Direction.y) > 0.99f ? glm::vec3(1.0f, 0.0f, 0.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+        light.ViewProjections[0] = lightProjection * glm::lookAt(light.Position, light.Position + light.Direction, up);
+    }
+    else
+    {
+        // the same face order and orientation as a cubemap
+        glm::mat4 shadowProj = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, light.Range);
+        const glm::vec3& lightPos = light.Position;
+        light.ViewProjections[0] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        light.ViewProjections[1] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        light.ViewProjections[2] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+        light.ViewProjections[3] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f));
+        light.ViewProjections[4] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+        light.ViewProjections[5] = shadowProj * glm::lookAt(lightPos, lightPos + glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, -1.0f, 0.0f));
+    }
+}
+
+// tests a sphere against the six planes of a view frustum (extracted from the view projection matrix)
+// ---------------------------------------------------------------------------------------------------
+bool sphereInFrustum(const glm::mat4& viewProjection, const glm::vec3& center, float radius)
+{
+    const glm::mat4 m = glm::transpose(viewProjection);
+    const glm::vec4 planes[6] = { m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2] };
+    for (const glm::vec4& plane : planes)
+    {
+        if (glm::dot(glm::vec3(plane), center) + plane.w < -radius * glm::length(glm::vec3(plane)))
+            return false;
+    }
+    return true;
+}
+
+// renders the 3D scene: a floor and a grid of boxes of different heights
+// ----------------------------------------------------------------------
+void renderScene(const Shader &shader)
+{
+    // floor
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::translate(model, glm::vec3(0.0f, -1.0f, 0.0f));
+    model = glm::scale(model, glm::vec3(30.0f, 0.5f, 30.0f));
+    shader.setMat4("model", model);
+    renderCube();
+    // boxes
+    for (int x = -2; x <= 2; ++x)
+    {
+        for (int z = -2; z <= 2; ++z)
+        {
+            float height = 0.75f + 0.5f * ((x + 2 + (z + 2) * 3) % 4);
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(x * 6.5f, height - 0.5f, z * 6.5f));
+            model = glm::rotate(model, glm::radians(20.0f * (x - z)), glm::vec3(0.0f, 1.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(0.75f, height, 0.75f));
+            shader.setMat4("model", model);
+            renderCube();
+        }
+    }
+}
+
+// renderCube() renders a 1x1 3D cube in NDC.
+// -------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube()
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glBindVertexArray(0);
+}
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS && !shadowsKeyPressed)
+    {
+        shadows = !shadows;
+        shadowsKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_RELEASE)
+    {
+        shadowsKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !cachingKeyPressed)
+    {
+        caching = !caching;
+        cachingKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        cachingKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !showAtlasKeyPressed)
+    {
+        showAtlas = !showAtlas;
+        showAtlasKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE)
+    {
+        showAtlasKeyPressed = false;
+    }
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
+
+// utility function for loading a 2D texture from file
+// ---------------------------------------------------
+unsigned int loadTexture(char const * path)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    int width, height, nrComponents;
+    unsigned char *data = stbi_load(path, &width, &height, &nrComponents, 0);
+    if (data)
+    {
+        GLenum format;
+        if (nrComponents == 1)
+            format = GL_RED;
+        else if (nrComponents == 3)
+            format = GL_RGB;
+        else if (nrComponents == 4)
+            format = GL_RGBA;
+
+        glBindTexture(GL_TEXTURE_2D, textureID);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT); // for this tutorial: use GL_CLAMP_TO_EDGE to prevent semi-transparent borders. Due to interpolation it takes texels from next repeat 
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, format == GL_RGBA ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        stbi_image_free(data);
+    }
+    else
+    {
+        std::cout << "Texture failed to load at path: " << path << std::endl;
+        stbi_image_free(data);
+    }
+
+    return textureID;
+}
@@ -1,4 +1,4 @@
-#version 330 core
+#version 430 core
 out vec4 FragColor;
 
 in vec2 TexCoords;
@@ -6,6 +6,16 @@ in vec2 TexCoords;
 uniform sampler2D hdrBuffer;
 uniform bool hdr;
 uniform float exposure;
+uniform bool autoExposure;
+
+// written by 6.histogram_average.cs; read here directly so the exposure never leaves the GPU
+layout (std430, binding = 1) readonly buffer Exposure
+{
+    float adaptedLuminance;
+    float autoExposureValue;
+    float targetLuminance;
+    float padding;
+};
 
 void main()
 {             
@@ -16,7 +26,7 @@ void main()
         // reinhard
         // vec3 result = hdrColor / (hdrColor + vec3(1.0));
         // exposure
-        vec3 result = vec3(1.0) - exp(-hdrColor * exposure);
+        vec3 result = vec3(1.0) - exp(-hdrColor * (autoExposure ? autoExposureValue : exposure));
         // also gamma correct while we're at it       
         result = pow(result, vec3(1.0 / gamma));
         FragColor = vec4(result, 1.0);
@@ -26,4 +36,4 @@ void main()
         vec3 result = pow(hdrColor, vec3(1.0 / gamma));
         FragColor = vec4(result, 1.0);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,42 @@
+#version 430 core
+layout (local_size_x = 16, local_size_y = 16) in;
+
+// pass 1 of the auto exposure: sort the luminance of every pixel into 256 log2 bins. Every work
+// group counts its 16x16 pixels in shared memory first, so the global histogram only sees 256
+// atomics per group instead of one per pixel. See BuildLuminanceHistogram() in auto_exposure.h.
+layout (binding = 0) uniform sampler2D hdrBuffer;
+
+layout (std430, binding = 0) buffer Histogram
+{
+    uint bins[256];
+};
+
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+
+shared uint localBins[256];
+
+uint luminanceBin(vec3 color)
+{
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (luminance < exp2(minLogLuminance))
+        return 0u;
+    float t = clamp((log2(luminance) - minLogLuminance) / logLuminanceRange, 0.0, 1.0);
+    return uint(t * 254.0 + 1.0);
+}
+
+void main()
+{
+    localBins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 size = textureSize(hdrBuffer, 0);
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (pixel.x < size.x && pixel.y < size.y)
+        atomicAdd(localBins[luminanceBin(texelFetch(hdrBuffer, pixel, 0).rgb)], 1u);
+    barrier();
+
+    uint count = localBins[gl_LocalInvocationIndex];
+    if (count > 0u)
+        atomicAdd(bins[gl_LocalInvocationIndex], count);
+}
@@ -0,0 +1,93 @@
+#version 430 core
+layout (local_size_x = 256) in;
+
+// pass 2 of the auto exposure, a single work group with one thread per bin: a prefix sum over
+// the histogram finds the pixels between the clipping percentiles, a reduction averages their
+// bins, and the first thread adapts the exposure towards the result. The histogram is cleared
+// for the next frame on the way. See HistogramAverageLuminance() and AdaptLuminance() in
+// auto_exposure.h.
+layout (std430, binding = 0) buffer Histogram
+{
+    uint bins[256];
+};
+
+layout (std430, binding = 1) buffer Exposure
+{
+    float adaptedLuminance;
+    float exposure;
+    float targetLuminance;
+    float padding;
+};
+
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+uniform float lowPercentile;
+uniform float highPercentile;
+uniform float keyValue;
+uniform float speedUp;
+uniform float speedDown;
+uniform float deltaTime;
+uniform bool resetAdaptation;   // jump straight to the target, e.g. on the first frame
+
+shared uint prefix[256];
+shared float weighted[256];
+shared float counted[256];
+
+void main()
+{
+    uint bin = gl_LocalInvocationIndex;
+    uint count = bin == 0u ? 0u : bins[bin]; // bin 0 holds the black pixels, they don't count
+    bins[bin] = 0u;
+
+    // inclusive prefix sum (Hillis-Steele)
+    prefix[bin] = count;
+    barrier();
+    for (uint offset = 1u; offset < 256u; offset *= 2u)
+    {
+        uint value = bin >= offset ? prefix[bin - offset] : 0u;
+        barrier();
+        prefix[bin] += value;
+        barrier();
+    }
+
+    // the part of this bin between the percentiles
+    float lit = float(prefix[255]);
+    float low = lit * lowPercentile;
+    float high = lit * (1.0 - highPercentile);
+    float after = float(prefix[bin]);
+    float before = after - float(count);
+    float clipped = clamp(after, low, high) - clamp(before, low, high);
+    weighted[bin] = bin == 0u ? 0.0 : clipped * float(bin - 1u);
+    counted[bin] = clipped;
+    barrier();
+
+    // sum up the weights
+    for (uint stride = 128u; stride > 0u; stride /= 2u)
+    {
+        if (bin < stride)
+        {
+            weighted[bin] += weighted[bin + stride];
+            counted[bin] += counted[bin + stride];
+        }
+        barrier();
+    }
+
+    if (bin == 0u)
+    {
+        float target = exp2(minLogLuminance);
+        if (lit > 0.0)
+        {
+            float averageBin = counted[0] > 0.0 ? weighted[0] / counted[0] : 0.0;
+            target = exp2((averageBin + 0.5) / 254.0 * logLuminanceRange + minLogLuminance);
+        }
+        float adapted = target;
+        if (!resetAdaptation)
+        {
+            float speed = target > adaptedLuminance ? speedUp : speedDown;
+            adapted = adaptedLuminance + (target - adaptedLuminance) * (1.0 - exp(-deltaTime * speed));
+        }
+        targetLuminance = target;
+        adaptedLuminance = adapted;
+        exposure = keyValue / max(adapted, 1e-4);
+    }
+}
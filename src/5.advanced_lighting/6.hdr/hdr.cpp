@@ -8,10 +8,15 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
+#include <learnopengl/auto_exposure.h>
 
 #include <iostream>
+#include <iomanip>
+#include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -27,6 +32,10 @@ const unsigned int SCR_HEIGHT = 600;
 bool hdr = true;
 bool hdrKeyPressed = false;
 float exposure = 1.0f;
+bool autoExposure = true;       // X: exposure from the luminance histogram instead of Q/E
+bool autoExposureKeyPressed = false;
+bool validateRequested = false; // V: compare the GPU histogram and average with the CPU reference
+bool validateKeyPressed = false;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
@@ -43,7 +52,7 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -80,10 +89,21 @@ int main()
     // -----------------------------
     glEnable(GL_DEPTH_TEST);
 
+    // check the auto exposure reference on synthetic images; V compares the GPU passes with it
+    // ----------------------------------------------------------------------------------------
+    unsigned int misbinnedPixels;
+    float maxAverageError, maxAdaptError;
+    AutoExposureValidate(misbinnedPixels, maxAverageError, maxAdaptError);
+    std::cout << "auto exposure reference: misbinned pixels " << misbinnedPixels
+              << ", clipped average max error " << maxAverageError << " stops"
+              << ", adaptation max error " << maxAdaptError << std::endl;
+
     // build and compile shaders
     // -------------------------
     Shader shader("6.lighting.vs", "6.lighting.fs");
     Shader hdrShader("6.hdr.vs", "6.hdr.fs");
+    ComputeShader histogramShader("6.histogram.cs");
+    ComputeShader histogramAverageShader("6.histogram_average.cs");
 
     // load textures
     // -------------
@@ -135,6 +155,38 @@ int main()
     hdrShader.use();
     hdrShader.setInt("hdrBuffer", 0);
 
+    // auto exposure: the histogram and the exposure state live in GPU buffers; the CPU never
+    // reads them except to validate against the reference in auto_exposure.h
+    // ------------------------------------------------------------------------------------------
+    AutoExposureSettings exposureSettings;
+    unsigned int histogramBuffer, exposureBuffer;
+    const GLuint emptyHistogram[256] = { 0 };
+    const float initialExposure[4] = { 1.0f, 1.0f, 1.0f, 0.0f };
+    glGenBuffers(1, &histogramBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(emptyHistogram), emptyHistogram, GL_DYNAMIC_COPY);
+    glGenBuffers(1, &exposureBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposureBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(initialExposure), initialExposure, GL_DYNAMIC_COPY);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, histogramBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, exposureBuffer);
+
+    histogramShader.use();
+    histogramShader.setFloat("minLogLuminance", exposureSettings.MinLogLuminance);
+    histogramShader.setFloat("logLuminanceRange", exposureSettings.LogLuminanceRange);
+    histogramAverageShader.use();
+    histogramAverageShader.setFloat("minLogLuminance", exposureSettings.MinLogLuminance);
+    histogramAverageShader.setFloat("logLuminanceRange", exposureSettings.LogLuminanceRange);
+    histogramAverageShader.setFloat("lowPercentile", exposureSettings.LowPercentile);
+    histogramAverageShader.setFloat("highPercentile", exposureSettings.HighPercentile);
+    histogramAverageShader.setFloat("keyValue", exposureSettings.KeyValue);
+    histogramAverageShader.setFloat("speedUp", exposureSettings.SpeedUp);
+    histogramAverageShader.setFloat("speedDown", exposureSettings.SpeedDown);
+
+    GpuTimer exposureTimer;
+    unsigned int frameCount = 0;
+    bool resetAdaptation = true;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -181,7 +233,60 @@ int main()
             renderCube();
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 2. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
+        // 2. measure the scene luminance and adapt the exposure to it, all on the GPU
+        // --------------------------------------------------------------------------
+        if (autoExposure)
+        {
+            exposureTimer.Begin();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, colorBuffer);
+            histogramShader.use();
+            glDispatchCompute((SCR_WIDTH + 15) / 16, (SCR_HEIGHT + 15) / 16, 1);
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+            // the averaging pass clears the histogram, so a validation reads it back in between
+            bool validate = validateRequested;
+            validateRequested = false;
+            LuminanceHistogram gpuHistogram;
+            if (validate)
+            {
+                glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, histogramBuffer);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(gpuHistogram), gpuHistogram.data());
+            }
+
+            histogramAverageShader.use();
+            histogramAverageShader.setFloat("deltaTime", deltaTime);
+            histogramAverageShader.setBool("resetAdaptation", resetAdaptation);
+            glDispatchCompute(1, 1, 1);
+
+            if (validate)
+            {
+                glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+                float state[4];
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposureBuffer);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(state), state);
+                std::vector<float> pixels((size_t)SCR_WIDTH * SCR_HEIGHT * 4);
+                glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_FLOAT, pixels.data());
+                LuminanceHistogram cpuHistogram = BuildLuminanceHistogram(pixels.data(), (size_t)SCR_WIDTH * SCR_HEIGHT, 4, exposureSettings);
+                unsigned int differentPixels = 0;
+                for (unsigned int bin = 0; bin < 256; bin++)
+                    differentPixels += (unsigned int)std::abs((long long)gpuHistogram[bin] - (long long)cpuHistogram[bin]);
+                std::cout << "histogram validation: " << differentPixels / 2 << " of " << SCR_WIDTH * SCR_HEIGHT << " pixels in a different bin"
+                          << " | average luminance CPU: " << HistogramAverageLuminance(cpuHistogram, exposureSettings)
+                          << ", CPU from the GPU histogram: " << HistogramAverageLuminance(gpuHistogram, exposureSettings)
+                          << ", GPU: " << state[2] << std::endl;
+            }
+            glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+            resetAdaptation = false;
+            exposureTimer.End();
+        }
+        else
+        {
+            resetAdaptation = true;
+        }
+
+        // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         hdrShader.use();
@@ -189,9 +294,28 @@ int main()
         glBindTexture(GL_TEXTURE_2D, colorBuffer);
         hdrShader.setInt("hdr", hdr);
         hdrShader.setFloat("exposure", exposure);
+        hdrShader.setBool("autoExposure", autoExposure);
         renderQuad();
 
-        std::cout << "hdr: " << (hdr ? "on" : "off") << "| exposure: " << exposure << std::endl;
+        if (++frameCount % 100 == 0)
+        {
+            std::cout << "hdr: " << (hdr ? "on" : "off") << " | exposure: ";
+            if (autoExposure)
+            {
+                // only read for this report
+                float state[4];
+                glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, exposureBuffer);
+                glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(state), state);
+                std::cout << "auto " << state[1] << " (adapted luminance " << state[0] << ", target " << state[2] << ") | histogram + average: "
+                          << std::fixed << std::setprecision(3) << exposureTimer.AverageMs() << " ms" << std::defaultfloat << std::endl;
+                exposureTimer.Reset();
+            }
+            else
+            {
+                std::cout << exposure << std::endl;
+            }
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -335,6 +459,25 @@ void processInput(GLFWwindow *window)
         hdrKeyPressed = false;
     }
 
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_PRESS && !autoExposureKeyPressed)
+    {
+        autoExposure = !autoExposure;
+        autoExposureKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_X) == GLFW_RELEASE)
+    {
+        autoExposureKeyPressed = false;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !validateKeyPressed)
+    {
+        validateRequested = true;
+        validateKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE)
+    {
+        validateKeyPressed = false;
+    }
+
     if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
     {
         if (exposure > 0.0f)
@@ -0,0 +1,12 @@
+#version 330 core
+out vec4 FragColor;
+
+uniform sampler2D gAlbedoSpec;
+uniform vec2 screenSize;
+
+void main()
+{
+    // hard-coded ambient component, written once before the light volumes are added on top
+    vec3 Diffuse = texture(gAlbedoSpec, gl_FragCoord.xy / screenSize).rgb;
+    FragColor = vec4(Diffuse * 0.1, 1.0);
+}
@@ -1,9 +1,9 @@
 #version 330 core
 layout (location = 0) out vec4 FragColor;
 
-uniform vec3 lightColor;
+flat in vec3 LightColor;
 
 void main()
 {           
-    FragColor = vec4(lightColor, 1.0);
-}
\ No newline at end of file
+    FragColor = vec4(LightColor, 1.0);
+}
@@ -1,13 +1,16 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in vec4 aLightPositionRadius;
+layout (location = 4) in vec4 aLightColorQuadratic;
+
+flat out vec3 LightColor;
 
 uniform mat4 projection;
 uniform mat4 view;
-uniform mat4 model;
+uniform float boxScale;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    LightColor = aLightColorQuadratic.rgb;
+    gl_Position = projection * view * vec4(aPos * boxScale + aLightPositionRadius.xyz, 1.0);
+}
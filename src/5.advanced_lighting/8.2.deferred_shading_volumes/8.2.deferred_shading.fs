@@ -1,54 +1,46 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 TexCoords;
+flat in vec4 LightPositionRadius;
+flat in vec4 LightColorQuadratic;
 
 uniform sampler2D gPosition;
 uniform sampler2D gNormal;
 uniform sampler2D gAlbedoSpec;
 
-struct Light {
-    vec3 Position;
-    vec3 Color;
-    
-    float Linear;
-    float Quadratic;
-    float Radius;
-};
-const int NR_LIGHTS = 32;
-uniform Light lights[NR_LIGHTS];
 uniform vec3 viewPos;
+uniform vec2 screenSize;
+uniform float lightLinear;
 
 void main()
-{             
+{
+    // light volumes don't cover the screen, so derive the gbuffer coordinates from the fragment itself
+    vec2 TexCoords = gl_FragCoord.xy / screenSize;
+
     // retrieve data from gbuffer
     vec3 FragPos = texture(gPosition, TexCoords).rgb;
     vec3 Normal = texture(gNormal, TexCoords).rgb;
     vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
     float Specular = texture(gAlbedoSpec, TexCoords).a;
-    
-    // then calculate lighting as usual
-    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+
+    // calculate distance between light source and current fragment
+    vec3 lightPos = LightPositionRadius.xyz;
+    float distance = length(lightPos - FragPos);
+    if(distance >= LightPositionRadius.w)
+        discard;
+
+    // then calculate lighting of this single light as usual; lights are summed by additive blending
     vec3 viewDir  = normalize(viewPos - FragPos);
-    for(int i = 0; i < NR_LIGHTS; ++i)
-    {
-        // calculate distance between light source and current fragment
-        float distance = length(lights[i].Position - FragPos);
-        if(distance < lights[i].Radius)
-        {
-            // diffuse
-            vec3 lightDir = normalize(lights[i].Position - FragPos);
-            vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * lights[i].Color;
-            // specular
-            vec3 halfwayDir = normalize(lightDir + viewDir);  
-            float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
-            vec3 specular = lights[i].Color * spec * Specular;
-            // attenuation
-            float attenuation = 1.0 / (1.0 + lights[i].Linear * distance + lights[i].Quadratic * distance * distance);
-            diffuse *= attenuation;
-            specular *= attenuation;
-            lighting += diffuse + specular;
-        }
-    }    
-    FragColor = vec4(lighting, 1.0);
+    // diffuse
+    vec3 lightDir = normalize(lightPos - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * LightColorQuadratic.rgb;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);  
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+    vec3 specular = LightColorQuadratic.rgb * spec * Specular;
+    // attenuation
+    float attenuation = 1.0 / (1.0 + lightLinear * distance + LightColorQuadratic.a * distance * distance);
+    diffuse *= attenuation;
+    specular *= attenuation;
+    FragColor = vec4(diffuse + specular, 1.0);
 }
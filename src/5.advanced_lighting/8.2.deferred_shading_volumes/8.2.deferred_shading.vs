@@ -1,11 +1,16 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoords;
+layout (location = 3) in vec4 aLightPositionRadius;
+layout (location = 4) in vec4 aLightColorQuadratic;
 
-out vec2 TexCoords;
+flat out vec4 LightPositionRadius;
+flat out vec4 LightColorQuadratic;
 
 void main()
 {
-    TexCoords = aTexCoords;
+    // full screen quad per light: the reference cost light volumes are compared against
+    LightPositionRadius = aLightPositionRadius;
+    LightColorQuadratic = aLightColorQuadratic;
     gl_Position = vec4(aPos, 1.0);
-}
\ No newline at end of file
+}
@@ -0,0 +1,18 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in vec4 aLightPositionRadius;
+layout (location = 4) in vec4 aLightColorQuadratic;
+
+flat out vec4 LightPositionRadius;
+flat out vec4 LightColorQuadratic;
+
+uniform mat4 projection;
+uniform mat4 view;
+
+void main()
+{
+    // unit sphere scaled by the light's radius and moved to the light's position
+    LightPositionRadius = aLightPositionRadius;
+    LightColorQuadratic = aLightColorQuadratic;
+    gl_Position = projection * view * vec4(aPos * aLightPositionRadius.w + aLightPositionRadius.xyz, 1.0);
+}
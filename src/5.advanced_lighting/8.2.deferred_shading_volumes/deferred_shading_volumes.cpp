@@ -9,21 +9,50 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
-unsigned int loadTexture(const char *path, bool gammaCorrection);
-void renderQuad();
-void renderCube();
+void renderQuad(unsigned int firstLight = 0, GLsizei lightCount = 1);
+void renderCube(unsigned int firstLight, GLsizei lightCount);
+void renderSphere(unsigned int firstLight, GLsizei lightCount);
+void bindLightInstances(unsigned int firstLight);
+unsigned int generateLights(unsigned int count);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 
+// the ways of applying the lights to the gbuffer: a full screen quad per light (every pixel pays for
+// every light), instanced light spheres whose back faces reject pixels behind the volume, and
+// per-light stencil-masked spheres that only shade pixels inside the volume
+enum LightingMode {
+    LIGHTING_FULLSCREEN,
+    LIGHTING_VOLUMES,
+    LIGHTING_STENCIL_VOLUMES,
+    LIGHTING_MODE_COUNT
+};
+const char* LIGHTING_MODE_NAMES[] = { "fullscreen", "volumes", "stencil volumes" };
+LightingMode lightingMode = LIGHTING_STENCIL_VOLUMES;
+
+// light counts, cycled with the left/right arrow keys and swept by the benchmark (B key)
+const unsigned int LIGHT_COUNTS[] = { 32, 128, 512, 2048, 8192 };
+const unsigned int NR_LIGHT_COUNTS = sizeof(LIGHT_COUNTS) / sizeof(LIGHT_COUNTS[0]);
+unsigned int lightCountIndex = 0;
+bool lightsDirty = true;
+bool lightCountKeyPressed = false;
+bool benchmarkRequested = false;
+bool benchmarkKeyPressed = false;
+
+// per-light instance data: vec4 position + radius, vec4 color + quadratic attenuation term
+unsigned int lightInstanceVBO = 0;
+const float LIGHT_LINEAR = 0.7f;
+
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
 float lastX = (float)SCR_WIDTH / 2.0;
@@ -83,6 +112,8 @@ int main()
     // -------------------------
     Shader shaderGeometryPass("8.2.g_buffer.vs", "8.2.g_buffer.fs");
     Shader shaderLightingPass("8.2.deferred_shading.vs", "8.2.deferred_shading.fs");
+    Shader shaderLightVolume("8.2.light_volume.vs", "8.2.deferred_shading.fs");
+    Shader shaderAmbient("8.2.deferred_shading.vs", "8.2.deferred_ambient.fs");
     Shader shaderLightBox("8.2.deferred_light_box.vs", "8.2.deferred_light_box.fs");
 
     // load models
@@ -130,46 +161,69 @@ int main()
     // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
     unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
     glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
+    // create and attach depth buffer (renderbuffer); the stencil part is used to mask the light volumes
     unsigned int rboDepth;
     glGenRenderbuffers(1, &rboDepth);
     glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
     // finally check if framebuffer is complete
     if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "Framebuffer not complete!" << std::endl;
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+    // light accumulation framebuffer: shares the gbuffer's depth-stencil buffer so the light volumes
+    // can be depth/stencil tested against the scene
+    // --------------------------------------------------------------------------------------------
+    unsigned int lightFBO, lightColorBuffer;
+    glGenFramebuffers(1, &lightFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+    glGenTextures(1, &lightColorBuffer);
+    glBindTexture(GL_TEXTURE_2D, lightColorBuffer);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, lightColorBuffer, 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
     // lighting info
     // -------------
-    const unsigned int NR_LIGHTS = 32;
-    std::vector<glm::vec3> lightPositions;
-    std::vector<glm::vec3> lightColors;
-    srand(13);
-    for (unsigned int i = 0; i < NR_LIGHTS; i++)
-    {
-        // calculate slightly random offsets
-        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
-        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
-        lightPositions.push_back(glm::vec3(xPos, yPos, zPos));
-        // also calculate random color
-        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.)
-        lightColors.push_back(glm::vec3(rColor, gColor, bColor));
-    }
+    glGenBuffers(1, &lightInstanceVBO);
+    unsigned int nrLights = 0;
 
     // shader configuration
     // --------------------
-    shaderLightingPass.use();
-    shaderLightingPass.setInt("gPosition", 0);
-    shaderLightingPass.setInt("gNormal", 1);
-    shaderLightingPass.setInt("gAlbedoSpec", 2);
+    Shader* lightingShaders[] = { &shaderLightingPass, &shaderLightVolume };
+    for (Shader* shader : lightingShaders)
+    {
+        shader->use();
+        shader->setInt("gPosition", 0);
+        shader->setInt("gNormal", 1);
+        shader->setInt("gAlbedoSpec", 2);
+        shader->setVec2("screenSize", glm::vec2((float)SCR_WIDTH, (float)SCR_HEIGHT));
+        shader->setFloat("lightLinear", LIGHT_LINEAR);
+    }
+    shaderAmbient.use();
+    shaderAmbient.setInt("gAlbedoSpec", 2);
+    shaderAmbient.setVec2("screenSize", glm::vec2((float)SCR_WIDTH, (float)SCR_HEIGHT));
+
+    // benchmark sweep state: every lighting mode at every light count, timed over a number of frames
+    // ----------------------------------------------------------------------------------------------
+    const unsigned int BENCHMARK_WARMUP_FRAMES = 10;
+    const unsigned int BENCHMARK_MEASURE_FRAMES = 100;
+    bool benchmarkActive = false;
+    unsigned int benchmarkStep = 0, benchmarkFrame = 0;
+    double benchmarkResults[NR_LIGHT_COUNTS][LIGHTING_MODE_COUNT];
+    LightingMode modeBeforeBenchmark = lightingMode;
+    unsigned int countBeforeBenchmark = lightCountIndex;
+    GpuTimer lightingTimer;
 
     // render loop
     // -----------
+    int frameCounter = 0;
     while (!glfwWindowShouldClose(window))
     {
         // per-frame time logic
@@ -182,6 +236,65 @@ int main()
         // -----
         processInput(window);
 
+        // benchmark sweep: step through (light count, mode) pairs, one step per measured batch of frames
+        if (benchmarkRequested && !benchmarkActive)
+        {
+            benchmarkActive = true;
+            benchmarkStep = 0;
+            benchmarkFrame = 0;
+            modeBeforeBenchmark = lightingMode;
+            countBeforeBenchmark = lightCountIndex;
+            std::cout << "benchmark: sweeping " << NR_LIGHT_COUNTS << " light counts x " << LIGHTING_MODE_COUNT << " modes" << std::endl;
+        }
+        benchmarkRequested = false;
+        if (benchmarkActive)
+        {
+            unsigned int countIndex = benchmarkStep / LIGHTING_MODE_COUNT;
+            LightingMode mode = (LightingMode)(benchmarkStep % LIGHTING_MODE_COUNT);
+            if (benchmarkFrame == 0)
+            {
+                lightingMode = mode;
+                if (lightCountIndex != countIndex)
+                {
+                    lightCountIndex = countIndex;
+                    lightsDirty = true;
+                }
+            }
+            else if (benchmarkFrame == BENCHMARK_WARMUP_FRAMES)
+                lightingTimer.Reset();
+            else if (benchmarkFrame == BENCHMARK_WARMUP_FRAMES + BENCHMARK_MEASURE_FRAMES)
+            {
+                benchmarkResults[countIndex][mode] = lightingTimer.AverageMs();
+                benchmarkFrame = 0;
+                if (++benchmarkStep == NR_LIGHT_COUNTS * LIGHTING_MODE_COUNT)
+                {
+                    std::cout << std::setw(8) << "lights";
+                    for (unsigned int m = 0; m < LIGHTING_MODE_COUNT; m++)
+                        std::cout << " | " << std::setw(15) << LIGHTING_MODE_NAMES[m];
+                    std::cout << "   (lighting pass GPU time in ms)" << std::endl;
+                    for (unsigned int c = 0; c < NR_LIGHT_COUNTS; c++)
+                    {
+                        std::cout << std::setw(8) << LIGHT_COUNTS[c];
+                        for (unsigned int m = 0; m < LIGHTING_MODE_COUNT; m++)
+                            std::cout << " | " << std::setw(15) << std::fixed << std::setprecision(3) << benchmarkResults[c][m];
+                        std::cout << std::endl;
+                    }
+                    benchmarkActive = false;
+                    lightingMode = modeBeforeBenchmark;
+                    lightCountIndex = countBeforeBenchmark;
+                    lightsDirty = true;
+                }
+                continue;
+            }
+            benchmarkFrame++;
+        }
+
+        if (lightsDirty)
+        {
+            nrLights = generateLights(LIGHT_COUNTS[lightCountIndex]);
+            lightsDirty = false;
+        }
+
         // render
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -190,7 +303,7 @@ int main()
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
         glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100.0f);
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 model = glm::mat4(1.0f);
@@ -205,63 +318,108 @@ int main()
             shaderGeometryPass.setMat4("model", model);
             backpack.Draw(shaderGeometryPass);
         }
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        // 2. lighting pass: calculate lighting by iterating over a screen filled quad pixel-by-pixel using the gbuffer's content.
-        // -----------------------------------------------------------------------------------------------------------------------
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderLightingPass.use();
+        // 2. lighting pass: add every light's contribution into the light accumulation buffer
+        // ------------------------------------------------------------------------------------
+        lightingTimer.Begin();
+        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+        glClear(GL_COLOR_BUFFER_BIT);
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, gPosition);
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, gNormal);
         glActiveTexture(GL_TEXTURE2);
         glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
-        // send light relevant uniforms
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
+        glDepthMask(GL_FALSE);
+        glDisable(GL_DEPTH_TEST);
+        // ambient is written once for the whole screen
+        shaderAmbient.use();
+        renderQuad();
+        // all lights are summed with additive blending
+        glEnable(GL_BLEND);
+        glBlendEquation(GL_FUNC_ADD);
+        glBlendFunc(GL_ONE, GL_ONE);
+        if (lightingMode == LIGHTING_FULLSCREEN)
         {
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Position", lightPositions[i]);
-            shaderLightingPass.setVec3("lights[" + std::to_string(i) + "].Color", lightColors[i]);
-            // update attenuation parameters and calculate radius
-            const float constant = 1.0f; // note that we don't send this to the shader, we assume it is always 1.0 (in our case)
-            const float linear = 0.7f;
-            const float quadratic = 1.8f;
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Linear", linear);
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Quadratic", quadratic);
-            // then calculate radius of light volume/sphere
-            const float maxBrightness = std::fmaxf(std::fmaxf(lightColors[i].r, lightColors[i].g), lightColors[i].b);
-            float radius = (-linear + std::sqrt(linear * linear - 4 * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) / (2.0f * quadratic);
-            shaderLightingPass.setFloat("lights[" + std::to_string(i) + "].Radius", radius);
+            shaderLightingPass.use();
+            shaderLightingPass.setVec3("viewPos", camera.Position);
+            renderQuad(0, nrLights);
         }
-        shaderLightingPass.setVec3("viewPos", camera.Position);
-        // finally render quad
-        renderQuad();
+        else if (lightingMode == LIGHTING_VOLUMES)
+        {
+            // only draw the back faces of the volumes and keep the pixels whose surface lies in front
+            // of them: this rejects everything behind the volume in a single instanced draw call
+            shaderLightVolume.use();
+            shaderLightVolume.setMat4("projection", projection);
+            shaderLightVolume.setMat4("view", view);
+            shaderLightVolume.setVec3("viewPos", camera.Position);
+            glEnable(GL_DEPTH_TEST);
+            glDepthFunc(GL_GEQUAL);
+            glEnable(GL_CULL_FACE);
+            glCullFace(GL_FRONT);
+            renderSphere(0, nrLights);
+            glCullFace(GL_BACK);
+            glDisable(GL_CULL_FACE);
+            glDepthFunc(GL_LESS);
+            glDisable(GL_DEPTH_TEST);
+        }
+        else
+        {
+            shaderLightVolume.use();
+            shaderLightVolume.setMat4("projection", projection);
+            shaderLightVolume.setMat4("view", view);
+            shaderLightVolume.setVec3("viewPos", camera.Position);
+            glEnable(GL_STENCIL_TEST);
+            for (unsigned int i = 0; i < nrLights; i++)
+            {
+                // stencil pass: count the volume's faces that lie behind the scene's surface. back faces
+                // increment and front faces decrement, so only pixels inside the volume end up non-zero
+                glDrawBuffer(GL_NONE);
+                glEnable(GL_DEPTH_TEST);
+                glStencilFunc(GL_ALWAYS, 0, 0);
+                glStencilOpSeparate(GL_BACK, GL_KEEP, GL_INCR_WRAP, GL_KEEP);
+                glStencilOpSeparate(GL_FRONT, GL_KEEP, GL_DECR_WRAP, GL_KEEP);
+                renderSphere(i, 1);
+
+                // light pass: shade the marked pixels and reset their stencil value for the next light
+                glDrawBuffer(GL_COLOR_ATTACHMENT0);
+                glDisable(GL_DEPTH_TEST);
+                glEnable(GL_CULL_FACE);
+                glCullFace(GL_FRONT);
+                glStencilFunc(GL_NOTEQUAL, 0, 0xFF);
+                glStencilOp(GL_ZERO, GL_ZERO, GL_ZERO);
+                renderSphere(i, 1);
+                glCullFace(GL_BACK);
+                glDisable(GL_CULL_FACE);
+            }
+            glDisable(GL_STENCIL_TEST);
+        }
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+        glEnable(GL_DEPTH_TEST);
+        lightingTimer.End();
 
-        // 2.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
-        // ----------------------------------------------------------------------------------
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
-        // blit to default framebuffer. Note that this may or may not work as the internal formats of both the FBO and default framebuffer have to match.
-        // the internal formats are implementation defined. This works on all of my systems, but if it doesn't on yours you'll likely have to write to the 		
-        // depth buffer in another shader stage (or somehow see to match the default framebuffer's internal format with the FBO's internal format).
-        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (!benchmarkActive && ++frameCounter >= 100)
+        {
+            std::cout << "mode: " << LIGHTING_MODE_NAMES[lightingMode] << " | lights: " << nrLights
+                      << " | lighting pass: " << lightingTimer.ElapsedMs() << " ms" << std::endl;
+            frameCounter = 0;
+        }
 
-        // 3. render lights on top of scene
-        // --------------------------------
+        // 3. render lights on top of scene, the light buffer already holds the gbuffer's depth
+        // -------------------------------------------------------------------------------------
         shaderLightBox.use();
         shaderLightBox.setMat4("projection", projection);
         shaderLightBox.setMat4("view", view);
-        for (unsigned int i = 0; i < lightPositions.size(); i++)
-        {
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, lightPositions[i]);
-            model = glm::scale(model, glm::vec3(0.125f));
-            shaderLightBox.setMat4("model", model);
-            shaderLightBox.setVec3("lightColor", lightColors[i]);
-            renderCube();
-        }
+        shaderLightBox.setFloat("boxScale", nrLights > 128 ? 0.03f : 0.125f);
+        renderCube(0, nrLights);
 
+        // 4. copy the lit result to the default framebuffer
+        // -------------------------------------------------
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, lightFBO);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -269,15 +427,131 @@ int main()
         glfwPollEvents();
     }
 
+    glDeleteBuffers(1, &lightInstanceVBO);
+    glDeleteFramebuffers(1, &lightFBO);
+    glDeleteTextures(1, &lightColorBuffer);
+
     glfwTerminate();
     return 0;
 }
 
-// renderCube() renders a 1x1 3D cube in NDC.
-// -------------------------------------------------
+// fill the light instance buffer with the given number of lights and return the count. The lights
+// keep the layout of the original demo, but their radius shrinks as more lights are added so the
+// scene doesn't simply saturate
+// -----------------------------------------------------------------------------------------------
+unsigned int generateLights(unsigned int count)
+{
+    std::vector<glm::vec4> lightData;
+    lightData.reserve(count * 2);
+    srand(13);
+    const float constant = 1.0f; // note that we don't send this to the shader, we assume it is always 1.0 (in our case)
+    for (unsigned int i = 0; i < count; i++)
+    {
+        // calculate slightly random offsets
+        float xPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
+        float yPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 4.0);
+        float zPos = static_cast<float>(((rand() % 100) / 100.0) * 6.0 - 3.0);
+        // also calculate random color
+        float rColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
+        float gColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
+        float bColor = static_cast<float>(((rand() % 100) / 200.0f) + 0.5); // between 0.5 and 1.0
+        // with 32 lights use the original attenuation; beyond that scale the quadratic term up
+        float quadratic = 1.8f * std::cbrt((float)count / 32.0f) * std::cbrt((float)count / 32.0f);
+        // then calculate radius of light volume/sphere
+        const float maxBrightness = std::fmaxf(std::fmaxf(rColor, gColor), bColor);
+        float radius = (-LIGHT_LINEAR + std::sqrt(LIGHT_LINEAR * LIGHT_LINEAR - 4 * quadratic * (constant - (256.0f / 5.0f) * maxBrightness))) / (2.0f * quadratic);
+        lightData.push_back(glm::vec4(xPos, yPos, zPos, radius));
+        lightData.push_back(glm::vec4(rColor, gColor, bColor, quadratic));
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+    glBufferData(GL_ARRAY_BUFFER, lightData.size() * sizeof(glm::vec4), lightData.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    return count;
+}
+
+// point the per-instance light attributes of the bound VAO at the given light, so a draw call with
+// N instances renders lights [firstLight, firstLight + N)
+// ------------------------------------------------------------------------------------------------
+void bindLightInstances(unsigned int firstLight)
+{
+    const GLsizei stride = 2 * sizeof(glm::vec4);
+    const std::size_t offset = (std::size_t)firstLight * stride;
+    glBindBuffer(GL_ARRAY_BUFFER, lightInstanceVBO);
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, stride, (void*)offset);
+    glVertexAttribDivisor(3, 1);
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, stride, (void*)(offset + sizeof(glm::vec4)));
+    glVertexAttribDivisor(4, 1);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+// renderSphere() renders a low-poly unit sphere per light. The vertices are pushed outwards so the
+// faceted sphere fully encloses the true sphere, otherwise the volume would clip the light's edge
+// ------------------------------------------------------------------------------------------------
+unsigned int sphereVAO = 0;
+unsigned int sphereVBO, sphereEBO;
+unsigned int sphereIndexCount;
+void renderSphere(unsigned int firstLight, GLsizei lightCount)
+{
+    if (sphereVAO == 0)
+    {
+        const unsigned int X_SEGMENTS = 16;
+        const unsigned int Y_SEGMENTS = 12;
+        const float PI = 3.14159265359f;
+        const float enclose = 1.0f / (std::cos(PI / X_SEGMENTS) * std::cos(PI / (2 * Y_SEGMENTS)));
+        std::vector<glm::vec3> positions;
+        std::vector<unsigned int> indices;
+        for (unsigned int y = 0; y <= Y_SEGMENTS; ++y)
+        {
+            for (unsigned int x = 0; x <= X_SEGMENTS; ++x)
+            {
+                float xSegment = (float)x / (float)X_SEGMENTS;
+                float ySegment = (float)y / (float)Y_SEGMENTS;
+                float xPos = std::cos(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+                float yPos = std::cos(ySegment * PI);
+                float zPos = std::sin(xSegment * 2.0f * PI) * std::sin(ySegment * PI);
+                positions.push_back(glm::vec3(xPos, yPos, zPos) * enclose);
+            }
+        }
+        // counter-clockwise triangles when seen from outside, so face culling picks the right side
+        for (unsigned int y = 0; y < Y_SEGMENTS; ++y)
+        {
+            for (unsigned int x = 0; x < X_SEGMENTS; ++x)
+            {
+                unsigned int i0 = y * (X_SEGMENTS + 1) + x;
+                unsigned int i1 = i0 + X_SEGMENTS + 1;
+                indices.push_back(i0);
+                indices.push_back(i0 + 1);
+                indices.push_back(i1);
+                indices.push_back(i1);
+                indices.push_back(i0 + 1);
+                indices.push_back(i1 + 1);
+            }
+        }
+        sphereIndexCount = static_cast<unsigned int>(indices.size());
+        glGenVertexArrays(1, &sphereVAO);
+        glGenBuffers(1, &sphereVBO);
+        glGenBuffers(1, &sphereEBO);
+        glBindVertexArray(sphereVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, sphereVBO);
+        glBufferData(GL_ARRAY_BUFFER, positions.size() * sizeof(glm::vec3), positions.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, sphereEBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    }
+    glBindVertexArray(sphereVAO);
+    bindLightInstances(firstLight);
+    glDrawElementsInstanced(GL_TRIANGLES, sphereIndexCount, GL_UNSIGNED_INT, 0, lightCount);
+    glBindVertexArray(0);
+}
+
+// renderCube() renders a 1x1 3D cube in NDC per light.
+// -----------------------------------------------------
 unsigned int cubeVAO = 0;
 unsigned int cubeVBO = 0;
-void renderCube()
+void renderCube(unsigned int firstLight, GLsizei lightCount)
 {
     // initialize (if necessary)
     if (cubeVAO == 0)
@@ -342,18 +616,19 @@ void renderCube()
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindVertexArray(0);
     }
-    // render Cube
+    // render Cubes
     glBindVertexArray(cubeVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 36);
+    bindLightInstances(firstLight);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, lightCount);
     glBindVertexArray(0);
 }
 
 
-// renderQuad() renders a 1x1 XY quad in NDC
-// -----------------------------------------
+// renderQuad() renders a 1x1 XY quad in NDC, once per light
+// ----------------------------------------------------------
 unsigned int quadVAO = 0;
 unsigned int quadVBO;
-void renderQuad()
+void renderQuad(unsigned int firstLight, GLsizei lightCount)
 {
     if (quadVAO == 0)
     {
@@ -376,7 +651,8 @@ void renderQuad()
         glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
     }
     glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    bindLightInstances(firstLight);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, lightCount);
     glBindVertexArray(0);
 }
 
@@ -395,6 +671,42 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // 1-3 select the lighting mode
+    if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
+        lightingMode = LIGHTING_FULLSCREEN;
+    if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
+        lightingMode = LIGHTING_VOLUMES;
+    if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
+        lightingMode = LIGHTING_STENCIL_VOLUMES;
+
+    // left/right arrows cycle through the light counts
+    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS && !lightCountKeyPressed)
+    {
+        lightCountIndex = (lightCountIndex + 1) % NR_LIGHT_COUNTS;
+        lightsDirty = true;
+        lightCountKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS && !lightCountKeyPressed)
+    {
+        lightCountIndex = (lightCountIndex + NR_LIGHT_COUNTS - 1) % NR_LIGHT_COUNTS;
+        lightsDirty = true;
+        lightCountKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_RELEASE && glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_RELEASE)
+    {
+        lightCountKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_PRESS && !benchmarkKeyPressed)
+    {
+        benchmarkRequested = true;
+        benchmarkKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_B) == GLFW_RELEASE)
+    {
+        benchmarkKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,75 @@
+#version 430 core
+
+// one invocation per light: find the range of clusters the light's sphere overlaps and append
+// the light's index to each of them. Mirrors ComputeClusterRange() in clustered_lights.h.
+layout (local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct PointLight {
+    vec4 PositionRadius;
+    vec4 ColorQuadratic;
+};
+
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+layout (std430, binding = 1) buffer ClusterCountBuffer {
+    uint clusterCounts[];
+};
+layout (std430, binding = 2) writeonly buffer ClusterIndexBuffer {
+    uint clusterIndices[];
+};
+
+uniform mat4 view;
+uniform vec2 projScale; // projection[0][0], projection[1][1]
+uniform uvec3 gridSize;
+uniform uint maxLightsPerCluster;
+uniform uint numLights;
+uniform float zNear;
+uniform float zFar;
+
+int depthSlice(float viewDepth)
+{
+    return int(floor(log(viewDepth / zNear) * float(gridSize.z) / log(zFar / zNear)));
+}
+
+void main()
+{
+    uint lightIndex = gl_GlobalInvocationID.x;
+    if (lightIndex >= numLights)
+        return;
+
+    vec3 viewPos = (view * vec4(lights[lightIndex].PositionRadius.xyz, 1.0)).xyz;
+    float radius = lights[lightIndex].PositionRadius.w;
+
+    float depthMin = -viewPos.z - radius;
+    float depthMax = -viewPos.z + radius;
+    if (depthMax < zNear || depthMin > zFar)
+        return;
+    depthMin = max(depthMin, zNear);
+    depthMax = min(depthMax, zFar);
+
+    // conservative NDC rectangle from the corners of the view-space bounding box
+    vec2 extentMin = viewPos.xy - vec2(radius);
+    vec2 extentMax = viewPos.xy + vec2(radius);
+    vec2 ndcA = projScale * extentMin / depthMin;
+    vec2 ndcB = projScale * extentMax / depthMin;
+    vec2 ndcC = projScale * extentMin / depthMax;
+    vec2 ndcD = projScale * extentMax / depthMax;
+    vec2 ndcMin = min(min(ndcA, ndcB), min(ndcC, ndcD));
+    vec2 ndcMax = max(max(ndcA, ndcB), max(ndcC, ndcD));
+    if (any(lessThan(ndcMax, vec2(-1.0))) || any(greaterThan(ndcMin, vec2(1.0))))
+        return;
+
+    ivec3 minCluster = max(ivec3(floor((ndcMin * 0.5 + 0.5) * vec2(gridSize.xy)), depthSlice(depthMin)), ivec3(0));
+    ivec3 maxCluster = min(ivec3(floor((ndcMax * 0.5 + 0.5) * vec2(gridSize.xy)), depthSlice(depthMax)), ivec3(gridSize) - 1);
+
+    for (int z = minCluster.z; z <= maxCluster.z; ++z)
+    for (int y = minCluster.y; y <= maxCluster.y; ++y)
+    for (int x = minCluster.x; x <= maxCluster.x; ++x)
+    {
+        uint cluster = uint(x) + gridSize.x * (uint(y) + gridSize.y * uint(z));
+        uint slot = atomicAdd(clusterCounts[cluster], 1u);
+        if (slot < maxLightsPerCluster)
+            clusterIndices[cluster * maxLightsPerCluster + slot] = lightIndex;
+    }
+}
@@ -0,0 +1,27 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+struct PointLight {
+    vec4 PositionRadius;
+    vec4 ColorQuadratic;
+};
+
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+
+out vec3 LightColor;
+
+uniform mat4 projection;
+uniform mat4 view;
+uniform float boxScale;
+
+void main()
+{
+    // one instance per light, positioned straight from the light buffer
+    PointLight light = lights[gl_InstanceID];
+    LightColor = light.ColorQuadratic.rgb;
+    gl_Position = projection * view * vec4(aPos * boxScale + light.PositionRadius.xyz, 1.0);
+}
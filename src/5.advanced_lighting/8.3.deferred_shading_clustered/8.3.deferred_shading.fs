@@ -0,0 +1,83 @@
+#version 430 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gPosition;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedoSpec;
+
+struct PointLight {
+    vec4 PositionRadius;
+    vec4 ColorQuadratic;
+};
+
+layout (std430, binding = 0) readonly buffer LightBuffer {
+    PointLight lights[];
+};
+layout (std430, binding = 1) readonly buffer ClusterCountBuffer {
+    uint clusterCounts[];
+};
+layout (std430, binding = 2) readonly buffer ClusterIndexBuffer {
+    uint clusterIndices[];
+};
+
+uniform vec3 viewPos;
+uniform mat4 view;
+uniform vec2 screenSize;
+uniform uvec3 gridSize;
+uniform uint maxLightsPerCluster;
+uniform float zNear;
+uniform float zFar;
+uniform float lightLinear;
+uniform bool showHeatmap;
+
+void main()
+{
+    // retrieve data from gbuffer
+    vec3 FragPos = texture(gPosition, TexCoords).rgb;
+    vec3 Normal = texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedoSpec, TexCoords).rgb;
+    float Specular = texture(gAlbedoSpec, TexCoords).a;
+
+    // find the cluster this fragment belongs to
+    float viewDepth = -(view * vec4(FragPos, 1.0)).z;
+    uvec2 tile = uvec2(gl_FragCoord.xy / screenSize * vec2(gridSize.xy));
+    int slice = int(floor(log(viewDepth / zNear) * float(gridSize.z) / log(zFar / zNear)));
+    uvec3 clusterCoord = min(uvec3(tile, uint(max(slice, 0))), gridSize - 1u);
+    uint cluster = clusterCoord.x + gridSize.x * (clusterCoord.y + gridSize.y * clusterCoord.z);
+    uint lightCount = min(clusterCounts[cluster], maxLightsPerCluster);
+
+    if (showHeatmap)
+    {
+        float heat = float(lightCount) / float(maxLightsPerCluster);
+        FragColor = vec4(mix(vec3(0.0, 0.0, 0.5), vec3(1.0, 0.2, 0.0), heat) + Diffuse * 0.1, 1.0);
+        return;
+    }
+
+    // then calculate lighting as usual, but only for the lights binned into this cluster
+    vec3 lighting  = Diffuse * 0.1; // hard-coded ambient component
+    vec3 viewDir  = normalize(viewPos - FragPos);
+    for(uint i = 0u; i < lightCount; ++i)
+    {
+        PointLight light = lights[clusterIndices[cluster * maxLightsPerCluster + i]];
+        // calculate distance between light source and current fragment
+        float distance = length(light.PositionRadius.xyz - FragPos);
+        if(distance < light.PositionRadius.w)
+        {
+            // diffuse
+            vec3 lightDir = normalize(light.PositionRadius.xyz - FragPos);
+            vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.ColorQuadratic.rgb;
+            // specular
+            vec3 halfwayDir = normalize(lightDir + viewDir);
+            float spec = pow(max(dot(Normal, halfwayDir), 0.0), 16.0);
+            vec3 specular = light.ColorQuadratic.rgb * spec * Specular;
+            // attenuation
+            float attenuation = 1.0 / (1.0 + lightLinear * distance + light.ColorQuadratic.a * distance * distance);
+            diffuse *= attenuation;
+            specular *= attenuation;
+            lighting += diffuse + specular;
+        }
+    }
+    FragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,574 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/clustered_lights.h>
+
+#include <iostream>
+#include <random>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+void renderQuad();
+void renderCubeInstanced(GLsizei instanceCount);
+std::vector<ClusterPointLight> generateLights(unsigned int count);
+bool validateClusters(const ClusterGrid& grid, const std::vector<ClusterPointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+                      unsigned int clusterCountBuffer, unsigned int clusterIndexBuffer);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// light counts selectable with the number keys 1-5
+const unsigned int LIGHT_COUNTS[] = { 32, 1024, 4096, 16384, 65536 };
+unsigned int lightCountIndex = 2;
+bool lightsDirty = true;
+bool showHeatmap = false;
+bool heatmapKeyPressed = false;
+bool validateRequested = false;
+bool validateKeyPressed = false;
+
+// the lights are scattered over the area covered by the grid of backpacks
+const int SCENE_HALF_EXTENT = 3;
+const float OBJECT_SPACING = 3.0f;
+const float LIGHT_LINEAR = 0.7f;
+
+// camera
+Camera camera(glm::vec3(0.0f, 2.0f, 12.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // tell stb_image.h to flip loaded texture's on the y-axis (before loading model).
+    stbi_set_flip_vertically_on_load(true);
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // build and compile shaders
+    // -------------------------
+    Shader shaderGeometryPass("8.3.g_buffer.vs", "8.3.g_buffer.fs");
+    Shader shaderLightingPass("8.3.deferred_shading.vs", "8.3.deferred_shading.fs");
+    Shader shaderLightBox("8.3.deferred_light_box.vs", "8.3.deferred_light_box.fs");
+    ComputeShader shaderClusterBinning("8.3.cluster_binning.cs");
+
+    // load models
+    // -----------
+    Model backpack(FileSystem::getPath("resources/objects/backpack/backpack.obj"));
+    std::vector<glm::vec3> objectPositions;
+    for (int z = -SCENE_HALF_EXTENT; z <= SCENE_HALF_EXTENT; z++)
+        for (int x = -SCENE_HALF_EXTENT; x <= SCENE_HALF_EXTENT; x++)
+            objectPositions.push_back(glm::vec3(x * OBJECT_SPACING, -0.5f, z * OBJECT_SPACING));
+
+    // configure g-buffer framebuffer
+    // ------------------------------
+    unsigned int gBuffer;
+    glGenFramebuffers(1, &gBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+    unsigned int gPosition, gNormal, gAlbedoSpec;
+    // position color buffer
+    glGenTextures(1, &gPosition);
+    glBindTexture(GL_TEXTURE_2D, gPosition);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
+    // normal color buffer
+    glGenTextures(1, &gNormal);
+    glBindTexture(GL_TEXTURE_2D, gNormal);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
+    // color + specular color buffer
+    glGenTextures(1, &gAlbedoSpec);
+    glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedoSpec, 0);
+    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
+    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+    glDrawBuffers(3, attachments);
+    // create and attach depth buffer (renderbuffer)
+    unsigned int rboDepth;
+    glGenRenderbuffers(1, &rboDepth);
+    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
+    // finally check if framebuffer is complete
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // cluster grid and light buffers
+    // ------------------------------
+    // binding 0: all lights, binding 1: number of lights per cluster, binding 2: light indices per cluster
+    ClusterGrid grid;
+    grid.ZNear = 0.1f;
+    grid.ZFar = 100.0f;
+    unsigned int lightBuffer, clusterCountBuffer, clusterIndexBuffer;
+    glGenBuffers(1, &lightBuffer);
+    glGenBuffers(1, &clusterCountBuffer);
+    glGenBuffers(1, &clusterIndexBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterCountBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, grid.NumClusters() * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterIndexBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, grid.NumClusters() * grid.MaxLightsPerCluster * sizeof(unsigned int), NULL, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lightBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, clusterCountBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, clusterIndexBuffer);
+    std::vector<ClusterPointLight> lights;
+
+    // shader configuration
+    // --------------------
+    shaderLightingPass.use();
+    shaderLightingPass.setInt("gPosition", 0);
+    shaderLightingPass.setInt("gNormal", 1);
+    shaderLightingPass.setInt("gAlbedoSpec", 2);
+    shaderLightingPass.setVec2("screenSize", glm::vec2((float)SCR_WIDTH, (float)SCR_HEIGHT));
+    glUniform3ui(glGetUniformLocation(shaderLightingPass.ID, "gridSize"), grid.GridX, grid.GridY, grid.GridZ);
+    glUniform1ui(glGetUniformLocation(shaderLightingPass.ID, "maxLightsPerCluster"), grid.MaxLightsPerCluster);
+    shaderLightingPass.setFloat("zNear", grid.ZNear);
+    shaderLightingPass.setFloat("zFar", grid.ZFar);
+    shaderLightingPass.setFloat("lightLinear", LIGHT_LINEAR);
+    shaderClusterBinning.use();
+    glUniform3ui(glGetUniformLocation(shaderClusterBinning.ID, "gridSize"), grid.GridX, grid.GridY, grid.GridZ);
+    glUniform1ui(glGetUniformLocation(shaderClusterBinning.ID, "maxLightsPerCluster"), grid.MaxLightsPerCluster);
+    shaderClusterBinning.setFloat("zNear", grid.ZNear);
+    shaderClusterBinning.setFloat("zFar", grid.ZFar);
+
+    // render loop
+    // -----------
+    int frameCounter = 0;
+    float frameTimeSum = 0.0f;
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        auto currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+        frameTimeSum += deltaTime;
+        if (++frameCounter == 100)
+        {
+            std::cout << "lights: " << lights.size() << " | frame time: " << frameTimeSum * 10.0f << " ms" << std::endl;
+            frameCounter = 0;
+            frameTimeSum = 0.0f;
+        }
+
+        // input
+        // -----
+        processInput(window);
+
+        // (re)generate the light buffer when the light count changed; the lights are static in
+        // world space so this only happens on a key press, never per frame
+        if (lightsDirty)
+        {
+            lights = generateLights(LIGHT_COUNTS[lightCountIndex]);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, lightBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, lights.size() * sizeof(ClusterPointLight), lights.data(), GL_STATIC_DRAW);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            lightsDirty = false;
+        }
+
+        // render
+        // ------
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 1. geometry pass: render scene's geometry/color data into gbuffer
+        // -----------------------------------------------------------------
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, grid.ZNear, grid.ZFar);
+        glm::mat4 view = camera.GetViewMatrix();
+        glm::mat4 model = glm::mat4(1.0f);
+        shaderGeometryPass.use();
+        shaderGeometryPass.setMat4("projection", projection);
+        shaderGeometryPass.setMat4("view", view);
+        for (unsigned int i = 0; i < objectPositions.size(); i++)
+        {
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, objectPositions[i]);
+            model = glm::scale(model, glm::vec3(0.5f));
+            shaderGeometryPass.setMat4("model", model);
+            backpack.Draw(shaderGeometryPass);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 2. cluster pass: bin every light into the view-space clusters it overlaps
+        // ------------------------------------------------------------------------
+        unsigned int zero = 0;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterCountBuffer);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        shaderClusterBinning.use();
+        shaderClusterBinning.setMat4("view", view);
+        shaderClusterBinning.setVec2("projScale", glm::vec2(projection[0][0], projection[1][1]));
+        glUniform1ui(glGetUniformLocation(shaderClusterBinning.ID, "numLights"), (unsigned int)lights.size());
+        glDispatchCompute(((unsigned int)lights.size() + 63) / 64, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+        if (validateRequested)
+        {
+            // the readback needs the binning writes visible to buffer reads as well
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+            validateClusters(grid, lights, view, projection, clusterCountBuffer, clusterIndexBuffer);
+            validateRequested = false;
+        }
+
+        // 3. lighting pass: every pixel only iterates over the lights of its own cluster
+        // -----------------------------------------------------------------------------
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shaderLightingPass.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, gAlbedoSpec);
+        shaderLightingPass.setVec3("viewPos", camera.Position);
+        shaderLightingPass.setMat4("view", view);
+        shaderLightingPass.setBool("showHeatmap", showHeatmap);
+        renderQuad();
+
+        // 3.5. copy content of geometry's depth buffer to default framebuffer's depth buffer
+        // ----------------------------------------------------------------------------------
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, gBuffer);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0); // write to default framebuffer
+        glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+        // 4. render lights on top of scene, all of them in a single instanced draw call
+        // ----------------------------------------------------------------------------
+        shaderLightBox.use();
+        shaderLightBox.setMat4("projection", projection);
+        shaderLightBox.setMat4("view", view);
+        shaderLightBox.setFloat("boxScale", lights.size() > 1024 ? 0.02f : 0.125f);
+        renderCubeInstanced((GLsizei)lights.size());
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glDeleteBuffers(1, &lightBuffer);
+    glDeleteBuffers(1, &clusterCountBuffer);
+    glDeleteBuffers(1, &clusterIndexBuffer);
+
+    glfwTerminate();
+    return 0;
+}
+
+// scatter the given number of lights over the scene; the light radius shrinks with the light
+// count so that the amount of lights per cluster (and thus per pixel) stays roughly the same
+// -------------------------------------------------------------------------------------------
+std::vector<ClusterPointLight> generateLights(unsigned int count)
+{
+    std::vector<ClusterPointLight> lights(count);
+    std::mt19937 generator(13);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float halfExtent = SCENE_HALF_EXTENT * OBJECT_SPACING + 1.0f;
+    const float targetRadius = std::max(0.35f, 4.0f * std::cbrt(32.0f / (float)count));
+    for (unsigned int i = 0; i < count; i++)
+    {
+        glm::vec3 position(unit(generator) * 2.0f * halfExtent - halfExtent,
+                           unit(generator) * 3.0f - 1.0f,
+                           unit(generator) * 2.0f * halfExtent - halfExtent);
+        glm::vec3 color(unit(generator) * 0.5f + 0.5f, unit(generator) * 0.5f + 0.5f, unit(generator) * 0.5f + 0.5f); // between 0.5 and 1.0
+        // solve the attenuation equation used to derive the radius in 8.2 for the quadratic term instead
+        const float maxBrightness = std::fmaxf(std::fmaxf(color.r, color.g), color.b);
+        float quadratic = ((256.0f / 5.0f) * maxBrightness - 1.0f - LIGHT_LINEAR * targetRadius) / (targetRadius * targetRadius);
+        lights[i].PositionRadius = glm::vec4(position, targetRadius);
+        lights[i].ColorQuadratic = glm::vec4(color, quadratic);
+    }
+    return lights;
+}
+
+// read back the GPU cluster lists and compare them against the CPU reference binner
+// ----------------------------------------------------------------------------------
+bool validateClusters(const ClusterGrid& grid, const std::vector<ClusterPointLight>& lights, const glm::mat4& view, const glm::mat4& projection,
+                      unsigned int clusterCountBuffer, unsigned int clusterIndexBuffer)
+{
+    std::vector<unsigned int> cpuCounts, cpuIndices;
+    unsigned int overflow = BinLightsCPU(grid, lights, view, projection, cpuCounts, cpuIndices);
+
+    std::vector<unsigned int> gpuCounts(grid.NumClusters());
+    std::vector<unsigned int> gpuIndices(grid.NumClusters() * grid.MaxLightsPerCluster);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterCountBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuCounts.size() * sizeof(unsigned int), gpuCounts.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, clusterIndexBuffer);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuIndices.size() * sizeof(unsigned int), gpuIndices.data());
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+    unsigned int mismatches = 0, totalEntries = 0;
+    for (unsigned int c = 0; c < grid.NumClusters(); c++)
+    {
+        totalEntries += cpuCounts[c];
+        if (cpuCounts[c] != gpuCounts[c])
+        {
+            mismatches++;
+            continue;
+        }
+        // the GPU appends in arbitrary order, so only compare sets (skip overflowing clusters
+        // as which lights made it in depends on that order)
+        if (cpuCounts[c] > grid.MaxLightsPerCluster)
+            continue;
+        auto cpuBegin = cpuIndices.begin() + c * grid.MaxLightsPerCluster;
+        auto gpuBegin = gpuIndices.begin() + c * grid.MaxLightsPerCluster;
+        std::sort(cpuBegin, cpuBegin + cpuCounts[c]);
+        std::sort(gpuBegin, gpuBegin + gpuCounts[c]);
+        if (!std::equal(cpuBegin, cpuBegin + cpuCounts[c], gpuBegin))
+            mismatches++;
+    }
+    std::cout << "cluster validation: " << (mismatches == 0 ? "OK" : "FAILED") << " | mismatching clusters: " << mismatches
+              << " | light-cluster pairs: " << totalEntries << " | dropped (overflow): " << overflow << std::endl;
+    return mismatches == 0;
+}
+
+// renderCubeInstanced() renders instanceCount 1x1 3D cubes in NDC.
+// -----------------------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCubeInstanced(GLsizei instanceCount)
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cubes
+    glBindVertexArray(cubeVAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 36, instanceCount);
+    glBindVertexArray(0);
+}
+
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    // number keys select the light count
+    for (unsigned int i = 0; i < sizeof(LIGHT_COUNTS) / sizeof(LIGHT_COUNTS[0]); i++)
+    {
+        if (glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS && lightCountIndex != i)
+        {
+            lightCountIndex = i;
+            lightsDirty = true;
+        }
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS && !heatmapKeyPressed)
+    {
+        showHeatmap = !showHeatmap;
+        heatmapKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_H) == GLFW_RELEASE)
+    {
+        heatmapKeyPressed = false;
+    }
+
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS && !validateKeyPressed)
+    {
+        validateRequested = true;
+        validateKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE)
+    {
+        validateKeyPressed = false;
+    }
+}
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
@@ -0,0 +1,110 @@
+#version 430 core
+
+// Ground-truth ambient occlusion (Jimenez et al. 2016). For every pixel the hemisphere is cut
+// into slices around the view vector; along each slice the horizon is searched on both sides in
+// the hierarchical depth buffer and the cosine-weighted visibility between the two horizons is
+// integrated analytically. The math mirrors the CPU reference in learnopengl/gtao.h.
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (r16f, binding = 0) uniform writeonly image2D aoOutput;
+
+uniform sampler2D hzb;      // linear depth, closest depth per texel in the coarser levels
+uniform sampler2D gNormal;
+
+uniform bool octahedralNormals; // thin G-buffer layout
+uniform mat4 projection;
+uniform vec2 resolution;
+uniform int sliceCount;
+uniform int stepsPerSide;
+uniform float radius;       // view-space radius of the horizon search
+uniform float maxLevel;
+
+const float PI = 3.14159265358979;
+
+vec3 octahedralDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+vec3 viewPosition(vec2 uv, float linearDepth)
+{
+    return vec3((uv * 2.0 - 1.0) * linearDepth / vec2(projection[0][0], projection[1][1]), -linearDepth);
+}
+
+// integral of cos(theta - n) * |sin(theta)| between 0 and h, see GTAOIntegrateArc()
+float integrateArc(float h, float n)
+{
+    return 0.25 * (-cos(2.0 * h - n) + cos(n) + 2.0 * h * sin(n));
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, ivec2(resolution))))
+        return;
+
+    vec2 uv = (vec2(pixel) + 0.5) / resolution;
+    vec3 P = viewPosition(uv, texelFetch(hzb, pixel, 0).r);
+    vec3 V = normalize(-P);
+    vec3 N = octahedralNormals ? octahedralDecode(texelFetch(gNormal, pixel, 0).rg)
+                               : normalize(texelFetch(gNormal, pixel, 0).rgb);
+
+    // the search radius in pixels
+    float screenRadius = radius * projection[1][1] / -P.z * 0.5 * resolution.y;
+
+    // interleaved 4x4 noise for the slice rotation and step offsets, removed by the denoise pass
+    int pattern = (pixel.x & 3) + 4 * (pixel.y & 3);
+    float sliceNoise = float(pattern) / 16.0;
+    float stepNoise = float((pattern * 7) & 15) / 16.0;
+
+    float visibility = 0.0;
+    for (int slice = 0; slice < sliceCount; ++slice)
+    {
+        float phi = (float(slice) + sliceNoise) / float(sliceCount) * PI;
+        vec2 direction = vec2(cos(phi), sin(phi));
+
+        // project the normal onto the slice plane, see GTAOProjectNormal()
+        vec3 directionVector = vec3(direction, 0.0);
+        vec3 orthoDirection = directionVector - dot(directionVector, V) * V;
+        vec3 axis = normalize(cross(orthoDirection, V));
+        vec3 projectedNormal = N - axis * dot(N, axis);
+        float projectedLength = length(projectedNormal);
+        float signN = dot(orthoDirection, projectedNormal) >= 0.0 ? 1.0 : -1.0;
+        float n = signN * acos(clamp(dot(projectedNormal, V) / projectedLength, 0.0, 1.0));
+
+        // march both sides of the slice and keep the highest horizon (largest cosine to V)
+        float horizonCos0 = -1.0;
+        float horizonCos1 = -1.0;
+        for (int i = 0; i < stepsPerSide; ++i)
+        {
+            // quadratic distribution: more steps close to the pixel, where occluders matter most
+            float t = (float(i) + stepNoise) / float(stepsPerSide);
+            float offsetPixels = t * t * screenRadius + 1.0;
+            // far steps read coarser levels of the depth hierarchy to stay cache friendly
+            float level = clamp(floor(log2(offsetPixels)) - 2.0, 0.0, maxLevel);
+            vec2 offsetUV = direction * offsetPixels / resolution;
+
+            vec3 S0 = viewPosition(uv - offsetUV, textureLod(hzb, uv - offsetUV, level).r) - P;
+            vec3 S1 = viewPosition(uv + offsetUV, textureLod(hzb, uv + offsetUV, level).r) - P;
+            float distance0 = length(S0);
+            float distance1 = length(S1);
+            // occluders fade out over the second half of the radius
+            float falloff0 = clamp(2.0 - 2.0 * distance0 / radius, 0.0, 1.0);
+            float falloff1 = clamp(2.0 - 2.0 * distance1 / radius, 0.0, 1.0);
+            horizonCos0 = max(horizonCos0, mix(-1.0, dot(S0 / distance0, V), falloff0));
+            horizonCos1 = max(horizonCos1, mix(-1.0, dot(S1 / distance1, V), falloff1));
+        }
+
+        // horizon angles, clamped to the hemisphere around the normal, see GTAOSliceVisibility()
+        float h0 = n + max(-acos(horizonCos0) - n, -0.5 * PI);
+        float h1 = n + min(acos(horizonCos1) - n, 0.5 * PI);
+        visibility += projectedLength * (integrateArc(h0, n) + integrateArc(h1, n));
+    }
+    visibility /= float(sliceCount);
+
+    imageStore(aoOutput, pixel, vec4(visibility));
+}
@@ -0,0 +1,36 @@
+#version 430 core
+
+// 4x4 depth-aware blur; the window matches the 4x4 noise pattern of 9.2.gtao.cs so every output
+// pixel averages all slice rotations and step offsets
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (r16f, binding = 0) uniform writeonly image2D aoOutput;
+
+uniform sampler2D aoInput;
+uniform sampler2D hzb;
+
+uniform float depthSharpness;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    ivec2 size = imageSize(aoOutput);
+    if (any(greaterThanEqual(pixel, size)))
+        return;
+
+    float centerDepth = texelFetch(hzb, pixel, 0).r;
+    float result = 0.0;
+    float totalWeight = 0.0;
+    for (int x = -2; x < 2; ++x)
+    {
+        for (int y = -2; y < 2; ++y)
+        {
+            ivec2 coord = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+            float sampleDepth = texelFetch(hzb, coord, 0).r;
+            float weight = exp(-depthSharpness * abs(sampleDepth - centerDepth) / centerDepth);
+            result += texelFetch(aoInput, coord, 0).r * weight;
+            totalWeight += weight;
+        }
+    }
+    imageStore(aoOutput, pixel, vec4(result / totalWeight));
+}
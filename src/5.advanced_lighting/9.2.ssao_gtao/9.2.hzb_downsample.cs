@@ -0,0 +1,29 @@
+#version 430 core
+
+// builds one level of the hierarchical depth buffer from the level above it. Every texel keeps
+// the closest (smallest) depth of its 2x2 source texels, so occluders never disappear from the
+// coarse levels the horizon search samples far away from the center pixel.
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (r32f, binding = 0) uniform readonly image2D sourceLevel;
+layout (r32f, binding = 1) uniform writeonly image2D destinationLevel;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, imageSize(destinationLevel))))
+        return;
+    ivec2 maxSource = imageSize(sourceLevel) - 1;
+    ivec2 source = pixel * 2;
+    float d0 = imageLoad(sourceLevel, min(source, maxSource)).r;
+    float d1 = imageLoad(sourceLevel, min(source + ivec2(1, 0), maxSource)).r;
+    float d2 = imageLoad(sourceLevel, min(source + ivec2(0, 1), maxSource)).r;
+    float d3 = imageLoad(sourceLevel, min(source + ivec2(1, 1), maxSource)).r;
+    float closest = min(min(d0, d1), min(d2, d3));
+    // odd sized sources: the last destination texel also covers the extra row/column
+    if (pixel.x * 2 + 2 == maxSource.x)
+        closest = min(closest, min(imageLoad(sourceLevel, ivec2(maxSource.x, source.y)).r, imageLoad(sourceLevel, ivec2(maxSource.x, min(source.y + 1, maxSource.y))).r));
+    if (pixel.y * 2 + 2 == maxSource.y)
+        closest = min(closest, min(imageLoad(sourceLevel, ivec2(source.x, maxSource.y)).r, imageLoad(sourceLevel, ivec2(min(source.x + 1, maxSource.x), maxSource.y)).r));
+    imageStore(destinationLevel, pixel, vec4(closest));
+}
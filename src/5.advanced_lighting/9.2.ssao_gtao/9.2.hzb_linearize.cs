@@ -0,0 +1,20 @@
+#version 430 core
+
+// first level of the hierarchical depth buffer: linear view-space depth (distance along the
+// view direction) of every G-buffer pixel
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout (r32f, binding = 0) uniform writeonly image2D hzbLevel0;
+
+uniform sampler2D gDepth;
+uniform mat4 projection;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(pixel, imageSize(hzbLevel0))))
+        return;
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    float linearDepth = projection[3][2] / ((depth * 2.0 - 1.0) + projection[2][2]);
+    imageStore(hzbLevel0, pixel, vec4(linearDepth));
+}
@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 1) out vec2 gNormal;
+layout (location = 2) out vec3 gAlbedo;
+
+in vec2 TexCoords;
+in vec3 FragPos;
+in vec3 Normal;
+
+// map a unit vector onto the octahedron and unfold it into [0, 1]^2
+vec2 octahedralEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return e * 0.5 + 0.5;
+}
+
+void main()
+{    
+    // no position output: the view-space position is reconstructed from the depth buffer
+    // store the view-space normal octahedral encoded into two 16 bit channels
+    gNormal = octahedralEncode(normalize(Normal));
+    // and the diffuse per-fragment color
+    gAlbedo.rgb = vec3(0.95);
+}
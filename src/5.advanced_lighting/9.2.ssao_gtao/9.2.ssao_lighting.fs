@@ -0,0 +1,72 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoords;
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+uniform sampler2D gAlbedo;
+uniform sampler2D ssao;
+
+struct Light {
+    vec3 Position;
+    vec3 Color;
+    
+    float Linear;
+    float Quadratic;
+};
+uniform Light light;
+uniform mat4 inverseProjection;
+uniform bool octahedralNormals; // thin G-buffer layout
+uniform bool showOcclusion;
+
+vec3 octahedralDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+// un-project the stored depth back into a view-space position
+vec3 reconstructPosition(vec2 texCoords)
+{
+    vec4 clipPos = vec4(vec3(texCoords, texture(gDepth, texCoords).r) * 2.0 - 1.0, 1.0);
+    vec4 viewPos = inverseProjection * clipPos;
+    return viewPos.xyz / viewPos.w;
+}
+
+void main()
+{             
+    // retrieve data from gbuffer
+    vec3 FragPos = reconstructPosition(TexCoords);
+    vec3 Normal = octahedralNormals ? octahedralDecode(texture(gNormal, TexCoords).rg) : texture(gNormal, TexCoords).rgb;
+    vec3 Diffuse = texture(gAlbedo, TexCoords).rgb;
+    float AmbientOcclusion = texture(ssao, TexCoords).r;
+    if (showOcclusion)
+    {
+        FragColor = vec4(vec3(AmbientOcclusion), 1.0);
+        return;
+    }
+    
+    // then calculate lighting as usual
+    vec3 ambient = vec3(0.3 * Diffuse * AmbientOcclusion);
+    vec3 lighting  = ambient; 
+    vec3 viewDir  = normalize(-FragPos); // viewpos is (0.0.0)
+    // diffuse
+    vec3 lightDir = normalize(light.Position - FragPos);
+    vec3 diffuse = max(dot(Normal, lightDir), 0.0) * Diffuse * light.Color;
+    // specular
+    vec3 halfwayDir = normalize(lightDir + viewDir);  
+    float spec = pow(max(dot(Normal, halfwayDir), 0.0), 8.0);
+    vec3 specular = light.Color * spec;
+    // attenuation
+    float distance = length(light.Position - FragPos);
+    float attenuation = 1.0 / (1.0 + light.Linear * distance + light.Quadratic * distance * distance);
+    diffuse *= attenuation;
+    specular *= attenuation;
+    lighting += diffuse + specular;
+
+    FragColor = vec4(lighting, 1.0);
+}
@@ -0,0 +1,565 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
+#include <learnopengl/gpu_timer.h>
+#include <learnopengl/gtao.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+void renderQuad();
+void renderCube();
+unsigned int createAOTexture();
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+// camera
+Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
+float lastX = (float)SCR_WIDTH / 2.0;
+float lastY = (float)SCR_HEIGHT / 2.0;
+bool firstMouse = true;
+
+// g-buffer layout, toggled with G
+GBufferLayout gbufferLayout = GBUFFER_FAT;
+bool gbufferLayoutChanged = false;
+bool gbufferKeyPressed = false;
+
+// GTAO presets, selected with 1-3. Samples per pixel are slices * 2 sides * steps; the medium
+// preset takes 16, a quarter of the 64 sample hemisphere kernel of 9.ssao
+struct GTAOPreset
+{
+    const char* Name;
+    int SliceCount;
+    int StepsPerSide;
+};
+const GTAOPreset GTAO_PRESETS[] = {
+    { "low: 1 slice x 4 steps",    1, 4 },
+    { "medium: 2 slices x 4 steps", 2, 4 },
+    { "high: 4 slices x 8 steps",  4, 8 },
+};
+const unsigned int NR_GTAO_PRESETS = sizeof(GTAO_PRESETS) / sizeof(GTAO_PRESETS[0]);
+unsigned int gtaoPreset = 1;
+bool gtaoPresetChanged = true;
+bool showOcclusion = false; // toggled with O
+bool occlusionKeyPressed = false;
+
+// GPU timer readouts, printed every 100 frames
+enum TimerStage {
+    TIMER_GEOMETRY,
+    TIMER_HZB,
+    TIMER_GTAO,
+    TIMER_DENOISE,
+    TIMER_LIGHTING,
+    TIMER_STAGE_COUNT
+};
+const char* TIMER_STAGE_NAMES[] = { "geometry", "hzb", "gtao", "denoise", "lighting" };
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+int main()
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+
+    // check the slice integral used by the compute shader against its CPU reference
+    // -----------------------------------------------------------------------------
+    float maxIntegralError, maxUnoccludedError;
+    GTAOValidate(maxIntegralError, maxUnoccludedError);
+    std::cout << "gtao reference: closed form vs numeric integral max error " << maxIntegralError
+              << ", unoccluded visibility max error " << maxUnoccludedError << std::endl;
+
+    // build and compile shaders
+    // -------------------------
+    Shader shaderGeometryPass("9.2.ssao_geometry.vs", "9.2.ssao_geometry.fs");
+    Shader shaderGeometryPassThin("9.2.ssao_geometry.vs", "9.2.ssao_geometry_thin.fs");
+    Shader shaderLightingPass("9.2.ssao.vs", "9.2.ssao_lighting.fs");
+    ComputeShader shaderHZBLinearize("9.2.hzb_linearize.cs");
+    ComputeShader shaderHZBDownsample("9.2.hzb_downsample.cs");
+    ComputeShader shaderGTAO("9.2.gtao.cs");
+    ComputeShader shaderDenoise("9.2.gtao_denoise.cs");
+
+    // load models
+    // -----------
+    Model backpack(FileSystem::getPath("resources/objects/backpack/backpack.obj"));
+
+    // configure g-buffer framebuffer
+    // ------------------------------
+    GBuffer gBuffer;
+    gBuffer.Create(gbufferLayout, SCR_WIDTH, SCR_HEIGHT);
+    gBuffer.PrintReport(2); // read by the GTAO and the lighting pass
+
+    // hierarchical depth buffer: linear depth with a full mip chain
+    // -------------------------------------------------------------
+    const int hzbLevels = 1 + (int)std::floor(std::log2((float)std::max(SCR_WIDTH, SCR_HEIGHT)));
+    unsigned int hzbTexture;
+    glGenTextures(1, &hzbTexture);
+    glBindTexture(GL_TEXTURE_2D, hzbTexture);
+    glTexStorage2D(GL_TEXTURE_2D, hzbLevels, GL_R32F, SCR_WIDTH, SCR_HEIGHT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // raw and denoised ambient occlusion
+    // ----------------------------------
+    unsigned int aoTexture = createAOTexture();
+    unsigned int aoDenoisedTexture = createAOTexture();
+
+    // lighting info
+    // -------------
+    glm::vec3 lightPos = glm::vec3(2.0, 4.0, -2.0);
+    glm::vec3 lightColor = glm::vec3(0.2, 0.2, 0.7);
+
+    // shader configuration
+    // --------------------
+    shaderLightingPass.use();
+    shaderLightingPass.setInt("gDepth", 0);
+    shaderLightingPass.setInt("gNormal", 1);
+    shaderLightingPass.setInt("gAlbedo", 2);
+    shaderLightingPass.setInt("ssao", 3);
+    shaderHZBLinearize.use();
+    shaderHZBLinearize.setInt("gDepth", 0);
+    shaderGTAO.use();
+    shaderGTAO.setInt("hzb", 0);
+    shaderGTAO.setInt("gNormal", 1);
+    shaderGTAO.setVec2("resolution", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+    shaderGTAO.setFloat("radius", 0.5f);
+    shaderGTAO.setFloat("maxLevel", (float)(hzbLevels - 1));
+    shaderDenoise.use();
+    shaderDenoise.setInt("aoInput", 0);
+    shaderDenoise.setInt("hzb", 1);
+    shaderDenoise.setFloat("depthSharpness", 20.0f);
+
+    GpuTimer timers[TIMER_STAGE_COUNT];
+    unsigned int frameCounter = 0;
+    const unsigned int groupsX = (SCR_WIDTH + 7) / 8;
+    const unsigned int groupsY = (SCR_HEIGHT + 7) / 8;
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = static_cast<float>(glfwGetTime());
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+        if (gbufferLayoutChanged)
+        {
+            gBuffer.Create(gbufferLayout, SCR_WIDTH, SCR_HEIGHT);
+            gBuffer.PrintReport(2);
+            gbufferLayoutChanged = false;
+        }
+        const GTAOPreset& preset = GTAO_PRESETS[gtaoPreset];
+        if (gtaoPresetChanged)
+        {
+            for (unsigned int i = 0; i < TIMER_STAGE_COUNT; i++)
+                timers[i].Reset();
+            std::cout << "gtao preset: " << preset.Name << " (" << preset.SliceCount * 2 * preset.StepsPerSide << " samples per pixel)" << std::endl;
+            gtaoPresetChanged = false;
+        }
+        const bool thin = gbufferLayout == GBUFFER_THIN;
+        Shader& geometryPass = thin ? shaderGeometryPassThin : shaderGeometryPass;
+
+        // render
+        // ------
+        glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // 1. geometry pass: render scene's geometry/color data into gbuffer
+        // -----------------------------------------------------------------
+        timers[TIMER_GEOMETRY].Begin();
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.FBO);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 50.0f);
+            glm::mat4 view = camera.GetViewMatrix();
+            glm::mat4 model = glm::mat4(1.0f);
+            geometryPass.use();
+            geometryPass.setMat4("projection", projection);
+            geometryPass.setMat4("view", view);
+            // room cube
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(0.0, 7.0f, 0.0f));
+            model = glm::scale(model, glm::vec3(7.5f, 7.5f, 7.5f));
+            geometryPass.setMat4("model", model);
+            geometryPass.setInt("invertedNormals", 1); // invert normals as we're inside the cube
+            renderCube();
+            geometryPass.setInt("invertedNormals", 0); 
+            // backpack model on the floor
+            model = glm::mat4(1.0f);
+            model = glm::translate(model, glm::vec3(0.0f, 0.5f, 0.0));
+            model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
+            model = glm::scale(model, glm::vec3(1.0f));
+            geometryPass.setMat4("model", model);
+            backpack.Draw(geometryPass);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        timers[TIMER_GEOMETRY].End();
+
+        // 2. build the hierarchical depth buffer: linearize the depth, then reduce level by level
+        // ----------------------------------------------------------------------------------------
+        timers[TIMER_HZB].Begin();
+        shaderHZBLinearize.use();
+        shaderHZBLinearize.setMat4("projection", projection);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+        glBindImageTexture(0, hzbTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+        glDispatchCompute(groupsX, groupsY, 1);
+        shaderHZBDownsample.use();
+        for (int level = 1; level < hzbLevels; level++)
+        {
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            unsigned int levelWidth = std::max(1u, SCR_WIDTH >> level);
+            unsigned int levelHeight = std::max(1u, SCR_HEIGHT >> level);
+            glBindImageTexture(0, hzbTexture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+            glBindImageTexture(1, hzbTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            glDispatchCompute((levelWidth + 7) / 8, (levelHeight + 7) / 8, 1);
+        }
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        timers[TIMER_HZB].End();
+
+        // 3. GTAO: horizon search and analytic integration per slice
+        // -----------------------------------------------------------
+        timers[TIMER_GTAO].Begin();
+        shaderGTAO.use();
+        shaderGTAO.setBool("octahedralNormals", thin);
+        shaderGTAO.setMat4("projection", projection);
+        shaderGTAO.setInt("sliceCount", preset.SliceCount);
+        shaderGTAO.setInt("stepsPerSide", preset.StepsPerSide);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, hzbTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+        glBindImageTexture(0, aoTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16F);
+        glDispatchCompute(groupsX, groupsY, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        timers[TIMER_GTAO].End();
+
+        // 4. remove the interleaved noise with a depth-aware 4x4 blur
+        // ------------------------------------------------------------
+        timers[TIMER_DENOISE].Begin();
+        shaderDenoise.use();
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, aoTexture);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, hzbTexture);
+        glBindImageTexture(0, aoDenoisedTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R16F);
+        glDispatchCompute(groupsX, groupsY, 1);
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        timers[TIMER_DENOISE].End();
+
+        // 5. lighting pass: traditional deferred Blinn-Phong lighting with added ambient occlusion
+        // -----------------------------------------------------------------------------------------
+        timers[TIMER_LIGHTING].Begin();
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        shaderLightingPass.use();
+        // send light relevant uniforms
+        glm::vec3 lightPosView = glm::vec3(camera.GetViewMatrix() * glm::vec4(lightPos, 1.0));
+        shaderLightingPass.setVec3("light.Position", lightPosView);
+        shaderLightingPass.setVec3("light.Color", lightColor);
+        // Update attenuation parameters
+        const float linear    = 0.09f;
+        const float quadratic = 0.032f;
+        shaderLightingPass.setFloat("light.Linear", linear);
+        shaderLightingPass.setFloat("light.Quadratic", quadratic);
+        shaderLightingPass.setMat4("inverseProjection", glm::inverse(projection));
+        shaderLightingPass.setBool("octahedralNormals", thin);
+        shaderLightingPass.setBool("showOcclusion", showOcclusion);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.AlbedoSpec);
+        glActiveTexture(GL_TEXTURE3); // add extra AO texture to lighting pass
+        glBindTexture(GL_TEXTURE_2D, aoDenoisedTexture);
+        renderQuad();
+        timers[TIMER_LIGHTING].End();
+
+        if (++frameCounter >= 100)
+        {
+            std::cout << std::fixed << std::setprecision(3);
+            for (unsigned int i = 0; i < TIMER_STAGE_COUNT; i++)
+            {
+                std::cout << TIMER_STAGE_NAMES[i] << ": " << timers[i].AverageMs() << " ms | ";
+                timers[i].Reset();
+            }
+            std::cout << "(" << preset.Name << ")" << std::endl;
+            frameCounter = 0;
+        }
+
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    glfwTerminate();
+    return 0;
+}
+
+// creates a single channel texture the compute passes write ambient occlusion into
+// ---------------------------------------------------------------------------------
+unsigned int createAOTexture()
+{
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R16F, SCR_WIDTH, SCR_HEIGHT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
+
+// renderCube() renders a 1x1 3D cube in NDC.
+// -------------------------------------------------
+unsigned int cubeVAO = 0;
+unsigned int cubeVBO = 0;
+void renderCube()
+{
+    // initialize (if necessary)
+    if (cubeVAO == 0)
+    {
+        float vertices[] = {
+            // back face
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 0.0f, // bottom-right         
+             1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 1.0f, 1.0f, // top-right
+            -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 0.0f, // bottom-left
+            -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, -1.0f, 0.0f, 1.0f, // top-left
+            // front face
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+             1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 1.0f, 1.0f, // top-right
+            -1.0f,  1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 1.0f, // top-left
+            -1.0f, -1.0f,  1.0f,  0.0f,  0.0f,  1.0f, 0.0f, 0.0f, // bottom-left
+            // left face
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            -1.0f,  1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f, -1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f,  1.0f, -1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-right
+            // right face
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 1.0f, // top-right         
+             1.0f, -1.0f, -1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 1.0f, // bottom-right
+             1.0f,  1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 1.0f, 0.0f, // top-left
+             1.0f, -1.0f,  1.0f,  1.0f,  0.0f,  0.0f, 0.0f, 0.0f, // bottom-left     
+            // bottom face
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+             1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 1.0f, // top-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+             1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 1.0f, 0.0f, // bottom-left
+            -1.0f, -1.0f,  1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 0.0f, // bottom-right
+            -1.0f, -1.0f, -1.0f,  0.0f, -1.0f,  0.0f, 0.0f, 1.0f, // top-right
+            // top face
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+             1.0f,  1.0f , 1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+             1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 1.0f, // top-right     
+             1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 1.0f, 0.0f, // bottom-right
+            -1.0f,  1.0f, -1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 1.0f, // top-left
+            -1.0f,  1.0f,  1.0f,  0.0f,  1.0f,  0.0f, 0.0f, 0.0f  // bottom-left        
+        };
+        glGenVertexArrays(1, &cubeVAO);
+        glGenBuffers(1, &cubeVBO);
+        // fill buffer
+        glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+        // link vertex attributes
+        glBindVertexArray(cubeVAO);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindVertexArray(0);
+    }
+    // render Cube
+    glBindVertexArray(cubeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 36);
+    glBindVertexArray(0);
+}
+
+
+// renderQuad() renders a 1x1 XY quad in NDC
+// -----------------------------------------
+unsigned int quadVAO = 0;
+unsigned int quadVBO;
+void renderQuad()
+{
+    if (quadVAO == 0)
+    {
+        float quadVertices[] = {
+            // positions        // texture Coords
+            -1.0f,  1.0f, 0.0f, 0.0f, 1.0f,
+            -1.0f, -1.0f, 0.0f, 0.0f, 0.0f,
+             1.0f,  1.0f, 0.0f, 1.0f, 1.0f,
+             1.0f, -1.0f, 0.0f, 1.0f, 0.0f,
+        };
+        // setup plane VAO
+        glGenVertexArrays(1, &quadVAO);
+        glGenBuffers(1, &quadVBO);
+        glBindVertexArray(quadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(float)));
+    }
+    glBindVertexArray(quadVAO);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    glBindVertexArray(0);
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gbufferKeyPressed)
+    {
+        gbufferLayout = gbufferLayout == GBUFFER_FAT ? GBUFFER_THIN : GBUFFER_FAT;
+        gbufferLayoutChanged = true;
+        gbufferKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+    {
+        gbufferKeyPressed = false;
+    }
+
+    for (unsigned int i = 0; i < NR_GTAO_PRESETS; i++)
+    {
+        if (glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS && gtaoPreset != i)
+        {
+            gtaoPreset = i;
+            gtaoPresetChanged = true;
+        }
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_PRESS && !occlusionKeyPressed)
+    {
+        showOcclusion = !showOcclusion;
+        occlusionKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_O) == GLFW_RELEASE)
+    {
+        occlusionKeyPressed = false;
+    }
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and 
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xposIn, double yposIn)
+{
+    float xpos = static_cast<float>(xposIn);
+    float ypos = static_cast<float>(yposIn);
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(static_cast<float>(yoffset));
+}
@@ -0,0 +1,32 @@
+#version 330 core
+out float FragColor;
+
+// 4x4 depth-aware blur at low resolution. The window matches the interleaving tile of
+// 9.ssao_interleaved.fs, so every output combines all 16 kernels; neighbours on other
+// surfaces (large relative depth difference) get little weight so AO doesn't bleed over edges.
+
+uniform sampler2D ssaoInput;
+uniform sampler2D prepared;
+
+uniform float depthSharpness;
+
+void main() 
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    ivec2 size = textureSize(ssaoInput, 0);
+    float centerZ = texelFetch(prepared, pixel, 0).w;
+    float result = 0.0;
+    float totalWeight = 0.0;
+    for (int x = -2; x < 2; ++x) 
+    {
+        for (int y = -2; y < 2; ++y) 
+        {
+            ivec2 coord = clamp(pixel + ivec2(x, y), ivec2(0), size - 1);
+            float sampleZ = texelFetch(prepared, coord, 0).w;
+            float weight = exp(-depthSharpness * abs(sampleZ - centerZ) / abs(centerZ));
+            result += texelFetch(ssaoInput, coord, 0).r * weight;
+            totalWeight += weight;
+        }
+    }
+    FragColor = result / totalWeight;
+}
@@ -0,0 +1,67 @@
+#version 330 core
+out float FragColor;
+
+in vec2 TexCoords;
+
+// Low resolution SSAO with interleaved sampling: each pixel of a 4x4 tile uses its own kernel
+// (one row of sampleKernels), so a 4x4 blur afterwards combines 16x the per-pixel sample count.
+
+uniform sampler2D prepared;      // view-space normal + linear depth, see 9.ssao_prepare.fs
+uniform sampler2D sampleKernels; // kernelSize x 16 texels, one kernel per tile pixel
+uniform sampler2D texNoise;
+
+uniform int kernelSize;
+uniform int downsample;
+uniform vec2 fullResolution;
+uniform float temporalRotation; // extra rotation per frame so temporal accumulation sees new samples
+
+// parameters (you'd probably want to use them as uniforms to more easily tweak the effect)
+float radius = 0.5;
+float bias = 0.025;
+
+uniform mat4 projection;
+
+// view-space position of a low resolution texel from its stored linear depth
+vec3 viewPosition(ivec2 pixel, float viewZ)
+{
+    vec2 uv = (vec2(pixel * downsample) + 0.5) / fullResolution;
+    return vec3((uv * 2.0 - 1.0) * -viewZ / vec2(projection[0][0], projection[1][1]), viewZ);
+}
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 center = texelFetch(prepared, pixel, 0);
+    vec3 fragPos = viewPosition(pixel, center.w);
+    vec3 normal = center.xyz;
+
+    // rotate the tile's random vector around the tangent-space z-axis
+    vec2 noise = texelFetch(texNoise, pixel & 3, 0).xy;
+    float s = sin(temporalRotation), c = cos(temporalRotation);
+    vec3 randomVec = normalize(vec3(c * noise.x - s * noise.y, s * noise.x + c * noise.y, 0.0));
+    // create TBN change-of-basis matrix: from tangent-space to view-space
+    vec3 tangent = normalize(randomVec - normal * dot(randomVec, normal));
+    vec3 bitangent = cross(normal, tangent);
+    mat3 TBN = mat3(tangent, bitangent, normal);
+
+    int pattern = (pixel.x & 3) + 4 * (pixel.y & 3);
+    float occlusion = 0.0;
+    for(int i = 0; i < kernelSize; ++i)
+    {
+        // get sample position
+        vec3 samplePos = TBN * texelFetch(sampleKernels, ivec2(i, pattern), 0).xyz; // from tangent to view-space
+        samplePos = fragPos + samplePos * radius;
+
+        // project sample position (to sample texture) (to get position on screen/texture)
+        vec4 offset = projection * vec4(samplePos, 1.0);
+        offset.xy = (offset.xy / offset.w) * 0.5 + 0.5;
+
+        // get sample depth from the low resolution depth
+        float sampleDepth = texture(prepared, offset.xy).w;
+
+        // range check & accumulate
+        float rangeCheck = smoothstep(0.0, 1.0, radius / abs(fragPos.z - sampleDepth));
+        occlusion += (sampleDepth >= samplePos.z + bias ? 1.0 : 0.0) * rangeCheck;
+    }
+    FragColor = 1.0 - (occlusion / float(kernelSize));
+}
@@ -0,0 +1,32 @@
+#version 330 core
+out vec4 FragColor;
+
+// Downsamples the G-buffer for the optimized SSAO path: every low resolution texel takes the
+// top-left full resolution texel of its block (no averaging, so depths stay on real surfaces)
+// and stores the view-space normal in xyz and the linear view-space depth in w.
+
+uniform sampler2D gDepth;
+uniform sampler2D gNormal;
+
+uniform bool octahedralNormals; // thin G-buffer layout
+uniform int downsample;
+uniform mat4 projection;
+
+vec3 octahedralDecode(vec2 e)
+{
+    e = e * 2.0 - 1.0;
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t);
+    return normalize(n);
+}
+
+void main()
+{
+    ivec2 fullResPixel = ivec2(gl_FragCoord.xy) * downsample;
+    float depth = texelFetch(gDepth, fullResPixel, 0).r;
+    float viewZ = -projection[3][2] / ((depth * 2.0 - 1.0) + projection[2][2]);
+    vec3 normal = octahedralNormals ? octahedralDecode(texelFetch(gNormal, fullResPixel, 0).rg)
+                                    : normalize(texelFetch(gNormal, fullResPixel, 0).rgb);
+    FragColor = vec4(normal, viewZ);
+}
@@ -0,0 +1,40 @@
+#version 330 core
+out vec2 FragColor;
+
+// Blends the new low resolution AO with last frame's result reprojected to this pixel. History
+// stores (ao, view-space depth) so samples whose surface moved or was disoccluded are rejected.
+
+uniform sampler2D occlusion;
+uniform sampler2D prepared;
+uniform sampler2D history;
+
+uniform bool historyValid;
+uniform float blendFactor;       // weight of the new frame
+uniform int downsample;
+uniform vec2 fullResolution;
+uniform mat4 projection;
+uniform mat4 previousProjection;
+uniform mat4 currentToPreviousView;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float ao = texelFetch(occlusion, pixel, 0).r;
+    float viewZ = texelFetch(prepared, pixel, 0).w;
+    vec2 uv = (vec2(pixel * downsample) + 0.5) / fullResolution;
+    vec3 viewPos = vec3((uv * 2.0 - 1.0) * -viewZ / vec2(projection[0][0], projection[1][1]), viewZ);
+
+    // where was this surface point last frame?
+    vec3 previousViewPos = (currentToPreviousView * vec4(viewPos, 1.0)).xyz;
+    vec4 previousClip = previousProjection * vec4(previousViewPos, 1.0);
+    vec2 previousUV = (previousClip.xy / previousClip.w) * 0.5 + 0.5;
+
+    if (historyValid && all(greaterThanEqual(previousUV, vec2(0.0))) && all(lessThanEqual(previousUV, vec2(1.0))))
+    {
+        vec2 previous = texture(history, previousUV).rg;
+        // accept the history only if it saw (roughly) the same depth
+        if (abs(previous.g - previousViewPos.z) < 0.05 * abs(previousViewPos.z))
+            ao = mix(previous.r, ao, blendFactor);
+    }
+    FragColor = vec2(ao, viewZ);
+}
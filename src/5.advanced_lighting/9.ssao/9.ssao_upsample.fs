@@ -0,0 +1,43 @@
+#version 330 core
+out float FragColor;
+
+// Joint bilateral upsample of the low resolution AO: the four low resolution texels around a
+// full resolution pixel are weighted bilinearly and by how close their depth is to the pixel's
+// own depth, which keeps silhouettes sharp where plain bilinear filtering would leak AO.
+
+uniform sampler2D ssaoInput;
+uniform sampler2D prepared;
+uniform sampler2D gDepth;
+
+uniform int downsample;
+uniform float depthSharpness;
+uniform mat4 projection;
+
+void main()
+{
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    float depth = texelFetch(gDepth, pixel, 0).r;
+    float viewZ = -projection[3][2] / ((depth * 2.0 - 1.0) + projection[2][2]);
+
+    // low resolution texel i sits on full resolution pixel i * downsample
+    vec2 lowResCoord = vec2(pixel) / float(downsample);
+    ivec2 base = ivec2(floor(lowResCoord));
+    vec2 f = lowResCoord - vec2(base);
+    ivec2 maxCoord = textureSize(ssaoInput, 0) - 1;
+
+    float result = 0.0;
+    float totalWeight = 0.0;
+    for (int y = 0; y < 2; ++y)
+    {
+        for (int x = 0; x < 2; ++x)
+        {
+            ivec2 coord = min(base + ivec2(x, y), maxCoord);
+            float bilinear = (x == 0 ? 1.0 - f.x : f.x) * (y == 0 ? 1.0 - f.y : f.y);
+            float sampleZ = texelFetch(prepared, coord, 0).w;
+            float weight = (bilinear + 1e-3) * exp(-depthSharpness * abs(sampleZ - viewZ) / abs(viewZ));
+            result += texelFetch(ssaoInput, coord, 0).r * weight;
+            totalWeight += weight;
+        }
+    }
+    FragColor = result / max(totalWeight, 1e-5);
+}
@@ -9,8 +9,11 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gbuffer.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
 #include <random>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -21,6 +24,19 @@ unsigned int loadTexture(const char *path, bool gammaCorrection);
 void renderQuad();
 void renderCube();
 
+// render targets of the optimized SSAO path, all at 1/Downsample of the screen resolution
+struct LowResTargets
+{
+    unsigned int Width = 0, Height = 0;
+    unsigned int PrepareFBO = 0, Prepared = 0;       // view-space normal + linear depth
+    unsigned int OcclusionFBO = 0, Occlusion = 0;    // raw interleaved AO
+    unsigned int HistoryFBO[2] = { 0, 0 }, History[2] = { 0, 0 }; // temporally accumulated (ao, depth)
+    unsigned int BlurFBO = 0, Blur = 0;              // bilateral blurred AO
+};
+void createLowResTargets(LowResTargets& targets, unsigned int downsample);
+void releaseLowResTargets(LowResTargets& targets);
+void generateInterleavedKernels(unsigned int kernelSize, unsigned int kernelTexture);
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -31,6 +47,46 @@ float lastX = (float)SCR_WIDTH / 2.0;
 float lastY = (float)SCR_HEIGHT / 2.0;
 bool firstMouse = true;
 
+// g-buffer layout, toggled with G
+GBufferLayout gbufferLayout = GBUFFER_FAT;
+bool gbufferLayoutChanged = false;
+bool gbufferKeyPressed = false;
+
+// SSAO presets, selected with 1-4. The first one is the original full resolution path; the
+// others compute AO at reduced resolution with interleaved kernels and upsample it bilaterally
+struct SSAOPreset
+{
+    const char* Name;
+    bool Optimized;
+    unsigned int Downsample;
+    unsigned int KernelSize;
+    bool Temporal;
+};
+const SSAOPreset SSAO_PRESETS[] = {
+    { "reference: full res, 64 samples",              false, 1, 64, false },
+    { "quality: half res, 16 samples",                true,  2, 16, false },
+    { "balanced: half res, 8 samples, temporal",      true,  2,  8, true  },
+    { "fast: quarter res, 8 samples, temporal",       true,  4,  8, true  },
+};
+const unsigned int NR_SSAO_PRESETS = sizeof(SSAO_PRESETS) / sizeof(SSAO_PRESETS[0]);
+unsigned int ssaoPreset = 1;
+bool ssaoPresetChanged = true;
+bool temporalEnabled = false;  // toggled with T
+bool temporalKeyPressed = false;
+
+// GPU timer readouts, printed every 100 frames
+enum TimerStage {
+    TIMER_GEOMETRY,
+    TIMER_PREPARE,
+    TIMER_OCCLUSION,
+    TIMER_TEMPORAL,
+    TIMER_BLUR,
+    TIMER_UPSAMPLE,
+    TIMER_LIGHTING,
+    TIMER_STAGE_COUNT
+};
+const char* TIMER_STAGE_NAMES[] = { "geometry", "prepare", "ao", "temporal", "blur", "upsample", "lighting" };
+
 // timing
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
@@ -88,6 +144,14 @@ int main()
     Shader shaderLightingPass("9.ssao.vs", "9.ssao_lighting.fs");
     Shader shaderSSAO("9.ssao.vs", "9.ssao.fs");
     Shader shaderSSAOBlur("9.ssao.vs", "9.ssao_blur.fs");
+    Shader shaderGeometryPassThin("9.ssao_geometry.vs", "9.ssao_geometry_thin.fs");
+    Shader shaderLightingPassThin("9.ssao.vs", "9.ssao_lighting_thin.fs");
+    Shader shaderSSAOThin("9.ssao.vs", "9.ssao_thin.fs");
+    Shader shaderSSAOPrepare("9.ssao.vs", "9.ssao_prepare.fs");
+    Shader shaderSSAOInterleaved("9.ssao.vs", "9.ssao_interleaved.fs");
+    Shader shaderSSAOTemporal("9.ssao.vs", "9.ssao_temporal.fs");
+    Shader shaderSSAOBilateral("9.ssao.vs", "9.ssao_bilateral.fs");
+    Shader shaderSSAOUpsample("9.ssao.vs", "9.ssao_upsample.fs");
 
     // load models
     // -----------
@@ -95,46 +159,9 @@ int main()
 
     // configure g-buffer framebuffer
     // ------------------------------
-    unsigned int gBuffer;
-    glGenFramebuffers(1, &gBuffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
-    unsigned int gPosition, gNormal, gAlbedo;
-    // position color buffer
-    glGenTextures(1, &gPosition);
-    glBindTexture(GL_TEXTURE_2D, gPosition);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gPosition, 0);
-    // normal color buffer
-    glGenTextures(1, &gNormal);
-    glBindTexture(GL_TEXTURE_2D, gNormal);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_FLOAT, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, gNormal, 0);
-    // color + specular color buffer
-    glGenTextures(1, &gAlbedo);
-    glBindTexture(GL_TEXTURE_2D, gAlbedo);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, gAlbedo, 0);
-    // tell OpenGL which color attachments we'll use (of this framebuffer) for rendering 
-    unsigned int attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
-    glDrawBuffers(3, attachments);
-    // create and attach depth buffer (renderbuffer)
-    unsigned int rboDepth;
-    glGenRenderbuffers(1, &rboDepth);
-    glBindRenderbuffer(GL_RENDERBUFFER, rboDepth);
-    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT, SCR_WIDTH, SCR_HEIGHT);
-    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, rboDepth);
-    // finally check if framebuffer is complete
-    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
-        std::cout << "Framebuffer not complete!" << std::endl;
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GBuffer gBuffer;
+    gBuffer.Create(gbufferLayout, SCR_WIDTH, SCR_HEIGHT);
+    gBuffer.PrintReport(2); // read by the SSAO and the lighting pass
 
     // also create framebuffer to hold SSAO processing stage 
     // -----------------------------------------------------
@@ -197,6 +224,14 @@ int main()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
+    // the optimized path's 16 interleaved kernels (one per pixel of a 4x4 tile) live in a
+    // kernelSize x 16 texture, filled whenever a preset is selected
+    unsigned int kernelTexture; glGenTextures(1, &kernelTexture);
+    glBindTexture(GL_TEXTURE_2D, kernelTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    LowResTargets lowRes;
+
     // lighting info
     // -------------
     glm::vec3 lightPos = glm::vec3(2.0, 4.0, -2.0);
@@ -215,6 +250,45 @@ int main()
     shaderSSAO.setInt("texNoise", 2);
     shaderSSAOBlur.use();
     shaderSSAOBlur.setInt("ssaoInput", 0);
+    shaderLightingPassThin.use();
+    shaderLightingPassThin.setInt("gDepth", 0);
+    shaderLightingPassThin.setInt("gNormal", 1);
+    shaderLightingPassThin.setInt("gAlbedo", 2);
+    shaderLightingPassThin.setInt("ssao", 3);
+    shaderSSAOThin.use();
+    shaderSSAOThin.setInt("gDepth", 0);
+    shaderSSAOThin.setInt("gNormal", 1);
+    shaderSSAOThin.setInt("texNoise", 2);
+    shaderSSAOPrepare.use();
+    shaderSSAOPrepare.setInt("gDepth", 0);
+    shaderSSAOPrepare.setInt("gNormal", 1);
+    shaderSSAOInterleaved.use();
+    shaderSSAOInterleaved.setInt("prepared", 0);
+    shaderSSAOInterleaved.setInt("sampleKernels", 1);
+    shaderSSAOInterleaved.setInt("texNoise", 2);
+    shaderSSAOInterleaved.setVec2("fullResolution", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+    shaderSSAOTemporal.use();
+    shaderSSAOTemporal.setInt("occlusion", 0);
+    shaderSSAOTemporal.setInt("prepared", 1);
+    shaderSSAOTemporal.setInt("history", 2);
+    shaderSSAOTemporal.setFloat("blendFactor", 0.15f);
+    shaderSSAOTemporal.setVec2("fullResolution", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+    shaderSSAOBilateral.use();
+    shaderSSAOBilateral.setInt("ssaoInput", 0);
+    shaderSSAOBilateral.setInt("prepared", 1);
+    shaderSSAOBilateral.setFloat("depthSharpness", 20.0f);
+    shaderSSAOUpsample.use();
+    shaderSSAOUpsample.setInt("ssaoInput", 0);
+    shaderSSAOUpsample.setInt("prepared", 1);
+    shaderSSAOUpsample.setInt("gDepth", 2);
+    shaderSSAOUpsample.setFloat("depthSharpness", 20.0f);
+
+    GpuTimer timers[TIMER_STAGE_COUNT];
+    unsigned int frameCounter = 0;
+    unsigned int frameIndex = 0;
+    unsigned int historyIndex = 0;
+    bool historyValid = false;
+    glm::mat4 previousView(1.0f), previousProjection(1.0f);
 
     // render loop
     // -----------
@@ -229,6 +303,33 @@ int main()
         // input
         // -----
         processInput(window);
+        if (gbufferLayoutChanged)
+        {
+            gBuffer.Create(gbufferLayout, SCR_WIDTH, SCR_HEIGHT);
+            gBuffer.PrintReport(2);
+            gbufferLayoutChanged = false;
+        }
+        const SSAOPreset& preset = SSAO_PRESETS[ssaoPreset];
+        if (ssaoPresetChanged)
+        {
+            if (preset.Optimized)
+            {
+                createLowResTargets(lowRes, preset.Downsample);
+                generateInterleavedKernels(preset.KernelSize, kernelTexture);
+            }
+            temporalEnabled = preset.Temporal;
+            historyValid = false;
+            for (unsigned int i = 0; i < TIMER_STAGE_COUNT; i++)
+                timers[i].Reset();
+            std::cout << "ssao preset: " << preset.Name << " (T toggles temporal accumulation)" << std::endl;
+            ssaoPresetChanged = false;
+        }
+        const bool thin = gbufferLayout == GBUFFER_THIN;
+        Shader& geometryPass = thin ? shaderGeometryPassThin : shaderGeometryPass;
+        Shader& lightingPass = thin ? shaderLightingPassThin : shaderLightingPass;
+        Shader& ssaoPass = thin ? shaderSSAOThin : shaderSSAO;
+        // the thin layout has no position buffer; its shaders reconstruct the position from depth
+        unsigned int positionSource = thin ? gBuffer.Depth : gBuffer.Position;
 
         // render
         // ------
@@ -237,84 +338,207 @@ int main()
 
         // 1. geometry pass: render scene's geometry/color data into gbuffer
         // -----------------------------------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer);
+        timers[TIMER_GEOMETRY].Begin();
+        glBindFramebuffer(GL_FRAMEBUFFER, gBuffer.FBO);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
             glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 50.0f);
             glm::mat4 view = camera.GetViewMatrix();
             glm::mat4 model = glm::mat4(1.0f);
-            shaderGeometryPass.use();
-            shaderGeometryPass.setMat4("projection", projection);
-            shaderGeometryPass.setMat4("view", view);
+            geometryPass.use();
+            geometryPass.setMat4("projection", projection);
+            geometryPass.setMat4("view", view);
             // room cube
             model = glm::mat4(1.0f);
             model = glm::translate(model, glm::vec3(0.0, 7.0f, 0.0f));
             model = glm::scale(model, glm::vec3(7.5f, 7.5f, 7.5f));
-            shaderGeometryPass.setMat4("model", model);
-            shaderGeometryPass.setInt("invertedNormals", 1); // invert normals as we're inside the cube
+            geometryPass.setMat4("model", model);
+            geometryPass.setInt("invertedNormals", 1); // invert normals as we're inside the cube
             renderCube();
-            shaderGeometryPass.setInt("invertedNormals", 0); 
+            geometryPass.setInt("invertedNormals", 0); 
             // backpack model on the floor
             model = glm::mat4(1.0f);
             model = glm::translate(model, glm::vec3(0.0f, 0.5f, 0.0));
             model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0, 0.0, 0.0));
             model = glm::scale(model, glm::vec3(1.0f));
-            shaderGeometryPass.setMat4("model", model);
-            backpack.Draw(shaderGeometryPass);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-
-        // 2. generate SSAO texture
-        // ------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
-            glClear(GL_COLOR_BUFFER_BIT);
-            shaderSSAO.use();
-            // Send kernel + rotation 
-            for (unsigned int i = 0; i < 64; ++i)
-                shaderSSAO.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
-            shaderSSAO.setMat4("projection", projection);
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, gPosition);
-            glActiveTexture(GL_TEXTURE1);
-            glBindTexture(GL_TEXTURE_2D, gNormal);
-            glActiveTexture(GL_TEXTURE2);
-            glBindTexture(GL_TEXTURE_2D, noiseTexture);
-            renderQuad();
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
-
-
-        // 3. blur SSAO texture to remove noise
-        // ------------------------------------
-        glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
-            glClear(GL_COLOR_BUFFER_BIT);
-            shaderSSAOBlur.use();
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
-            renderQuad();
+            geometryPass.setMat4("model", model);
+            backpack.Draw(geometryPass);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        timers[TIMER_GEOMETRY].End();
+
+
+        if (!preset.Optimized)
+        {
+            // 2. generate SSAO texture
+            // ------------------------
+            timers[TIMER_OCCLUSION].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoFBO);
+                glClear(GL_COLOR_BUFFER_BIT);
+                ssaoPass.use();
+                // Send kernel + rotation 
+                for (unsigned int i = 0; i < 64; ++i)
+                    ssaoPass.setVec3("samples[" + std::to_string(i) + "]", ssaoKernel[i]);
+                ssaoPass.setMat4("projection", projection);
+                if (thin)
+                    ssaoPass.setMat4("inverseProjection", glm::inverse(projection));
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, positionSource);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, noiseTexture);
+                renderQuad();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            timers[TIMER_OCCLUSION].End();
+
+
+            // 3. blur SSAO texture to remove noise
+            // ------------------------------------
+            timers[TIMER_BLUR].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+                glClear(GL_COLOR_BUFFER_BIT);
+                shaderSSAOBlur.use();
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, ssaoColorBuffer);
+                renderQuad();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            timers[TIMER_BLUR].End();
+        }
+        else
+        {
+            // 2. optimized path: downsample the G-buffer, interleaved SSAO and (optional) temporal
+            // accumulation at low resolution, bilateral blur, then upsample to full resolution
+            // -------------------------------------------------------------------------------------
+            glViewport(0, 0, lowRes.Width, lowRes.Height);
+            timers[TIMER_PREPARE].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, lowRes.PrepareFBO);
+                shaderSSAOPrepare.use();
+                shaderSSAOPrepare.setBool("octahedralNormals", thin);
+                shaderSSAOPrepare.setInt("downsample", preset.Downsample);
+                shaderSSAOPrepare.setMat4("projection", projection);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
+                renderQuad();
+            timers[TIMER_PREPARE].End();
+
+            timers[TIMER_OCCLUSION].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, lowRes.OcclusionFBO);
+                shaderSSAOInterleaved.use();
+                shaderSSAOInterleaved.setInt("kernelSize", preset.KernelSize);
+                shaderSSAOInterleaved.setInt("downsample", preset.Downsample);
+                shaderSSAOInterleaved.setMat4("projection", projection);
+                // with temporal accumulation every frame rotates the kernels a bit further
+                shaderSSAOInterleaved.setFloat("temporalRotation", temporalEnabled ? (frameIndex % 64) * 2.39996f : 0.0f);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, lowRes.Prepared);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, kernelTexture);
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, noiseTexture);
+                renderQuad();
+            timers[TIMER_OCCLUSION].End();
+
+            unsigned int blurSource = lowRes.Occlusion;
+            if (temporalEnabled)
+            {
+                timers[TIMER_TEMPORAL].Begin();
+                glBindFramebuffer(GL_FRAMEBUFFER, lowRes.HistoryFBO[historyIndex]);
+                    shaderSSAOTemporal.use();
+                    shaderSSAOTemporal.setBool("historyValid", historyValid);
+                    shaderSSAOTemporal.setInt("downsample", preset.Downsample);
+                    shaderSSAOTemporal.setMat4("projection", projection);
+                    shaderSSAOTemporal.setMat4("previousProjection", previousProjection);
+                    shaderSSAOTemporal.setMat4("currentToPreviousView", previousView * glm::inverse(view));
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, lowRes.Occlusion);
+                    glActiveTexture(GL_TEXTURE1);
+                    glBindTexture(GL_TEXTURE_2D, lowRes.Prepared);
+                    glActiveTexture(GL_TEXTURE2);
+                    glBindTexture(GL_TEXTURE_2D, lowRes.History[1 - historyIndex]);
+                    renderQuad();
+                timers[TIMER_TEMPORAL].End();
+                blurSource = lowRes.History[historyIndex];
+                historyIndex = 1 - historyIndex;
+                historyValid = true;
+            }
+            else
+            {
+                historyValid = false;
+            }
+
+            timers[TIMER_BLUR].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, lowRes.BlurFBO);
+                shaderSSAOBilateral.use();
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, blurSource);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, lowRes.Prepared);
+                renderQuad();
+            timers[TIMER_BLUR].End();
+
+            glViewport(0, 0, SCR_WIDTH, SCR_HEIGHT);
+            timers[TIMER_UPSAMPLE].Begin();
+            glBindFramebuffer(GL_FRAMEBUFFER, ssaoBlurFBO);
+                shaderSSAOUpsample.use();
+                shaderSSAOUpsample.setInt("downsample", preset.Downsample);
+                shaderSSAOUpsample.setMat4("projection", projection);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, lowRes.Blur);
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, lowRes.Prepared);
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, gBuffer.Depth);
+                renderQuad();
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            timers[TIMER_UPSAMPLE].End();
+        }
+        previousView = view;
+        previousProjection = projection;
+        frameIndex++;
 
 
         // 4. lighting pass: traditional deferred Blinn-Phong lighting with added screen-space ambient occlusion
         // -----------------------------------------------------------------------------------------------------
+        timers[TIMER_LIGHTING].Begin();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderLightingPass.use();
+        lightingPass.use();
         // send light relevant uniforms
         glm::vec3 lightPosView = glm::vec3(camera.GetViewMatrix() * glm::vec4(lightPos, 1.0));
-        shaderLightingPass.setVec3("light.Position", lightPosView);
-        shaderLightingPass.setVec3("light.Color", lightColor);
+        lightingPass.setVec3("light.Position", lightPosView);
+        lightingPass.setVec3("light.Color", lightColor);
         // Update attenuation parameters
         const float linear    = 0.09f;
         const float quadratic = 0.032f;
-        shaderLightingPass.setFloat("light.Linear", linear);
-        shaderLightingPass.setFloat("light.Quadratic", quadratic);
+        lightingPass.setFloat("light.Linear", linear);
+        lightingPass.setFloat("light.Quadratic", quadratic);
+        if (thin)
+            lightingPass.setMat4("inverseProjection", glm::inverse(projection));
         glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, gPosition);
+        glBindTexture(GL_TEXTURE_2D, positionSource);
         glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, gNormal);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.Normal);
         glActiveTexture(GL_TEXTURE2);
-        glBindTexture(GL_TEXTURE_2D, gAlbedo);
+        glBindTexture(GL_TEXTURE_2D, gBuffer.AlbedoSpec);
         glActiveTexture(GL_TEXTURE3); // add extra SSAO texture to lighting pass
         glBindTexture(GL_TEXTURE_2D, ssaoColorBufferBlur);
         renderQuad();
+        timers[TIMER_LIGHTING].End();
+
+        if (++frameCounter >= 100)
+        {
+            std::cout << std::fixed << std::setprecision(3);
+            for (unsigned int i = 0; i < TIMER_STAGE_COUNT; i++)
+            {
+                // only report the stages the current preset runs
+                if ((!preset.Optimized && (i == TIMER_PREPARE || i == TIMER_UPSAMPLE)) || (i == TIMER_TEMPORAL && !temporalEnabled))
+                    continue;
+                std::cout << TIMER_STAGE_NAMES[i] << ": " << timers[i].AverageMs() << " ms | ";
+                timers[i].Reset();
+            }
+            std::cout << "(" << preset.Name << (temporalEnabled ? "" : ", no temporal") << ")" << std::endl;
+            frameCounter = 0;
+        }
 
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -327,6 +551,79 @@ int main()
     return 0;
 }
 
+// creates a single-texture framebuffer for the optimized SSAO path
+// -----------------------------------------------------------------
+unsigned int createColorTarget(unsigned int& fbo, GLenum internalFormat, GLenum format, unsigned int width, unsigned int height)
+{
+    unsigned int texture;
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_FLOAT, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "SSAO low resolution framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    return texture;
+}
+
+// (re)creates the low resolution targets for the given downsample factor
+// ----------------------------------------------------------------------
+void createLowResTargets(LowResTargets& targets, unsigned int downsample)
+{
+    releaseLowResTargets(targets);
+    targets.Width = (SCR_WIDTH + downsample - 1) / downsample;
+    targets.Height = (SCR_HEIGHT + downsample - 1) / downsample;
+    // linear depth needs 32 bits: at 16 bits the error would be on the order of the SSAO bias
+    targets.Prepared = createColorTarget(targets.PrepareFBO, GL_RGBA32F, GL_RGBA, targets.Width, targets.Height);
+    targets.Occlusion = createColorTarget(targets.OcclusionFBO, GL_R16F, GL_RED, targets.Width, targets.Height);
+    for (unsigned int i = 0; i < 2; i++)
+        targets.History[i] = createColorTarget(targets.HistoryFBO[i], GL_RG32F, GL_RG, targets.Width, targets.Height);
+    targets.Blur = createColorTarget(targets.BlurFBO, GL_R16F, GL_RED, targets.Width, targets.Height);
+}
+
+void releaseLowResTargets(LowResTargets& targets)
+{
+    if (targets.PrepareFBO == 0)
+        return;
+    unsigned int fbos[5] = { targets.PrepareFBO, targets.OcclusionFBO, targets.HistoryFBO[0], targets.HistoryFBO[1], targets.BlurFBO };
+    unsigned int textures[5] = { targets.Prepared, targets.Occlusion, targets.History[0], targets.History[1], targets.Blur };
+    glDeleteFramebuffers(5, fbos);
+    glDeleteTextures(5, textures);
+    targets = LowResTargets();
+}
+
+// fills the kernelSize x 16 kernel texture: together the 16 kernels form one 16 * kernelSize
+// sample hemisphere, distributed so that every kernel covers the whole radius range
+// ------------------------------------------------------------------------------------------
+void generateInterleavedKernels(unsigned int kernelSize, unsigned int kernelTexture)
+{
+    std::uniform_real_distribution<GLfloat> randomFloats(0.0, 1.0);
+    std::default_random_engine generator;
+    const unsigned int totalSamples = 16 * kernelSize;
+    std::vector<glm::vec3> kernels(totalSamples);
+    for (unsigned int pattern = 0; pattern < 16; ++pattern)
+    {
+        for (unsigned int i = 0; i < kernelSize; ++i)
+        {
+            glm::vec3 sample(randomFloats(generator) * 2.0 - 1.0, randomFloats(generator) * 2.0 - 1.0, randomFloats(generator));
+            sample = glm::normalize(sample);
+            sample *= randomFloats(generator);
+            // interleave the patterns over the combined kernel's radius distribution
+            float scale = float(i * 16 + pattern) / float(totalSamples);
+            scale = ourLerp(0.1f, 1.0f, scale * scale);
+            kernels[pattern * kernelSize + i] = sample * scale;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, kernelTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, kernelSize, 16, 0, GL_RGB, GL_FLOAT, &kernels[0]);
+}
+
 // renderCube() renders a 1x1 3D cube in NDC.
 // -------------------------------------------------
 unsigned int cubeVAO = 0;
@@ -449,6 +746,35 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(LEFT, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
         camera.ProcessKeyboard(RIGHT, deltaTime);
+
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS && !gbufferKeyPressed)
+    {
+        gbufferLayout = gbufferLayout == GBUFFER_FAT ? GBUFFER_THIN : GBUFFER_FAT;
+        gbufferLayoutChanged = true;
+        gbufferKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_G) == GLFW_RELEASE)
+    {
+        gbufferKeyPressed = false;
+    }
+
+    for (unsigned int i = 0; i < NR_SSAO_PRESETS; i++)
+    {
+        if (glfwGetKey(window, GLFW_KEY_1 + i) == GLFW_PRESS && ssaoPreset != i)
+        {
+            ssaoPreset = i;
+            ssaoPresetChanged = true;
+        }
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_PRESS && !temporalKeyPressed)
+    {
+        temporalEnabled = !temporalEnabled;
+        temporalKeyPressed = true;
+    }
+    if (glfwGetKey(window, GLFW_KEY_T) == GLFW_RELEASE)
+    {
+        temporalKeyPressed = false;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
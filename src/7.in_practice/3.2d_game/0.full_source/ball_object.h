@@ -9,11 +9,9 @@
 #ifndef BALLOBJECT_H
 #define BALLOBJECT_H
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "texture.h"
 
 
 // BallObject holds the state of the Ball object inheriting
@@ -29,7 +27,7 @@ public:
     bool    Sticky, PassThrough;
     // constructor(s)
     BallObject();
-    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity, Texture2D sprite);
+    BallObject(glm::vec2 pos, float radius, glm::vec2 velocity);
     // moves the ball, keeping it constrained within the window bounds (except bottom edge); returns new position
     glm::vec2 Move(float dt, unsigned int window_width);
     // resets the ball to original state with given position and velocity
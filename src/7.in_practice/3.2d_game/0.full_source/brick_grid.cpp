@@ -0,0 +1,241 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "brick_grid.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+
+BrickGrid::BrickGrid()
+    : origin(0.0f), cellSize(1.0f), columns(0), rows(0), stamp(0) { }
+
+void BrickGrid::Build(const std::vector<glm::vec4> &boxes, glm::vec2 origin, glm::vec2 size, glm::vec2 cellSize)
+{
+    this->origin = origin;
+    this->cellSize = cellSize;
+    this->columns = std::max(1, static_cast<int>(std::ceil(size.x / cellSize.x)));
+    this->rows = std::max(1, static_cast<int>(std::ceil(size.y / cellSize.y)));
+    this->boxes = boxes;
+    this->stamps.assign(boxes.size(), 0);
+    this->stamp = 0;
+    // count the bricks per cell, then give each cell its range of entries and fill them
+    unsigned int cells = this->columns * this->rows;
+    this->cellCount.assign(cells, 0);
+    int x0, y0, x1, y1;
+    for (const glm::vec4 &box : this->boxes)
+        if (this->cellRange(glm::vec2(box), glm::vec2(box.z, box.w), true, x0, y0, x1, y1))
+            for (int y = y0; y <= y1; ++y)
+                for (int x = x0; x <= x1; ++x)
+                    ++this->cellCount[y * this->columns + x];
+    this->cellStart.resize(cells);
+    unsigned int total = 0;
+    for (unsigned int c = 0; c < cells; ++c)
+    {
+        this->cellStart[c] = total;
+        total += this->cellCount[c];
+        this->cellCount[c] = 0;
+    }
+    this->entries.resize(total);
+    for (unsigned int i = 0; i < this->boxes.size(); ++i)
+    {
+        const glm::vec4 &box = this->boxes[i];
+        if (this->cellRange(glm::vec2(box), glm::vec2(box.z, box.w), true, x0, y0, x1, y1))
+        {
+            for (int y = y0; y <= y1; ++y)
+            {
+                for (int x = x0; x <= x1; ++x)
+                {
+                    unsigned int c = y * this->columns + x;
+                    this->entries[this->cellStart[c] + this->cellCount[c]++] = i;
+                }
+            }
+        }
+    }
+}
+
+void BrickGrid::Remove(unsigned int brick)
+{
+    glm::vec4 &box = this->boxes[brick];
+    int x0, y0, x1, y1;
+    if (this->cellRange(glm::vec2(box), glm::vec2(box.z, box.w), true, x0, y0, x1, y1))
+    {
+        for (int y = y0; y <= y1; ++y)
+        {
+            for (int x = x0; x <= x1; ++x)
+            {
+                // swap the brick with the last one of the cell and shorten the cell
+                unsigned int c = y * this->columns + x;
+                unsigned int *first = &this->entries[this->cellStart[c]];
+                unsigned int *last = first + this->cellCount[c];
+                unsigned int *found = std::find(first, last, brick);
+                if (found != last)
+                {
+                    *found = *(last - 1);
+                    --this->cellCount[c];
+                }
+            }
+        }
+    }
+    // an empty box, so removing it again does nothing
+    box = glm::vec4(0.0f);
+}
+
+void BrickGrid::Query(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &result)
+{
+    result.clear();
+    int x0, y0, x1, y1;
+    if (!this->cellRange(min, max, false, x0, y0, x1, y1))
+        return;
+    if (++this->stamp == 0)
+    {
+        std::fill(this->stamps.begin(), this->stamps.end(), 0);
+        this->stamp = 1;
+    }
+    for (int y = y0; y <= y1; ++y)
+    {
+        for (int x = x0; x <= x1; ++x)
+        {
+            unsigned int c = y * this->columns + x;
+            for (unsigned int e = this->cellStart[c]; e < this->cellStart[c] + this->cellCount[c]; ++e)
+            {
+                unsigned int brick = this->entries[e];
+                if (this->stamps[brick] != this->stamp)
+                {
+                    this->stamps[brick] = this->stamp;
+                    result.push_back(brick);
+                }
+            }
+        }
+    }
+    // the order bricks were tested in before there was a broad phase
+    std::sort(result.begin(), result.end());
+}
+
+bool BrickGrid::cellRange(glm::vec2 min, glm::vec2 max, bool halfOpen, int &x0, int &y0, int &x1, int &y1) const
+{
+    if (this->columns == 0)
+        return false;
+    // empty bricks aren't in any cell
+    if (halfOpen && (max.x <= min.x || max.y <= min.y))
+        return false;
+    // clamp before converting, so boxes far outside the grid don't overflow
+    glm::vec2 limit(this->columns + 1.0f, this->rows + 1.0f);
+    glm::vec2 low = glm::clamp((min - this->origin) / this->cellSize, glm::vec2(-1.0f), limit);
+    glm::vec2 high = glm::clamp((max - this->origin) / this->cellSize, glm::vec2(-1.0f), limit);
+    // a brick's box ends where the next cell starts, so with halfOpen it isn't put in that cell
+    x0 = static_cast<int>(std::floor(low.x));
+    y0 = static_cast<int>(std::floor(low.y));
+    x1 = halfOpen ? static_cast<int>(std::ceil(high.x)) - 1 : static_cast<int>(std::floor(high.x));
+    y1 = halfOpen ? static_cast<int>(std::ceil(high.y)) - 1 : static_cast<int>(std::floor(high.y));
+    if (x1 < 0 || y1 < 0 || x0 >= this->columns || y0 >= this->rows)
+        return false;
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, this->columns - 1);
+    y1 = std::min(y1, this->rows - 1);
+    return x0 <= x1 && y0 <= y1;
+}
+
+
+// circle - AABB overlap, the same test as CheckCollision(BallObject, GameObject)
+static bool CircleOverlaps(glm::vec2 center, float radius, const glm::vec4 &box)
+{
+    glm::vec2 closest = glm::clamp(center, glm::vec2(box), glm::vec2(box.z, box.w));
+    return glm::length(closest - center) < radius;
+}
+
+BrickGridStats BrickGridBenchmark(unsigned int columns, unsigned int rows, unsigned int steps)
+{
+    const glm::vec2 brickSize(16.0f, 8.0f);
+    const float radius = 12.5f;
+    const float dt = 1.0f / 60.0f;
+    glm::vec2 size = brickSize * glm::vec2(columns, rows);
+    // a level with about one in five bricks missing
+    std::minstd_rand generator(5);
+    std::vector<glm::vec4> boxes;
+    for (unsigned int y = 0; y < rows; ++y)
+    {
+        for (unsigned int x = 0; x < columns; ++x)
+        {
+            if (generator() % 5 == 0)
+                continue;
+            glm::vec2 position = brickSize * glm::vec2(x, y);
+            boxes.push_back(glm::vec4(position, position + brickSize));
+        }
+    }
+    // the ball bounces off the level's edges; both variants follow the same path
+    std::vector<glm::vec2> path(steps);
+    float angle = (generator() % 360) * 3.14159265f / 180.0f;
+    glm::vec2 velocity = glm::vec2(std::cos(angle), std::sin(angle)) * 900.0f;
+    glm::vec2 center = size * 0.5f;
+    for (unsigned int s = 0; s < steps; ++s)
+    {
+        center += velocity * dt;
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            if (center[axis] < radius || center[axis] > size[axis] - radius)
+            {
+                velocity[axis] = -velocity[axis];
+                center[axis] = glm::clamp(center[axis], radius, size[axis] - radius);
+            }
+        }
+        path[s] = center;
+    }
+
+    BrickGridStats stats;
+    stats.Columns = columns;
+    stats.Rows = rows;
+    stats.Steps = steps;
+    std::vector<unsigned int> candidates, gridHits, bruteForceHits;
+    size_t candidateCount = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    BrickGrid grid;
+    grid.Build(boxes, glm::vec2(0.0f), size, brickSize);
+    stats.BuildMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    start = std::chrono::high_resolution_clock::now();
+    for (unsigned int s = 0; s < steps; ++s)
+    {
+        // swept box of the ball over this step
+        glm::vec2 previous = s > 0 ? path[s - 1] : path[s];
+        grid.Query(glm::min(previous, path[s]) - radius, glm::max(previous, path[s]) + radius, candidates);
+        candidateCount += candidates.size();
+        for (unsigned int brick : candidates)
+        {
+            if (CircleOverlaps(path[s], radius, boxes[brick]))
+            {
+                grid.Remove(brick);
+                gridHits.push_back(brick);
+            }
+        }
+    }
+    stats.GridMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<bool> destroyed(boxes.size(), false);
+    for (unsigned int s = 0; s < steps; ++s)
+    {
+        for (unsigned int brick = 0; brick < boxes.size(); ++brick)
+        {
+            if (!destroyed[brick] && CircleOverlaps(path[s], radius, boxes[brick]))
+            {
+                destroyed[brick] = true;
+                bruteForceHits.push_back(brick);
+            }
+        }
+    }
+    stats.BruteForceMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    stats.Candidates = steps > 0 ? static_cast<double>(candidateCount) / steps : 0.0;
+    stats.Hits = gridHits.size();
+    stats.Valid = gridHits == bruteForceHits;
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,67 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef BRICK_GRID_H
+#define BRICK_GRID_H
+#include <vector>
+
+#include <glm/glm.hpp>
+
+
+// BrickGrid is the broad phase of the ball's collision detection: a
+// uniform grid over the level in which every brick is listed in each
+// cell its box overlaps. A query visits only the cells overlapping the
+// queried box, so its cost depends on the size of the box relative to
+// the cells, not on the number of bricks in the level. Bricks are
+// static; destroyed bricks are removed from their cells one by one.
+// The grid only deals with boxes, so it doesn't need any GL state.
+class BrickGrid
+{
+public:
+    // constructor
+    BrickGrid();
+    // (re)builds the grid over origin .. origin + size with cells of cellSize;
+    // boxes holds one <vec2 min, vec2 max> box per brick, empty boxes are left out
+    void Build(const std::vector<glm::vec4> &boxes, glm::vec2 origin, glm::vec2 size, glm::vec2 cellSize);
+    // removes the brick from all cells it is listed in
+    void Remove(unsigned int brick);
+    // fills result with the index of every brick listed in the cells overlapping
+    // min .. max, each once and in ascending order
+    void Query(glm::vec2 min, glm::vec2 max, std::vector<unsigned int> &result);
+private:
+    // grid state
+    glm::vec2 origin, cellSize;
+    int columns, rows;
+    // the bricks of cell c are entries[cellStart[c]] .. entries[cellStart[c] + cellCount[c] - 1]
+    std::vector<unsigned int> cellStart, cellCount, entries;
+    std::vector<glm::vec4>    boxes;
+    // last query each brick was returned by, so bricks spanning several cells are returned once
+    std::vector<unsigned int> stamps;
+    unsigned int              stamp;
+    // computes the range of cells overlapping min .. max; returns false if it is outside the grid
+    bool cellRange(glm::vec2 min, glm::vec2 max, bool halfOpen, int &x0, int &y0, int &x1, int &y1) const;
+};
+
+
+// Result of BrickGridBenchmark
+struct BrickGridStats {
+    unsigned int Columns, Rows;
+    unsigned int Steps;
+    double       BuildMs;              // building the grid, once per level
+    double       GridMs, BruteForceMs; // finding the hit bricks, total over all steps
+    double       Candidates;           // average bricks returned per query
+    unsigned int Hits;                 // bricks destroyed by the ball
+    bool         Valid;                // grid and brute force hit the same bricks
+};
+
+// Moves a ball through a generated level of columns x rows bricks of 16x8
+// pixels for the given number of steps, destroying every brick it touches,
+// and times finding those bricks with the grid against testing every brick.
+BrickGridStats BrickGridBenchmark(unsigned int columns, unsigned int rows, unsigned int steps = 2000);
+
+#endif
\ No newline at end of file
@@ -7,122 +7,89 @@
 ** option) any later version.
 ******************************************************************/
 #include <algorithm>
-#include <sstream>
-#include <iostream>
+#include <cmath>
 
 #include <learnopengl/filesystem.h>
 
-#include <irrklang/irrKlang.h>
-using namespace irrklang;
+// only the key codes; the game doesn't use GLFW or GL itself
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
 
 #include "game.h"
-#include "resource_manager.h"
-#include "sprite_renderer.h"
-#include "game_object.h"
-#include "ball_object.h"
-#include "particle_generator.h"
-#include "post_processor.h"
-#include "text_renderer.h"
 
 
-// Game-related State data
-SpriteRenderer    *Renderer;
-GameObject        *Player;
-BallObject        *Ball;
-ParticleGenerator *Particles;
-PostProcessor     *Effects;
-ISoundEngine      *SoundEngine = createIrrKlangDevice();
-TextRenderer      *Text;
-
-float ShakeTime = 0.0f;
-
-
-Game::Game(unsigned int width, unsigned int height) 
-    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3)
+Game::Game(unsigned int width, unsigned int height, unsigned int seed) 
+    : State(GAME_MENU), Keys(), KeysProcessed(), Width(width), Height(height), Level(0), Lives(3), Ticks(0), Random(seed),
+      Shake(false), Confuse(false), Chaos(false), ShakeTime(0.0f), Audio(nullptr)
 { 
 
 }
 
-Game::~Game()
-{
-    delete Renderer;
-    delete Player;
-    delete Ball;
-    delete Particles;
-    delete Effects;
-    delete Text;
-    SoundEngine->drop();
-}
-
-void Game::Init()
+void Game::Init(const std::vector<GameLevel> &levels)
 {
-    // load shaders
-    ResourceManager::LoadShader("sprite.vs", "sprite.fs", nullptr, "sprite");
-    ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
-    ResourceManager::LoadShader("post_processing.vs", "post_processing.fs", nullptr, "postprocessing");
-    // configure shaders
-    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->Width), static_cast<float>(this->Height), 0.0f, -1.0f, 1.0f);
-    ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
-    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
-    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
-    // load textures
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/background.jpg").c_str(), false, "background");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/awesomeface.png").c_str(), true, "face");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/block.png").c_str(), false, "block");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/block_solid.png").c_str(), false, "block_solid");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/paddle.png").c_str(), true, "paddle");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/particle.png").c_str(), true, "particle");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_speed.png").c_str(), true, "powerup_speed");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_sticky.png").c_str(), true, "powerup_sticky");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_increase.png").c_str(), true, "powerup_increase");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_confuse.png").c_str(), true, "powerup_confuse");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_chaos.png").c_str(), true, "powerup_chaos");
-    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_passthrough.png").c_str(), true, "powerup_passthrough");
-    // set render-specific controls
-    Renderer = new SpriteRenderer(ResourceManager::GetShader("sprite"));
-    Particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
-    Effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->Width, this->Height);
-    Text = new TextRenderer(this->Width, this->Height);
-    Text->Load(FileSystem::getPath("resources/fonts/OCRAEXT.TTF").c_str(), 24);
-    // load levels
-    GameLevel one; one.Load(FileSystem::getPath("resources/levels/one.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel two; two.Load(FileSystem::getPath("resources/levels/two.lvl").c_str(), this->Width, this->Height /2 );
-    GameLevel three; three.Load(FileSystem::getPath("resources/levels/three.lvl").c_str(), this->Width, this->Height / 2);
-    GameLevel four; four.Load(FileSystem::getPath("resources/levels/four.lvl").c_str(), this->Width, this->Height / 2);
-    this->Levels.push_back(one);
-    this->Levels.push_back(two);
-    this->Levels.push_back(three);
-    this->Levels.push_back(four);
+    // levels
+    this->initialLevels = levels;
+    this->Levels = levels;
     this->Level = 0;
     // configure game objects
     glm::vec2 playerPos = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-    Player = new GameObject(playerPos, PLAYER_SIZE, ResourceManager::GetTexture("paddle"));
+    this->Player = GameObject(playerPos, PLAYER_SIZE);
     glm::vec2 ballPos = playerPos + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -BALL_RADIUS * 2.0f);
-    Ball = new BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY, ResourceManager::GetTexture("face"));
+    this->Ball = BallObject(ballPos, BALL_RADIUS, INITIAL_BALL_VELOCITY);
     // audio
-    SoundEngine->play2D(FileSystem::getPath("resources/audio/breakout.mp3").c_str(), true);
+    this->playSound(SOUND_MUSIC);
+}
+
+std::vector<GameLevel> LoadLevels(unsigned int width, unsigned int height)
+{
+    const char *files[] = { "resources/levels/one.lvl", "resources/levels/two.lvl", "resources/levels/three.lvl", "resources/levels/four.lvl" };
+    std::vector<GameLevel> levels(4);
+    for (unsigned int i = 0; i < 4; ++i)
+        levels[i].Load(FileSystem::getPath(files[i]).c_str(), width, height / 2);
+    return levels;
+}
+
+void Game::SetKey(int key, bool pressed)
+{
+    if (key < 0 || key >= 1024)
+        return;
+    if (pressed)
+        this->Keys[key] = true;
+    else
+    {
+        this->Keys[key] = false;
+        this->KeysProcessed[key] = false;
+    }
+}
+
+void Game::Tick(float dt)
+{
+    // remember where the moving objects were, to interpolate between ticks when rendering
+    this->Player.PreviousPosition = this->Player.Position;
+    this->Ball.PreviousPosition = this->Ball.Position;
+    for (PowerUp &powerUp : this->PowerUps)
+        powerUp.PreviousPosition = powerUp.Position;
+    this->ProcessInput(dt);
+    this->Update(dt);
+    ++this->Ticks;
 }
 
 void Game::Update(float dt)
 {
-    // update objects
-    Ball->Move(dt, this->Width);
-    // check for collisions
-    this->DoCollisions();
-    // update particles
-    Particles->Update(dt, *Ball, 2, glm::vec2(Ball->Radius / 2.0f));
+    // update objects and check for collisions
+    this->MoveBall(dt);
+    this->DoPowerUpCollisions();
     // update PowerUps
     this->UpdatePowerUps(dt);
     // reduce shake time
-    if (ShakeTime > 0.0f)
+    if (this->ShakeTime > 0.0f)
     {
-        ShakeTime -= dt;
-        if (ShakeTime <= 0.0f)
-            Effects->Shake = false;
+        this->ShakeTime -= dt;
+        if (this->ShakeTime <= 0.0f)
+            this->Shake = false;
     }
     // check loss condition
-    if (Ball->Position.y >= this->Height) // did ball reach bottom edge?
+    if (this->Ball.Position.y >= this->Height) // did ball reach bottom edge?
     {
         --this->Lives;
         // did the player lose all his lives? : game over
@@ -138,7 +105,7 @@ void Game::Update(float dt)
     {
         this->ResetLevel();
         this->ResetPlayer();
-        Effects->Chaos = true;
+        this->Chaos = true;
         this->State = GAME_WIN;
     }
 }
@@ -155,7 +122,7 @@ void Game::ProcessInput(float dt)
         }
         if (this->Keys[GLFW_KEY_W] && !this->KeysProcessed[GLFW_KEY_W])
         {
-            this->Level = (this->Level + 1) % 4;
+            this->Level = (this->Level + 1) % this->Levels.size();
             this->KeysProcessed[GLFW_KEY_W] = true;
         }
         if (this->Keys[GLFW_KEY_S] && !this->KeysProcessed[GLFW_KEY_S])
@@ -163,8 +130,7 @@ void Game::ProcessInput(float dt)
             if (this->Level > 0)
                 --this->Level;
             else
-                this->Level = 3;
-            //this->Level = (this->Level - 1) % 4;
+                this->Level = this->Levels.size() - 1;
             this->KeysProcessed[GLFW_KEY_S] = true;
         }
     }
@@ -173,7 +139,7 @@ void Game::ProcessInput(float dt)
         if (this->Keys[GLFW_KEY_ENTER])
         {
             this->KeysProcessed[GLFW_KEY_ENTER] = true;
-            Effects->Chaos = false;
+            this->Chaos = false;
             this->State = GAME_MENU;
         }
     }
@@ -183,93 +149,93 @@ void Game::ProcessInput(float dt)
         // move playerboard
         if (this->Keys[GLFW_KEY_A])
         {
-            if (Player->Position.x >= 0.0f)
+            if (this->Player.Position.x >= 0.0f)
             {
-                Player->Position.x -= velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x -= velocity;
+                this->Player.Position.x -= velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x -= velocity;
             }
         }
         if (this->Keys[GLFW_KEY_D])
         {
-            if (Player->Position.x <= this->Width - Player->Size.x)
+            if (this->Player.Position.x <= this->Width - this->Player.Size.x)
             {
-                Player->Position.x += velocity;
-                if (Ball->Stuck)
-                    Ball->Position.x += velocity;
+                this->Player.Position.x += velocity;
+                if (this->Ball.Stuck)
+                    this->Ball.Position.x += velocity;
             }
         }
         if (this->Keys[GLFW_KEY_SPACE])
-            Ball->Stuck = false;
+            this->Ball.Stuck = false;
     }
 }
 
-void Game::Render()
-{
-    if (this->State == GAME_ACTIVE || this->State == GAME_MENU || this->State == GAME_WIN)
-    {
-        // begin rendering to postprocessing framebuffer
-        Effects->BeginRender();
-            // draw background
-            Renderer->DrawSprite(ResourceManager::GetTexture("background"), glm::vec2(0.0f, 0.0f), glm::vec2(this->Width, this->Height), 0.0f);
-            // draw level
-            this->Levels[this->Level].Draw(*Renderer);
-            // draw player
-            Player->Draw(*Renderer);
-            // draw PowerUps
-            for (PowerUp &powerUp : this->PowerUps)
-                if (!powerUp.Destroyed)
-                    powerUp.Draw(*Renderer);
-            // draw particles	
-            Particles->Draw();
-            // draw ball
-            Ball->Draw(*Renderer);            
-        // end rendering to postprocessing framebuffer
-        Effects->EndRender();
-        // render postprocessing quad
-        Effects->Render(glfwGetTime());
-        // render text (don't include in postprocessing)
-        std::stringstream ss; ss << this->Lives;
-        Text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
-    }
-    if (this->State == GAME_MENU)
-    {
-        Text->RenderText("Press ENTER to start", 250.0f, this->Height / 2.0f, 1.0f);
-        Text->RenderText("Press W or S to select level", 245.0f, this->Height / 2.0f + 20.0f, 0.75f);
-    }
-    if (this->State == GAME_WIN)
-    {
-        Text->RenderText("You WON!!!", 320.0f, this->Height / 2.0f - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
-        Text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->Height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
-    }
-}
-
-
 void Game::ResetLevel()
 {
-    if (this->Level == 0)
-        this->Levels[0].Load("levels/one.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 1)
-        this->Levels[1].Load("levels/two.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 2)
-        this->Levels[2].Load("levels/three.lvl", this->Width, this->Height / 2);
-    else if (this->Level == 3)
-        this->Levels[3].Load("levels/four.lvl", this->Width, this->Height / 2);
-
+    this->Levels[this->Level] = this->initialLevels[this->Level];
     this->Lives = 3;
 }
 
 void Game::ResetPlayer()
 {
     // reset player/ball stats
-    Player->Size = PLAYER_SIZE;
-    Player->Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
-    Ball->Reset(Player->Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
+    this->Player.Size = PLAYER_SIZE;
+    this->Player.Position = glm::vec2(this->Width / 2.0f - PLAYER_SIZE.x / 2.0f, this->Height - PLAYER_SIZE.y);
+    this->Ball.Reset(this->Player.Position + glm::vec2(PLAYER_SIZE.x / 2.0f - BALL_RADIUS, -(BALL_RADIUS * 2.0f)), INITIAL_BALL_VELOCITY);
     // also disable all active powerups
-    Effects->Chaos = Effects->Confuse = false;
-    Ball->PassThrough = Ball->Sticky = false;
-    Player->Color = glm::vec3(1.0f);
-    Ball->Color = glm::vec3(1.0f);
+    this->Chaos = this->Confuse = false;
+    this->Ball.PassThrough = this->Ball.Sticky = false;
+    this->Player.Color = glm::vec3(1.0f);
+    this->Ball.Color = glm::vec3(1.0f);
+    // don't interpolate the jump back to the start
+    this->Player.PreviousPosition = this->Player.Position;
+    this->Ball.PreviousPosition = this->Ball.Position;
+}
+
+// FNV-1a hash of the bytes of a value
+template <typename T>
+void HashValue(uint64_t &hash, const T &value)
+{
+    const unsigned char *bytes = reinterpret_cast<const unsigned char *>(&value);
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+uint64_t Game::StateHash() const
+{
+    uint64_t hash = 14695981039346656037ull;
+    HashValue(hash, this->State);
+    HashValue(hash, this->Level);
+    HashValue(hash, this->Lives);
+    HashValue(hash, this->Ticks);
+    HashValue(hash, this->Player.Position);
+    HashValue(hash, this->Player.Size);
+    HashValue(hash, this->Ball.Position);
+    HashValue(hash, this->Ball.Velocity);
+    HashValue(hash, this->Ball.Stuck);
+    HashValue(hash, this->Ball.Sticky);
+    HashValue(hash, this->Ball.PassThrough);
+    for (const GameObject &brick : this->Levels[this->Level].Bricks)
+        HashValue(hash, brick.Destroyed);
+    for (const PowerUp &powerUp : this->PowerUps)
+    {
+        for (char c : powerUp.Type)
+            HashValue(hash, c);
+        HashValue(hash, powerUp.Position);
+        HashValue(hash, powerUp.Duration);
+        HashValue(hash, powerUp.Activated);
+        HashValue(hash, powerUp.Destroyed);
+    }
+    return hash;
+}
+
+void Game::playSound(GameSound sound)
+{
+    if (this->Audio)
+        this->Audio->Play(sound);
 }
 
 
@@ -294,30 +260,30 @@ void Game::UpdatePowerUps(float dt)
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "sticky"))
                     {	// only reset if no other PowerUp of type sticky is active
-                        Ball->Sticky = false;
-                        Player->Color = glm::vec3(1.0f);
+                        this->Ball.Sticky = false;
+                        this->Player.Color = glm::vec3(1.0f);
                     }
                 }
                 else if (powerUp.Type == "pass-through")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "pass-through"))
                     {	// only reset if no other PowerUp of type pass-through is active
-                        Ball->PassThrough = false;
-                        Ball->Color = glm::vec3(1.0f);
+                        this->Ball.PassThrough = false;
+                        this->Ball.Color = glm::vec3(1.0f);
                     }
                 }
                 else if (powerUp.Type == "confuse")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "confuse"))
                     {	// only reset if no other PowerUp of type confuse is active
-                        Effects->Confuse = false;
+                        this->Confuse = false;
                     }
                 }
                 else if (powerUp.Type == "chaos")
                 {
                     if (!IsOtherPowerUpActive(this->PowerUps, "chaos"))
                     {	// only reset if no other PowerUp of type chaos is active
-                        Effects->Chaos = false;
+                        this->Chaos = false;
                     }
                 }
             }
@@ -330,56 +296,58 @@ void Game::UpdatePowerUps(float dt)
     ), this->PowerUps.end());
 }
 
-bool ShouldSpawn(unsigned int chance)
+// the modulo of the raw std::mt19937 output is the same with every standard library, unlike the distributions
+bool ShouldSpawn(std::mt19937 &generator, unsigned int chance)
 {
-    unsigned int random = rand() % chance;
+    unsigned int random = generator() % chance;
     return random == 0;
 }
 void Game::SpawnPowerUps(GameObject &block)
 {
-    if (ShouldSpawn(75)) // 1 in 75 chance
-        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position, ResourceManager::GetTexture("powerup_speed")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position, ResourceManager::GetTexture("powerup_sticky")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position, ResourceManager::GetTexture("powerup_passthrough")));
-    if (ShouldSpawn(75))
-        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position, ResourceManager::GetTexture("powerup_increase")));
-    if (ShouldSpawn(15)) // Negative powerups should spawn more often
-        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_confuse")));
-    if (ShouldSpawn(15))
-        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position, ResourceManager::GetTexture("powerup_chaos")));
+    if (ShouldSpawn(this->Random, 75)) // 1 in 75 chance
+        this->PowerUps.push_back(PowerUp("speed", glm::vec3(0.5f, 0.5f, 1.0f), 0.0f, block.Position));
+    if (ShouldSpawn(this->Random, 75))
+        this->PowerUps.push_back(PowerUp("sticky", glm::vec3(1.0f, 0.5f, 1.0f), 20.0f, block.Position));
+    if (ShouldSpawn(this->Random, 75))
+        this->PowerUps.push_back(PowerUp("pass-through", glm::vec3(0.5f, 1.0f, 0.5f), 10.0f, block.Position));
+    if (ShouldSpawn(this->Random, 75))
+        this->PowerUps.push_back(PowerUp("pad-size-increase", glm::vec3(1.0f, 0.6f, 0.4), 0.0f, block.Position));
+    if (ShouldSpawn(this->Random, 15)) // Negative powerups should spawn more often
+        this->PowerUps.push_back(PowerUp("confuse", glm::vec3(1.0f, 0.3f, 0.3f), 15.0f, block.Position));
+    if (ShouldSpawn(this->Random, 15))
+        this->PowerUps.push_back(PowerUp("chaos", glm::vec3(0.9f, 0.25f, 0.25f), 15.0f, block.Position));
 }
 
-void ActivatePowerUp(PowerUp &powerUp)
+void Game::ActivatePowerUp(PowerUp &powerUp)
 {
     if (powerUp.Type == "speed")
     {
-        Ball->Velocity *= 1.2;
+        if (glm::length(this->Ball.Velocity) * 1.2f <= MAX_BALL_SPEED)
+            this->Ball.Velocity *= 1.2;
     }
     else if (powerUp.Type == "sticky")
     {
-        Ball->Sticky = true;
-        Player->Color = glm::vec3(1.0f, 0.5f, 1.0f);
+        this->Ball.Sticky = true;
+        this->Player.Color = glm::vec3(1.0f, 0.5f, 1.0f);
     }
     else if (powerUp.Type == "pass-through")
     {
-        Ball->PassThrough = true;
-        Ball->Color = glm::vec3(1.0f, 0.5f, 0.5f);
+        this->Ball.PassThrough = true;
+        this->Ball.Color = glm::vec3(1.0f, 0.5f, 0.5f);
     }
     else if (powerUp.Type == "pad-size-increase")
     {
-        Player->Size.x += 50;
+        this->Player.Size.x += 50;
     }
     else if (powerUp.Type == "confuse")
     {
-        if (!Effects->Chaos)
-            Effects->Confuse = true; // only activate if chaos wasn't already active
+        if (!this->Chaos)
+            this->Confuse = true; // only activate if chaos wasn't already active
     }
     else if (powerUp.Type == "chaos")
     {
-        if (!Effects->Confuse)
-            Effects->Chaos = true;
+        if (!this->Confuse)
+            this->Chaos = true;
     }
 }
 
@@ -402,59 +370,113 @@ bool CheckCollision(GameObject &one, GameObject &two);
 Collision CheckCollision(BallObject &one, GameObject &two);
 Direction VectorDirection(glm::vec2 closest);
 
+void Game::MoveBall(float dt)
+{
+    // continuous collision detection by sub-stepping: the ball moves at most its radius per step, so
+    // it overlaps every brick in its way in at least one step instead of jumping past it when fast
+    float distance = glm::length(this->Ball.Velocity) * dt;
+    unsigned int steps = std::max(1u, static_cast<unsigned int>(std::ceil(distance / this->Ball.Radius)));
+    float step = dt / steps;
+    bool query = true;
+    for (unsigned int i = 0; i < steps; ++i)
+    {
+        glm::vec2 velocity = this->Ball.Velocity;
+        if (query)
+        {
+            // broad phase: the bricks overlapping the box the ball sweeps over the rest of the frame
+            glm::vec2 end = this->Ball.Position + velocity * (step * (steps - i));
+            this->Levels[this->Level].Grid.Query(glm::min(this->Ball.Position, end), glm::max(this->Ball.Position, end) + this->Ball.Size, this->BrickCandidates);
+        }
+        this->Ball.Move(step, this->Width);
+        this->DoCollisions();
+        // after a bounce the ball leaves the swept box
+        query = this->Ball.Velocity != velocity;
+    }
+}
+
 void Game::DoCollisions()
 {
-    for (GameObject &box : this->Levels[this->Level].Bricks)
+    GameLevel &level = this->Levels[this->Level];
+    for (unsigned int index : this->BrickCandidates)
     {
+        GameObject &box = level.Bricks[index];
         if (!box.Destroyed)
         {
-            Collision collision = CheckCollision(*Ball, box);
+            Collision collision = CheckCollision(this->Ball, box);
             if (std::get<0>(collision)) // if collision is true
             {
                 // destroy block if not solid
                 if (!box.IsSolid)
                 {
-                    box.Destroyed = true;
+                    level.DestroyBrick(index);
                     this->SpawnPowerUps(box);
-                    SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.mp3").c_str(), false);
+                    this->playSound(SOUND_BRICK);
                 }
                 else
                 {   // if block is solid, enable shake effect
-                    ShakeTime = 0.05f;
-                    Effects->Shake = true;
-                    SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.mp3").c_str(), false);
+                    this->ShakeTime = 0.05f;
+                    this->Shake = true;
+                    this->playSound(SOUND_SOLID_BRICK);
                 }
                 // collision resolution
                 Direction dir = std::get<1>(collision);
                 glm::vec2 diff_vector = std::get<2>(collision);
-                if (!(Ball->PassThrough && !box.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
+                if (!(this->Ball.PassThrough && !box.IsSolid)) // don't do collision resolution on non-solid bricks if pass-through is activated
                 {
                     if (dir == LEFT || dir == RIGHT) // horizontal collision
                     {
-                        Ball->Velocity.x = -Ball->Velocity.x; // reverse horizontal velocity
+                        this->Ball.Velocity.x = -this->Ball.Velocity.x; // reverse horizontal velocity
                         // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.x);
+                        float penetration = this->Ball.Radius - std::abs(diff_vector.x);
                         if (dir == LEFT)
-                            Ball->Position.x += penetration; // move ball to right
+                            this->Ball.Position.x += penetration; // move ball to right
                         else
-                            Ball->Position.x -= penetration; // move ball to left;
+                            this->Ball.Position.x -= penetration; // move ball to left;
                     }
                     else // vertical collision
                     {
-                        Ball->Velocity.y = -Ball->Velocity.y; // reverse vertical velocity
+                        this->Ball.Velocity.y = -this->Ball.Velocity.y; // reverse vertical velocity
                         // relocate
-                        float penetration = Ball->Radius - std::abs(diff_vector.y);
+                        float penetration = this->Ball.Radius - std::abs(diff_vector.y);
                         if (dir == UP)
-                            Ball->Position.y -= penetration; // move ball bback up
+                            this->Ball.Position.y -= penetration; // move ball bback up
                         else
-                            Ball->Position.y += penetration; // move ball back down
+                            this->Ball.Position.y += penetration; // move ball back down
                     }
                 }
             }
         }    
     }
+    // relocating the ball out of many narrow bricks in one step can push it through the side walls
+    this->Ball.Position.x = glm::clamp(this->Ball.Position.x, 0.0f, this->Width - this->Ball.Size.x);
+
+    // and finally check collisions for player pad (unless stuck)
+    Collision result = CheckCollision(this->Ball, this->Player);
+    if (!this->Ball.Stuck && std::get<0>(result))
+    {
+        // check where it hit the board, and change velocity based on where it hit the board
+        float centerBoard = this->Player.Position.x + this->Player.Size.x / 2.0f;
+        float distance = (this->Ball.Position.x + this->Ball.Radius) - centerBoard;
+        float percentage = distance / (this->Player.Size.x / 2.0f);
+        // then move accordingly
+        float strength = 2.0f;
+        glm::vec2 oldVelocity = this->Ball.Velocity;
+        this->Ball.Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength; 
+        //this->Ball.Velocity.y = -this->Ball.Velocity.y;
+        this->Ball.Velocity = glm::normalize(this->Ball.Velocity) * glm::length(oldVelocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
+        // fix sticky paddle
+        this->Ball.Velocity.y = -1.0f * abs(this->Ball.Velocity.y);
+
+        // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
+        this->Ball.Stuck = this->Ball.Sticky;
+
+        this->playSound(SOUND_PADDLE);
+    }
+}
 
-    // also check collisions on PowerUps and if so, activate them
+void Game::DoPowerUpCollisions()
+{
+    // check collisions on PowerUps and if so, activate them
     for (PowerUp &powerUp : this->PowerUps)
     {
         if (!powerUp.Destroyed)
@@ -463,38 +485,15 @@ void Game::DoCollisions()
             if (powerUp.Position.y >= this->Height)
                 powerUp.Destroyed = true;
 
-            if (CheckCollision(*Player, powerUp))
+            if (CheckCollision(this->Player, powerUp))
             {	// collided with player, now activate powerup
-                ActivatePowerUp(powerUp);
+                this->ActivatePowerUp(powerUp);
                 powerUp.Destroyed = true;
                 powerUp.Activated = true;
-                SoundEngine->play2D(FileSystem::getPath("resources/audio/powerup.wav").c_str(), false);
+                this->playSound(SOUND_POWERUP);
             }
         }
     }
-
-    // and finally check collisions for player pad (unless stuck)
-    Collision result = CheckCollision(*Ball, *Player);
-    if (!Ball->Stuck && std::get<0>(result))
-    {
-        // check where it hit the board, and change velocity based on where it hit the board
-        float centerBoard = Player->Position.x + Player->Size.x / 2.0f;
-        float distance = (Ball->Position.x + Ball->Radius) - centerBoard;
-        float percentage = distance / (Player->Size.x / 2.0f);
-        // then move accordingly
-        float strength = 2.0f;
-        glm::vec2 oldVelocity = Ball->Velocity;
-        Ball->Velocity.x = INITIAL_BALL_VELOCITY.x * percentage * strength; 
-        //Ball->Velocity.y = -Ball->Velocity.y;
-        Ball->Velocity = glm::normalize(Ball->Velocity) * glm::length(oldVelocity); // keep speed consistent over both axes (multiply by length of old velocity, so total strength is not changed)
-        // fix sticky paddle
-        Ball->Velocity.y = -1.0f * abs(Ball->Velocity.y);
-
-        // if Sticky powerup is activated, also stick ball to paddle once new velocity vectors were calculated
-        Ball->Stuck = Ball->Sticky;
-
-        SoundEngine->play2D(FileSystem::getPath("resources/audio/bleep.wav").c_str(), false);
-    }
 }
 
 bool CheckCollision(GameObject &one, GameObject &two) // AABB - AABB collision
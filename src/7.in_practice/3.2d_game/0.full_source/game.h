@@ -10,12 +10,15 @@
 #define GAME_H
 #include <vector>
 #include <tuple>
+#include <random>
+#include <cstdint>
 
-#include <glad/glad.h>
-#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
 
 #include "game_level.h"
 #include "power_up.h"
+#include "ball_object.h"
+#include "game_audio.h"
 
 // Represents the current state of the game
 enum GameState {
@@ -42,10 +45,17 @@ const float PLAYER_VELOCITY(500.0f);
 const glm::vec2 INITIAL_BALL_VELOCITY(100.0f, -350.0f);
 // Radius of the ball object
 const float BALL_RADIUS = 12.5f;
+// Speed the speed PowerUp doesn't raise the ball beyond; it moves in sub-steps of at most its radius
+const float MAX_BALL_SPEED = 5000.0f;
+// Duration of one simulation step; the game always advances by whole ticks
+const float TICK_DURATION = 1.0f / 120.0f;
 
 // Game holds all game-related state and functionality.
 // Combines all game-related data into a single class for
 // easy access to each of the components and manageability.
+// Game is only the simulation: it doesn't render, and plays sound
+// through a GameAudio, so it runs without a window, GL context or
+// audio device. The GameRenderer draws it from its public state.
 class Game
 {
 public:
@@ -58,22 +68,52 @@ public:
     std::vector<PowerUp>    PowerUps;
     unsigned int            Level;
     unsigned int            Lives;
-    // constructor/destructor
-    Game(unsigned int width, unsigned int height);
-    ~Game();
-    // initialize game state (load all shaders/textures/levels)
-    void Init();
+    // number of ticks simulated so far
+    unsigned int            Ticks;
+    // all of the game's randomness comes from here, so a seed and the input determine a session
+    std::mt19937            Random;
+    // game objects
+    GameObject              Player;
+    BallObject              Ball;
+    // effects switched on by the game; the renderer shows them
+    bool                    Shake, Confuse, Chaos;
+    float                   ShakeTime;
+    // where sound goes; nullptr plays none
+    GameAudio              *Audio;
+    // bricks near the ball, from the level's broad phase
+    std::vector<unsigned int> BrickCandidates;
+    // constructor
+    Game(unsigned int width, unsigned int height, unsigned int seed = 1);
+    // initialize game state with the given levels
+    void Init(const std::vector<GameLevel> &levels);
+    // input
+    void SetKey(int key, bool pressed);
     // game loop
+    void Tick(float dt);
     void ProcessInput(float dt);
     void Update(float dt);
-    void Render();
+    // hash of all state the simulation depends on; equal in a recorded session and its replay
+    uint64_t StateHash() const;
+    // moves the ball in steps small enough that it can't pass through bricks, resolving collisions after each step
+    void MoveBall(float dt);
+    // resolves the collisions of the ball with the bricks in BrickCandidates and the player pad
     void DoCollisions();
+    void DoPowerUpCollisions();
     // reset
     void ResetLevel();
     void ResetPlayer();
     // powerups
     void SpawnPowerUps(GameObject &block);
+    void ActivatePowerUp(PowerUp &powerUp);
     void UpdatePowerUps(float dt);
+private:
+    // the levels as they were loaded, to restart a level from
+    std::vector<GameLevel> initialLevels;
+    // plays the sound if the game has audio
+    void playSound(GameSound sound);
 };
 
+// loads the game's four levels from resources/levels for a game of the given size
+std::vector<GameLevel> LoadLevels(unsigned int width, unsigned int height);
+
 #endif
\ No newline at end of file
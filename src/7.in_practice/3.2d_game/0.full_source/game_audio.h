@@ -0,0 +1,33 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_AUDIO_H
+#define GAME_AUDIO_H
+
+
+// The sounds the game plays
+enum GameSound {
+    SOUND_MUSIC,
+    SOUND_BRICK,
+    SOUND_SOLID_BRICK,
+    SOUND_PADDLE,
+    SOUND_POWERUP
+};
+
+// GameAudio is the interface the game plays its sounds through. The
+// game only says which sound to play, so it doesn't depend on an audio
+// library or device; a game without a GameAudio is silent.
+class GameAudio
+{
+public:
+    virtual ~GameAudio() { }
+    // plays the sound; the music loops
+    virtual void Play(GameSound sound) = 0;
+};
+
+#endif
\ No newline at end of file
@@ -13,18 +13,24 @@
 
 
 void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int levelHeight)
+{
+    std::ifstream fstream(file);
+    this->Load(fstream, levelWidth, levelHeight);
+}
+
+void GameLevel::Load(std::istream &stream, unsigned int levelWidth, unsigned int levelHeight)
 {
     // clear old data
     this->Bricks.clear();
-    // load from file
+    this->Grid = BrickGrid();
+    this->remaining = 0;
+    // load from stream
     unsigned int tileCode;
-    GameLevel level;
     std::string line;
-    std::ifstream fstream(file);
     std::vector<std::vector<unsigned int>> tileData;
-    if (fstream)
+    if (stream)
     {
-        while (std::getline(fstream, line)) // read each line from level file
+        while (std::getline(stream, line)) // read each line from level file
         {
             std::istringstream sstream(line);
             std::vector<unsigned int> row;
@@ -32,24 +38,25 @@ void GameLevel::Load(const char *file, unsigned int levelWidth, unsigned int lev
                 row.push_back(tileCode);
             tileData.push_back(row);
         }
-        if (tileData.size() > 0)
+        if (tileData.size() > 0 && tileData[0].size() > 0)
             this->init(tileData, levelWidth, levelHeight);
     }
 }
 
-void GameLevel::Draw(SpriteRenderer &renderer)
+bool GameLevel::IsCompleted()
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.Destroyed)
-            tile.Draw(renderer);
+    return this->remaining == 0;
 }
 
-bool GameLevel::IsCompleted()
+void GameLevel::DestroyBrick(unsigned int index)
 {
-    for (GameObject &tile : this->Bricks)
-        if (!tile.IsSolid && !tile.Destroyed)
-            return false;
-    return true;
+    GameObject &brick = this->Bricks[index];
+    if (brick.Destroyed)
+        return;
+    brick.Destroyed = true;
+    if (!brick.IsSolid)
+        --this->remaining;
+    this->Grid.Remove(index);
 }
 
 void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight)
@@ -58,17 +65,17 @@ void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned i
     unsigned int height = tileData.size();
     unsigned int width = tileData[0].size(); // note we can index vector at [0] since this function is only called if height > 0
     float unit_width = levelWidth / static_cast<float>(width), unit_height = levelHeight / height; 
-    // initialize level tiles based on tileData		
+    // initialize level tiles based on tileData; the first row sets the width, tiles missing from shorter rows are empty
     for (unsigned int y = 0; y < height; ++y)
     {
-        for (unsigned int x = 0; x < width; ++x)
+        for (unsigned int x = 0; x < width && x < tileData[y].size(); ++x)
         {
             // check block type from level data (2D level array)
             if (tileData[y][x] == 1) // solid
             {
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                GameObject obj(pos, size, ResourceManager::GetTexture("block_solid"), glm::vec3(0.8f, 0.8f, 0.7f));
+                GameObject obj(pos, size, glm::vec3(0.8f, 0.8f, 0.7f));
                 obj.IsSolid = true;
                 this->Bricks.push_back(obj);
             }
@@ -86,8 +93,14 @@ void GameLevel::init(std::vector<std::vector<unsigned int>> tileData, unsigned i
 
                 glm::vec2 pos(unit_width * x, unit_height * y);
                 glm::vec2 size(unit_width, unit_height);
-                this->Bricks.push_back(GameObject(pos, size, ResourceManager::GetTexture("block"), color));
+                this->Bricks.push_back(GameObject(pos, size, color));
+                ++this->remaining;
             }
         }
     }
+    // bricks fill the cells of the level's tile grid, so use the same cells for the broad phase
+    std::vector<glm::vec4> boxes;
+    for (GameObject &brick : this->Bricks)
+        boxes.push_back(glm::vec4(brick.Position, brick.Position + brick.Size));
+    this->Grid.Build(boxes, glm::vec2(0.0f), glm::vec2(levelWidth, levelHeight), glm::vec2(unit_width, unit_height));
 }
\ No newline at end of file
@@ -9,31 +9,36 @@
 #ifndef GAMELEVEL_H
 #define GAMELEVEL_H
 #include <vector>
+#include <istream>
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
-#include "sprite_renderer.h"
-#include "resource_manager.h"
+#include "brick_grid.h"
 
 
 /// GameLevel holds all Tiles as part of a Breakout level and 
-/// hosts functionality to Load/render levels from the harddisk.
+/// hosts functionality to Load levels from the harddisk.
 class GameLevel
 {
 public:
     // level state
     std::vector<GameObject> Bricks;
+    // broad phase of the ball's collisions; holds every brick that isn't destroyed
+    BrickGrid               Grid;
     // constructor
-    GameLevel() { }
+    GameLevel() : remaining(0) { }
     // loads level from file
     void Load(const char *file, unsigned int levelWidth, unsigned int levelHeight);
-    // render level
-    void Draw(SpriteRenderer &renderer);
+    // loads level from the text of a level file
+    void Load(std::istream &stream, unsigned int levelWidth, unsigned int levelHeight);
     // check if the level is completed (all non-solid tiles are destroyed)
     bool IsCompleted();
+    // destroys the brick and removes it from the grid
+    void DestroyBrick(unsigned int index);
 private:
+    // number of non-solid bricks left
+    unsigned int remaining;
     // initialize level from tile data
     void init(std::vector<std::vector<unsigned int>> tileData, unsigned int levelWidth, unsigned int levelHeight);
 };
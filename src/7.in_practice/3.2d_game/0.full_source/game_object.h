@@ -9,32 +9,29 @@
 #ifndef GAMEOBJECT_H
 #define GAMEOBJECT_H
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
-#include "texture.h"
-#include "sprite_renderer.h"
-
 
 // Container object for holding all state relevant for a single
 // game object entity. Each object in the game likely needs the
 // minimal of state as described within GameObject.
+// GameObject is pure simulation state; how an object looks is up
+// to the GameRenderer, so the game runs without any GL state.
 class GameObject
 {
 public:
     // object state
     glm::vec2   Position, Size, Velocity;
+    glm::vec2   PreviousPosition; // position at the start of the current tick
     glm::vec3   Color;
     float       Rotation;
     bool        IsSolid;
     bool        Destroyed;
-    // render state
-    Texture2D   Sprite;	
     // constructor(s)
     GameObject();
-    GameObject(glm::vec2 pos, glm::vec2 size, Texture2D sprite, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
-    // draw sprite
-    virtual void Draw(SpriteRenderer &renderer);
+    GameObject(glm::vec2 pos, glm::vec2 size, glm::vec3 color = glm::vec3(1.0f), glm::vec2 velocity = glm::vec2(0.0f, 0.0f));
+    // position between the previous and the current tick; alpha 0 is the previous, 1 the current position
+    glm::vec2 Interpolate(float alpha) const { return glm::mix(this->PreviousPosition, this->Position, alpha); }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,238 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "game_renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+
+#include <GLFW/glfw3.h>
+#include <learnopengl/filesystem.h>
+
+#include "resource_manager.h"
+
+
+// Sprite stress mode (B): draws STRESS_SPRITES spinning sprites on top of the
+// game and reports the frame time every 100 frames
+const unsigned int STRESS_SPRITES = 100000;
+// Particle stress mode (P): an extra emitter sweeping over the screen keeps
+// STRESS_PARTICLES particles alive; its update time is part of the report
+const unsigned int STRESS_PARTICLES = 2000000;
+
+
+GameRenderer::GameRenderer(unsigned int width, unsigned int height)
+    : width(width), height(height), stressTest(false), particleStress(false), stressParticles(nullptr),
+      lastRenderTime(0.0), frameMs(0.0), submitMs(0.0), particleUpdateMs(0.0), frameCount(0)
+{
+    // load shaders
+    ResourceManager::LoadShader("sprite.vs", "sprite.fs", nullptr, "sprite");
+    ResourceManager::LoadShader("particle.vs", "particle.fs", nullptr, "particle");
+    ResourceManager::LoadShader("post_processing.vs", "post_processing.fs", nullptr, "postprocessing");
+    // configure shaders
+    glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(this->width), static_cast<float>(this->height), 0.0f, -1.0f, 1.0f);
+    ResourceManager::GetShader("sprite").Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader("sprite").SetMatrix4("projection", projection);
+    ResourceManager::GetShader("particle").Use().SetInteger("sprite", 0);
+    ResourceManager::GetShader("particle").SetMatrix4("projection", projection);
+    // load textures
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/background.jpg").c_str(), false, "background");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/awesomeface.png").c_str(), true, "face");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/block.png").c_str(), false, "block");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/block_solid.png").c_str(), false, "block_solid");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/paddle.png").c_str(), true, "paddle");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/particle.png").c_str(), true, "particle");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_speed.png").c_str(), true, "powerup_speed");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_sticky.png").c_str(), true, "powerup_sticky");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_increase.png").c_str(), true, "powerup_increase");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_confuse.png").c_str(), true, "powerup_confuse");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_chaos.png").c_str(), true, "powerup_chaos");
+    ResourceManager::LoadTexture(FileSystem::getPath("resources/textures/powerup_passthrough.png").c_str(), true, "powerup_passthrough");
+    // set render-specific controls
+    Shader spriteShader = ResourceManager::GetShader("sprite");
+    this->sprites = new SpriteRenderer(spriteShader);
+    this->particles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), 500);
+    this->effects = new PostProcessor(ResourceManager::GetShader("postprocessing"), this->width, this->height);
+    this->text = new TextRenderer(this->width, this->height);
+    this->text->Load(FileSystem::getPath("resources/fonts/OCRAEXT.TTF").c_str(), 24);
+    this->sceneTimer = new GpuTimer();
+}
+
+GameRenderer::~GameRenderer()
+{
+    delete this->sprites;
+    delete this->particles;
+    delete this->effects;
+    delete this->text;
+    delete this->stressParticles;
+    delete this->sceneTimer;
+}
+
+void GameRenderer::ProcessInput(Game &game)
+{
+    if (game.Keys[GLFW_KEY_B] && !game.KeysProcessed[GLFW_KEY_B])
+    {
+        this->stressTest = !this->stressTest;
+        if (this->stressTest && this->stressSprites.empty())
+        {
+            for (unsigned int i = 0; i < STRESS_SPRITES; ++i)
+            {
+                StressSprite sprite;
+                sprite.Position = glm::vec2(rand() % this->width, rand() % this->height);
+                sprite.Size = glm::vec2(4.0f + rand() % 28, 4.0f + rand() % 28);
+                sprite.Color = glm::vec3(0.3f + (rand() % 70) / 100.0f, 0.3f + (rand() % 70) / 100.0f, 0.3f + (rand() % 70) / 100.0f);
+                sprite.Spin = (rand() % 360) - 180.0f;
+                sprite.Texture = rand() % 4;
+                this->stressSprites.push_back(sprite);
+            }
+        }
+        this->resetStats();
+        game.KeysProcessed[GLFW_KEY_B] = true;
+    }
+    if (game.Keys[GLFW_KEY_P] && !game.KeysProcessed[GLFW_KEY_P])
+    {
+        this->particleStress = !this->particleStress;
+        if (this->particleStress && !this->stressParticles)
+            this->stressParticles = new ParticleGenerator(ResourceManager::GetShader("particle"), ResourceManager::GetTexture("particle"), STRESS_PARTICLES, 2);
+        this->resetStats();
+        game.KeysProcessed[GLFW_KEY_P] = true;
+    }
+}
+
+void GameRenderer::Update(const Game &game, float dt)
+{
+    // the ball's trail
+    this->particles->Update(dt, game.Ball, 2, glm::vec2(game.Ball.Radius / 2.0f));
+    if (this->particleStress)
+    {
+        // spawn as many particles per second as live at once (particles live for one second)
+        float time = glfwGetTime();
+        this->stressEmitter.Position = glm::vec2(this->width * (0.5f + 0.45f * sin(time * 1.3f)), this->height * (0.5f + 0.45f * sin(time * 2.1f)));
+        this->stressEmitter.Velocity = glm::vec2(cos(time * 0.7f), sin(time * 0.7f)) * 1500.0f;
+        double start = glfwGetTime();
+        this->stressParticles->Update(dt, this->stressEmitter, static_cast<unsigned int>(STRESS_PARTICLES * std::min(dt, 1.0f)));
+        this->particleUpdateMs += (glfwGetTime() - start) * 1000.0;
+    }
+}
+
+// texture of each type of PowerUp
+static const char *PowerUpTexture(const std::string &type)
+{
+    if (type == "speed")
+        return "powerup_speed";
+    else if (type == "sticky")
+        return "powerup_sticky";
+    else if (type == "pass-through")
+        return "powerup_passthrough";
+    else if (type == "pad-size-increase")
+        return "powerup_increase";
+    else if (type == "confuse")
+        return "powerup_confuse";
+    return "powerup_chaos";
+}
+
+void GameRenderer::Render(const Game &game, float alpha)
+{
+    if (game.State == GAME_ACTIVE || game.State == GAME_MENU || game.State == GAME_WIN)
+    {
+        double submitStart = glfwGetTime();
+        this->sceneTimer->Begin();
+        // the effects the game switched on
+        this->effects->Shake = game.Shake;
+        this->effects->Confuse = game.Confuse;
+        this->effects->Chaos = game.Chaos;
+        // begin rendering to postprocessing framebuffer
+        this->effects->BeginRender();
+            // draw background
+            this->sprites->SetLayer(0);
+            Texture2D background = ResourceManager::GetTexture("background");
+            this->sprites->DrawSprite(background, glm::vec2(0.0f, 0.0f), glm::vec2(this->width, this->height), 0.0f);
+            // draw level; bricks don't move
+            this->sprites->SetLayer(1);
+            for (const GameObject &brick : game.Levels[game.Level].Bricks)
+                if (!brick.Destroyed)
+                    this->drawObject(brick.IsSolid ? "block_solid" : "block", brick, 1.0f);
+            // draw player
+            this->sprites->SetLayer(2);
+            this->drawObject("paddle", game.Player, alpha);
+            // draw PowerUps
+            for (const PowerUp &powerUp : game.PowerUps)
+                if (!powerUp.Destroyed)
+                    this->drawObject(PowerUpTexture(powerUp.Type), powerUp, alpha);
+            // the sprites queued so far go below the particles
+            this->sprites->Flush();
+            // draw particles	
+            this->particles->Draw();
+            if (this->particleStress)
+                this->stressParticles->Draw();
+            // draw ball
+            this->sprites->SetLayer(0);
+            this->drawObject("face", game.Ball, alpha);
+            // draw stress test sprites
+            if (this->stressTest)
+            {
+                Texture2D textures[4] = { ResourceManager::GetTexture("block"), ResourceManager::GetTexture("block_solid"),
+                                          ResourceManager::GetTexture("face"), ResourceManager::GetTexture("particle") };
+                float time = glfwGetTime();
+                this->sprites->SetLayer(1);
+                for (const StressSprite &sprite : this->stressSprites)
+                    this->sprites->DrawSprite(textures[sprite.Texture], sprite.Position, sprite.Size, sprite.Spin * time, sprite.Color);
+            }
+            this->sprites->Flush();
+        // end rendering to postprocessing framebuffer
+        this->effects->EndRender();
+        this->sceneTimer->End();
+        double now = glfwGetTime();
+        this->submitMs += (now - submitStart) * 1000.0;
+        if (this->lastRenderTime > 0.0)
+            this->frameMs += (now - this->lastRenderTime) * 1000.0;
+        this->lastRenderTime = now;
+        if ((this->stressTest || this->particleStress) && ++this->frameCount % 100 == 0)
+        {
+            std::cout << "sprites: " << this->sprites->SpritesDrawn / 100 << ", draw calls: " << this->sprites->DrawCalls / 100;
+            if (this->particleStress)
+                std::cout << ", particles: " << this->stressParticles->Alive() << ", particle update (cpu): " << this->particleUpdateMs / 100.0 << " ms";
+            std::cout << ", frame: " << this->frameMs / 100.0 << " ms, scene submit (cpu): " << this->submitMs / 100.0
+                      << " ms, scene (gpu): " << this->sceneTimer->AverageMs() << " ms" << std::endl;
+            this->frameMs = this->submitMs = this->particleUpdateMs = 0.0;
+            this->sceneTimer->Reset();
+        }
+        if (this->frameCount % 100 == 0)
+            this->sprites->ResetStats();
+        // render postprocessing quad
+        this->effects->Render(glfwGetTime());
+        // render text (don't include in postprocessing)
+        std::stringstream ss; ss << game.Lives;
+        this->text->RenderText("Lives:" + ss.str(), 5.0f, 5.0f, 1.0f);
+    }
+    if (game.State == GAME_MENU)
+    {
+        this->text->RenderText("Press ENTER to start", 250.0f, this->height / 2.0f, 1.0f);
+        this->text->RenderText("Press W or S to select level", 245.0f, this->height / 2.0f + 20.0f, 0.75f);
+    }
+    if (game.State == GAME_WIN)
+    {
+        this->text->RenderText("You WON!!!", 320.0f, this->height / 2.0f - 20.0f, 1.0f, glm::vec3(0.0f, 1.0f, 0.0f));
+        this->text->RenderText("Press ENTER to retry or ESC to quit", 130.0f, this->height / 2.0f, 1.0f, glm::vec3(1.0f, 1.0f, 0.0f));
+    }
+}
+
+void GameRenderer::drawObject(const char *texture, const GameObject &object, float alpha)
+{
+    Texture2D sprite = ResourceManager::GetTexture(texture);
+    this->sprites->DrawSprite(sprite, object.Interpolate(alpha), object.Size, object.Rotation, object.Color);
+}
+
+void GameRenderer::resetStats()
+{
+    this->frameCount = 0;
+    this->frameMs = this->submitMs = this->particleUpdateMs = 0.0;
+    this->sceneTimer->Reset();
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef GAME_RENDERER_H
+#define GAME_RENDERER_H
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/gpu_timer.h>
+
+#include "game.h"
+#include "sprite_renderer.h"
+#include "particle_generator.h"
+#include "post_processor.h"
+#include "text_renderer.h"
+
+
+// GameRenderer draws a Game with OpenGL. It owns all GL resources
+// (shaders, textures, sprite batches, particles, post-processing and
+// text) and draws from the game's public state, leaving the game
+// unchanged apart from marking its own keys as processed; the game in
+// turn doesn't know it is being drawn. Besides the game it
+// hosts the renderer's stress modes: B draws STRESS_SPRITES extra
+// sprites and P keeps STRESS_PARTICLES particles alive, both reporting
+// their frame times every 100 frames.
+class GameRenderer
+{
+public:
+    // constructor/destructor; loads all shaders/textures, so needs a GL context
+    GameRenderer(unsigned int width, unsigned int height);
+    ~GameRenderer();
+    // handles the keys of the stress modes
+    void ProcessInput(Game &game);
+    // advances the particles along with a tick of the game
+    void Update(const Game &game, float dt);
+    // renders the state between the game's last two ticks: alpha 0 is the previous tick, 1 the latest
+    void Render(const Game &game, float alpha = 1.0f);
+private:
+    // render state
+    unsigned int       width, height;
+    SpriteRenderer    *sprites;
+    ParticleGenerator *particles;
+    PostProcessor     *effects;
+    TextRenderer      *text;
+    // sprite stress mode
+    struct StressSprite {
+        glm::vec2    Position, Size;
+        glm::vec3    Color;
+        float        Spin;
+        unsigned int Texture;
+    };
+    bool                      stressTest;
+    std::vector<StressSprite> stressSprites;
+    // particle stress mode; an extra emitter sweeping over the screen
+    bool                      particleStress;
+    ParticleGenerator        *stressParticles;
+    GameObject                stressEmitter;
+    // timing of the stress modes
+    GpuTimer                 *sceneTimer;
+    double                    lastRenderTime;
+    double                    frameMs, submitMs, particleUpdateMs;
+    unsigned int              frameCount;
+    // draws the object with the texture at its interpolated position
+    void drawObject(const char *texture, const GameObject &object, float alpha);
+    // starts a new report of the stress modes
+    void resetStats();
+};
+
+#endif
\ No newline at end of file
@@ -1,17 +1,19 @@
 #version 330 core
 layout (location = 0) in vec4 vertex; // <vec2 position, vec2 texCoords>
+layout (location = 1) in float offsetX; // per particle
+layout (location = 2) in float offsetY;
+layout (location = 3) in float brightness;
+layout (location = 4) in float alpha;
 
 out vec2 TexCoords;
 out vec4 ParticleColor;
 
 uniform mat4 projection;
-uniform vec2 offset;
-uniform vec4 color;
 
 void main()
 {
     float scale = 10.0f;
     TexCoords = vertex.zw;
-    ParticleColor = color;
-    gl_Position = projection * vec4((vertex.xy * scale) + offset, 0.0, 1.0);
+    ParticleColor = vec4(vec3(brightness), alpha);
+    gl_Position = projection * vec4((vertex.xy * scale) + vec2(offsetX, offsetY), 0.0, 1.0);
 }
\ No newline at end of file
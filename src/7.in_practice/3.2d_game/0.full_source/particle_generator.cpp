@@ -8,51 +8,93 @@
 ******************************************************************/
 #include "particle_generator.h"
 
-ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount)
-    : shader(shader), texture(texture), amount(amount)
+#include <algorithm>
+
+ParticleGenerator::ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, unsigned int seed)
+    : amount(amount), first(0), count(0), generator(seed), shader(shader), texture(texture)
 {
     this->init();
 }
 
-void ParticleGenerator::Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset)
+ParticleGenerator::~ParticleGenerator()
+{
+    glDeleteVertexArrays(1, &this->VAO);
+    glDeleteBuffers(4, this->VBO);
+}
+
+void ParticleGenerator::Update(float dt, const GameObject &object, unsigned int newParticles, glm::vec2 offset)
 {
-    // add new particles 
+    // add new particles after the youngest one
     for (unsigned int i = 0; i < newParticles; ++i)
     {
-        int unusedParticle = this->firstUnusedParticle();
-        this->respawnParticle(this->particles[unusedParticle], object, offset);
+        // all particles are taken, override the oldest one (note that if it repeatedly hits this case, more particles should be reserved)
+        if (this->count == this->amount)
+        {
+            this->first = (this->first + 1) % this->amount;
+            --this->count;
+        }
+        this->respawnParticle((this->first + this->count) % this->amount, object, offset);
+        ++this->count;
     }
-    // update all particles
-    for (unsigned int i = 0; i < this->amount; ++i)
+    // update all live particles, in two parts if their range wraps around the end of the ring
+    unsigned int end = this->first + this->count;
+    if (end <= this->amount)
+        this->simulate(this->first, end, dt);
+    else
     {
-        Particle &p = this->particles[i];
-        p.Life -= dt; // reduce life
-        if (p.Life > 0.0f)
-        {	// particle is alive, thus update
-            p.Position -= p.Velocity * dt; 
-            p.Color.a -= dt * 2.5f;
-        }
+        this->simulate(this->first, this->amount, dt);
+        this->simulate(0, end - this->amount, dt);
+    }
+    // the oldest particles die first
+    while (this->count > 0 && this->life[this->first] <= 0.0f)
+    {
+        this->first = (this->first + 1) % this->amount;
+        --this->count;
+    }
+}
+
+void ParticleGenerator::simulate(unsigned int begin, unsigned int end, float dt)
+{
+    // no branches, so the loop is vectorized; particles that die in this step still move and fade
+    // once more, but Update() drops them before they are drawn
+    float *positionX = this->positionX.data(), *positionY = this->positionY.data();
+    const float *velocityX = this->velocityX.data(), *velocityY = this->velocityY.data();
+    float *alpha = this->alpha.data(), *life = this->life.data();
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        life[i] -= dt; // reduce life
+        positionX[i] -= velocityX[i] * dt;
+        positionY[i] -= velocityY[i] * dt;
+        alpha[i] -= dt * 2.5f;
     }
 }
 
 // render all particles
 void ParticleGenerator::Draw()
 {
+    if (this->count == 0)
+        return;
+    // copy the live particles to the start of the vertex buffers, one buffer per attribute array
+    const std::vector<float> *attributes[4] = { &this->positionX, &this->positionY, &this->brightness, &this->alpha };
+    unsigned int firstPart = std::min(this->count, this->amount - this->first);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO[i]);
+        // orphan the previous frame's data so the upload doesn't wait for its draw
+        glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(float), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, firstPart * sizeof(float), attributes[i]->data() + this->first);
+        if (firstPart < this->count)
+            glBufferSubData(GL_ARRAY_BUFFER, firstPart * sizeof(float), (this->count - firstPart) * sizeof(float), attributes[i]->data());
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     // use additive blending to give it a 'glow' effect
     glBlendFunc(GL_SRC_ALPHA, GL_ONE);
     this->shader.Use();
-    for (Particle particle : this->particles)
-    {
-        if (particle.Life > 0.0f)
-        {
-            this->shader.SetVector2f("offset", particle.Position);
-            this->shader.SetVector4f("color", particle.Color);
-            this->texture.Bind();
-            glBindVertexArray(this->VAO);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
-            glBindVertexArray(0);
-        }
-    }
+    glActiveTexture(GL_TEXTURE0);
+    this->texture.Bind();
+    glBindVertexArray(this->VAO);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, 6, this->count);
+    glBindVertexArray(0);
     // don't forget to reset to default blending mode
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
@@ -60,7 +102,7 @@ void ParticleGenerator::Draw()
 void ParticleGenerator::init()
 {
     // set up mesh and attribute properties
-    unsigned int VBO;
+    unsigned int quadVBO;
     float particle_quad[] = {
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
@@ -69,52 +111,48 @@ void ParticleGenerator::init()
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 1.0f, 1.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f
-    }; 
+    };
     glGenVertexArrays(1, &this->VAO);
-    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &quadVBO);
     glBindVertexArray(this->VAO);
     // fill mesh buffer
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBindBuffer(GL_ARRAY_BUFFER, quadVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(particle_quad), particle_quad, GL_STATIC_DRAW);
     // set mesh attributes
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // one float per particle from each of the attribute buffers
+    glGenBuffers(4, this->VBO);
+    for (unsigned int i = 0; i < 4; ++i)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO[i]);
+        glBufferData(GL_ARRAY_BUFFER, this->amount * sizeof(float), nullptr, GL_STREAM_DRAW);
+        glEnableVertexAttribArray(i + 1);
+        glVertexAttribPointer(i + 1, 1, GL_FLOAT, GL_FALSE, sizeof(float), (void*)0);
+        glVertexAttribDivisor(i + 1, 1);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 
-    // create this->amount default particle instances
-    for (unsigned int i = 0; i < this->amount; ++i)
-        this->particles.push_back(Particle());
-}
-
-// stores the index of the last particle used (for quick access to next dead particle)
-unsigned int lastUsedParticle = 0;
-unsigned int ParticleGenerator::firstUnusedParticle()
-{
-    // first search from last used particle, this will usually return almost instantly
-    for (unsigned int i = lastUsedParticle; i < this->amount; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // otherwise, do a linear search
-    for (unsigned int i = 0; i < lastUsedParticle; ++i){
-        if (this->particles[i].Life <= 0.0f){
-            lastUsedParticle = i;
-            return i;
-        }
-    }
-    // all particles are taken, override the first one (note that if it repeatedly hits this case, more particles should be reserved)
-    lastUsedParticle = 0;
-    return 0;
+    // reserve this->amount particles
+    this->positionX.resize(this->amount);
+    this->positionY.resize(this->amount);
+    this->velocityX.resize(this->amount);
+    this->velocityY.resize(this->amount);
+    this->brightness.resize(this->amount);
+    this->alpha.resize(this->amount);
+    this->life.resize(this->amount);
 }
 
-void ParticleGenerator::respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset)
+void ParticleGenerator::respawnParticle(unsigned int i, const GameObject &object, glm::vec2 offset)
 {
-    float random = ((rand() % 100) - 50) / 10.0f;
-    float rColor = 0.5f + ((rand() % 100) / 100.0f);
-    particle.Position = object.Position + random + offset;
-    particle.Color = glm::vec4(rColor, rColor, rColor, 1.0f);
-    particle.Life = 1.0f;
-    particle.Velocity = object.Velocity * 0.1f;
+    float random = (static_cast<int>(this->generator() % 100) - 50) / 10.0f;
+    float rColor = 0.5f + ((this->generator() % 100) / 100.0f);
+    this->positionX[i] = object.Position.x + random + offset.x;
+    this->positionY[i] = object.Position.y + random + offset.y;
+    this->brightness[i] = rColor;
+    this->alpha[i] = 1.0f;
+    this->life[i] = 1.0f;
+    this->velocityX[i] = object.Velocity.x * 0.1f;
+    this->velocityY[i] = object.Velocity.y * 0.1f;
 }
\ No newline at end of file
@@ -9,6 +9,7 @@
 #ifndef PARTICLE_GENERATOR_H
 #define PARTICLE_GENERATOR_H
 #include <vector>
+#include <random>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -18,42 +19,51 @@
 #include "game_object.h"
 
 
-// Represents a single particle and its state
-struct Particle {
-    glm::vec2 Position, Velocity;
-    glm::vec4 Color;
-    float     Life;
-
-    Particle() : Position(0.0f), Velocity(0.0f), Color(1.0f), Life(0.0f) { }
-};
-
-
-// ParticleGenerator acts as a container for rendering a large number of 
-// particles by repeatedly spawning and updating particles and killing 
+// ParticleGenerator acts as a container for rendering a large number of
+// particles by repeatedly spawning and updating particles and killing
 // them after a given amount of time.
+// Particles are stored as a structure of arrays, one float array per
+// attribute, so the update loops run over contiguous memory the compiler
+// can vectorize, and the arrays are uploaded as they are to one vertex
+// buffer per attribute for a single instanced draw. All particles live
+// equally long, so they die in the order they were spawned: the storage is
+// a ring where new particles go after the youngest and dead ones are
+// dropped from the oldest end, and the live particles always form one
+// (possibly wrapped) range. Each generator has its own ring and random
+// state.
 class ParticleGenerator
 {
 public:
     // constructor
-    ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount);
+    ParticleGenerator(Shader shader, Texture2D texture, unsigned int amount, unsigned int seed = 1);
+    // destructor
+    ~ParticleGenerator();
     // update all particles
-    void Update(float dt, GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    void Update(float dt, const GameObject &object, unsigned int newParticles, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
     // render all particles
     void Draw();
+    // number of particles currently alive
+    unsigned int Alive() const { return this->count; }
 private:
-    // state
-    std::vector<Particle> particles;
+    // state; particle i is (positionX[i], positionY[i]) etc.
+    std::vector<float> positionX, positionY;
+    std::vector<float> velocityX, velocityY;
+    std::vector<float> brightness, alpha;
+    std::vector<float> life;
     unsigned int amount;
+    unsigned int first, count; // live particles are first .. first + count - 1, wrapping at amount
+    std::minstd_rand generator;
     // render state
     Shader shader;
     Texture2D texture;
     unsigned int VAO;
+    unsigned int VBO[4]; // positionX, positionY, brightness, alpha
     // initializes buffer and vertex attributes
     void init();
-    // returns the first Particle index that's currently unused e.g. Life <= 0.0f or 0 if no particle is currently inactive
-    unsigned int firstUnusedParticle();
-    // respawns particle
-    void respawnParticle(Particle &particle, GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // respawns the particle at index i
+    void respawnParticle(unsigned int i, const GameObject &object, glm::vec2 offset = glm::vec2(0.0f, 0.0f));
+    // advances particles begin .. end - 1 by dt
+    void simulate(unsigned int begin, unsigned int end, float dt);
 };
 
 #endif
\ No newline at end of file
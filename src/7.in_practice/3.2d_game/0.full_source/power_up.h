@@ -10,7 +10,6 @@
 #define POWER_UP_H
 #include <string>
 
-#include <glad/glad.h>
 #include <glm/glm.hpp>
 
 #include "game_object.h"
@@ -34,8 +33,8 @@ public:
     float       Duration;	
     bool        Activated;
     // constructor
-    PowerUp(std::string type, glm::vec3 color, float duration, glm::vec2 position, Texture2D texture) 
-        : GameObject(position, POWERUP_SIZE, texture, color, VELOCITY), Type(type), Duration(duration), Activated() { }
+    PowerUp(std::string type, glm::vec3 color, float duration, glm::vec2 position) 
+        : GameObject(position, POWERUP_SIZE, color, VELOCITY), Type(type), Duration(duration), Activated() { }
 };
 
 #endif
\ No newline at end of file
@@ -10,9 +10,16 @@
 #include <GLFW/glfw3.h>
 
 #include "game.h"
+#include "game_renderer.h"
+#include "sound_engine.h"
 #include "resource_manager.h"
+#include "replay.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <random>
 
 // GLFW function declarations
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -25,8 +32,25 @@ const unsigned int SCREEN_HEIGHT = 600;
 
 Game Breakout(SCREEN_WIDTH, SCREEN_HEIGHT);
 
+// the session being recorded, if any
+Replay *Recording = nullptr;
+// a checkpoint of the game state is recorded every CHECKPOINT_TICKS ticks
+const unsigned int CHECKPOINT_TICKS = 120;
+
 int main(int argc, char *argv[])
 {
+    // command line: [--seed N] [--record file]; 3.2d_game__1.headless --replay file plays a recording back
+    const char *recordFile = nullptr;
+    unsigned int seed = std::random_device()();
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            recordFile = argv[++i];
+    }
+    Breakout.Random.seed(seed);
+
     glfwInit();
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
@@ -58,41 +82,69 @@ int main(int argc, char *argv[])
 
     // initialize game
     // ---------------
-    Breakout.Init();
+    GameRenderer *renderer = new GameRenderer(SCREEN_WIDTH, SCREEN_HEIGHT);
+    SoundEngine sound;
+    Breakout.Audio = &sound;
+    Breakout.Init(LoadLevels(SCREEN_WIDTH, SCREEN_HEIGHT));
 
-    // deltaTime variables
-    // -------------------
-    float deltaTime = 0.0f;
-    float lastFrame = 0.0f;
+    Replay replay;
+    if (recordFile)
+    {
+        Recording = &replay;
+        replay.Seed = seed;
+    }
+
+    // fixed timestep: the game advances in ticks of TICK_DURATION, however long a frame takes,
+    // and the frame shows the state between the last two ticks
+    // ------------------------------------------------------------------------------------------
+    double accumulator = 0.0;
+    double lastFrame = glfwGetTime();
 
     while (!glfwWindowShouldClose(window))
     {
-        // calculate delta time
+        // calculate delta time; after a long stall (e.g. moving the window) don't try to catch up more than a quarter second
         // --------------------
-        float currentFrame = glfwGetTime();
-        deltaTime = currentFrame - lastFrame;
+        double currentFrame = glfwGetTime();
+        accumulator += std::min(currentFrame - lastFrame, 0.25);
         lastFrame = currentFrame;
         glfwPollEvents();
 
-        // manage user input
-        // -----------------
-        Breakout.ProcessInput(deltaTime);
-
-        // update game state
-        // -----------------
-        Breakout.Update(deltaTime);
+        // manage user input and update game state
+        // ---------------------------------------
+        renderer->ProcessInput(Breakout);
+        while (accumulator >= TICK_DURATION)
+        {
+            Breakout.Tick(TICK_DURATION);
+            renderer->Update(Breakout, TICK_DURATION);
+            accumulator -= TICK_DURATION;
+            if (Recording && Breakout.Ticks % CHECKPOINT_TICKS == 0)
+                Recording->Checkpoints.push_back({ Breakout.Ticks, Breakout.StateHash() });
+        }
 
         // render
         // ------
         glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT);
-        Breakout.Render();
+        renderer->Render(Breakout, static_cast<float>(accumulator / TICK_DURATION));
 
         glfwSwapBuffers(window);
     }
 
+    if (Recording)
+    {
+        replay.Ticks = Breakout.Ticks;
+        if (replay.Checkpoints.empty() || replay.Checkpoints.back().Tick != replay.Ticks)
+            replay.Checkpoints.push_back({ replay.Ticks, Breakout.StateHash() });
+        if (replay.Save(recordFile))
+            std::cout << "recorded " << replay.Ticks << " ticks to " << recordFile << std::endl;
+        else
+            std::cout << "Failed to write replay " << recordFile << std::endl;
+    }
+
     // delete all resources as loaded using the resource manager
     // ---------------------------------------------------------
+    Breakout.Audio = nullptr;
+    delete renderer;
     ResourceManager::Clear();
 
     glfwTerminate();
@@ -104,15 +156,12 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     // when a user presses the escape key, we set the WindowShouldClose property to true, closing the application
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
         glfwSetWindowShouldClose(window, true);
-    if (key >= 0 && key < 1024)
+    if (key >= 0 && key < 1024 && (action == GLFW_PRESS || action == GLFW_RELEASE))
     {
-        if (action == GLFW_PRESS)
-            Breakout.Keys[key] = true;
-        else if (action == GLFW_RELEASE)
-        {
-            Breakout.Keys[key] = false;
-            Breakout.KeysProcessed[key] = false;
-        }
+        // the key takes effect at the next tick
+        Breakout.SetKey(key, action == GLFW_PRESS);
+        if (Recording)
+            Recording->Events.push_back({ Breakout.Ticks, key, action == GLFW_PRESS });
     }
 }
 
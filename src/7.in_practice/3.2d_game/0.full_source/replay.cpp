@@ -0,0 +1,65 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "replay.h"
+
+#include <fstream>
+#include <sstream>
+
+
+bool Replay::Save(const char *file) const
+{
+    std::ofstream fstream(file);
+    if (!fstream)
+        return false;
+    fstream << "breakout-replay 1\n";
+    fstream << "seed " << this->Seed << "\n";
+    fstream << "ticks " << this->Ticks << "\n";
+    for (const KeyEvent &event : this->Events)
+        fstream << "key " << event.Tick << " " << event.Key << " " << (event.Pressed ? 1 : 0) << "\n";
+    for (const Checkpoint &checkpoint : this->Checkpoints)
+        fstream << "checkpoint " << checkpoint.Tick << " " << checkpoint.Hash << "\n";
+    return static_cast<bool>(fstream);
+}
+
+bool Replay::Load(const char *file)
+{
+    this->Events.clear();
+    this->Checkpoints.clear();
+    std::ifstream fstream(file);
+    std::string line, word;
+    if (!std::getline(fstream, line) || line != "breakout-replay 1")
+        return false;
+    while (std::getline(fstream, line)) // read each entry
+    {
+        std::istringstream sstream(line);
+        if (!(sstream >> word))
+            continue;
+        if (word == "seed")
+            sstream >> this->Seed;
+        else if (word == "ticks")
+            sstream >> this->Ticks;
+        else if (word == "key")
+        {
+            KeyEvent event;
+            int pressed = 0;
+            sstream >> event.Tick >> event.Key >> pressed;
+            event.Pressed = pressed != 0;
+            this->Events.push_back(event);
+        }
+        else if (word == "checkpoint")
+        {
+            Checkpoint checkpoint;
+            sstream >> checkpoint.Tick >> checkpoint.Hash;
+            this->Checkpoints.push_back(checkpoint);
+        }
+        if (sstream.fail())
+            return false;
+    }
+    return true;
+}
\ No newline at end of file
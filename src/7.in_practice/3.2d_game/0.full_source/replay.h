@@ -0,0 +1,52 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef REPLAY_H
+#define REPLAY_H
+#include <vector>
+#include <string>
+#include <cstdint>
+
+
+// A key press or release, applied right before the given tick is simulated
+struct KeyEvent {
+    unsigned int Tick;
+    int          Key;
+    bool         Pressed;
+};
+
+// The hash of the game state after the given tick
+struct Checkpoint {
+    unsigned int Tick;
+    uint64_t     Hash;
+};
+
+// Replay holds a recorded session: the seed of the game's random
+// generator and every key event with the tick it took effect at. As
+// the game advances in fixed ticks, feeding the same events to a game
+// with the same seed reproduces the session bit for bit, without a
+// window or real time. The state hashes at regular checkpoints tell
+// whether a replay still matches the recording, and from which tick on
+// it doesn't. Replays are stored as text, one entry per line.
+class Replay
+{
+public:
+    // recorded state
+    unsigned int            Seed;
+    unsigned int            Ticks;
+    std::vector<KeyEvent>   Events;
+    std::vector<Checkpoint> Checkpoints;
+    // constructor
+    Replay() : Seed(0), Ticks(0) { }
+    // writes the replay to file; returns false if the file can't be written
+    bool Save(const char *file) const;
+    // reads a replay written by Save; returns false if the file can't be read or isn't a replay
+    bool Load(const char *file);
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,35 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#include "sound_engine.h"
+
+#include <learnopengl/filesystem.h>
+
+
+SoundEngine::SoundEngine()
+    : engine(irrklang::createIrrKlangDevice()) { }
+
+SoundEngine::~SoundEngine()
+{
+    if (this->engine)
+        this->engine->drop();
+}
+
+void SoundEngine::Play(GameSound sound)
+{
+    if (!this->engine)
+        return;
+    if (sound == SOUND_MUSIC)
+        this->engine->play2D(FileSystem::getPath("resources/audio/breakout.mp3").c_str(), true);
+    else if (sound == SOUND_BRICK || sound == SOUND_SOLID_BRICK)
+        this->engine->play2D(FileSystem::getPath("resources/audio/bleep.mp3").c_str(), false);
+    else if (sound == SOUND_PADDLE)
+        this->engine->play2D(FileSystem::getPath("resources/audio/bleep.wav").c_str(), false);
+    else if (sound == SOUND_POWERUP)
+        this->engine->play2D(FileSystem::getPath("resources/audio/powerup.wav").c_str(), false);
+}
\ No newline at end of file
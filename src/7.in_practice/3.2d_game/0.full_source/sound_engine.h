@@ -0,0 +1,31 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+#ifndef SOUND_ENGINE_H
+#define SOUND_ENGINE_H
+
+#include <irrklang/irrKlang.h>
+
+#include "game_audio.h"
+
+
+// SoundEngine plays the game's sounds with irrKlang, loading them
+// from resources/audio.
+class SoundEngine : public GameAudio
+{
+public:
+    // constructor/destructor
+    SoundEngine();
+    ~SoundEngine();
+    // plays the sound; the music loops
+    void Play(GameSound sound) override;
+private:
+    irrklang::ISoundEngine *engine;
+};
+
+#endif
\ No newline at end of file
@@ -8,8 +8,12 @@
 ******************************************************************/
 #include "sprite_renderer.h"
 
+#include <algorithm>
+#include <cstddef>
+
 
 SpriteRenderer::SpriteRenderer(Shader &shader)
+    : SpritesDrawn(0), DrawCalls(0), instanceCapacity(0), layer(0), lastBatch(0)
 {
     this->shader = shader;
     this->initRenderData();
@@ -18,43 +22,131 @@ SpriteRenderer::SpriteRenderer(Shader &shader)
 SpriteRenderer::~SpriteRenderer()
 {
     glDeleteVertexArrays(1, &this->quadVAO);
+    glDeleteBuffers(1, &this->instanceVBO);
 }
 
 void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
 {
-    // prepare transformations
-    this->shader.Use();
-    glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, glm::vec3(position, 0.0f));  // first translate (transformations are: scale happens first, then rotation, and then final translation happens; reversed order)
+    this->DrawSprite(texture, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), position, size, rotate, color);
+}
 
-    model = glm::translate(model, glm::vec3(0.5f * size.x, 0.5f * size.y, 0.0f)); // move origin of rotation to center of quad
-    model = glm::rotate(model, glm::radians(rotate), glm::vec3(0.0f, 0.0f, 1.0f)); // then rotate
-    model = glm::translate(model, glm::vec3(-0.5f * size.x, -0.5f * size.y, 0.0f)); // move origin back
+void SpriteRenderer::DrawSprite(Texture2D &texture, glm::vec4 texRect, glm::vec2 position, glm::vec2 size, float rotate, glm::vec3 color)
+{
+    // the vertex shader scales the unit quad by size, rotates it around its center and then moves it to position
+    SpriteInstance sprite;
+    sprite.Rect = glm::vec4(position, size);
+    sprite.ColorRotation = glm::vec4(color, glm::radians(rotate));
+    sprite.TexRect = texRect;
+    this->batchFor(texture.ID).instances.push_back(sprite);
+}
 
-    model = glm::scale(model, glm::vec3(size, 1.0f)); // last scale
+void SpriteRenderer::SetLayer(unsigned int layer)
+{
+    this->layer = layer;
+}
 
-    this->shader.SetMatrix4("model", model);
+void SpriteRenderer::Flush()
+{
+    // order the non-empty batches by layer, then by texture; there are only a few of them
+    this->order.clear();
+    unsigned int total = 0;
+    for (unsigned int i = 0; i < this->batches.size(); ++i)
+    {
+        if (!this->batches[i].instances.empty())
+        {
+            this->order.push_back(i);
+            total += this->batches[i].instances.size();
+        }
+    }
+    if (total == 0)
+        return;
+    std::sort(this->order.begin(), this->order.end(), [this](unsigned int a, unsigned int b) {
+        const Batch &one = this->batches[a], &two = this->batches[b];
+        return one.layer != two.layer ? one.layer < two.layer : one.textureID < two.textureID;
+    });
 
-    // render textured quad
-    this->shader.SetVector3f("spriteColor", color);
+    // stream all sprites into the instance buffer; orphaning the old storage lets the driver
+    // hand out fresh memory instead of waiting for draws still reading the previous contents
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    if (total > this->instanceCapacity)
+        this->instanceCapacity = std::max(total, this->instanceCapacity * 2);
+    glBufferData(GL_ARRAY_BUFFER, this->instanceCapacity * sizeof(SpriteInstance), nullptr, GL_STREAM_DRAW);
+    size_t offset = 0;
+    for (unsigned int i : this->order)
+    {
+        const std::vector<SpriteInstance> &instances = this->batches[i].instances;
+        glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(SpriteInstance), instances.size() * sizeof(SpriteInstance), instances.data());
+        offset += instances.size();
+    }
 
+    // one draw per batch; the instanced attributes are pointed at the batch's range of the buffer
+    this->shader.Use();
     glActiveTexture(GL_TEXTURE0);
-    texture.Bind();
-
     glBindVertexArray(this->quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    offset = 0;
+    for (unsigned int i : this->order)
+    {
+        Batch &batch = this->batches[i];
+        size_t base = offset * sizeof(SpriteInstance);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, Rect)));
+        glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, ColorRotation)));
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(SpriteInstance), (void*)(base + offsetof(SpriteInstance, TexRect)));
+        glBindTexture(GL_TEXTURE_2D, batch.textureID);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, batch.instances.size());
+        offset += batch.instances.size();
+        this->SpritesDrawn += batch.instances.size();
+        ++this->DrawCalls;
+        // keep the capacity for the next frame
+        batch.instances.clear();
+    }
     glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SpriteRenderer::ResetStats()
+{
+    this->SpritesDrawn = 0;
+    this->DrawCalls = 0;
+}
+
+SpriteRenderer::Batch &SpriteRenderer::batchFor(unsigned int textureID)
+{
+    // consecutive sprites mostly share their batch (e.g. all bricks of a level)
+    if (this->lastBatch < this->batches.size())
+    {
+        Batch &last = this->batches[this->lastBatch];
+        if (last.layer == this->layer && last.textureID == textureID)
+            return last;
+    }
+    for (unsigned int i = 0; i < this->batches.size(); ++i)
+    {
+        if (this->batches[i].layer == this->layer && this->batches[i].textureID == textureID)
+        {
+            this->lastBatch = i;
+            return this->batches[i];
+        }
+    }
+    // reuse an empty batch before adding a new one
+    unsigned int i = 0;
+    while (i < this->batches.size() && !this->batches[i].instances.empty())
+        ++i;
+    if (i == this->batches.size())
+        this->batches.push_back(Batch());
+    this->batches[i].layer = this->layer;
+    this->batches[i].textureID = textureID;
+    this->lastBatch = i;
+    return this->batches[i];
 }
 
 void SpriteRenderer::initRenderData()
 {
     // configure VAO/VBO
     unsigned int VBO;
-    float vertices[] = { 
+    float vertices[] = {
         // pos      // tex
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 0.0f, 1.0f, 0.0f,
-        0.0f, 0.0f, 0.0f, 0.0f, 
+        0.0f, 0.0f, 0.0f, 0.0f,
 
         0.0f, 1.0f, 0.0f, 1.0f,
         1.0f, 1.0f, 1.0f, 1.0f,
@@ -63,6 +155,7 @@ void SpriteRenderer::initRenderData()
 
     glGenVertexArrays(1, &this->quadVAO);
     glGenBuffers(1, &VBO);
+    glGenBuffers(1, &this->instanceVBO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
@@ -70,6 +163,13 @@ void SpriteRenderer::initRenderData()
     glBindVertexArray(this->quadVAO);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    // per sprite attributes; Flush() sets their offsets for every batch
+    glBindBuffer(GL_ARRAY_BUFFER, this->instanceVBO);
+    for (unsigned int i = 1; i <= 3; ++i)
+    {
+        glEnableVertexAttribArray(i);
+        glVertexAttribDivisor(i, 1);
+    }
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
\ No newline at end of file
@@ -8,6 +8,7 @@
 ******************************************************************/
 #ifndef SPRITE_RENDERER_H
 #define SPRITE_RENDERER_H
+#include <vector>
 
 #include <glad/glad.h>
 #include <glm/glm.hpp>
@@ -17,21 +18,59 @@
 #include "shader.h"
 
 
+// Per sprite vertex data of the instanced quad (48 bytes)
+struct SpriteInstance {
+    glm::vec4 Rect;          // <vec2 position, vec2 size>
+    glm::vec4 ColorRotation; // <vec3 color, float rotation in radians>
+    glm::vec4 TexRect;       // <vec2 min, vec2 max> texture coordinates
+};
+
+
+// SpriteRenderer batches sprites: DrawSprite only queues a sprite
+// and Flush draws everything queued since the last Flush with one
+// instanced draw call per layer and texture (or atlas page). Sprites
+// of a higher layer are drawn on top of sprites of a lower layer;
+// within a layer sprites are grouped by texture, so sprites with
+// different textures of the same layer should not overlap.
 class SpriteRenderer
 {
 public:
+    // statistics, counted since the last ResetStats()
+    unsigned int SpritesDrawn, DrawCalls;
     // Constructor (inits shaders/shapes)
     SpriteRenderer(Shader &shader);
     // Destructor
     ~SpriteRenderer();
-    // Renders a defined quad textured with given sprite
+    // Queues a quad textured with given sprite
     void DrawSprite(Texture2D &texture, glm::vec2 position, glm::vec2 size = glm::vec2(10.0f, 10.0f), float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Queues a quad textured with the <vec2 min, vec2 max> sub rectangle of the texture, e.g. a sprite of an atlas
+    void DrawSprite(Texture2D &texture, glm::vec4 texRect, glm::vec2 position, glm::vec2 size, float rotate = 0.0f, glm::vec3 color = glm::vec3(1.0f));
+    // Sprites queued from now on go to the given layer
+    void SetLayer(unsigned int layer);
+    // Draws all queued sprites, ordered by layer and grouped by texture
+    void Flush();
+    void ResetStats();
 private:
+    // all queued sprites of one layer that share a texture
+    struct Batch {
+        unsigned int                layer;
+        unsigned int                textureID;
+        std::vector<SpriteInstance> instances;
+    };
     // Render state
-    Shader       shader; 
+    Shader       shader;
     unsigned int quadVAO;
+    unsigned int instanceVBO;
+    unsigned int instanceCapacity;
+    // Batch state; batches keep their memory between frames so queueing doesn't allocate
+    std::vector<Batch>        batches;
+    std::vector<unsigned int> order;
+    unsigned int              layer;
+    unsigned int              lastBatch;
     // Initializes and configures the quad's buffer and vertex attributes
     void initRenderData();
+    // Returns the batch of the current layer for the given texture
+    Batch &batchFor(unsigned int textureID);
 };
 
 #endif
\ No newline at end of file
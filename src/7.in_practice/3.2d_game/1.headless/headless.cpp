@@ -0,0 +1,369 @@
+/*******************************************************************
+** This code is part of Breakout.
+**
+** Breakout is free software: you can redistribute it and/or modify
+** it under the terms of the CC BY 4.0 license as published by
+** Creative Commons, either version 4 of the License, or (at your
+** option) any later version.
+******************************************************************/
+// Runs Breakout's simulation without a window, GL context or audio
+// device: many games played by a bot on parallel threads, to measure
+// the simulation's throughput, or to fuzz the level loader and the
+// collision code with mutated level files. Also plays back sessions
+// recorded by the game with --record, and times the brick grid broad
+// phase against testing every brick.
+#define GLFW_INCLUDE_NONE
+#include <GLFW/glfw3.h>
+
+#include <learnopengl/filesystem.h>
+
+#include "game.h"
+#include "brick_grid.h"
+#include "replay.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// size of the simulated screen, as in the game
+const unsigned int SCREEN_WIDTH = 800;
+const unsigned int SCREEN_HEIGHT = 600;
+
+// Runs job(0) .. job(count - 1) on the given number of threads
+template <typename Job>
+void RunParallel(unsigned int count, unsigned int threads, Job job)
+{
+    std::atomic<unsigned int> next(0);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; ++t)
+        workers.emplace_back([&]() {
+            for (unsigned int i = next++; i < count; i = next++)
+                job(i);
+        });
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+// Plays the game like a player would: starts it from the menu and the
+// win screen, launches the ball and keeps the paddle under it. Aims a
+// bit off the paddle's center (by aim, -1 to 1) so the ball bounces at
+// an angle. Only depends on the game state, so a game stays
+// deterministic.
+void Autopilot(Game &game, float aim)
+{
+    if (game.State != GAME_ACTIVE)
+    {
+        // ENTER only counts once per press, so alternate pressing and releasing it
+        game.SetKey(GLFW_KEY_ENTER, !game.Keys[GLFW_KEY_ENTER]);
+        game.SetKey(GLFW_KEY_A, false);
+        game.SetKey(GLFW_KEY_D, false);
+        return;
+    }
+    game.SetKey(GLFW_KEY_ENTER, false);
+    game.SetKey(GLFW_KEY_SPACE, game.Ball.Stuck);
+    float paddle = game.Player.Position.x + game.Player.Size.x / 2.0f;
+    float target = game.Ball.Position.x + game.Ball.Radius - aim * game.Player.Size.x * 0.4f;
+    game.SetKey(GLFW_KEY_A, target < paddle - 5.0f);
+    game.SetKey(GLFW_KEY_D, target > paddle + 5.0f);
+}
+
+// Outcome of a simulated game
+struct GameResult {
+    uint64_t     Hash;      // state hash after the last tick
+    unsigned int Wins;      // levels completed
+    unsigned int LivesLost;
+    unsigned int Bricks;    // bricks destroyed
+};
+
+// Plays game for the given number of ticks, aiming by aim
+GameResult Play(Game &game, unsigned int ticks, float aim)
+{
+    GameResult result = { 0, 0, 0, 0 };
+    for (unsigned int t = 0; t < ticks; ++t)
+    {
+        Autopilot(game, aim);
+        GameState state = game.State;
+        unsigned int lives = game.Lives;
+        game.Tick(TICK_DURATION);
+        if (state == GAME_ACTIVE && game.State == GAME_WIN)
+            ++result.Wins;
+        if (game.Lives < lives || (state == GAME_ACTIVE && game.State == GAME_MENU))
+            ++result.LivesLost;
+    }
+    for (const GameObject &brick : game.Levels[game.Level].Bricks)
+        result.Bricks += brick.Destroyed ? 1 : 0;
+    result.Hash = game.StateHash();
+    return result;
+}
+
+// Plays games games of ticks ticks each on threads threads and reports the throughput
+int RunBenchmark(unsigned int games, unsigned int ticks, unsigned int threads)
+{
+    std::vector<GameLevel> levels = LoadLevels(SCREEN_WIDTH, SCREEN_HEIGHT);
+    if (levels[0].Bricks.empty())
+    {
+        std::cout << "Failed to load the levels" << std::endl;
+        return -1;
+    }
+    std::vector<GameResult> results(games);
+    auto start = std::chrono::high_resolution_clock::now();
+    RunParallel(games, threads, [&](unsigned int i) {
+        // each game has its own seed, level and aim
+        Game game(SCREEN_WIDTH, SCREEN_HEIGHT, i + 1);
+        game.Init(levels);
+        game.Level = i % levels.size();
+        results[i] = Play(game, ticks, ((i * 7) % 11) / 5.0f - 1.0f);
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    unsigned long long wins = 0, livesLost = 0, bricks = 0;
+    uint64_t hash = 0;
+    for (const GameResult &result : results)
+    {
+        wins += result.Wins;
+        livesLost += result.LivesLost;
+        bricks += result.Bricks;
+        // the same whichever thread played which game
+        hash = hash * 1099511628211ull + result.Hash;
+    }
+    double totalTicks = static_cast<double>(games) * ticks;
+    std::cout << games << " games of " << ticks << " ticks on " << threads << " threads: " << seconds << " s, "
+              << totalTicks / seconds << " ticks/s (" << totalTicks * TICK_DURATION / seconds << "x real time)" << std::endl;
+    std::cout << "levels won: " << wins << ", lives lost: " << livesLost << ", bricks destroyed at the end: " << bricks
+              << ", combined state hash: " << hash << std::endl;
+    return 0;
+}
+
+// Mutates the text of a level file: changes, inserts and removes tile
+// codes, line breaks and junk, duplicates or drops lines
+std::string MutateLevel(const std::string &source, std::mt19937 &random)
+{
+    const char *tokens[] = { "0", "1", "2", "3", "4", "5", "6", "9", " ", "\n", "\t", "-1", "x",
+                             "4294967295", "4294967296", "99999999999999999999" };
+    const unsigned int tokenCount = sizeof(tokens) / sizeof(tokens[0]);
+    std::string text = source;
+    unsigned int mutations = 1 + random() % 8;
+    for (unsigned int m = 0; m < mutations; ++m)
+    {
+        size_t at = text.empty() ? 0 : random() % text.size();
+        switch (random() % 6)
+        {
+        case 0: // replace a character
+            if (!text.empty())
+                text.replace(at, 1, tokens[random() % tokenCount]);
+            break;
+        case 1: // insert a token
+            text.insert(at, tokens[random() % tokenCount]);
+            break;
+        case 2: // remove a few characters
+            text.erase(at, 1 + random() % 4);
+            break;
+        case 3: // duplicate a line
+        {
+            size_t begin = text.rfind('\n', at);
+            begin = begin == std::string::npos ? 0 : begin + 1;
+            size_t end = text.find('\n', at);
+            end = end == std::string::npos ? text.size() : end + 1;
+            std::string line = text.substr(begin, end - begin);
+            // sometimes many times, as long as the level stays below about a megabyte
+            unsigned int copies = random() % 4 == 0 && text.size() + line.size() * 500 < (1 << 20) ? 500 : 1;
+            for (unsigned int c = 0; c < copies; ++c)
+                text.insert(end, line);
+            break;
+        }
+        case 4: // cut the file short
+            text.resize(at);
+            break;
+        case 5: // a very wide row
+        {
+            std::string row;
+            for (unsigned int n = random() % 2000; n > 0; --n)
+                row += "5 ";
+            text.insert(at, row);
+            break;
+        }
+        }
+    }
+    return text;
+}
+
+// Checks the invariants of the game state; returns an empty string if they hold
+std::string CheckGame(Game &game)
+{
+    if (game.Level >= game.Levels.size())
+        return "level index out of range";
+    if (!std::isfinite(game.Ball.Position.x) || !std::isfinite(game.Ball.Position.y) ||
+        !std::isfinite(game.Ball.Velocity.x) || !std::isfinite(game.Ball.Velocity.y))
+        return "ball position or velocity isn't finite";
+    if (game.Ball.Position.x < -1.0f || game.Ball.Position.x + game.Ball.Size.x > game.Width + 1.0f)
+        return "ball left the screen sideways";
+    const GameLevel &level = game.Levels[game.Level];
+    for (unsigned int brick : game.BrickCandidates)
+        if (brick >= level.Bricks.size())
+            return "broad phase returned a brick that doesn't exist";
+    bool completed = true;
+    for (const GameObject &brick : level.Bricks)
+        if (!brick.IsSolid && !brick.Destroyed)
+            completed = false;
+    if (completed != game.Levels[game.Level].IsCompleted())
+        return "level completion doesn't match its bricks";
+    return std::string();
+}
+
+// Plays cases mutations of the game's levels for ticks ticks each, checking
+// the game after every tick, and writes the levels that fail to files in
+// failureDirectory
+int RunFuzz(unsigned int cases, unsigned int ticks, unsigned int threads, const std::string &failureDirectory)
+{
+    const char *files[] = { "resources/levels/one.lvl", "resources/levels/two.lvl", "resources/levels/three.lvl", "resources/levels/four.lvl" };
+    std::vector<std::string> sources;
+    for (const char *file : files)
+    {
+        std::ifstream fstream(FileSystem::getPath(file).c_str());
+        std::stringstream sstream;
+        sstream << fstream.rdbuf();
+        sources.push_back(sstream.str());
+    }
+    std::atomic<unsigned int> failures(0);
+    std::mutex output;
+    auto start = std::chrono::high_resolution_clock::now();
+    RunParallel(cases, threads, [&](unsigned int i) {
+        std::mt19937 random(i + 1);
+        std::string text = MutateLevel(sources[i % sources.size()], random);
+        std::istringstream sstream(text);
+        GameLevel level;
+        level.Load(sstream, SCREEN_WIDTH, SCREEN_HEIGHT / 2);
+        Game game(SCREEN_WIDTH, SCREEN_HEIGHT, i + 1);
+        game.Init(std::vector<GameLevel>(1, level));
+        std::string error = CheckGame(game);
+        float aim = ((i * 7) % 11) / 5.0f - 1.0f;
+        for (unsigned int t = 0; t < ticks && error.empty(); ++t)
+        {
+            Autopilot(game, aim);
+            game.Tick(TICK_DURATION);
+            error = CheckGame(game);
+            if (!error.empty())
+                error += " at tick " + std::to_string(game.Ticks);
+        }
+        if (!error.empty())
+        {
+            std::string file = failureDirectory + "/fuzz_failure_" + std::to_string(i) + ".lvl";
+            std::ofstream(file.c_str()) << text;
+            std::lock_guard<std::mutex> lock(output);
+            std::cout << "case " << i << ": " << error << ", level written to " << file << std::endl;
+            ++failures;
+        }
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << cases << " mutated levels of " << ticks << " ticks in " << seconds << " s, " << failures << " failed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+// Times the broad phase on generated levels of growing size; returns
+// non-zero if the grid and testing every brick hit different bricks
+int RunGridBenchmark()
+{
+    const unsigned int sizes[][2] = { { 50, 20 }, { 100, 40 }, { 200, 80 }, { 500, 200 } };
+    bool valid = true;
+    std::cout << "level      bricks hit  build (ms)  grid (us/step)  brute force (us/step)  bricks per query" << std::endl;
+    for (const auto &size : sizes)
+    {
+        BrickGridStats stats = BrickGridBenchmark(size[0], size[1]);
+        std::cout << stats.Columns << "x" << stats.Rows << "  " << stats.Hits << "  " << stats.BuildMs << "  "
+                  << 1000.0 * stats.GridMs / stats.Steps << "  " << 1000.0 * stats.BruteForceMs / stats.Steps << "  "
+                  << stats.Candidates << (stats.Valid ? "" : "  MISMATCH") << std::endl;
+        valid = valid && stats.Valid;
+    }
+    return valid ? 0 : 1;
+}
+
+// Replays a session recorded by the game as fast as possible and checks
+// that it matches the recording at every checkpoint
+int RunReplay(const char *file)
+{
+    Replay replay;
+    if (!replay.Load(file))
+    {
+        std::cout << "Failed to load replay " << file << std::endl;
+        return -1;
+    }
+    Game game(SCREEN_WIDTH, SCREEN_HEIGHT, replay.Seed);
+    game.Init(LoadLevels(SCREEN_WIDTH, SCREEN_HEIGHT));
+    std::cout << "replaying " << replay.Ticks << " ticks (" << replay.Ticks * TICK_DURATION << " s of play)" << std::endl;
+    size_t nextEvent = 0, nextCheckpoint = 0;
+    bool identical = true;
+    auto start = std::chrono::high_resolution_clock::now();
+    while (game.Ticks < replay.Ticks)
+    {
+        while (nextEvent < replay.Events.size() && replay.Events[nextEvent].Tick <= game.Ticks)
+        {
+            game.SetKey(replay.Events[nextEvent].Key, replay.Events[nextEvent].Pressed);
+            ++nextEvent;
+        }
+        game.Tick(TICK_DURATION);
+        if (nextCheckpoint < replay.Checkpoints.size() && replay.Checkpoints[nextCheckpoint].Tick == game.Ticks)
+        {
+            if (game.StateHash() != replay.Checkpoints[nextCheckpoint].Hash)
+            {
+                std::cout << "replay diverged from the recording at tick " << game.Ticks << std::endl;
+                identical = false;
+                break;
+            }
+            ++nextCheckpoint;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+    std::cout << game.Ticks << " ticks in " << seconds << " s (" << game.Ticks / seconds << " ticks/s), "
+              << (identical ? "identical to the recording" : "NOT identical") << std::endl;
+    return identical ? 0 : 1;
+}
+
+// Directory of this binary, from the path it was started with
+std::string BinaryDirectory(const char *argv0)
+{
+    std::string path(argv0);
+    size_t separator = path.find_last_of("/\\");
+    return separator == std::string::npos ? std::string(".") : path.substr(0, separator);
+}
+
+int main(int argc, char *argv[])
+{
+    // command line: [--games N] [--ticks N] [--threads N] [--fuzz N [--failures dir]] | --benchmark-grid | --replay file
+    unsigned int games = 1000;
+    unsigned int ticks = 60 * 120;
+    unsigned int threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int fuzzCases = 0;
+    // failing levels go next to the binary unless a directory is given
+    std::string failureDirectory = BinaryDirectory(argv[0]);
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--games") == 0 && i + 1 < argc)
+            games = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--ticks") == 0 && i + 1 < argc)
+            ticks = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = std::max(1ul, strtoul(argv[++i], nullptr, 10));
+        else if (strcmp(argv[i], "--fuzz") == 0 && i + 1 < argc)
+            fuzzCases = strtoul(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--failures") == 0 && i + 1 < argc)
+            failureDirectory = argv[++i];
+        else if (strcmp(argv[i], "--benchmark-grid") == 0)
+            return RunGridBenchmark();
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+            return RunReplay(argv[++i]);
+    }
+    if (fuzzCases > 0)
+        return RunFuzz(fuzzCases, std::min(ticks, 20u * 120u), threads, failureDirectory);
+    return RunBenchmark(games, ticks, threads);
+}
\ No newline at end of file
@@ -0,0 +1,24 @@
+#version 420 core
+
+// run the depth test first, so fragments behind solid objects never take a layer
+layout (early_fragment_tests) in;
+
+// fragments that reached every pixel; may run past the number of layers, which is how overflow is detected
+layout (binding = 2, r32ui) uniform coherent uimage2D fragmentCounts;
+
+// one layer per fragment: packed color, depth bits
+layout (binding = 3, rg32ui) uniform writeonly uimage2DArray fragmentLayers;
+
+// number of layers (k)
+uniform uint layers;
+
+// material color
+uniform vec4 color;
+
+void main()
+{
+	ivec2 coords = ivec2(gl_FragCoord.xy);
+	uint slot = imageAtomicAdd(fragmentCounts, coords, 1u);
+	if (slot < layers)
+		imageStore(fragmentLayers, ivec3(coords, slot), uvec4(packUnorm4x8(color), floatBitsToUint(gl_FragCoord.z), 0u, 0u));
+}
@@ -0,0 +1,57 @@
+#version 420 core
+
+// shader outputs, premultiplied by alpha
+layout (location = 0) out vec4 frag;
+
+// fragments that reached every pixel
+layout (binding = 2, r32ui) uniform readonly uimage2D fragmentCounts;
+
+// one layer per fragment: packed color, depth bits
+layout (binding = 3, rg32ui) uniform readonly uimage2DArray fragmentLayers;
+
+// pixels that received more fragments than there are layers
+layout (binding = 0, offset = 4) uniform atomic_uint truncatedPixels;
+
+// number of layers (k), at most MAX_LAYERS
+uniform uint layers;
+
+#define MAX_LAYERS 16
+
+void main()
+{
+	ivec2 coords = ivec2(gl_FragCoord.xy);
+	uint stored = imageLoad(fragmentCounts, coords).r;
+
+	// save the sort if there is not a transparent fragment
+	if (stored == 0u)
+		discard;
+	if (stored > layers)
+		atomicCounterIncrement(truncatedPixels);
+
+	// x = packed color, y = depth bits
+	uvec2 fragments[MAX_LAYERS];
+	int count = int(min(stored, layers));
+	for (int i = 0; i < count; i++)
+		fragments[i] = imageLoad(fragmentLayers, ivec3(coords, i)).xy;
+
+	// insertion sort, furthest first; depths in [0, 1] compare correctly as bits
+	for (int i = 1; i < count; i++)
+	{
+		uvec2 fragment = fragments[i];
+		int j = i - 1;
+		for (; j >= 0 && fragments[j].y < fragment.y; j--)
+			fragments[j + 1] = fragments[j];
+		fragments[j + 1] = fragment;
+	}
+
+	// blend back to front
+	vec3 color = vec3(0.0f);
+	float transmittance = 1.0f;
+	for (int i = 0; i < count; i++)
+	{
+		vec4 fragment = unpackUnorm4x8(fragments[i].x);
+		color = mix(color, fragment.rgb, fragment.a);
+		transmittance *= 1.0f - fragment.a;
+	}
+	frag = vec4(color, 1.0f - transmittance);
+}
@@ -0,0 +1,29 @@
+#version 420 core
+
+// run the depth test first, so fragments behind solid objects never take a node
+layout (early_fragment_tests) in;
+
+// index of the last node stored for every pixel, 0xFFFFFFFF for none
+layout (binding = 0, r32ui) uniform coherent uimage2D headPointers;
+
+// fragment pool: packed color, depth bits, index of the next node
+layout (binding = 1, rgba32ui) uniform writeonly uimageBuffer fragmentPool;
+
+// number of nodes asked for this frame; may run past the pool size, which is how overflow is detected
+layout (binding = 0, offset = 0) uniform atomic_uint nodeCounter;
+
+// nodes in the fragment pool
+uniform uint poolSize;
+
+// material color
+uniform vec4 color;
+
+void main()
+{
+	uint node = atomicCounterIncrement(nodeCounter);
+	if (node < poolSize)
+	{
+		uint next = imageAtomicExchange(headPointers, ivec2(gl_FragCoord.xy), node);
+		imageStore(fragmentPool, int(node), uvec4(packUnorm4x8(color), floatBitsToUint(gl_FragCoord.z), next, 0u));
+	}
+}
@@ -0,0 +1,60 @@
+#version 420 core
+
+// shader outputs, premultiplied by alpha
+layout (location = 0) out vec4 frag;
+
+// index of the last node stored for every pixel, 0xFFFFFFFF for none
+layout (binding = 0, r32ui) uniform readonly uimage2D headPointers;
+
+// fragment pool: packed color, depth bits, index of the next node
+layout (binding = 1, rgba32ui) uniform readonly uimageBuffer fragmentPool;
+
+// pixels with more fragments than can be sorted here
+layout (binding = 0, offset = 4) uniform atomic_uint truncatedPixels;
+
+// the most fragments sorted per pixel
+#define MAX_FRAGMENTS 32
+
+const uint END_OF_LIST = 0xFFFFFFFFu;
+
+void main()
+{
+	uint node = imageLoad(headPointers, ivec2(gl_FragCoord.xy)).r;
+
+	// save the sort if there is not a transparent fragment
+	if (node == END_OF_LIST)
+		discard;
+
+	// gather the list: x = packed color, y = depth bits
+	uvec2 fragments[MAX_FRAGMENTS];
+	int count = 0;
+	while (node != END_OF_LIST && count < MAX_FRAGMENTS)
+	{
+		uvec4 entry = imageLoad(fragmentPool, int(node));
+		fragments[count++] = entry.xy;
+		node = entry.z;
+	}
+	if (node != END_OF_LIST)
+		atomicCounterIncrement(truncatedPixels);
+
+	// insertion sort, furthest first; depths in [0, 1] compare correctly as bits
+	for (int i = 1; i < count; i++)
+	{
+		uvec2 fragment = fragments[i];
+		int j = i - 1;
+		for (; j >= 0 && fragments[j].y < fragment.y; j--)
+			fragments[j + 1] = fragments[j];
+		fragments[j + 1] = fragment;
+	}
+
+	// blend back to front
+	vec3 color = vec3(0.0f);
+	float transmittance = 1.0f;
+	for (int i = 0; i < count; i++)
+	{
+		vec4 fragment = unpackUnorm4x8(fragments[i].x);
+		color = mix(color, fragment.rgb, fragment.a);
+		transmittance *= 1.0f - fragment.a;
+	}
+	frag = vec4(color, 1.0f - transmittance);
+}
@@ -7,8 +7,12 @@
 
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
@@ -16,6 +20,13 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void process_input(GLFWwindow *window);
 glm::mat4 calculate_model_matrix(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f));
 
+struct TransparentQuad
+{
+	glm::mat4 model;
+	glm::vec4 color;
+};
+std::vector<TransparentQuad> generate_transparent_quads(unsigned int count);
+
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
@@ -30,6 +41,28 @@ bool firstMouse = true;
 float deltaTime = 0.0f;
 float lastFrame = 0.0f;
 
+// transparency modes: weighted blended is approximate, the linked list and the k-buffer are exact
+// as long as they don't overflow
+enum OITMode
+{
+	WEIGHTED_BLENDED,
+	LINKED_LIST,
+	K_BUFFER,
+	OIT_MODE_COUNT
+};
+const char* oitModeNames[OIT_MODE_COUNT] = { "weighted blended", "linked list", "k-buffer" };
+int oitMode = WEIGHTED_BLENDED;
+bool oitModeKeyPressed = false;
+
+// number of transparent quads, UP/DOWN to change
+unsigned int transparentQuadCount = 2;
+bool quadCountKeyPressed = false;
+
+// GPU memory the exact modes may use; the fragment pool of the linked list grows up to this
+const size_t OIT_MEMORY_BUDGET = 64 * 1024 * 1024;
+// layers of the k-buffer, at most MAX_LAYERS in kbuffer_resolve.fs
+const unsigned int KBUFFER_LAYERS = 8;
+
 int main(int argc, char* argv[])
 {
 	// glfw: initialize and configure
@@ -74,6 +107,10 @@ int main(int argc, char* argv[])
 	Shader transparentShader("transparent.vs", "transparent.fs");
 	Shader compositeShader("composite.vs", "composite.fs");
 	Shader screenShader("screen.vs", "screen.fs");
+	Shader linkedListShader("transparent.vs", "linked_list.fs");
+	Shader linkedListResolveShader("composite.vs", "linked_list_resolve.fs");
+	Shader kBufferShader("transparent.vs", "kbuffer.fs");
+	Shader kBufferResolveShader("composite.vs", "kbuffer_resolve.fs");
 
 	// set up vertex data (and buffer(s)) and configure vertex attributes
 	// ------------------------------------------------------------------
@@ -161,16 +198,82 @@ int main(int argc, char* argv[])
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
+	// set up the exact transparency modes: a per-pixel linked list, whose nodes come from a fixed
+	// size fragment pool, and a k-buffer of KBUFFER_LAYERS fragments per pixel
+	// ------------------------------------------------------------------
+	const size_t pixels = (size_t)SCR_WIDTH * SCR_HEIGHT;
+
+	// head pointers of the lists and fragment counts of the k-buffer; both are cleared through a framebuffer
+	unsigned int headTexture, countTexture;
+	glGenTextures(1, &headTexture);
+	glBindTexture(GL_TEXTURE_2D, headTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, SCR_WIDTH, SCR_HEIGHT);
+	glGenTextures(1, &countTexture);
+	glBindTexture(GL_TEXTURE_2D, countTexture);
+	glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32UI, SCR_WIDTH, SCR_HEIGHT);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	unsigned int clearFBO;
+	glGenFramebuffers(1, &clearFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, clearFBO);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, headTexture, 0);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, countTexture, 0);
+	glDrawBuffers(2, transparentDrawBuffers);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cout << "ERROR::FRAMEBUFFER:: Clear framebuffer is not complete!" << std::endl;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// fragment pool, 16 bytes a node; starts at two nodes per pixel and grows on overflow
+	const size_t maxPoolSize = (OIT_MEMORY_BUDGET - pixels * sizeof(GLuint)) / (4 * sizeof(GLuint));
+	size_t poolSize = std::min(pixels * 2, maxPoolSize);
+	unsigned int poolBuffer, poolTexture;
+	glGenBuffers(1, &poolBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, poolBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, poolSize * 4 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+	glGenTextures(1, &poolTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, poolTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, poolBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
+	// k-buffer layers, 8 bytes a fragment, as many as fit in the budget
+	const unsigned int kBufferLayers = (unsigned int)std::min<size_t>(KBUFFER_LAYERS, (OIT_MEMORY_BUDGET - pixels * sizeof(GLuint)) / (pixels * 2 * sizeof(GLuint)));
+	unsigned int layerTexture;
+	glGenTextures(1, &layerTexture);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, layerTexture);
+	glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_RG32UI, SCR_WIDTH, SCR_HEIGHT, kBufferLayers);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	// atomic counters: nodes taken from the pool and pixels truncated by the resolve pass; they are
+	// copied into alternating readback buffers and read a frame later, so reading them doesn't stall
+	const GLuint zeroCounters[2] = { 0, 0 };
+	unsigned int counterBuffer, readbackBuffers[2];
+	glGenBuffers(1, &counterBuffer);
+	glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+	glBufferData(GL_ATOMIC_COUNTER_BUFFER, sizeof(zeroCounters), zeroCounters, GL_DYNAMIC_DRAW);
+	glGenBuffers(2, readbackBuffers);
+	for (unsigned int i = 0; i < 2; i++)
+	{
+		glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[i]);
+		glBufferData(GL_COPY_WRITE_BUFFER, sizeof(zeroCounters), zeroCounters, GL_STREAM_READ);
+	}
+
 	// set up transformation matrices
 	// ------------------------------------------------------------------
 	glm::mat4 redModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 1.0f));
-	glm::mat4 greenModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 0.0f));
-	glm::mat4 blueModelMat = calculate_model_matrix(glm::vec3(0.0f, 0.0f, 2.0f));
+	std::vector<TransparentQuad> transparentQuads = generate_transparent_quads(transparentQuadCount);
 
 	// set up intermediate variables
 	// ------------------------------------------------------------------
 	glm::vec4 zeroFillerVec(0.0f);
 	glm::vec4 oneFillerVec(1.0f);
+	const GLuint endOfList[4] = { 0xFFFFFFFFu, 0, 0, 0 };
+	const GLuint zeroCount[4] = { 0, 0, 0, 0 };
+
+	GpuTimer transparentTimer, resolveTimer;
+	unsigned int frameCount = 0;
+	GLuint nodesUsed = 0, truncatedPixels = 0, overflowFrames = 0, maxTruncatedPixels = 0;
 	
 	// render loop
 	// -----------
@@ -190,6 +293,8 @@ int main(int argc, char* argv[])
 		// input
 		// -----
 		process_input(window);
+		if (transparentQuads.size() != transparentQuadCount)
+			transparentQuads = generate_transparent_quads(transparentQuadCount);
 
 		// render
 		// ------
@@ -219,55 +324,156 @@ int main(int argc, char* argv[])
 
 		// draw transparent objects (transparent pass)
 		// -----
-
-		// configure render states
-		glDepthMask(GL_FALSE);
-		glEnable(GL_BLEND);
-		glBlendFunci(0, GL_ONE, GL_ONE);
-		glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
-		glBlendEquation(GL_FUNC_ADD);
-
-		// bind transparent framebuffer to render transparent objects
-		glBindFramebuffer(GL_FRAMEBUFFER, transparentFBO);
-		glClearBufferfv(GL_COLOR, 0, &zeroFillerVec[0]);
-		glClearBufferfv(GL_COLOR, 1, &oneFillerVec[0]);
-
-		// use transparent shader
-		transparentShader.use();
-
-		// draw green quad
-		transparentShader.setMat4("mvp", vp * greenModelMat);
-		transparentShader.setVec4("color", glm::vec4(0.0f, 1.0f, 0.0f, 0.5f));
+		transparentTimer.Begin();
+		if (oitMode == WEIGHTED_BLENDED)
+		{
+			// configure render states
+			glDepthMask(GL_FALSE);
+			glEnable(GL_BLEND);
+			glBlendFunci(0, GL_ONE, GL_ONE);
+			glBlendFunci(1, GL_ZERO, GL_ONE_MINUS_SRC_COLOR);
+			glBlendEquation(GL_FUNC_ADD);
+
+			// bind transparent framebuffer to render transparent objects
+			glBindFramebuffer(GL_FRAMEBUFFER, transparentFBO);
+			glClearBufferfv(GL_COLOR, 0, &zeroFillerVec[0]);
+			glClearBufferfv(GL_COLOR, 1, &oneFillerVec[0]);
+
+			// use transparent shader
+			transparentShader.use();
+		}
+		else
+		{
+			// empty the lists and the k-buffer, and take nodes from the start of the pool again
+			glBindFramebuffer(GL_FRAMEBUFFER, clearFBO);
+			glClearBufferuiv(GL_COLOR, 0, endOfList);
+			glClearBufferuiv(GL_COLOR, 1, zeroCount);
+			glBindBuffer(GL_ATOMIC_COUNTER_BUFFER, counterBuffer);
+			glBufferSubData(GL_ATOMIC_COUNTER_BUFFER, 0, sizeof(zeroCounters), zeroCounters);
+			glBindBufferBase(GL_ATOMIC_COUNTER_BUFFER, 0, counterBuffer);
+			glBindImageTexture(0, headTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+			glBindImageTexture(1, poolTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32UI);
+			glBindImageTexture(2, countTexture, 0, GL_FALSE, 0, GL_READ_WRITE, GL_R32UI);
+			glBindImageTexture(3, layerTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_RG32UI);
+
+			// fragments are only stored, the opaque framebuffer provides the depth test
+			glDepthMask(GL_FALSE);
+			glDisable(GL_BLEND);
+			glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+			glBindFramebuffer(GL_FRAMEBUFFER, opaqueFBO);
+
+			if (oitMode == LINKED_LIST)
+			{
+				linkedListShader.use();
+				glUniform1ui(glGetUniformLocation(linkedListShader.ID, "poolSize"), (GLuint)poolSize);
+			}
+			else
+			{
+				kBufferShader.use();
+				glUniform1ui(glGetUniformLocation(kBufferShader.ID, "layers"), kBufferLayers);
+			}
+		}
+		Shader& transparentPassShader = oitMode == WEIGHTED_BLENDED ? transparentShader : (oitMode == LINKED_LIST ? linkedListShader : kBufferShader);
+
+		// draw transparent quads
 		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
-
-		// draw blue quad
-		transparentShader.setMat4("mvp", vp * blueModelMat);
-		transparentShader.setVec4("color", glm::vec4(0.0f, 0.0f, 1.0f, 0.5f));
-		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		for (const TransparentQuad& quad : transparentQuads)
+		{
+			transparentPassShader.setMat4("mvp", vp * quad.model);
+			transparentPassShader.setVec4("color", quad.color);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
+		glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+		transparentTimer.End();
 
 		// draw composite image (composite pass)
 		// -----
+		resolveTimer.Begin();
 
 		// set render states
 		glDepthFunc(GL_ALWAYS);
 		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 		// bind opaque framebuffer
 		glBindFramebuffer(GL_FRAMEBUFFER, opaqueFBO);
 
-		// use composite shader
-		compositeShader.use();
-
-		// draw screen quad
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, accumTexture);
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, revealTexture);
-		glBindVertexArray(quadVAO);
-		glDrawArrays(GL_TRIANGLES, 0, 6);
+		if (oitMode == WEIGHTED_BLENDED)
+		{
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+			// use composite shader
+			compositeShader.use();
+
+			// draw screen quad
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D, accumTexture);
+			glActiveTexture(GL_TEXTURE1);
+			glBindTexture(GL_TEXTURE_2D, revealTexture);
+			glBindVertexArray(quadVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+		}
+		else
+		{
+			// sort every pixel's fragments and blend them over the opaque image (premultiplied alpha)
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+			if (oitMode == LINKED_LIST)
+			{
+				linkedListResolveShader.use();
+			}
+			else
+			{
+				kBufferResolveShader.use();
+				glUniform1ui(glGetUniformLocation(kBufferResolveShader.ID, "layers"), kBufferLayers);
+			}
+			glBindVertexArray(quadVAO);
+			glDrawArrays(GL_TRIANGLES, 0, 6);
+
+			// overflow detection: fetch the counters of the previous frame and queue this frame's
+			glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+			GLuint counters[2];
+			glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[(frameCount + 1) % 2]);
+			glGetBufferSubData(GL_COPY_WRITE_BUFFER, 0, sizeof(counters), counters);
+			glBindBuffer(GL_COPY_READ_BUFFER, counterBuffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, readbackBuffers[frameCount % 2]);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, sizeof(counters));
+			nodesUsed = counters[0];
+			truncatedPixels = counters[1];
+			maxTruncatedPixels = std::max(maxTruncatedPixels, truncatedPixels);
+			if (nodesUsed > poolSize || truncatedPixels > 0)
+				overflowFrames++;
+
+			// fragments were dropped: grow the pool for the next frames, as far as the budget allows
+			if (oitMode == LINKED_LIST && nodesUsed > poolSize && poolSize < maxPoolSize)
+			{
+				poolSize = std::min(std::max<size_t>(poolSize * 2, nodesUsed + nodesUsed / 4), maxPoolSize);
+				glBindBuffer(GL_TEXTURE_BUFFER, poolBuffer);
+				glBufferData(GL_TEXTURE_BUFFER, poolSize * 4 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+				std::cout << "linked list overflowed with " << nodesUsed << " fragments, fragment pool grown to " << poolSize << " nodes" << std::endl;
+			}
+		}
+		resolveTimer.End();
+
+		if (++frameCount % 100 == 0)
+		{
+			size_t memory = oitMode == WEIGHTED_BLENDED ? pixels * (4 * sizeof(GLushort) + 1) :
+							oitMode == LINKED_LIST ? pixels * sizeof(GLuint) + poolSize * 4 * sizeof(GLuint) :
+							pixels * sizeof(GLuint) + pixels * kBufferLayers * 2 * sizeof(GLuint);
+			std::cout << std::fixed << std::setprecision(3) << oitModeNames[oitMode] << " | " << transparentQuads.size() << " quads | transparent: "
+					  << transparentTimer.AverageMs() << " ms | composite: " << resolveTimer.AverageMs() << " ms | memory: "
+					  << std::setprecision(1) << memory / (1024.0 * 1024.0) << " MB";
+			if (oitMode == LINKED_LIST)
+				std::cout << " | nodes: " << nodesUsed << " / " << poolSize;
+			else if (oitMode == K_BUFFER)
+				std::cout << " | layers: " << kBufferLayers;
+			if (oitMode != WEIGHTED_BLENDED)
+				std::cout << " | overflowed frames: " << overflowFrames << ", most truncated pixels: " << maxTruncatedPixels;
+			std::cout << std::endl;
+			transparentTimer.Reset();
+			resolveTimer.Reset();
+			overflowFrames = 0;
+			maxTruncatedPixels = 0;
+		}
 
 		// draw to backbuffer (final pass)
 		// -----
@@ -307,6 +513,14 @@ int main(int argc, char* argv[])
 	glDeleteTextures(1, &revealTexture);
 	glDeleteFramebuffers(1, &opaqueFBO);
 	glDeleteFramebuffers(1, &transparentFBO);
+	glDeleteTextures(1, &headTexture);
+	glDeleteTextures(1, &countTexture);
+	glDeleteTextures(1, &poolTexture);
+	glDeleteTextures(1, &layerTexture);
+	glDeleteBuffers(1, &poolBuffer);
+	glDeleteBuffers(1, &counterBuffer);
+	glDeleteBuffers(2, readbackBuffers);
+	glDeleteFramebuffers(1, &clearFBO);
 
 	glfwTerminate();
 
@@ -364,6 +578,29 @@ void process_input(GLFWwindow *window)
 		camera.ProcessKeyboard(LEFT, deltaTime);
 	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
 		camera.ProcessKeyboard(RIGHT, deltaTime);
+
+	if (glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS && !oitModeKeyPressed)
+	{
+		oitMode = (oitMode + 1) % OIT_MODE_COUNT;
+		oitModeKeyPressed = true;
+		std::cout << "transparency: " << oitModeNames[oitMode] << std::endl;
+	}
+	if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE)
+	{
+		oitModeKeyPressed = false;
+	}
+
+	bool up = glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS;
+	bool down = glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS;
+	if ((up || down) && !quadCountKeyPressed)
+	{
+		transparentQuadCount = up ? std::min(transparentQuadCount * 2, 64u) : std::max(transparentQuadCount / 2, 2u);
+		quadCountKeyPressed = true;
+	}
+	if (!up && !down)
+	{
+		quadCountKeyPressed = false;
+	}
 }
 
 // generate a model matrix
@@ -380,3 +617,28 @@ glm::mat4 calculate_model_matrix(const glm::vec3& position, const glm::vec3& rot
 
 	return trans;
 }
+
+// generate transparent quads stacked between the green one in front of the red quad and the blue
+// one behind it; with two quads this is the original scene
+// ---------------------------------------------------------------------------------------------------------
+std::vector<TransparentQuad> generate_transparent_quads(unsigned int count)
+{
+	std::vector<TransparentQuad> quads(count);
+	for (unsigned int i = 0; i < count; i++)
+	{
+		float t = (float)i / (float)(count - 1);
+		glm::vec3 position(0.0f, 0.0f, 2.0f * t);
+		glm::vec3 rotation(0.0f);
+		glm::vec4 color(0.0f, 1.0f - t, t, 0.5f);
+		if (i > 0 && i + 1 < count)
+		{
+			// tilt the quads in between so they intersect their neighbours
+			position.x = 0.4f * sin(i * 2.4f);
+			rotation.y = 25.0f * cos(i * 1.7f);
+			color = glm::vec4(0.5f + 0.5f * sin(i * 1.3f), 1.0f - t, t, 0.25f);
+		}
+		quads[i].model = calculate_model_matrix(position, rotation);
+		quads[i].color = color;
+	}
+	return quads;
+}
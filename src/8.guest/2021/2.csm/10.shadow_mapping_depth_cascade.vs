@@ -0,0 +1,12 @@
+#version 410 core
+layout (location = 0) in vec3 aPos;
+
+// renders a single cascade (bound with glFramebufferTextureLayer), used instead of the
+// geometry shader when cascades are culled and updated individually
+uniform mat4 lightSpaceMatrix;
+uniform mat4 model;
+
+void main()
+{
+    gl_Position = lightSpaceMatrix * model * vec4(aPos, 1.0);
+}
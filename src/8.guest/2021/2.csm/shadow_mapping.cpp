@@ -10,8 +10,10 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
 #include <random>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -19,12 +21,18 @@ void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
 unsigned int loadTexture(const char *path);
+void initSceneCasters();
+void updateSceneCasters(float time);
 void renderScene(const Shader &shader);
+unsigned int renderSceneCulled(const Shader &shader, unsigned int cascade);
 void renderCube();
 void renderQuad();
 std::vector<glm::mat4> getLightSpaceMatrices();
 std::vector<glm::vec4> getFrustumCornersWorldSpace(const glm::mat4& projview);
 void drawCascadeVolumeVisualizers(const std::vector<glm::mat4>& lightMatrices, Shader* shader);
+struct CascadeState;
+void updateCascades(unsigned int frameIndex);
+bool casterInCascade(const glm::vec3& center, float radius, const CascadeState& cascade);
 
 // settings
 const unsigned int SCR_WIDTH = 2560;
@@ -61,6 +69,53 @@ constexpr unsigned int depthMapResolution = 4096;
 
 bool showQuad = false;
 
+// how the cascades are fitted and rendered, cycled with V
+enum CascadeMode {
+    CASCADES_FIT_EVERY_FRAME,    // original: box around each slice, all cascades through the geometry shader every frame
+    CASCADES_STABLE_EVERY_FRAME, // texel-snapped bounding spheres, culled per cascade, every frame
+    CASCADES_STABLE_CACHED,      // as above, but cascades are only re-rendered when needed
+    CASCADE_MODE_COUNT
+};
+const char* CASCADE_MODE_NAMES[] = { "fit every frame", "stable every frame", "stable cached" };
+CascadeMode cascadeMode = CASCADES_STABLE_CACHED;
+bool animateCaster = false; // toggled with M: moves one cube to show caster-driven updates
+
+// stable cascades are computed in a light space without translation, so snapping the cascade
+// center to whole texels keeps the shadow map texels fixed in the world
+const glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), -lightDir, glm::vec3(0.0f, 1.0f, 0.0f));
+// how far towards the light casters outside a cascade's sphere are still rendered; covers the scene
+constexpr float casterMargin = 50.0f;
+// a cached cascade is refreshed at most every N frames (staggered over the cascades) unless the
+// camera leaves its coverage or a caster inside it moves; cached cascades are fitted with some
+// slack so small camera motions stay covered
+const unsigned int cascadeUpdateIntervals[] = { 1, 1, 2, 4, 8 };
+constexpr float cascadeSlack = 1.15f;
+
+struct CascadeState
+{
+    glm::mat4 LightSpaceMatrix;   // matrix the layer was last rendered with, the one the lighting pass samples with
+    glm::vec3 Center;             // snapped center in light rotation space
+    float Radius = 0.0f;          // half extent of the cascade's ortho box
+    bool Valid = false;
+    bool NeedsRender = false;
+    // statistics, reset with every report
+    unsigned int Renders = 0;
+    unsigned int Draws = 0;
+    unsigned int Culled = 0;
+};
+std::vector<CascadeState> cascades;
+
+// shadow casters with bounding spheres for the per-cascade culling
+struct Caster
+{
+    glm::mat4 Model;
+    glm::vec3 Center;
+    float Radius;
+    bool Moved;
+    glm::vec3 PreviousCenter;
+};
+std::vector<Caster> casters;
+
 std::random_device device;
 std::mt19937 generator = std::mt19937(device());
 
@@ -114,6 +169,7 @@ int main()
     // -------------------------
     Shader shader("10.shadow_mapping.vs", "10.shadow_mapping.fs");
     Shader simpleDepthShader("10.shadow_mapping_depth.vs", "10.shadow_mapping_depth.fs", "10.shadow_mapping_depth.gs");
+    Shader cascadeDepthShader("10.shadow_mapping_depth_cascade.vs", "10.shadow_mapping_depth.fs");
     Shader debugDepthQuad("10.debug_quad.vs", "10.debug_quad_depth.fs");
     Shader debugCascadeShader("10.debug_cascade.vs", "10.debug_cascade.fs");
 
@@ -188,6 +244,14 @@ int main()
     glBindBufferBase(GL_UNIFORM_BUFFER, 0, matricesUBO);
     glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
+    initSceneCasters();
+    cascades.resize(shadowCascadeLevels.size() + 1);
+    std::vector<GpuTimer> cascadeTimers(cascades.size());
+    GpuTimer allCascadesTimer;
+    unsigned int frameIndex = 0;
+    unsigned int reportFrames = 0;
+    CascadeMode reportedMode = cascadeMode;
+
     // shader configuration
     // --------------------
     shader.use();
@@ -220,28 +284,104 @@ int main()
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // 0. UBO setup
-        const auto lightMatrices = getLightSpaceMatrices();
-        glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
-        for (size_t i = 0; i < lightMatrices.size(); ++i)
+        updateSceneCasters(currentFrame);
+        if (cascadeMode != reportedMode)
         {
-            glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &lightMatrices[i]);
+            // the cached layers and statistics belong to the previous mode
+            for (auto& cascade : cascades)
+                cascade = CascadeState();
+            for (auto& timer : cascadeTimers)
+                timer.Reset();
+            allCascadesTimer.Reset();
+            reportFrames = 0;
+            reportedMode = cascadeMode;
+            std::cout << "cascades: " << CASCADE_MODE_NAMES[cascadeMode] << std::endl;
         }
-        glBindBuffer(GL_UNIFORM_BUFFER, 0);
 
-        // 1. render depth of scene to texture (from light's perspective)
-        // --------------------------------------------------------------
-        //lightProjection = glm::perspective(glm::radians(45.0f), (GLfloat)SHADOW_WIDTH / (GLfloat)SHADOW_HEIGHT, near_plane, far_plane); // note that if you use a perspective projection matrix you'll have to change the light position as the current light position isn't enough to reflect the whole scene
-        // render scene from light's point of view
-        simpleDepthShader.use();
-
-        glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
-        glViewport(0, 0, depthMapResolution, depthMapResolution);
-        glClear(GL_DEPTH_BUFFER_BIT);
-        glCullFace(GL_FRONT);  // peter panning
-        renderScene(simpleDepthShader);
-        glCullFace(GL_BACK);
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (cascadeMode == CASCADES_FIT_EVERY_FRAME)
+        {
+            // 0. UBO setup
+            const auto lightMatrices = getLightSpaceMatrices();
+            glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+            for (size_t i = 0; i < lightMatrices.size(); ++i)
+            {
+                glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &lightMatrices[i]);
+            }
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+            // 1. render depth of scene to texture (from light's perspective)
+            // --------------------------------------------------------------
+            // render scene from light's point of view, all cascades at once through the geometry shader
+            allCascadesTimer.Begin();
+            simpleDepthShader.use();
+
+            glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+            glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0);
+            glViewport(0, 0, depthMapResolution, depthMapResolution);
+            glClear(GL_DEPTH_BUFFER_BIT);
+            glCullFace(GL_FRONT);  // peter panning
+            renderScene(simpleDepthShader);
+            glCullFace(GL_BACK);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+            allCascadesTimer.End();
+        }
+        else
+        {
+            // 0. decide which cascades need to be re-rendered this frame
+            updateCascades(frameIndex);
+
+            // 1. render each scheduled cascade into its own layer with only the casters inside it
+            // -----------------------------------------------------------------------------------
+            cascadeDepthShader.use();
+            glBindFramebuffer(GL_FRAMEBUFFER, lightFBO);
+            glViewport(0, 0, depthMapResolution, depthMapResolution);
+            glCullFace(GL_FRONT);  // peter panning
+            glBindBuffer(GL_UNIFORM_BUFFER, matricesUBO);
+            for (unsigned int i = 0; i < cascades.size(); ++i)
+            {
+                if (!cascades[i].NeedsRender)
+                    continue;
+                cascadeTimers[i].Begin();
+                glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, lightDepthMaps, 0, i);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                cascadeDepthShader.setMat4("lightSpaceMatrix", cascades[i].LightSpaceMatrix);
+                cascades[i].Draws += renderSceneCulled(cascadeDepthShader, i);
+                cascades[i].Renders++;
+                cascadeTimers[i].End();
+                glBufferSubData(GL_UNIFORM_BUFFER, i * sizeof(glm::mat4x4), sizeof(glm::mat4x4), &cascades[i].LightSpaceMatrix);
+            }
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            glCullFace(GL_BACK);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+        frameIndex++;
+
+        // per-cascade report
+        if (++reportFrames >= 100)
+        {
+            std::cout << std::fixed << std::setprecision(3);
+            if (cascadeMode == CASCADES_FIT_EVERY_FRAME)
+            {
+                std::cout << "all " << cascades.size() << " cascades (geometry shader): " << casters.size() + 1 << " draws each, "
+                          << allCascadesTimer.AverageMs() << " ms" << std::endl;
+                allCascadesTimer.Reset();
+            }
+            else
+            {
+                for (unsigned int i = 0; i < cascades.size(); ++i)
+                {
+                    CascadeState& cascade = cascades[i];
+                    std::cout << "cascade " << i << ": " << std::setw(3) << cascade.Renders << " renders / " << reportFrames << " frames";
+                    if (cascade.Renders > 0)
+                        std::cout << " | draws " << (float)cascade.Draws / cascade.Renders << " (culled " << (float)cascade.Culled / cascade.Renders << ")"
+                                  << " | " << cascadeTimers[i].AverageMs() << " ms/render";
+                    std::cout << std::endl;
+                    cascade.Renders = cascade.Draws = cascade.Culled = 0;
+                    cascadeTimers[i].Reset();
+                }
+            }
+            reportFrames = 0;
+        }
 
         // reset viewport
         glViewport(0, 0, fb_width, fb_height);
@@ -318,30 +458,77 @@ void renderScene(const Shader &shader)
     glBindVertexArray(planeVAO);
     glDrawArrays(GL_TRIANGLES, 0, 6);
 
-    static std::vector<glm::mat4> modelMatrices;
-    if (modelMatrices.size() == 0)
+    for (const auto& caster : casters)
     {
-        for (int i = 0; i < 10; ++i)
+        shader.setMat4("model", caster.Model);
+        renderCube();
+    }
+}
+
+// renders the floor and the cubes that overlap the given cascade; returns the number of draws
+// -------------------------------------------------------------------------------------------
+unsigned int renderSceneCulled(const Shader &shader, unsigned int cascade)
+{
+    const CascadeState& state = cascades[cascade];
+    unsigned int draws = 0;
+    // floor: always inside, it spans the whole scene
+    glm::mat4 model = glm::mat4(1.0f);
+    shader.setMat4("model", model);
+    glBindVertexArray(planeVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    draws++;
+
+    for (const auto& caster : casters)
+    {
+        if (!casterInCascade(caster.Center, caster.Radius, state))
         {
-            static std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-10, 10);
-            static std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
-            static std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
-
-            auto model = glm::mat4(1.0f);
-            model = glm::translate(model, glm::vec3(offsetDistribution(generator), offsetDistribution(generator) + 10.0f, offsetDistribution(generator)));
-            model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
-            model = glm::scale(model, glm::vec3(scaleDistribution(generator)));
-            modelMatrices.push_back(model);
+            cascades[cascade].Culled++;
+            continue;
         }
+        shader.setMat4("model", caster.Model);
+        renderCube();
+        draws++;
     }
+    return draws;
+}
 
-    for (const auto& model : modelMatrices)
+// creates the randomly placed cubes of the scene
+// ----------------------------------------------
+void initSceneCasters()
+{
+    std::uniform_real_distribution<float> offsetDistribution = std::uniform_real_distribution<float>(-10, 10);
+    std::uniform_real_distribution<float> scaleDistribution = std::uniform_real_distribution<float>(1.0, 2.0);
+    std::uniform_real_distribution<float> rotationDistribution = std::uniform_real_distribution<float>(0, 180);
+    for (int i = 0; i < 10; ++i)
     {
-        shader.setMat4("model", model);
-        renderCube();
+        const glm::vec3 position(offsetDistribution(generator), offsetDistribution(generator) + 10.0f, offsetDistribution(generator));
+        const float scale = scaleDistribution(generator);
+        auto model = glm::mat4(1.0f);
+        model = glm::translate(model, position);
+        model = glm::rotate(model, glm::radians(rotationDistribution(generator)), glm::normalize(glm::vec3(1.0, 0.0, 1.0)));
+        model = glm::scale(model, glm::vec3(scale));
+        // the unit cube spans [-1, 1], so its bounding sphere has radius sqrt(3) * scale
+        casters.push_back({ model, position, scale * 1.7321f, false, position });
     }
 }
 
+// moves the first cube up and down while animateCaster is on and flags it as moved
+// --------------------------------------------------------------------------------
+void updateSceneCasters(float time)
+{
+    for (auto& caster : casters)
+    {
+        caster.Moved = false;
+        caster.PreviousCenter = caster.Center;
+    }
+    if (!animateCaster || casters.empty())
+        return;
+    Caster& caster = casters[0];
+    const glm::vec3 offset(0.0f, std::sin(time) * 4.0f * deltaTime, 0.0f);
+    caster.Model = glm::translate(glm::mat4(1.0f), offset) * caster.Model;
+    caster.Center += offset;
+    caster.Moved = true;
+}
 
 // renderCube() renders a 1x1 3D cube in NDC.
 // -------------------------------------------------
@@ -558,9 +745,33 @@ void processInput(GLFWwindow *window)
     static int cPress = GLFW_RELEASE;
     if (glfwGetKey(window, GLFW_KEY_C) == GLFW_RELEASE && cPress == GLFW_PRESS)
     {
-        lightMatricesCache = getLightSpaceMatrices();
+        if (cascadeMode == CASCADES_FIT_EVERY_FRAME)
+        {
+            lightMatricesCache = getLightSpaceMatrices();
+        }
+        else
+        {
+            // visualize the matrices the layers were actually rendered with
+            lightMatricesCache.clear();
+            for (const auto& cascade : cascades)
+                lightMatricesCache.push_back(cascade.LightSpaceMatrix);
+        }
     }
     cPress = glfwGetKey(window, GLFW_KEY_C);
+
+    static int vPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_V) == GLFW_RELEASE && vPress == GLFW_PRESS)
+    {
+        cascadeMode = (CascadeMode)((cascadeMode + 1) % CASCADE_MODE_COUNT);
+    }
+    vPress = glfwGetKey(window, GLFW_KEY_V);
+
+    static int mPress = GLFW_RELEASE;
+    if (glfwGetKey(window, GLFW_KEY_M) == GLFW_RELEASE && mPress == GLFW_PRESS)
+    {
+        animateCaster = !animateCaster;
+    }
+    mPress = glfwGetKey(window, GLFW_KEY_M);
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -742,3 +953,119 @@ std::vector<glm::mat4> getLightSpaceMatrices()
     }
     return ret;
 }
+
+// near and far plane of the camera frustum slice covered by a cascade
+void getCascadeSlice(unsigned int cascade, float& nearPlane, float& farPlane)
+{
+    nearPlane = cascade == 0 ? cameraNearPlane : shadowCascadeLevels[cascade - 1];
+    farPlane = cascade < shadowCascadeLevels.size() ? shadowCascadeLevels[cascade] : cameraFarPlane;
+}
+
+// bounding sphere of a cascade's frustum slice, center in light rotation space. The radius only
+// depends on the projection, so it stays the same while the camera moves or turns; it is rounded
+// up to keep float noise from changing the texel size.
+void getCascadeSphere(unsigned int cascade, glm::vec3& center, float& radius)
+{
+    float nearPlane, farPlane;
+    getCascadeSlice(cascade, nearPlane, farPlane);
+    const auto proj = glm::perspective(
+        glm::radians(camera.Zoom), (float)fb_width / (float)fb_height, nearPlane,
+        farPlane);
+    const auto corners = getFrustumCornersWorldSpace(proj, camera.GetViewMatrix());
+
+    glm::vec3 worldCenter = glm::vec3(0, 0, 0);
+    for (const auto& v : corners)
+    {
+        worldCenter += glm::vec3(v);
+    }
+    worldCenter /= corners.size();
+
+    radius = 0.0f;
+    for (const auto& v : corners)
+    {
+        radius = std::max(radius, glm::length(glm::vec3(v) - worldCenter));
+    }
+    radius = std::ceil(radius * 16.0f) / 16.0f;
+    center = glm::vec3(lightRotation * glm::vec4(worldCenter, 1.0f));
+}
+
+// snaps the sphere center to whole shadow map texels of a cascade with the given radius
+glm::vec3 snapCascadeCenter(glm::vec3 center, float radius)
+{
+    const float texelSize = 2.0f * radius / depthMapResolution;
+    center.x = std::floor(center.x / texelSize) * texelSize;
+    center.y = std::floor(center.y / texelSize) * texelSize;
+    return center;
+}
+
+// ortho box around the sphere, extended by casterMargin towards the light
+glm::mat4 getStableLightSpaceMatrix(const glm::vec3& center, float radius)
+{
+    const glm::mat4 lightProjection = glm::ortho(center.x - radius, center.x + radius, center.y - radius, center.y + radius,
+                                                 -(center.z + radius) - casterMargin, -(center.z - radius));
+    return lightProjection * lightRotation;
+}
+
+// whether a bounding sphere (world space) overlaps the ortho box a cascade was rendered with
+bool casterInCascade(const glm::vec3& center, float radius, const CascadeState& cascade)
+{
+    const glm::vec3 p = glm::vec3(lightRotation * glm::vec4(center, 1.0f));
+    const glm::vec3& c = cascade.Center;
+    const float extent = cascade.Radius + radius;
+    return std::abs(p.x - c.x) <= extent && std::abs(p.y - c.y) <= extent &&
+           p.z - radius <= c.z + cascade.Radius + casterMargin && p.z + radius >= c.z - cascade.Radius;
+}
+
+// decides per cascade whether its layer has to be re-rendered this frame and refits the ones
+// that do. Outside the cached mode every cascade is refit and rendered each frame.
+void updateCascades(unsigned int frameIndex)
+{
+    const bool cached = cascadeMode == CASCADES_STABLE_CACHED;
+    for (unsigned int i = 0; i < cascades.size(); ++i)
+    {
+        CascadeState& cascade = cascades[i];
+        const unsigned int interval = cascadeUpdateIntervals[std::min<size_t>(i, sizeof(cascadeUpdateIntervals) / sizeof(cascadeUpdateIntervals[0]) - 1)];
+
+        glm::vec3 sliceCenter;
+        float sliceRadius;
+        getCascadeSphere(i, sliceCenter, sliceRadius);
+        float radius = sliceRadius;
+        if (cached && interval > 1)
+            radius = std::ceil(sliceRadius * cascadeSlack * 16.0f) / 16.0f;
+        const glm::vec3 center = snapCascadeCenter(sliceCenter, radius);
+
+        bool render = !cached || !cascade.Valid || cascade.Radius != radius;
+        if (!render)
+        {
+            // the slice has left the area the layer was rendered for
+            const glm::vec3 d = glm::abs(sliceCenter - cascade.Center);
+            render = d.x + sliceRadius > cascade.Radius || d.y + sliceRadius > cascade.Radius || d.z + sliceRadius > cascade.Radius;
+        }
+        if (!render)
+        {
+            // a caster moved into, out of or within the layer
+            for (const auto& caster : casters)
+            {
+                if (caster.Moved && (casterInCascade(caster.PreviousCenter, caster.Radius, cascade) || casterInCascade(caster.Center, caster.Radius, cascade)))
+                {
+                    render = true;
+                    break;
+                }
+            }
+        }
+        if (!render && (frameIndex + i) % interval == 0)
+        {
+            // staggered refresh, skipped while the camera hasn't moved a texel
+            render = center != cascade.Center;
+        }
+
+        cascade.NeedsRender = render;
+        if (render)
+        {
+            cascade.Center = center;
+            cascade.Radius = radius;
+            cascade.LightSpaceMatrix = getStableLightSpaceMatrix(center, radius);
+            cascade.Valid = true;
+        }
+    }
+}
@@ -0,0 +1,49 @@
+#version 330 core
+layout (location = 0) in vec2 aGridPos;     // shared grid mesh, [0, 1] on both axes
+layout (location = 1) in vec4 aNode;        // per instance: xy = node offset, z = node size, w = lod level
+
+out float Height;
+out vec3 Position;
+out vec3 Normal;
+
+uniform sampler2D heightMap;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform vec3 cameraPos;
+uniform float gridDim;                      // quads per side of the grid mesh
+uniform vec2 morphRanges[16];               // per lod level: distance where morphing starts and ends
+uniform vec2 terrainOrigin;                 // world xz of texel (0, 0)
+uniform vec2 terrainExtent;                 // texels along world x and z
+uniform float heightScale;
+uniform float heightShift;
+
+float sampleHeight(vec2 worldXZ)
+{
+    // world x runs along the rows of the heightmap, world z along the columns
+    vec2 texel = clamp(worldXZ - terrainOrigin, vec2(0.0), terrainExtent - 1.0);
+    vec2 uv = (texel.yx + 0.5) / terrainExtent.yx;
+    return textureLod(heightMap, uv, 0.0).r * heightScale - heightShift;
+}
+
+void main()
+{
+    vec2 worldXZ = aNode.xy + aGridPos * aNode.z;
+
+    // towards the end of its range, move every odd vertex onto the grid of the next coarser level
+    vec2 morphRange = morphRanges[int(aNode.w)];
+    float dist = distance(cameraPos, vec3(worldXZ.x, sampleHeight(worldXZ), worldXZ.y));
+    float morph = clamp((dist - morphRange.x) / (morphRange.y - morphRange.x), 0.0, 1.0);
+    vec2 fracPart = fract(aGridPos * gridDim * 0.5) * 2.0 / gridDim;
+    worldXZ -= fracPart * aNode.z * morph;
+
+    // nodes on the border of the map reach past its last texel, fold those vertices onto the edge
+    worldXZ = clamp(worldXZ, terrainOrigin, terrainOrigin + terrainExtent - 1.0);
+
+    Height = sampleHeight(worldXZ);
+    Normal = normalize(vec3(sampleHeight(worldXZ - vec2(1.0, 0.0)) - sampleHeight(worldXZ + vec2(1.0, 0.0)), 2.0,
+                            sampleHeight(worldXZ - vec2(0.0, 1.0)) - sampleHeight(worldXZ + vec2(0.0, 1.0))));
+    vec4 worldPos = vec4(worldXZ.x, Height, worldXZ.y, 1.0);
+    Position = (view * worldPos).xyz;
+    gl_Position = projection * view * worldPos;
+}
@@ -1,16 +1,47 @@
 #version 330 core
-layout (location = 0) in vec3 aPos;
+layout (location = 0) in float aHeight;     // quantized to 16 bits, 0..1 over [heightMin, heightMin + heightRange]
+layout (location = 1) in vec4 aNormal;      // packed 10-bit normal in the grid frame (x = column, z = row)
 
 out float Height;
 out vec3 Position;
+out vec3 Normal;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+uniform int gridWidth;      // vertices per row
+uniform int gridHeight;     // rows
+uniform float heightMin;
+uniform float heightRange;
+
+// skirt vertices follow the grid and walk its border: along row 0, up the last column, back along
+// the last row and down column 0 (see TerrainSkirtCoordinate)
+ivec2 skirtCoordinate(int k)
+{
+    if(k < gridWidth - 1)
+        return ivec2(k, 0);
+    k -= gridWidth - 1;
+    if(k < gridHeight - 1)
+        return ivec2(gridWidth - 1, k);
+    k -= gridHeight - 1;
+    if(k < gridWidth - 1)
+        return ivec2(gridWidth - 1 - k, gridHeight - 1);
+    k -= gridWidth - 1;
+    return ivec2(0, gridHeight - 1 - k);
+}
+
 void main()
 {
-    Height = aPos.y;
-    Position = (view * model * vec4(aPos, 1.0)).xyz;
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-}
\ No newline at end of file
+    // x and z aren't stored, the index of the vertex is its position in the grid
+    int gridVertices = gridWidth * gridHeight;
+    ivec2 grid = gl_VertexID < gridVertices ? ivec2(gl_VertexID % gridWidth, gl_VertexID / gridWidth)
+                                            : skirtCoordinate(gl_VertexID - gridVertices);
+
+    // rows run along world x and columns along world z, like the original lattice
+    Height = aHeight * heightRange + heightMin;
+    vec4 worldPos = model * vec4(-gridHeight / 2.0 + grid.y, Height, -gridWidth / 2.0 + grid.x, 1.0);
+    Normal = mat3(model) * aNormal.zyx;
+    Position = (view * worldPos).xyz;
+    gl_Position = projection * view * worldPos;
+}
@@ -9,21 +9,30 @@
 
 #include <learnopengl/shader_m.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/cdlod.h>
+#include <learnopengl/terrain_builder.h>
 
 #include <iostream>
 #include <vector>
+#include <chrono>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int modifiers);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow *window);
+unsigned int createGridMesh(unsigned int resolution, unsigned int instanceVBO, size_t instanceOffset);
+void uploadTerrainMesh(const TerrainMesh& mesh, unsigned int vao, unsigned int heightVBO, unsigned int normalVBO, unsigned int ibo);
 
 // settings
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 int useWireframe = 0;
 int displayGrayscale = 0;
+int useCDLOD = 1;           // T: quadtree terrain with a shared grid mesh instead of one strip per heightmap row
+int freezeSelection = 0;    // F: keep the current node selection to inspect culling and lod from elsewhere
+int useSkirts = 0;          // K: rebuild the full resolution mesh with skirts along its border
+int rebuildMesh = 0;
 
 // camera - give pretty starting point
 Camera camera(glm::vec3(67.0f, 627.5f, 169.9f),
@@ -83,6 +92,7 @@ int main()
     // build and compile our shader program
     // ------------------------------------
     Shader heightMapShader("8.3.cpuheight.vs","8.3.cpuheight.fs");
+    Shader cdlodShader("8.3.cdlod.vs","8.3.cpuheight.fs");
 
     // load and create a texture
     // -------------------------
@@ -101,62 +111,100 @@ int main()
     }
 
 
-    // set up vertex data (and buffer(s)) and configure vertex attributes
-    // ------------------------------------------------------------------
-    std::vector<float> vertices;
+    // build the full resolution mesh of every heightmap once, to compare build time and memory
+    // with float positions and one index strip per row
+    // -----------------------------------------------------------------------------------------
     float yScale = 64.0f / 256.0f, yShift = 16.0f;
-    int rez = 1;
     unsigned bytePerPixel = nrChannels;
-    for(int i = 0; i < height; i++)
+    TerrainMeshSettings meshSettings;
+    meshSettings.YScale = yScale;
+    meshSettings.YShift = yShift;
+    const char* heightmapFiles[] = { "heightmaps/iceland_heightmap.png", "heightmaps/river_heightmap.png", "heightmaps/river2_heightmap.png" };
+    for(const char* file : heightmapFiles)
     {
-        for(int j = 0; j < width; j++)
-        {
-            unsigned char* pixelOffset = data + (j + width * i) * bytePerPixel;
-            unsigned char y = pixelOffset[0];
-
-            // vertex
-            vertices.push_back( -height/2.0f + height*i/(float)height );   // vx
-            vertices.push_back( (int) y * yScale - yShift);   // vy
-            vertices.push_back( -width/2.0f + width*j/(float)width );   // vz
-        }
+        int mapWidth, mapHeight, mapChannels;
+        unsigned char* mapData = stbi_load(file, &mapWidth, &mapHeight, &mapChannels, 0);
+        if (!mapData)
+            continue;
+        TerrainMesh mapMesh = BuildTerrainMesh(mapData, mapWidth, mapHeight, mapChannels, meshSettings);
+        stbi_image_free(mapData);
+        size_t floatBytes = (size_t)mapWidth * mapHeight * 3 * sizeof(float) + (size_t)(mapHeight - 1) * mapWidth * 2 * sizeof(unsigned);
+        std::cout << file << ": " << mapWidth << " x " << mapHeight << " built in " << mapMesh.BuildMs << " ms on " << mapMesh.ThreadsUsed
+                  << " threads, " << (mapMesh.VertexBytes() + mapMesh.IndexBytes()) / (1024 * 1024) << " MB (vertices "
+                  << mapMesh.VertexBytes() / (1024 * 1024) << " MB, indices " << mapMesh.IndexBytes() / (1024 * 1024) << " MB) instead of "
+                  << floatBytes / (1024 * 1024) << " MB" << std::endl;
     }
-    std::cout << "Loaded " << vertices.size() / 3 << " vertices" << std::endl;
-    stbi_image_free(data);
 
-    std::vector<unsigned> indices;
-    for(unsigned i = 0; i < height-1; i += rez)
-    {
-        for(unsigned j = 0; j < width; j += rez)
-        {
-            for(unsigned k = 0; k < 2; k++)
-            {
-                indices.push_back(j + width * (i + k*rez));
-            }
-        }
-    }
-    std::cout << "Loaded " << indices.size() << " indices" << std::endl;
-
-    const int numStrips = (height-1)/rez;
-    const int numTrisPerStrip = (width/rez)*2-2;
-    std::cout << "Created lattice of " << numStrips << " strips with " << numTrisPerStrip << " triangles each" << std::endl;
-    std::cout << "Created " << numStrips * numTrisPerStrip << " triangles total" << std::endl;
+    // CDLOD: the heights go into a single channel texture and only a min/max height quadtree
+    // stays on the CPU; every node is drawn with one of two small grid meshes
+    // ------------------------------------------------------------------------------------
+    CDLODSettings cdlodSettings;
+    CDLODTerrain terrain;
+    terrain.Build(data, width, height, nrChannels, yScale, yShift, glm::vec2(-height/2.0f, -width/2.0f), cdlodSettings);
+
+    // the first channel is kept for the height texture and for rebuilding the mesh with skirts
+    std::vector<unsigned char> heights((size_t)width * height);
+    for(size_t i = 0; i < heights.size(); i++)
+        heights[i] = data[i * bytePerPixel];
+    unsigned int heightTexture;
+    glGenTextures(1, &heightTexture);
+    glBindTexture(GL_TEXTURE_2D, heightTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, heights.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    stbi_image_free(data);
 
-    // first, configure the cube's VAO (and terrainVBO + terrainIBO)
-    unsigned int terrainVAO, terrainVBO, terrainIBO;
+    cdlodShader.use();
+    cdlodShader.setInt("heightMap", 0);
+    cdlodShader.setVec2("terrainOrigin", terrain.Origin);
+    cdlodShader.setVec2("terrainExtent", glm::vec2(terrain.Extent));
+    cdlodShader.setFloat("heightScale", 255.0f * yScale);
+    cdlodShader.setFloat("heightShift", yShift);
+    for(unsigned int l = 0; l < terrain.LodLevels(); l++)
+        cdlodShader.setVec2("morphRanges[" + std::to_string(l) + "]", terrain.MorphRange(l));
+
+    // per node instance data is streamed every frame; the first half of the buffer holds the
+    // full nodes, the second half the quarter nodes
+    const unsigned int maxNodes = 2048;
+    unsigned int nodeVBO;
+    glGenBuffers(1, &nodeVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, nodeVBO);
+    glBufferData(GL_ARRAY_BUFFER, 2 * maxNodes * sizeof(CDLODNode), NULL, GL_STREAM_DRAW);
+    const unsigned int gridResolution = cdlodSettings.GridResolution;
+    unsigned int fullGridVAO = createGridMesh(gridResolution, nodeVBO, 0);
+    unsigned int quarterGridVAO = createGridMesh(gridResolution / 2, nodeVBO, maxNodes * sizeof(CDLODNode));
+
+    std::vector<CDLODNode> fullNodes, quarterNodes;
+    fullNodes.reserve(maxNodes);
+    quarterNodes.reserve(maxNodes);
+    std::cout << "CDLOD quadtree: " << terrain.LodLevels() << " levels, " << cdlodSettings.LeafSize << " texel leaves, "
+              << gridResolution << "x" << gridResolution << " grid mesh" << std::endl;
+
+    // LOD selection benchmark from random viewpoints
+    glm::mat4 benchmarkProjection = glm::perspective(glm::radians(45.0f), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100000.0f);
+    glm::vec2 benchmark = CDLODBenchmark(terrain, benchmarkProjection);
+    std::cout << "CDLOD selection benchmark: " << benchmark.x << " us per selection, " << benchmark.y << " nodes on average" << std::endl;
+
+    // the full resolution mesh: quantized heights and packed normals, x and z come from gl_VertexID
+    TerrainMesh mesh = BuildTerrainMesh(heights.data(), width, height, 1, meshSettings);
+    std::cout << "Loaded " << mesh.Heights.size() << " vertices and " << mesh.Indices.size() << " indices in one strip" << std::endl;
+
+    unsigned int terrainVAO, terrainHeightVBO, terrainNormalVBO, terrainIBO;
     glGenVertexArrays(1, &terrainVAO);
-    glBindVertexArray(terrainVAO);
-
-    glGenBuffers(1, &terrainVBO);
-    glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
+    glGenBuffers(1, &terrainHeightVBO);
+    glGenBuffers(1, &terrainNormalVBO);
     glGenBuffers(1, &terrainIBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, terrainIBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned), &indices[0], GL_STATIC_DRAW);
+    uploadTerrainMesh(mesh, terrainVAO, terrainHeightVBO, terrainNormalVBO, terrainIBO);
+    glPrimitiveRestartIndex(TerrainMesh::RestartIndex);
+
+    // statistics, reported every 100 frames
+    unsigned int frameCount = 0;
+    double selectionMicroseconds = 0.0;
+    unsigned long long drawCalls = 0, drawnVertices = 0;
 
     // render loop
     // -----------
@@ -173,34 +221,103 @@ int main()
         // input
         // -----
         processInput(window);
+        if (rebuildMesh)
+        {
+            meshSettings.Skirts = useSkirts;
+            mesh = BuildTerrainMesh(heights.data(), width, height, 1, meshSettings);
+            uploadTerrainMesh(mesh, terrainVAO, terrainHeightVBO, terrainNormalVBO, terrainIBO);
+            std::cout << "Rebuilt mesh " << (useSkirts ? "with" : "without") << " skirts in " << mesh.BuildMs << " ms, "
+                      << mesh.SkirtVertexCount() << " skirt vertices" << std::endl;
+            rebuildMesh = 0;
+        }
 
         // render
         // ------
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // be sure to activate shader when setting uniforms/drawing objects
-        heightMapShader.use();
-
         // view/projection transformations
         glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100000.0f);
         glm::mat4 view = camera.GetViewMatrix();
-        heightMapShader.setMat4("projection", projection);
-        heightMapShader.setMat4("view", view);
-
-        // world transformation
-        glm::mat4 model = glm::mat4(1.0f);
-        heightMapShader.setMat4("model", model);
-        
-        // render the cube
-        glBindVertexArray(terrainVAO);
-//        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-        for(unsigned strip = 0; strip < numStrips; strip++)
+
+        glPolygonMode(GL_FRONT_AND_BACK, useWireframe ? GL_LINE : GL_FILL);
+        if (useCDLOD)
         {
-            glDrawElements(GL_TRIANGLE_STRIP,   // primitive type
-                           numTrisPerStrip+2,   // number of indices to render
-                           GL_UNSIGNED_INT,     // index data type
-                           (void*)(sizeof(unsigned) * (numTrisPerStrip+2) * strip)); // offset to starting index
+            // pick the nodes for this frame and draw each grid mesh once, instanced over its nodes
+            if (!freezeSelection)
+            {
+                auto start = std::chrono::high_resolution_clock::now();
+                terrain.Select(camera.Position, CDLODFrustum(projection * view), fullNodes, quarterNodes);
+                selectionMicroseconds += std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - start).count();
+                fullNodes.resize(std::min<size_t>(fullNodes.size(), maxNodes));
+                quarterNodes.resize(std::min<size_t>(quarterNodes.size(), maxNodes));
+                glBindBuffer(GL_ARRAY_BUFFER, nodeVBO);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, fullNodes.size() * sizeof(CDLODNode), fullNodes.data());
+                glBufferSubData(GL_ARRAY_BUFFER, maxNodes * sizeof(CDLODNode), quarterNodes.size() * sizeof(CDLODNode), quarterNodes.data());
+            }
+
+            cdlodShader.use();
+            cdlodShader.setMat4("projection", projection);
+            cdlodShader.setMat4("view", view);
+            cdlodShader.setVec3("cameraPos", camera.Position);
+            cdlodShader.setBool("shaded", !displayGrayscale);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, heightTexture);
+
+            if (!fullNodes.empty())
+            {
+                cdlodShader.setFloat("gridDim", (float)gridResolution);
+                glBindVertexArray(fullGridVAO);
+                glDrawElementsInstanced(GL_TRIANGLES, gridResolution * gridResolution * 6, GL_UNSIGNED_INT, 0, fullNodes.size());
+                drawCalls++;
+                drawnVertices += fullNodes.size() * (gridResolution + 1) * (gridResolution + 1);
+            }
+            if (!quarterNodes.empty())
+            {
+                unsigned int quarterResolution = gridResolution / 2;
+                cdlodShader.setFloat("gridDim", (float)quarterResolution);
+                glBindVertexArray(quarterGridVAO);
+                glDrawElementsInstanced(GL_TRIANGLES, quarterResolution * quarterResolution * 6, GL_UNSIGNED_INT, 0, quarterNodes.size());
+                drawCalls++;
+                drawnVertices += quarterNodes.size() * (quarterResolution + 1) * (quarterResolution + 1);
+            }
+        }
+        else
+        {
+            // be sure to activate shader when setting uniforms/drawing objects
+            heightMapShader.use();
+            heightMapShader.setMat4("projection", projection);
+            heightMapShader.setMat4("view", view);
+
+            // world transformation
+            glm::mat4 model = glm::mat4(1.0f);
+            heightMapShader.setMat4("model", model);
+            heightMapShader.setInt("gridWidth", mesh.Width);
+            heightMapShader.setInt("gridHeight", mesh.Height);
+            heightMapShader.setFloat("heightMin", mesh.MinHeight);
+            heightMapShader.setFloat("heightRange", mesh.MaxHeight - mesh.MinHeight);
+            heightMapShader.setBool("shaded", !displayGrayscale);
+
+            // render the whole terrain as one strip, the rows are separated by restart indices
+            glBindVertexArray(terrainVAO);
+            glEnable(GL_PRIMITIVE_RESTART);
+            glDrawElements(GL_TRIANGLE_STRIP, (GLsizei)mesh.Indices.size(), GL_UNSIGNED_INT, 0);
+            glDisable(GL_PRIMITIVE_RESTART);
+            drawCalls++;
+            drawnVertices += mesh.Heights.size();
+        }
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+        if (++frameCount % 100 == 0)
+        {
+            std::cout << (useCDLOD ? "CDLOD" : "full mesh") << ": " << drawCalls / 100.0 << " draw calls, "
+                      << drawnVertices / 100 << " vertices per frame";
+            if (useCDLOD)
+                std::cout << ", " << fullNodes.size() << " full + " << quarterNodes.size() << " quarter nodes, selection "
+                          << selectionMicroseconds / 100.0 << " us" << (freezeSelection ? " (frozen)" : "");
+            std::cout << std::endl;
+            selectionMicroseconds = 0.0;
+            drawCalls = drawnVertices = 0;
         }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
@@ -212,8 +329,13 @@ int main()
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &terrainVAO);
-    glDeleteBuffers(1, &terrainVBO);
+    glDeleteBuffers(1, &terrainHeightVBO);
+    glDeleteBuffers(1, &terrainNormalVBO);
     glDeleteBuffers(1, &terrainIBO);
+    glDeleteVertexArrays(1, &fullGridVAO);
+    glDeleteVertexArrays(1, &quarterGridVAO);
+    glDeleteBuffers(1, &nodeVBO);
+    glDeleteTextures(1, &heightTexture);
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -238,6 +360,71 @@ void processInput(GLFWwindow *window)
         camera.ProcessKeyboard(RIGHT, deltaTime);
 }
 
+// (re)fills the buffers of the full resolution mesh: heights as normalized 16-bit values and
+// normals as packed 10-bit values, both read as floats by 8.3.cpuheight.vs
+// ------------------------------------------------------------------------------------------
+void uploadTerrainMesh(const TerrainMesh& mesh, unsigned int vao, unsigned int heightVBO, unsigned int normalVBO, unsigned int ibo)
+{
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, heightVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.Heights.size() * sizeof(uint16_t), mesh.Heights.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, normalVBO);
+    glBufferData(GL_ARRAY_BUFFER, mesh.Normals.size() * sizeof(uint32_t), mesh.Normals.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(uint32_t), (void*)0);
+    glEnableVertexAttribArray(1);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.Indices.size() * sizeof(uint32_t), mesh.Indices.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+}
+
+// creates a VAO with a flat (resolution + 1)^2 vertex grid over [0, 1]^2 and the per node
+// instance attribute read from instanceVBO at instanceOffset; the grid buffers stay bound to the VAO
+// -----------------------------------------------------------------------------------------------
+unsigned int createGridMesh(unsigned int resolution, unsigned int instanceVBO, size_t instanceOffset)
+{
+    std::vector<float> vertices;
+    vertices.reserve((resolution + 1) * (resolution + 1) * 2);
+    for(unsigned int z = 0; z <= resolution; z++)
+    {
+        for(unsigned int x = 0; x <= resolution; x++)
+        {
+            vertices.push_back(x / (float)resolution);
+            vertices.push_back(z / (float)resolution);
+        }
+    }
+    std::vector<unsigned int> indices;
+    indices.reserve(resolution * resolution * 6);
+    for(unsigned int z = 0; z < resolution; z++)
+    {
+        for(unsigned int x = 0; x < resolution; x++)
+        {
+            unsigned int i0 = x + (resolution + 1) * z, i1 = i0 + 1, i2 = i0 + resolution + 1, i3 = i2 + 1;
+            indices.insert(indices.end(), { i0, i2, i1, i1, i2, i3 });
+        }
+    }
+
+    unsigned int vao, vbo, ibo;
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+    glGenBuffers(1, &vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glGenBuffers(1, &ibo);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CDLODNode), (void*)instanceOffset);
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+    glBindVertexArray(0);
+    return vao;
+}
+
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
 // ---------------------------------------------------------------------------------------------
 void framebuffer_size_callback(GLFWwindow* window, int width, int height)
@@ -261,6 +448,16 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
             case GLFW_KEY_G:
                 displayGrayscale = 1 - displayGrayscale;
                 break;
+            case GLFW_KEY_T:
+                useCDLOD = 1 - useCDLOD;
+                break;
+            case GLFW_KEY_F:
+                freezeSelection = 1 - freezeSelection;
+                break;
+            case GLFW_KEY_K:
+                useSkirts = 1 - useSkirts;
+                rebuildMesh = 1;
+                break;
             default:
                 break;
         }
@@ -1,11 +1,14 @@
 #version 410 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTex;
+layout (location = 2) in vec2 aHeightBounds;
 
 out vec2 TexCoord;
+out vec2 HeightBounds;
 
 void main()
 {
     gl_Position = vec4(aPos, 1.0);
     TexCoord = aTex;
-}
\ No newline at end of file
+    HeightBounds = aHeightBounds;
+}
@@ -9,6 +9,7 @@
 
 #include <learnopengl/shader_t.h>
 #include <learnopengl/camera.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
 #include <vector>
@@ -23,6 +24,9 @@ void processInput(GLFWwindow *window);
 const unsigned int SCR_WIDTH = 800;
 const unsigned int SCR_HEIGHT = 600;
 const unsigned int NUM_PATCH_PTS = 4;
+int tessMode = 1;               // T: 0 = levels from eye-space distance, 1 = from projected edge length
+int frustumCulling = 1;         // C: drop patches outside the view frustum in the TCS
+float targetTriangleSize = 8.0f; // UP/DOWN: target edge length of generated triangles in pixels
 
 // camera - give pretty starting point
 Camera camera(glm::vec3(67.0f, 627.5f, 169.9f),
@@ -104,6 +108,8 @@ int main()
     int width, height, nrChannels;
     // The FileSystem::getPath(...) is part of the GitHub repository so we can find files on any IDE/platform; replace it with your own image path.
     unsigned char *data = stbi_load("heightmaps/iceland_heightmap.png", &width, &height, &nrChannels, 0);
+    unsigned rez = 20;
+    std::vector<glm::vec2> patchHeightBounds(rez*rez, glm::vec2(-16.0f, 48.0f));
     if (data)
     {
         glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
@@ -111,6 +117,29 @@ int main()
 
         tessHeightMapShader.setInt("heightMap", 0);
         std::cout << "Loaded heightmap of size " << height << " x " << width << std::endl;
+
+        // height range of the texels under each patch (the tes reads the green channel), one texel
+        // wider on every side for the bilinear filter; the tcs culls patches with these bounds
+        int channel = std::min(1, nrChannels - 1);
+        for(unsigned i = 0; i < rez; i++)
+        {
+            for(unsigned j = 0; j < rez; j++)
+            {
+                int column0 = std::max(0, (int)(width * i / rez) - 1), column1 = std::min(width - 1, (int)(width * (i + 1) / rez) + 1);
+                int row0 = std::max(0, (int)(height * j / rez) - 1), row1 = std::min(height - 1, (int)(height * (j + 1) / rez) + 1);
+                unsigned char low = 255, high = 0;
+                for(int row = row0; row <= row1; row++)
+                {
+                    for(int column = column0; column <= column1; column++)
+                    {
+                        unsigned char h = data[(row * width + column) * nrChannels + channel];
+                        low = std::min(low, h);
+                        high = std::max(high, h);
+                    }
+                }
+                patchHeightBounds[i * rez + j] = glm::vec2(low / 255.0f * 64.0f - 16.0f, high / 255.0f * 64.0f - 16.0f);
+            }
+        }
     }
     else
     {
@@ -122,34 +151,42 @@ int main()
     // ------------------------------------------------------------------
     std::vector<float> vertices;
 
-    unsigned rez = 20;
     for(unsigned i = 0; i <= rez-1; i++)
     {
         for(unsigned j = 0; j <= rez-1; j++)
         {
+            const glm::vec2& bounds = patchHeightBounds[i * rez + j];
             vertices.push_back(-width/2.0f + width*i/(float)rez); // v.x
             vertices.push_back(0.0f); // v.y
             vertices.push_back(-height/2.0f + height*j/(float)rez); // v.z
             vertices.push_back(i / (float)rez); // u
             vertices.push_back(j / (float)rez); // v
+            vertices.push_back(bounds.x); // min height
+            vertices.push_back(bounds.y); // max height
 
             vertices.push_back(-width/2.0f + width*(i+1)/(float)rez); // v.x
             vertices.push_back(0.0f); // v.y
             vertices.push_back(-height/2.0f + height*j/(float)rez); // v.z
             vertices.push_back((i+1) / (float)rez); // u
             vertices.push_back(j / (float)rez); // v
+            vertices.push_back(bounds.x); // min height
+            vertices.push_back(bounds.y); // max height
 
             vertices.push_back(-width/2.0f + width*i/(float)rez); // v.x
             vertices.push_back(0.0f); // v.y
             vertices.push_back(-height/2.0f + height*(j+1)/(float)rez); // v.z
             vertices.push_back(i / (float)rez); // u
             vertices.push_back((j+1) / (float)rez); // v
+            vertices.push_back(bounds.x); // min height
+            vertices.push_back(bounds.y); // max height
 
             vertices.push_back(-width/2.0f + width*(i+1)/(float)rez); // v.x
             vertices.push_back(0.0f); // v.y
             vertices.push_back(-height/2.0f + height*(j+1)/(float)rez); // v.z
             vertices.push_back((i+1) / (float)rez); // u
             vertices.push_back((j+1) / (float)rez); // v
+            vertices.push_back(bounds.x); // min height
+            vertices.push_back(bounds.y); // max height
         }
     }
     std::cout << "Loaded " << rez*rez << " patches of 4 control points each" << std::endl;
@@ -165,14 +202,25 @@ int main()
     glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
 
     // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
     // texCoord attribute
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(sizeof(float) * 3));
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(sizeof(float) * 3));
     glEnableVertexAttribArray(1);
+    // patch height bounds attribute
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(sizeof(float) * 5));
+    glEnableVertexAttribArray(2);
 
     glPatchParameteri(GL_PATCH_VERTICES, NUM_PATCH_PTS);
 
+    // count the triangles coming out of the tessellator; like the timer, the query of the
+    // previous frame is read back so the cpu doesn't wait on the gpu
+    unsigned int primitivesQueries[2];
+    glGenQueries(2, primitivesQueries);
+    GpuTimer terrainTimer;
+    unsigned int frameCount = 0;
+    unsigned long long primitivesGenerated = 0;
+
     // render loop
     // -----------
     while (!glfwWindowShouldClose(window))
@@ -205,9 +253,34 @@ int main()
         glm::mat4 model = glm::mat4(1.0f);
         tessHeightMapShader.setMat4("model", model);
 
+        tessHeightMapShader.setInt("tessMode", tessMode);
+        tessHeightMapShader.setBool("frustumCulling", frustumCulling);
+        tessHeightMapShader.setVec2("viewportSize", glm::vec2(SCR_WIDTH, SCR_HEIGHT));
+        tessHeightMapShader.setFloat("targetTriangleSize", targetTriangleSize);
+
         // render the terrain
+        terrainTimer.Begin();
+        glBeginQuery(GL_PRIMITIVES_GENERATED, primitivesQueries[frameCount % 2]);
         glBindVertexArray(terrainVAO);
         glDrawArrays(GL_PATCHES, 0, NUM_PATCH_PTS*rez*rez);
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        terrainTimer.End();
+
+        if (frameCount > 0)
+        {
+            GLuint64 primitives = 0;
+            glGetQueryObjectui64v(primitivesQueries[(frameCount + 1) % 2], GL_QUERY_RESULT, &primitives);
+            primitivesGenerated += primitives;
+        }
+        if (++frameCount % 100 == 0)
+        {
+            std::cout << (tessMode == 1 ? "screen-space error" : "distance") << " tessellation, culling " << (frustumCulling ? "on" : "off");
+            if (tessMode == 1)
+                std::cout << ", " << targetTriangleSize << " px triangles";
+            std::cout << ": " << primitivesGenerated / 100 << " triangles, " << terrainTimer.AverageMs() << " ms per frame" << std::endl;
+            primitivesGenerated = 0;
+            terrainTimer.Reset();
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
@@ -219,6 +292,7 @@ int main()
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, &terrainVAO);
     glDeleteBuffers(1, &terrainVBO);
+    glDeleteQueries(2, primitivesQueries);
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -260,6 +334,18 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     {
         switch(key)
         {
+            case GLFW_KEY_T:
+                tessMode = 1 - tessMode;
+                break;
+            case GLFW_KEY_C:
+                frustumCulling = 1 - frustumCulling;
+                break;
+            case GLFW_KEY_UP:
+                targetTriangleSize = std::min(targetTriangleSize * 2.0f, 64.0f);
+                break;
+            case GLFW_KEY_DOWN:
+                targetTriangleSize = std::max(targetTriangleSize * 0.5f, 1.0f);
+                break;
             default:
                 break;
         }
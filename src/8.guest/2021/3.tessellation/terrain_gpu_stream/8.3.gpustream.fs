@@ -0,0 +1,19 @@
+#version 410 core
+
+in float Height;
+in vec3 WorldPos;
+
+out vec4 FragColor;
+
+uniform float heightScale;
+uniform float heightShift;
+
+void main()
+{
+    // the tiled terrain is too large to read much from plain grayscale, so add a little
+    // directional light from the screen-space derivatives of the position
+    vec3 normal = normalize(cross(dFdx(WorldPos), dFdy(WorldPos)));
+    float diffuse = 0.4 + 0.6 * abs(dot(normal, normalize(vec3(0.3, 1.0, 0.2))));
+    float h = (Height + heightShift) / heightScale;
+    FragColor = vec4(vec3(h * diffuse), 1.0);
+}
@@ -0,0 +1,9 @@
+#version 410 core
+layout (location = 0) in vec3 aPos;
+
+uniform vec2 gridOffset;    // the patch grid follows the camera in whole patch steps
+
+void main()
+{
+    gl_Position = vec4(aPos + vec3(gridOffset.x, 0.0, gridOffset.y), 1.0);
+}
@@ -0,0 +1,540 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <learnopengl/filesystem.h>
+#include <learnopengl/shader_t.h>
+#include <learnopengl/camera.h>
+#include <learnopengl/terrain_tiles.h>
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <chrono>
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int modifiers);
+void mouse_callback(GLFWwindow* window, double xpos, double ypos);
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
+void processInput(GLFWwindow *window);
+bool buildTileFile(const std::string& path);
+size_t residentMemoryBytes();
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+const unsigned int NUM_PATCH_PTS = 4;
+
+// tiled terrain: the Iceland heightmap upscaled 8 times with added detail, 20992 x 14048 texels.
+// The tile file is built on first run (about 780 MB, git ignores *.hts) at TILE_FILE relative to the
+// repository root, or at the path given as the first command line argument
+const char* TILE_FILE = "bin/terrain_stream.hts";
+const unsigned int TERRAIN_UPSCALE = 8;
+const unsigned int TILE_SIZE = 256;
+const float HEIGHT_SCALE = 512.0f;
+const float HEIGHT_SHIFT = 128.0f;
+
+// every clipmap layer is a window of CLIPMAP_TILES x CLIPMAP_TILES tiles around the camera
+const int CLIPMAP_TILES = 4;
+const int MAX_CLIPMAP_LEVELS = 8;
+const unsigned int CACHE_TILES = 256;
+const unsigned int UPLOADS_PER_FRAME = 16;
+
+// the patch grid drawn around the camera
+const int PATCHES = 96;
+const float PATCH_SIZE = 128.0f;
+
+int flyAcross = 0;      // P: fly straight across the terrain to watch tiles stream in and out
+
+// camera - start above the middle of the terrain
+Camera camera(glm::vec3(10496.0f, 900.0f, 7024.0f),
+              glm::vec3(0.0f, 1.0f, 0.0f),
+              45.0f, -25.0f);
+float lastX = SCR_WIDTH / 2.0f;
+float lastY = SCR_HEIGHT / 2.0f;
+bool firstMouse = true;
+
+// timing
+float deltaTime = 0.0f;
+float lastFrame = 0.0f;
+
+// one layer of the clipmap: which tile occupies each toroidal slot and the window it should show
+struct ClipmapLevel
+{
+    glm::ivec2 WindowStart = glm::ivec2(0);
+    glm::ivec2 WindowSize = glm::ivec2(0);
+    glm::ivec2 CameraTile = glm::ivec2(0);
+    std::vector<glm::ivec2> Resident = std::vector<glm::ivec2>(CLIPMAP_TILES * CLIPMAP_TILES, glm::ivec2(-1));
+    glm::vec4 Valid = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);    // world xz min, xz max; empty when min > max
+
+    glm::ivec2& Slot(const glm::ivec2& tile)
+    {
+        return Resident[(tile.x % CLIPMAP_TILES) + CLIPMAP_TILES * (tile.y % CLIPMAP_TILES)];
+    }
+};
+
+// moves every clipmap window to the camera, uploads resident tiles that moved into a window and
+// asks the cache for the missing ones; returns the number of uploaded tiles
+unsigned int updateClipmap(std::vector<ClipmapLevel>& levels, const TerrainTileSet& tiles, TerrainTileCache& cache,
+                           unsigned int clipmapTexture, const glm::vec3& cameraPosition, unsigned int uploadBudget)
+{
+    unsigned int uploads = 0;
+    std::vector<TerrainTileKey> requests, prefetch;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, clipmapTexture);
+    for(int l = (int)levels.size() - 1; l >= 0; l--)   // coarse levels first, they back up the finer ones
+    {
+        ClipmapLevel& level = levels[l];
+        glm::ivec2 count = tiles.TileCount(l);
+        float tileWorldSize = (float)(TILE_SIZE << l);
+        level.CameraTile = glm::clamp(glm::ivec2(glm::floor(glm::vec2(cameraPosition.x, cameraPosition.z) / tileWorldSize)), glm::ivec2(0), count - 1);
+        level.WindowSize = glm::min(count, glm::ivec2(CLIPMAP_TILES));
+        level.WindowStart = glm::clamp(level.CameraTile - CLIPMAP_TILES / 2, glm::ivec2(0), count - level.WindowSize);
+
+        // tiles of the window, nearest to the camera first
+        std::vector<glm::ivec2> window;
+        for(int y = 0; y < level.WindowSize.y; y++)
+            for(int x = 0; x < level.WindowSize.x; x++)
+                window.push_back(level.WindowStart + glm::ivec2(x, y));
+        std::sort(window.begin(), window.end(), [&](const glm::ivec2& a, const glm::ivec2& b) {
+            glm::ivec2 da = glm::abs(a - level.CameraTile), db = glm::abs(b - level.CameraTile);
+            return std::max(da.x, da.y) < std::max(db.x, db.y);
+        });
+        for(const glm::ivec2& tile : window)
+        {
+            if(level.Slot(tile) == tile)
+                continue;
+            TerrainTileKey key = { l, tile.x, tile.y };
+            bool uploaded = uploads < uploadBudget && cache.Use(key, [&](const uint16_t* texels) {
+                glm::ivec2 slot = tile % CLIPMAP_TILES;
+                glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, slot.x * TILE_SIZE, slot.y * TILE_SIZE, l, TILE_SIZE, TILE_SIZE, 1, GL_RED, GL_UNSIGNED_SHORT, texels);
+            });
+            if(uploaded)
+            {
+                level.Slot(tile) = tile;
+                uploads++;
+            }
+            else
+            {
+                requests.push_back(key);
+            }
+        }
+
+        // one ring of tiles around the window is loaded ahead of time, after everything visible
+        for(int y = level.WindowStart.y - 1; y <= level.WindowStart.y + level.WindowSize.y; y++)
+            for(int x = level.WindowStart.x - 1; x <= level.WindowStart.x + level.WindowSize.x; x++)
+                if(x >= 0 && y >= 0 && x < count.x && y < count.y &&
+                   (x < level.WindowStart.x || y < level.WindowStart.y || x >= level.WindowStart.x + level.WindowSize.x || y >= level.WindowStart.y + level.WindowSize.y))
+                    prefetch.push_back({ l, x, y });
+
+        // the usable part of the window: cut off rows and columns with tiles that are still missing,
+        // keeping the camera's tile
+        glm::ivec2 rectMin = level.WindowStart, rectMax = level.WindowStart + level.WindowSize;
+        for(const glm::ivec2& tile : window)
+        {
+            if(level.Slot(tile) == tile || glm::any(glm::lessThan(tile, rectMin)) || glm::any(glm::greaterThanEqual(tile, rectMax)))
+                continue;
+            glm::ivec2 d = tile - level.CameraTile;
+            if(d == glm::ivec2(0))
+            {
+                rectMax = rectMin;
+                break;
+            }
+            if(std::abs(d.x) >= std::abs(d.y))
+                (d.x < 0 ? rectMin.x : rectMax.x) = d.x < 0 ? tile.x + 1 : tile.x;
+            else
+                (d.y < 0 ? rectMin.y : rectMax.y) = d.y < 0 ? tile.y + 1 : tile.y;
+        }
+        if(glm::any(glm::greaterThanEqual(rectMin, rectMax)))
+        {
+            level.Valid = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+            continue;
+        }
+        level.Valid = glm::vec4(glm::vec2(rectMin) * tileWorldSize, glm::vec2(rectMax) * tileWorldSize);
+        // sides on the border of the terrain never have to fade into a coarser level
+        if(rectMin.x == 0) level.Valid.x = -1e9f;
+        if(rectMin.y == 0) level.Valid.y = -1e9f;
+        if(rectMax.x == count.x) level.Valid.z = 1e9f;
+        if(rectMax.y == count.y) level.Valid.w = 1e9f;
+    }
+    requests.insert(requests.end(), prefetch.begin(), prefetch.end());
+    cache.SetRequests(requests);
+    return uploads;
+}
+
+int main(int argc, char* argv[])
+{
+    // glfw: initialize and configure
+    // ------------------------------
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // glfw window creation
+    // --------------------
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL: Terrain GPU Streaming", NULL, NULL);
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetKeyCallback(window, key_callback);
+    glfwSetCursorPosCallback(window, mouse_callback);
+    glfwSetScrollCallback(window, scroll_callback);
+
+    // tell GLFW to capture our mouse
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+    // glad: load all OpenGL function pointers
+    // ---------------------------------------
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return -1;
+    }
+
+    // configure global opengl state
+    // -----------------------------
+    glEnable(GL_DEPTH_TEST);
+    camera.MovementSpeed = 400.0f;
+
+    // build and compile our shader program
+    // ------------------------------------
+    Shader tessHeightMapShader("8.3.gpustream.vs", "8.3.gpustream.fs", nullptr,
+                               "8.3.gpustream.tcs", "8.3.gpustream.tes");
+
+    // open the tiled heightmap, converting it first when it doesn't exist yet
+    // -----------------------------------------------------------------------
+    std::string tilePath = argc > 1 ? argv[1] : FileSystem::getPath(TILE_FILE);
+    TerrainTileSet tiles;
+    if (!tiles.Open(tilePath))
+    {
+        if (!buildTileFile(tilePath) || !tiles.Open(tilePath))
+        {
+            std::cout << "Failed to create " << tilePath << std::endl;
+            return -1;
+        }
+    }
+    std::cout << "Tiled heightmap of " << tiles.Header.Width << " x " << tiles.Header.Height << " texels, "
+              << tiles.Header.Levels << " levels of " << tiles.Header.TileSize << " texel tiles" << std::endl;
+
+    // the coarsest clipmap level has to hold its whole mip level, so it can back up everything else
+    int clipmapLevels = 1;
+    while (clipmapLevels < MAX_CLIPMAP_LEVELS && clipmapLevels < (int)tiles.Header.Levels &&
+           glm::any(glm::greaterThan(tiles.TileCount(clipmapLevels - 1), glm::ivec2(CLIPMAP_TILES))))
+        clipmapLevels++;
+    const unsigned int clipmapSize = CLIPMAP_TILES * TILE_SIZE;
+
+    unsigned int clipmapTexture;
+    glGenTextures(1, &clipmapTexture);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, clipmapTexture);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R16, clipmapSize, clipmapSize, clipmapLevels, 0, GL_RED, GL_UNSIGNED_SHORT, NULL);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT); // toroidal addressing
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 2);
+    std::cout << "Clipmap: " << clipmapLevels << " levels of " << clipmapSize << " x " << clipmapSize << std::endl;
+
+    TerrainTileCache cache(tiles, CACHE_TILES);
+    std::vector<ClipmapLevel> levels(clipmapLevels);
+
+    // wait until the coarsest level is complete, from then on there is always something to draw
+    while (levels.back().Valid.x > levels.back().Valid.z)
+    {
+        updateClipmap(levels, tiles, cache, clipmapTexture, camera.Position, CLIPMAP_TILES * CLIPMAP_TILES);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    tessHeightMapShader.use();
+    tessHeightMapShader.setInt("clipmap", 0);
+    tessHeightMapShader.setInt("clipmapLevels", clipmapLevels);
+    tessHeightMapShader.setFloat("clipmapSize", (float)clipmapSize);
+    tessHeightMapShader.setVec2("terrainSize", glm::vec2(tiles.Header.Width, tiles.Header.Height));
+    tessHeightMapShader.setFloat("heightScale", HEIGHT_SCALE);
+    tessHeightMapShader.setFloat("heightShift", HEIGHT_SHIFT);
+
+    // set up vertex data (and buffer(s)) and configure vertex attributes
+    // ------------------------------------------------------------------
+    // a fixed grid of patches centered on the origin, moved to the camera every frame
+    std::vector<float> vertices;
+    vertices.reserve(PATCHES * PATCHES * NUM_PATCH_PTS * 3);
+    for(int i = 0; i < PATCHES; i++)
+    {
+        for(int j = 0; j < PATCHES; j++)
+        {
+            float x0 = (i - PATCHES / 2) * PATCH_SIZE, z0 = (j - PATCHES / 2) * PATCH_SIZE;
+            const float corners[NUM_PATCH_PTS][2] = { { x0, z0 }, { x0 + PATCH_SIZE, z0 }, { x0, z0 + PATCH_SIZE }, { x0 + PATCH_SIZE, z0 + PATCH_SIZE } };
+            for(const auto& corner : corners)
+            {
+                vertices.push_back(corner[0]); // v.x
+                vertices.push_back(0.0f);      // v.y
+                vertices.push_back(corner[1]); // v.z
+            }
+        }
+    }
+    std::cout << "Drawing " << PATCHES * PATCHES << " patches around the camera" << std::endl;
+
+    unsigned int terrainVAO, terrainVBO;
+    glGenVertexArrays(1, &terrainVAO);
+    glBindVertexArray(terrainVAO);
+
+    glGenBuffers(1, &terrainVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, terrainVBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glPatchParameteri(GL_PATCH_VERTICES, NUM_PATCH_PTS);
+
+    // statistics, reported every 100 frames
+    unsigned int frameCount = 0, uploadCount = 0;
+    const size_t clipmapBytes = (size_t)clipmapSize * clipmapSize * clipmapLevels * sizeof(uint16_t);
+
+    // render loop
+    // -----------
+    while (!glfwWindowShouldClose(window))
+    {
+        // per-frame time logic
+        // --------------------
+        float currentFrame = glfwGetTime();
+        deltaTime = currentFrame - lastFrame;
+        lastFrame = currentFrame;
+
+        // input
+        // -----
+        processInput(window);
+        if (flyAcross)
+        {
+            // fly along x and wrap around, so the loader never runs out of new tiles
+            camera.Position.x += 1500.0f * deltaTime;
+            if (camera.Position.x > tiles.Header.Width)
+                camera.Position.x -= tiles.Header.Width;
+        }
+
+        // stream
+        // ------
+        uploadCount += updateClipmap(levels, tiles, cache, clipmapTexture, camera.Position, UPLOADS_PER_FRAME);
+
+        // render
+        // ------
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+        // be sure to activate shader when setting uniforms/drawing objects
+        tessHeightMapShader.use();
+
+        // view/projection transformations
+        glm::mat4 projection = glm::perspective(glm::radians(camera.Zoom), (float)SCR_WIDTH / (float)SCR_HEIGHT, 0.1f, 100000.0f);
+        glm::mat4 view = camera.GetViewMatrix();
+        tessHeightMapShader.setMat4("projection", projection);
+        tessHeightMapShader.setMat4("view", view);
+
+        // world transformation
+        glm::mat4 model = glm::mat4(1.0f);
+        tessHeightMapShader.setMat4("model", model);
+
+        glm::vec2 gridOffset = glm::floor(glm::vec2(camera.Position.x, camera.Position.z) / PATCH_SIZE) * PATCH_SIZE;
+        tessHeightMapShader.setVec2("gridOffset", gridOffset);
+        for(int l = 0; l < clipmapLevels; l++)
+            tessHeightMapShader.setVec4("clipmapValid[" + std::to_string(l) + "]", levels[l].Valid);
+
+        // render the terrain
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, clipmapTexture);
+        glBindVertexArray(terrainVAO);
+        glDrawArrays(GL_PATCHES, 0, NUM_PATCH_PTS*PATCHES*PATCHES);
+
+        if (++frameCount % 100 == 0)
+        {
+            std::cout << "camera (" << (int)camera.Position.x << ", " << (int)camera.Position.z << "): "
+                      << cache.Loads << " tiles loaded, " << cache.Evictions << " evicted, " << uploadCount << " uploaded, "
+                      << cache.PendingRequests() << " pending | cache " << cache.MemoryBytes() / (1024 * 1024) << " MB, clipmap "
+                      << clipmapBytes / (1024 * 1024) << " MB, resident set " << residentMemoryBytes() / (1024 * 1024) << " MB" << std::endl;
+            cache.ResetStats();
+            uploadCount = 0;
+        }
+
+        // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
+        // -------------------------------------------------------------------------------
+        glfwSwapBuffers(window);
+        glfwPollEvents();
+    }
+
+    // optional: de-allocate all resources once they've outlived their purpose:
+    // ------------------------------------------------------------------------
+    glDeleteVertexArrays(1, &terrainVAO);
+    glDeleteBuffers(1, &terrainVBO);
+    glDeleteTextures(1, &clipmapTexture);
+
+    // glfw: terminate, clearing all previously allocated GLFW resources.
+    // ------------------------------------------------------------------
+    glfwTerminate();
+    return 0;
+}
+
+// converts the Iceland heightmap into a tile file: bilinearly upscaled, with a few octaves of
+// value noise so the extra resolution has detail to show
+// ---------------------------------------------------------------------------------------------
+float valueNoise(int x, int y)
+{
+    unsigned int h = (unsigned int)x * 374761393u + (unsigned int)y * 668265263u;
+    h = (h ^ (h >> 13)) * 1274126177u;
+    return ((h ^ (h >> 16)) & 0xffff) / 65535.0f;
+}
+
+float smoothNoise(float x, float y)
+{
+    int x0 = (int)std::floor(x), y0 = (int)std::floor(y);
+    float fx = x - x0, fy = y - y0;
+    fx = fx * fx * (3.0f - 2.0f * fx);
+    fy = fy * fy * (3.0f - 2.0f * fy);
+    float a = valueNoise(x0, y0) + (valueNoise(x0 + 1, y0) - valueNoise(x0, y0)) * fx;
+    float b = valueNoise(x0, y0 + 1) + (valueNoise(x0 + 1, y0 + 1) - valueNoise(x0, y0 + 1)) * fx;
+    return a + (b - a) * fy;
+}
+
+bool buildTileFile(const std::string& path)
+{
+    stbi_set_flip_vertically_on_load(true);
+    int width, height, nrChannels;
+    unsigned char *data = stbi_load(FileSystem::getPath("src/8.guest/2021/3.tessellation/terrain_gpu_dist/heightmaps/iceland_heightmap.png").c_str(), &width, &height, &nrChannels, 0);
+    if (!data)
+    {
+        std::cout << "Failed to load heightmap" << std::endl;
+        return false;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    unsigned int terrainWidth = width * TERRAIN_UPSCALE, terrainHeight = height * TERRAIN_UPSCALE;
+    std::cout << "Building " << path << " (" << terrainWidth << " x " << terrainHeight << " texels, "
+              << TerrainTileSet::FileSize(terrainWidth, terrainHeight, TILE_SIZE) / (1024 * 1024) << " MB), this only happens once;"
+              << " pass another path as the first argument to put it elsewhere" << std::endl;
+    bool written = TerrainTileSet::Write(path, terrainWidth, terrainHeight, TILE_SIZE,
+        [&](int x0, int y0, uint16_t* tile) {
+            for(unsigned int y = 0; y < TILE_SIZE; y++)
+            {
+                for(unsigned int x = 0; x < TILE_SIZE; x++)
+                {
+                    // clamp to the terrain, texels past its edge repeat the border
+                    float tx = (float)std::min(x0 + x, terrainWidth - 1), ty = (float)std::min(y0 + y, terrainHeight - 1);
+                    float u = std::min(tx / TERRAIN_UPSCALE, width - 1.001f), v = std::min(ty / TERRAIN_UPSCALE, height - 1.001f);
+                    int iu = (int)u, iv = (int)v;
+                    float fu = u - iu, fv = v - iv;
+                    auto texel = [&](int i, int j) { return data[(j * width + i) * nrChannels] / 255.0f; };
+                    float h = (texel(iu, iv) * (1.0f - fu) + texel(iu + 1, iv) * fu) * (1.0f - fv) +
+                              (texel(iu, iv + 1) * (1.0f - fu) + texel(iu + 1, iv + 1) * fu) * fv;
+                    float detail = smoothNoise(tx / 32.0f, ty / 32.0f) * 0.5f + smoothNoise(tx / 8.0f, ty / 8.0f) * 0.25f;
+                    h = glm::clamp(h * 0.94f + detail * 0.08f * h, 0.0f, 1.0f);
+                    tile[y * TILE_SIZE + x] = (uint16_t)(h * 65535.0f);
+                }
+            }
+        },
+        [](int level, int levels) {
+            std::cout << "  level " << level + 1 << " / " << levels << std::endl;
+        });
+    stbi_image_free(data);
+    std::cout << "Built in " << std::chrono::duration<float>(std::chrono::high_resolution_clock::now() - start).count() << " s" << std::endl;
+    return written;
+}
+
+// resident set size of the process, so we can check it stays flat while flying around
+// -------------------------------------------------------------------------------------
+size_t residentMemoryBytes()
+{
+#if defined(__linux__)
+    std::ifstream statm("/proc/self/statm");
+    size_t pages = 0, residentPages = 0;
+    statm >> pages >> residentPages;
+    return residentPages * (size_t)sysconf(_SC_PAGESIZE);
+#else
+    return 0;
+#endif
+}
+
+// process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
+// ---------------------------------------------------------------------------------------------------------
+void processInput(GLFWwindow *window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+        glfwSetWindowShouldClose(window, true);
+
+    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+        camera.ProcessKeyboard(FORWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+        camera.ProcessKeyboard(BACKWARD, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        camera.ProcessKeyboard(LEFT, deltaTime);
+    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        camera.ProcessKeyboard(RIGHT, deltaTime);
+}
+
+// glfw: whenever the window size changed (by OS or user resize) this callback function executes
+// ---------------------------------------------------------------------------------------------
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    // make sure the viewport matches the new window dimensions; note that width and
+    // height will be significantly larger than specified on retina displays.
+    glViewport(0, 0, width, height);
+}
+
+// glfw: whenever a key event occurs, this callback is called
+// ---------------------------------------------------------------------------------------------
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int modifiers)
+{
+    if(action == GLFW_PRESS)
+    {
+        switch(key)
+        {
+            case GLFW_KEY_P:
+                flyAcross = 1 - flyAcross;
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+// glfw: whenever the mouse moves, this callback is called
+// -------------------------------------------------------
+void mouse_callback(GLFWwindow* window, double xpos, double ypos)
+{
+    if (firstMouse)
+    {
+        lastX = xpos;
+        lastY = ypos;
+        firstMouse = false;
+    }
+
+    float xoffset = xpos - lastX;
+    float yoffset = lastY - ypos; // reversed since y-coordinates go from bottom to top
+
+    lastX = xpos;
+    lastY = ypos;
+
+    camera.ProcessMouseMovement(xoffset, yoffset);
+}
+
+// glfw: whenever the mouse scroll wheel scrolls, this callback is called
+// ----------------------------------------------------------------------
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
+{
+    camera.ProcessMouseScroll(yoffset);
+}
@@ -0,0 +1,116 @@
+#version 430 core
+
+// Compute version of 6.new_downsample.fs. Every 13-tap sample of the Call Of Duty downsample
+// sits on a texel corner of the source, so it is the average of a 2x2 texel block; a work group
+// loads the 20x20 source texels its 8x8 outputs need into shared memory once and builds all taps
+// from there. The first pass reads the HDR scene, applies the brightness threshold while loading
+// and the Karis average while combining, so no separate threshold pass or bright color buffer is
+// needed.
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+#define TILE 20 // 2 * 8 outputs + 2 texels on the low side + 2 on the high side
+
+uniform sampler2D srcTexture;
+uniform int srcLevel;
+layout (rgba16f, binding = 0) uniform writeonly image2D dstImage;
+
+uniform bool prefilter;  // first pass: threshold + Karis average
+uniform float threshold;
+uniform float knee;
+
+shared vec3 texels[TILE][TILE];
+
+vec3 PowVec3(vec3 v, float p)
+{
+    return vec3(pow(v.x, p), pow(v.y, p), pow(v.z, p));
+}
+
+const float invGamma = 1.0 / 2.2;
+vec3 ToSRGB(vec3 v)   { return PowVec3(v, invGamma); }
+
+float sRGBToLuma(vec3 col)
+{
+    return dot(col, vec3(0.299f, 0.587f, 0.114f));
+}
+
+float KarisAverage(vec3 col)
+{
+    // Formula is 1 / (1 + luma)
+    float luma = sRGBToLuma(ToSRGB(col)) * 0.25f;
+    return 1.0f / (1.0f + luma);
+}
+
+// soft knee threshold: fades in between threshold - knee and threshold + knee
+vec3 Threshold(vec3 color)
+{
+    float brightness = max(color.r, max(color.g, color.b));
+    float soft = clamp(brightness - threshold + knee, 0.0, 2.0 * knee);
+    soft = soft * soft / (4.0 * knee + 0.00001);
+    float contribution = max(soft, brightness - threshold) / max(brightness, 0.00001);
+    return color * contribution;
+}
+
+// average of the 2x2 texels starting at p, relative to the tile origin
+vec3 Box(ivec2 p)
+{
+    return 0.25 * (texels[p.y][p.x] + texels[p.y][p.x + 1] + texels[p.y + 1][p.x] + texels[p.y + 1][p.x + 1]);
+}
+
+void main()
+{
+    ivec2 srcSize = textureSize(srcTexture, srcLevel);
+    ivec2 dstSize = imageSize(dstImage);
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * 16 - 2;
+
+    for (int i = int(gl_LocalInvocationIndex); i < TILE * TILE; i += 64)
+    {
+        ivec2 local = ivec2(i % TILE, i / TILE);
+        vec3 color = texelFetch(srcTexture, clamp(tileOrigin + local, ivec2(0), srcSize - 1), srcLevel).rgb;
+        texels[local.y][local.x] = prefilter ? Threshold(color) : color;
+    }
+    barrier();
+
+    ivec2 dst = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(dst, dstSize)))
+        return;
+
+    // 2x2 block under the output texel's center, see 6.new_downsample.fs for the tap layout
+    ivec2 o = ivec2(gl_LocalInvocationID.xy) * 2 + 2;
+    vec3 a = Box(o + ivec2(-2,  2));
+    vec3 b = Box(o + ivec2( 0,  2));
+    vec3 c = Box(o + ivec2( 2,  2));
+    vec3 d = Box(o + ivec2(-2,  0));
+    vec3 e = Box(o);
+    vec3 f = Box(o + ivec2( 2,  0));
+    vec3 g = Box(o + ivec2(-2, -2));
+    vec3 h = Box(o + ivec2( 0, -2));
+    vec3 i = Box(o + ivec2( 2, -2));
+    vec3 j = Box(o + ivec2(-1,  1));
+    vec3 k = Box(o + ivec2( 1,  1));
+    vec3 l = Box(o + ivec2(-1, -1));
+    vec3 m = Box(o + ivec2( 1, -1));
+
+    vec3 downsample;
+    if (prefilter)
+    {
+        vec3 groups[5];
+        groups[0] = (a+b+d+e) * (0.125f/4.0f);
+        groups[1] = (b+c+e+f) * (0.125f/4.0f);
+        groups[2] = (d+e+g+h) * (0.125f/4.0f);
+        groups[3] = (e+f+h+i) * (0.125f/4.0f);
+        groups[4] = (j+k+l+m) * (0.5f/4.0f);
+        downsample = vec3(0.0);
+        for (int n = 0; n < 5; ++n)
+            downsample += groups[n] * KarisAverage(groups[n]);
+        downsample = max(downsample, 0.0001f);
+    }
+    else
+    {
+        downsample = e*0.125;
+        downsample += (a+c+g+i)*0.03125;
+        downsample += (b+d+f+h)*0.0625;
+        downsample += (j+k+l+m)*0.125;
+    }
+    imageStore(dstImage, dst, vec4(downsample, 1.0));
+}
@@ -0,0 +1,74 @@
+#version 430 core
+
+// Compute version of 6.new_upsample.fs: a 3x3 tent filter with a radius of one source texel,
+// sampled bilinearly at twice the source resolution. A work group's 8x8 outputs only touch an
+// 8x8 block of the smaller source mip, which is loaded into shared memory once. The result is
+// added to what the destination mip already holds (the additive blending of the fragment path).
+// The last pass writes the full resolution image instead: it adds the bloom to the HDR scene and
+// tonemaps and gamma corrects in the same pass, so the bloom never exists at full resolution.
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+#define TILE 8
+
+uniform sampler2D srcTexture;   // bloom mips
+uniform int srcLevel;
+uniform sampler2D sceneTexture; // HDR scene, final pass only
+layout (rgba16f, binding = 0) uniform image2D dstImage;
+layout (rgba8, binding = 1) uniform writeonly image2D outputImage;
+
+uniform bool finalComposite;
+uniform float exposure;
+uniform float bloomStrength;
+
+shared vec3 texels[TILE][TILE];
+
+// bilinear sample at continuous source texel coordinate p (texel centers on integers), relative to the tile origin
+vec3 Bilinear(vec2 p)
+{
+    ivec2 base = ivec2(floor(p));
+    vec2 t = p - vec2(base);
+    vec3 bottom = mix(texels[base.y][base.x], texels[base.y][base.x + 1], t.x);
+    vec3 top = mix(texels[base.y + 1][base.x], texels[base.y + 1][base.x + 1], t.x);
+    return mix(bottom, top, t.y);
+}
+
+void main()
+{
+    ivec2 srcSize = textureSize(srcTexture, srcLevel);
+    ivec2 dstSize = finalComposite ? imageSize(outputImage) : imageSize(dstImage);
+    // the source is at most half the destination size, so the taps of the group's outputs stay
+    // within TILE texels starting one texel before the first output's bilinear footprint
+    vec2 scale = vec2(srcSize) / vec2(dstSize);
+    ivec2 tileOrigin = ivec2(floor((vec2(gl_WorkGroupID.xy * 8u) + 0.5) * scale - 0.5)) - 1;
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    texels[local.y][local.x] = texelFetch(srcTexture, clamp(tileOrigin + local, ivec2(0), srcSize - 1), srcLevel).rgb;
+    barrier();
+
+    ivec2 dst = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(dst, dstSize)))
+        return;
+
+    // output texel center in source texel coordinates
+    vec2 p = (vec2(dst) + 0.5) * scale - 0.5 - vec2(tileOrigin);
+    //  1   | 1 2 1 |
+    // -- * | 2 4 2 |
+    // 16   | 1 2 1 |
+    vec3 upsample = Bilinear(p) * 4.0;
+    upsample += (Bilinear(p + vec2(0, 1)) + Bilinear(p + vec2(-1, 0)) + Bilinear(p + vec2(1, 0)) + Bilinear(p + vec2(0, -1))) * 2.0;
+    upsample += Bilinear(p + vec2(-1, 1)) + Bilinear(p + vec2(1, 1)) + Bilinear(p + vec2(-1, -1)) + Bilinear(p + vec2(1, -1));
+    upsample *= 1.0 / 16.0;
+
+    if (!finalComposite)
+    {
+        imageStore(dstImage, dst, vec4(imageLoad(dstImage, dst).rgb + upsample, 1.0));
+        return;
+    }
+    vec3 result = texelFetch(sceneTexture, dst, 0).rgb + upsample * bloomStrength;
+    // tone mapping
+    result = vec3(1.0) - exp(-result * exposure);
+    // also gamma correct while we're at it
+    const float gamma = 2.2;
+    result = pow(result, vec3(1.0 / gamma));
+    imageStore(outputImage, dst, vec4(result, 1.0));
+}
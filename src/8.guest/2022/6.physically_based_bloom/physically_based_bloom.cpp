@@ -8,10 +8,13 @@
 
 #include <learnopengl/filesystem.h>
 #include <learnopengl/shader.h>
+#include <learnopengl/shader_c.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
+#include <learnopengl/gpu_timer.h>
 
 #include <iostream>
+#include <iomanip>
 #include <vector>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -29,6 +32,10 @@ bool bloom = true;
 float exposure = 1.0f;
 int programChoice = 1;
 float bloomFilterRadius = 0.005f;
+// compute bloom (program 4): same mip count as the BloomRenderer
+const unsigned int COMPUTE_BLOOM_MIPS = 6;
+const float computeBloomThreshold = 1.0f;
+const float computeBloomKnee = 0.5f;
 
 // camera
 Camera camera(glm::vec3(0.0f, 0.0f, 5.0f));
@@ -322,7 +329,7 @@ int main()
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
@@ -365,6 +372,8 @@ int main()
     Shader shaderLight("6.bloom.vs", "6.light_box.fs");
     Shader shaderBlur("6.old_blur.vs", "6.old_blur.fs");
     Shader shaderBloomFinal("6.bloom_final.vs", "6.bloom_final.fs");
+    ComputeShader computeDownsample("6.compute_bloom_downsample.cs");
+    ComputeShader computeUpsample("6.compute_bloom_upsample.cs");
 
     // load textures
     // -------------
@@ -424,6 +433,28 @@ int main()
             std::cout << "Framebuffer not complete!" << std::endl;
     }
 
+    // compute bloom: one mipmapped texture for the whole chain (level 0 at half resolution) and
+    // the tonemapped output of the fused composite, which is blitted to the screen
+    unsigned int computeBloomTexture;
+    glGenTextures(1, &computeBloomTexture);
+    glBindTexture(GL_TEXTURE_2D, computeBloomTexture);
+    glTexStorage2D(GL_TEXTURE_2D, COMPUTE_BLOOM_MIPS, GL_RGBA16F, SCR_WIDTH / 2, SCR_HEIGHT / 2);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    unsigned int computeOutputFBO, computeOutputTexture;
+    glGenTextures(1, &computeOutputTexture);
+    glBindTexture(GL_TEXTURE_2D, computeOutputTexture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+    glGenFramebuffers(1, &computeOutputFBO);
+    glBindFramebuffer(GL_FRAMEBUFFER, computeOutputFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, computeOutputTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Framebuffer not complete!" << std::endl;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    auto computeBloomMipSize = [](unsigned int level) {
+        return glm::ivec2(std::max(1u, (SCR_WIDTH / 2) >> level), std::max(1u, (SCR_HEIGHT / 2) >> level));
+    };
+
     // lighting info
     // -------------
     // positions
@@ -449,6 +480,22 @@ int main()
     shaderBloomFinal.use();
     shaderBloomFinal.setInt("scene", 0);
     shaderBloomFinal.setInt("bloomBlur", 1);
+    computeDownsample.use();
+    computeDownsample.setInt("srcTexture", 0);
+    computeDownsample.setFloat("threshold", computeBloomThreshold);
+    computeDownsample.setFloat("knee", computeBloomKnee);
+    computeUpsample.use();
+    computeUpsample.setInt("srcTexture", 0);
+    computeUpsample.setInt("sceneTexture", 1);
+    // every mip adds its share of the thresholded energy, so average them
+    computeUpsample.setFloat("bloomStrength", 1.0f / COMPUTE_BLOOM_MIPS);
+
+    // timings of the bloom and the composite of every program, printed side by side every 100 frames
+    GpuTimer bloomTimer, compositeTimer;
+    float bloomMs[5] = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+    float compositeMs[5] = { -1.0f, -1.0f, -1.0f, -1.0f, -1.0f };
+    unsigned int reportFrames = 0;
+    int reportedChoice = programChoice;
 
     // bloom renderer
     // --------------
@@ -554,10 +601,11 @@ int main()
         }
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-        if (programChoice < 1 || programChoice > 3) { programChoice = 1; }
+        if (programChoice < 1 || programChoice > 4) { programChoice = 1; }
         bloom = (programChoice == 1) ? false : true;
         bool horizontal = true;
 
+        bloomTimer.Begin();
         // 2.A) bloom is disabled
         // ----------------------
         if (programChoice == 1)
@@ -592,25 +640,105 @@ int main()
 	        bloomRenderer.RenderBloomTexture(colorBuffers[1], bloomFilterRadius);
         }
 
+        // 2.D) compute bloom: threshold and first downsample in one dispatch straight from the
+        // HDR scene, the rest of the chain down and back up; the last upsample is fused into the composite
+        // ------------------------------------------------------------------------------------------------
+        else if (programChoice == 4)
+        {
+            computeDownsample.use();
+            glActiveTexture(GL_TEXTURE0);
+            for (unsigned int i = 0; i < COMPUTE_BLOOM_MIPS; i++)
+            {
+                computeDownsample.setBool("prefilter", i == 0);
+                computeDownsample.setInt("srcLevel", i == 0 ? 0 : i - 1);
+                glBindTexture(GL_TEXTURE_2D, i == 0 ? colorBuffers[0] : computeBloomTexture);
+                glBindImageTexture(0, computeBloomTexture, i, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+                glm::ivec2 size = computeBloomMipSize(i);
+                glDispatchCompute((size.x + 7) / 8, (size.y + 7) / 8, 1);
+                glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+            }
+            computeUpsample.use();
+            computeUpsample.setBool("finalComposite", false);
+            glBindTexture(GL_TEXTURE_2D, computeBloomTexture);
+            for (unsigned int i = COMPUTE_BLOOM_MIPS - 1; i > 0; i--)
+            {
+                computeUpsample.setInt("srcLevel", i);
+                glBindImageTexture(0, computeBloomTexture, i - 1, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA16F);
+                glm::ivec2 size = computeBloomMipSize(i - 1);
+                glDispatchCompute((size.x + 7) / 8, (size.y + 7) / 8, 1);
+                glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            }
+        }
+        bloomTimer.End();
+
         // 3. now render floating point color buffer to 2D quad and tonemap HDR colors to default framebuffer's (clamped) color range
         // --------------------------------------------------------------------------------------------------------------------------
+        compositeTimer.Begin();
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-        shaderBloomFinal.use();
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
-        glActiveTexture(GL_TEXTURE1);
-        if (programChoice == 1) {
-	        glBindTexture(GL_TEXTURE_2D, 0); // trick to bind invalid texture "0", we don't care either way!
+        if (programChoice == 4)
+        {
+            // upsample mip 0 to full resolution, add it to the scene and tonemap in one dispatch
+            computeUpsample.use();
+            computeUpsample.setBool("finalComposite", true);
+            computeUpsample.setInt("srcLevel", 0);
+            computeUpsample.setFloat("exposure", exposure);
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, computeBloomTexture);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+            glBindImageTexture(1, computeOutputTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+            glDispatchCompute((SCR_WIDTH + 7) / 8, (SCR_HEIGHT + 7) / 8, 1);
+            glMemoryBarrier(GL_FRAMEBUFFER_BARRIER_BIT);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, computeOutputFBO);
+            glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
         }
-        if (programChoice == 2) {
-	        glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
+        else
+        {
+            shaderBloomFinal.use();
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, colorBuffers[0]);
+            glActiveTexture(GL_TEXTURE1);
+            if (programChoice == 1) {
+                glBindTexture(GL_TEXTURE_2D, 0); // trick to bind invalid texture "0", we don't care either way!
+            }
+            if (programChoice == 2) {
+                glBindTexture(GL_TEXTURE_2D, pingpongColorbuffers[!horizontal]);
+            }
+            else if (programChoice == 3) {
+                glBindTexture(GL_TEXTURE_2D, bloomRenderer.BloomTexture());
+            }
+            shaderBloomFinal.setInt("programChoice", programChoice);
+            shaderBloomFinal.setFloat("exposure", exposure);
+            renderQuad();
+        }
+        compositeTimer.End();
+
+        if (programChoice != reportedChoice)
+        {
+            reportedChoice = programChoice;
+            bloomTimer.Reset();
+            compositeTimer.Reset();
+            reportFrames = 0;
         }
-        else if (programChoice == 3) {
-	        glBindTexture(GL_TEXTURE_2D, bloomRenderer.BloomTexture());
+        else if (++reportFrames >= 100)
+        {
+            bloomMs[programChoice] = (float)bloomTimer.AverageMs();
+            compositeMs[programChoice] = (float)compositeTimer.AverageMs();
+            const char* names[5] = { "", "no bloom", "gaussian ping-pong", "mip chain (fragment)", "mip chain (compute)" };
+            std::cout << std::fixed << std::setprecision(3) << "bloom + composite (ms), press 1-4 to measure the others:" << std::endl;
+            for (int i = 1; i <= 4; i++)
+            {
+                std::cout << (i == programChoice ? " > " : "   ") << i << " " << std::left << std::setw(22) << names[i] << std::right;
+                if (bloomMs[i] < 0.0f)
+                    std::cout << "not measured yet" << std::endl;
+                else
+                    std::cout << bloomMs[i] << " + " << compositeMs[i] << " = " << bloomMs[i] + compositeMs[i] << std::endl;
+            }
+            bloomTimer.Reset();
+            compositeTimer.Reset();
+            reportFrames = 0;
         }
-        shaderBloomFinal.setInt("programChoice", programChoice);
-        shaderBloomFinal.setFloat("exposure", exposure);
-        renderQuad();
 
         //std::cout << "bloom: " << (bloom ? "on" : "off") << "| exposure: " << exposure << std::endl;
 
@@ -621,6 +749,9 @@ int main()
     }
 
     bloomRenderer.Destroy();
+    glDeleteTextures(1, &computeBloomTexture);
+    glDeleteTextures(1, &computeOutputTexture);
+    glDeleteFramebuffers(1, &computeOutputFBO);
     glfwTerminate();
     return 0;
 }
@@ -771,6 +902,10 @@ void processInput(GLFWwindow *window)
     {
 	    programChoice = 3;
     }
+    else if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+    {
+	    programChoice = 4;
+    }
 }
 
 // glfw: whenever the window size changed (by OS or user resize) this callback function executes
@@ -0,0 +1,51 @@
+// Runs the self-checks of the CPU reference implementations in includes/learnopengl that the
+// compute shader demos are validated against, without a window or GL context. Each demo can
+// compare its GPU results with these references at runtime; this checks the references
+// themselves. Returns the number of failed checks, so it can run as a test.
+#include <learnopengl/clustered_lights.h>
+#include <learnopengl/gtao.h>
+#include <learnopengl/shadow_atlas.h>
+#include <learnopengl/transparency_queue.h>
+#include <learnopengl/auto_exposure.h>
+
+#include <iostream>
+#include <string>
+
+unsigned int failures = 0;
+
+void report(const std::string& name, bool passed, const std::string& details)
+{
+    std::cout << (passed ? "passed  " : "FAILED  ") << name << ": " << details << std::endl;
+    if (!passed)
+        failures++;
+}
+
+int main()
+{
+    // 8.3.deferred_shading_clustered: every point of a light sphere lies in a cluster that lists the light
+    unsigned int clusterMisses = ClusterBinningValidate();
+    report("cluster binning", clusterMisses == 0, std::to_string(clusterMisses) + " sampled points whose cluster misses their light");
+
+    // 9.2.ssao_gtao: closed-form slice integral against numeric integration, unoccluded visibility is 1
+    float maxIntegralError, maxUnoccludedError;
+    GTAOValidate(maxIntegralError, maxUnoccludedError);
+    report("gtao integral", maxIntegralError < 1e-4f && maxUnoccludedError < 1e-3f,
+           "closed form vs numeric max error " + std::to_string(maxIntegralError) + ", unoccluded visibility max error " + std::to_string(maxUnoccludedError));
+
+    // 3.3.shadow_atlas: tiles never overlap or leave the atlas, free space is counted exactly and merges back
+    report("shadow atlas allocator", ShadowAtlasValidate(), "random allocations and frees");
+
+    // 3.2.blending_sort: the queue keeps every object exactly once, furthest first, with many equal distances
+    TransparencyQueueStats queueStats = TransparencyQueueBenchmark(20000, 5);
+    report("transparency queue", queueStats.Valid, std::to_string(queueStats.Count) + " quads from 5 cameras, none lost and back to front");
+
+    // 6.hdr: histogram bins, clipped average and adaptation on synthetic images
+    unsigned int misbinnedPixels;
+    float maxAverageError, maxAdaptError;
+    AutoExposureValidate(misbinnedPixels, maxAverageError, maxAdaptError);
+    report("auto exposure", misbinnedPixels == 0 && maxAverageError < 1e-3f && maxAdaptError < 1e-4f,
+           std::to_string(misbinnedPixels) + " misbinned pixels, clipped average max error " + std::to_string(maxAverageError) +
+           " stops, adaptation max error " + std::to_string(maxAdaptError));
+
+    return (int)failures;
+}